@@ -0,0 +1,120 @@
+// push -> pop latency of the main thread queue, compared to the old mutex + std::queue.
+// usage: mpsc_queue_bench [producers] [messages per producer]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+#include <spdlog/spdlog.h>
+
+#include "vengine/core/mpsc_queue.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Message {
+    Clock::time_point sent;
+};
+
+class MutexQueue {
+   public:
+    auto tryPush(const Message& message) -> bool {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.push(message);
+        return true;
+    }
+
+    auto tryPop(Message& out) -> bool {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_queue.empty()) {
+            return false;
+        }
+        out = m_queue.front();
+        m_queue.pop();
+        return true;
+    }
+
+   private:
+    std::mutex m_mutex;
+    std::queue<Message> m_queue;
+};
+
+template <typename Queue>
+auto run(const std::string& name, Queue& queue, int producerCount, int messagesPerProducer) -> void {
+    std::atomic<bool> start{false};
+    std::vector<std::thread> producers;
+
+    for (int p = 0; p < producerCount; ++p) {
+        producers.emplace_back([&queue, &start, messagesPerProducer]() {
+            while (!start.load()) {
+                std::this_thread::yield();
+            }
+            for (int i = 0; i < messagesPerProducer; ++i) {
+                while (!queue.tryPush(Message{Clock::now()})) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    const size_t total = static_cast<size_t>(producerCount) * static_cast<size_t>(messagesPerProducer);
+    std::vector<uint64_t> latencies;
+    latencies.reserve(total);
+
+    auto begin = Clock::now();
+    start.store(true);
+
+    Message message;
+    while (latencies.size() < total) {
+        if (queue.tryPop(message)) {
+            latencies.push_back(static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - message.sent).count()));
+        }
+    }
+    auto seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+
+    for (auto& producer : producers) {
+        producer.join();
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&latencies](double p) {
+        return static_cast<double>(latencies[static_cast<size_t>(p * static_cast<double>(latencies.size() - 1))]) /
+               1000.0;
+    };
+
+    spdlog::info("{:<12} {} producers: {:.2f} M msg/s, latency p50 {:.2f} us, p99 {:.2f} us, p99.9 {:.2f} us, max {:.2f} us",
+                 name,
+                 producerCount,
+                 static_cast<double>(total) / seconds / 1e6,
+                 percentile(0.5),
+                 percentile(0.99),
+                 percentile(0.999),
+                 static_cast<double>(latencies.back()) / 1000.0);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int producerCount = argc > 1 ? std::stoi(argv[1]) : static_cast<int>(std::max(2u, std::thread::hardware_concurrency() - 1));
+    int messagesPerProducer = argc > 2 ? std::stoi(argv[2]) : 200000;
+
+    {
+        Vengine::MpscQueue<Message> queue(4096);
+        run("mpsc", queue, producerCount, messagesPerProducer);
+        auto stats = queue.getStats();
+        spdlog::info("{:<12} failed pushes (full): {}, high water mark: {}", "mpsc", stats.failedPushes, stats.highWaterMark);
+    }
+    {
+        MutexQueue queue;
+        run("mutex", queue, producerCount, messagesPerProducer);
+    }
+
+    return 0;
+}
@@ -0,0 +1,681 @@
+// load times of the textures and models in resources/ (and of a big synthetic texture and mesh),
+// per stage and through the ResourceManager sync and async paths, with throughput and peak memory.
+// runs from the directory the engine runs in. no window: resources stay cpu only and the gpu
+// upload is skipped, unless --gl gets a hidden context to upload to.
+//   read    the source file into memory (the page cache is warm after the first run)
+//   decode  source -> cpu data: stb decode + mips (Texture::load) or the assimp import with
+//           optimizing, lods and meshlets (MeshLoader::loadModelData), or their .vtex/.vmesh
+//   build   meshes only, gpu vertex formats and bounds (MeshLoader::createMesh + Mesh::load)
+//   upload  finalizeOnMainThread + glFinish, --gl only
+// with the caches on, the first run imports and fills cache/, later runs read it back.
+// usage: resource_bench [--runs n] [--no-cache] [--gl] [--synthetic size | --no-synthetic] [--json file]
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include <spdlog/spdlog.h>
+
+#ifdef __linux__
+#include <sys/resource.h>
+#endif
+
+#include "vengine/core/mesh.hpp"
+#include "vengine/core/mesh_loader.hpp"
+#include "vengine/core/resource_manager.hpp"
+#include "vengine/core/resources.hpp"
+#include "vengine/core/texture_cache.hpp"
+#include "vengine/core/thread_manager.hpp"
+#include "vengine/utils/vfs.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+enum class AssetType { Texture, Mesh };
+
+struct Asset {
+    std::string name;
+    std::string fileName;  // what the loaders take, relative to resources/models for meshes
+    std::filesystem::path path;
+    AssetType type = AssetType::Texture;
+    uint64_t bytes = 0;
+    bool synthetic = false;
+};
+
+struct Options {
+    int runs = 3;
+    bool cache = true;
+    bool gl = false;
+    uint32_t syntheticSize = 2048;  // texture size, the mesh is a grid of size / 4 quads a side
+    std::string json;
+};
+
+// seconds, negative for stages that did not run
+struct StageTimes {
+    double read = -1.0;
+    double decode = -1.0;
+    double build = -1.0;
+    double upload = -1.0;
+};
+
+struct AssetResult {
+    std::vector<StageTimes> runs;
+    uint64_t cpuBytes = 0;
+    uint64_t gpuBytes = 0;
+    size_t failed = 0;
+};
+
+struct PassResult {
+    std::string name;
+    std::vector<double> seconds{};
+    uint64_t peakRssKb = 0;
+    size_t failed = 0;
+};
+
+auto secondsSince(Clock::time_point start) -> double {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+auto getTypeName(AssetType type) -> const char* {
+    return type == AssetType::Texture ? "Texture" : "Mesh";
+}
+
+// negative values are skipped, -1 if nothing is left
+auto median(std::vector<double> values) -> double {
+    std::erase_if(values, [](double value) { return value < 0.0; });
+    if (values.empty()) {
+        return -1.0;
+    }
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+auto getMbPerSecond(uint64_t bytes, double seconds) -> double {
+    return seconds > 0.0 ? static_cast<double>(bytes) / (1024.0 * 1024.0) / seconds : 0.0;
+}
+
+// /proc/self/status field in kB, 0 off linux
+auto readStatusKb(const std::string& field) -> uint64_t {
+#ifdef __linux__
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.size() > field.size() && line.compare(0, field.size(), field) == 0 && line[field.size()] == ':') {
+            return std::stoull(line.substr(field.size() + 1));
+        }
+    }
+#endif
+    return 0;
+}
+
+// makes VmHWM start over from the current rss, so each pass gets its own peak. false on kernels
+// without it, the peak then is the one of the whole process so far
+auto resetPeakRss() -> bool {
+#ifdef __linux__
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    clearRefs << "5";
+    return static_cast<bool>(clearRefs.flush());
+#else
+    return false;
+#endif
+}
+
+auto getProcessPeakRssKb() -> uint64_t {
+#ifdef __linux__
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<uint64_t>(usage.ru_maxrss);
+#else
+    return 0;
+#endif
+}
+
+// uncompressed 32 bit tga, noise on a gradient so the block compressor has something to do
+auto writeSyntheticTexture(const std::filesystem::path& path, uint32_t size) -> bool {
+    std::vector<uint8_t> file(18 + static_cast<size_t>(size) * size * 4);
+    file[2] = 2;  // uncompressed true color
+    file[12] = static_cast<uint8_t>(size & 0xff);
+    file[13] = static_cast<uint8_t>(size >> 8);
+    file[14] = file[12];
+    file[15] = file[13];
+    file[16] = 32;
+    file[17] = 0x28;  // 8 alpha bits, top left origin
+
+    uint8_t* pixel = file.data() + 18;
+    for (uint32_t y = 0; y < size; ++y) {
+        for (uint32_t x = 0; x < size; ++x) {
+            uint32_t noise = (x * 73856093u) ^ (y * 19349663u);
+            noise = (noise ^ (noise >> 13)) * 0x5bd1e995u;
+            pixel[0] = static_cast<uint8_t>((x * 255 / size + (noise & 0x1f)) & 0xff);
+            pixel[1] = static_cast<uint8_t>((y * 255 / size + ((noise >> 8) & 0x1f)) & 0xff);
+            pixel[2] = static_cast<uint8_t>(((x ^ y) & 0xff) / 2 + ((noise >> 16) & 0x3f));
+            pixel[3] = 255;
+            pixel += 4;
+        }
+    }
+
+    std::ofstream out(path, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(file.data()), static_cast<std::streamsize>(file.size()));
+    return static_cast<bool>(out);
+}
+
+// obj height field of size x size quads with uvs and normals, one vertex per grid point
+auto writeSyntheticMesh(const std::filesystem::path& path, uint32_t size) -> bool {
+    std::string obj;
+    auto height = [](float x, float y) { return std::sin(x * 0.05f) * std::cos(y * 0.07f) * 4.0f; };
+    for (uint32_t y = 0; y <= size; ++y) {
+        for (uint32_t x = 0; x <= size; ++x) {
+            auto fx = static_cast<float>(x);
+            auto fy = static_cast<float>(y);
+            float dx = height(fx + 1.0f, fy) - height(fx - 1.0f, fy);
+            float dy = height(fx, fy + 1.0f) - height(fx, fy - 1.0f);
+            float length = std::sqrt(dx * dx + dy * dy + 4.0f);
+            fmt::format_to(std::back_inserter(obj),
+                           "v {:.4f} {:.4f} {:.4f}\nvt {:.5f} {:.5f}\nvn {:.4f} {:.4f} {:.4f}\n",
+                           fx,
+                           height(fx, fy),
+                           fy,
+                           fx / static_cast<float>(size),
+                           fy / static_cast<float>(size),
+                           -dx / length,
+                           2.0f / length,
+                           -dy / length);
+        }
+    }
+    for (uint32_t y = 0; y < size; ++y) {
+        for (uint32_t x = 0; x < size; ++x) {
+            // obj indices start at 1
+            uint32_t a = y * (size + 1) + x + 1;
+            uint32_t b = a + size + 1;
+            fmt::format_to(std::back_inserter(obj), "f {0}/{0}/{0} {1}/{1}/{1} {2}/{2}/{2}\n", a, b, a + 1);
+            fmt::format_to(std::back_inserter(obj), "f {0}/{0}/{0} {1}/{1}/{1} {2}/{2}/{2}\n", a + 1, b, b + 1);
+        }
+    }
+
+    std::ofstream out(path, std::ios::binary);
+    out.write(obj.data(), static_cast<std::streamsize>(obj.size()));
+    return static_cast<bool>(out);
+}
+
+auto collectAssets(const Options& options) -> std::vector<Asset> {
+    std::vector<Asset> assets;
+    std::error_code error;
+    const std::filesystem::path models = "resources/models";
+
+    for (const auto& entry : std::filesystem::recursive_directory_iterator("resources", error)) {
+        if (!entry.is_regular_file()) {
+            continue;
+        }
+        auto path = entry.path().lexically_normal();
+        auto extension = path.extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+        Asset asset;
+        asset.path = path;
+        asset.bytes = entry.file_size(error);
+        if (extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".tga" ||
+            extension == ".bmp") {
+            asset.type = AssetType::Texture;
+            asset.fileName = path.generic_string();
+        } else if (extension == ".obj" || extension == ".fbx" || extension == ".gltf" || extension == ".glb" ||
+                   extension == ".dae") {
+            asset.type = AssetType::Mesh;
+            asset.fileName = path.lexically_relative(models).generic_string();
+        } else {
+            continue;
+        }
+        asset.name = path.generic_string();
+        assets.push_back(std::move(asset));
+    }
+    std::sort(assets.begin(), assets.end(), [](const Asset& a, const Asset& b) { return a.name < b.name; });
+
+    if (options.syntheticSize == 0) {
+        return assets;
+    }
+
+    // kept between runs, so the caches see the same file stamp every time
+    auto directory = std::filesystem::temp_directory_path(error) / "vengine_resource_bench";
+    std::filesystem::create_directories(directory, error);
+    auto meshSize = std::max(1u, options.syntheticSize / 4);
+    auto texturePath = directory / fmt::format("synthetic_{}.tga", options.syntheticSize);
+    auto meshPath = directory / fmt::format("synthetic_{}.obj", meshSize);
+
+    if (!std::filesystem::exists(texturePath, error) && !writeSyntheticTexture(texturePath, options.syntheticSize)) {
+        spdlog::warn("Could not write {}", texturePath.string());
+    } else {
+        assets.push_back({"synthetic texture " + std::to_string(options.syntheticSize), texturePath.string(),
+                          texturePath, AssetType::Texture, std::filesystem::file_size(texturePath, error), true});
+    }
+    if (!std::filesystem::exists(meshPath, error) && !writeSyntheticMesh(meshPath, meshSize)) {
+        spdlog::warn("Could not write {}", meshPath.string());
+    } else {
+        assets.push_back({"synthetic mesh " + std::to_string(meshSize), meshPath.string(), meshPath, AssetType::Mesh,
+                          std::filesystem::file_size(meshPath, error), true});
+    }
+    return assets;
+}
+
+auto getResidency(const Options& options) -> Vengine::Residency {
+    return options.gl ? Vengine::Residency::GpuOnly : Vengine::Residency::CpuOnly;
+}
+
+auto measureStages(const Asset& asset,
+                   const Options& options,
+                   Vengine::TextureCache& textureCache,
+                   Vengine::MeshLoader& meshLoader,
+                   AssetResult& result) -> void {
+    StageTimes times;
+
+    auto start = Clock::now();
+    auto file = Vengine::Vfs::open(asset.path);
+    if (!file.isOpen()) {
+        spdlog::error("Could not read {}", asset.path.string());
+        result.failed++;
+        return;
+    }
+    // the file is mapped, touch every page to get it off the disk
+    volatile uint8_t sink = 0;
+    for (size_t i = 0; i < file.size(); i += 4096) {
+        sink = sink + file.data()[i];
+    }
+    times.read = secondsSince(start);
+
+    std::shared_ptr<Vengine::IResource> resource;
+    if (asset.type == AssetType::Texture) {
+        auto texture = std::make_shared<Vengine::Texture>();
+        texture->setResidency(getResidency(options));
+        texture->setCache(&textureCache);
+        start = Clock::now();
+        bool loaded = texture->load(asset.fileName);
+        times.decode = secondsSince(start);
+        if (!loaded) {
+            result.failed++;
+            return;
+        }
+        resource = texture;
+    } else {
+        Vengine::MeshCacheData data;
+        start = Clock::now();
+        bool loaded = meshLoader.loadModelData(asset.fileName, data);
+        times.decode = secondsSince(start);
+        if (!loaded) {
+            result.failed++;
+            return;
+        }
+        start = Clock::now();
+        auto mesh = meshLoader.createMesh(data, asset.fileName);
+        loaded = mesh && mesh->load(asset.fileName);
+        times.build = secondsSince(start);
+        if (!loaded) {
+            result.failed++;
+            return;
+        }
+        resource = mesh;
+    }
+
+    if (options.gl && resource->needsMainThreadInit()) {
+        start = Clock::now();
+        bool finalized = resource->finalizeOnMainThread();
+        // the driver copies in the background, the upload is done once the gpu has it
+        glFinish();
+        times.upload = secondsSince(start);
+        if (!finalized) {
+            result.failed++;
+        }
+    }
+
+    auto memory = resource->getMemoryUsage();
+    result.cpuBytes = memory.cpuBytes;
+    result.gpuBytes = memory.gpuBytes;
+    result.runs.push_back(times);
+    resource->unload();
+}
+
+auto configure(Vengine::ResourceManager& resources, const Options& options) -> void {
+    resources.setResidency<Vengine::Texture>(getResidency(options));
+    resources.setResidency<Vengine::Mesh>(getResidency(options));
+    resources.getTextureCache().setEnabled(options.cache);
+    resources.getMeshCache().setEnabled(options.cache);
+    resources.setHotReload(false);
+    if (options.gl) {
+        resources.initUploadRing();
+    }
+}
+
+// a fresh manager every pass, nothing is shared with (or deduplicated against) the previous one
+auto runSync(const std::vector<Asset>& assets,
+             const Options& options,
+             const std::shared_ptr<Vengine::ThreadManager>& threadManager,
+             PassResult& pass) -> void {
+    Vengine::ResourceManager resources;
+    if (auto result = resources.init(threadManager); !result) {
+        spdlog::error("ResourceManager init failed: {}", result.error().message);
+        pass.failed += assets.size();
+        return;
+    }
+    configure(resources, options);
+
+    resetPeakRss();
+    auto start = Clock::now();
+    for (const auto& asset : assets) {
+        bool loaded = asset.type == AssetType::Texture
+                          ? resources.load<Vengine::Texture>(asset.name, asset.fileName).isValid()
+                          : resources.load<Vengine::Mesh>(asset.name, asset.fileName).isValid();
+        if (!loaded) {
+            pass.failed++;
+        }
+    }
+    if (options.gl) {
+        glFinish();
+    }
+    pass.seconds.push_back(secondsSince(start));
+    pass.peakRssKb = std::max(pass.peakRssKb, readStatusKb("VmHWM"));
+}
+
+auto runAsync(const std::vector<Asset>& assets,
+              const Options& options,
+              const std::shared_ptr<Vengine::ThreadManager>& threadManager,
+              PassResult& pass) -> void {
+    Vengine::ResourceManager resources;
+    if (auto result = resources.init(threadManager); !result) {
+        spdlog::error("ResourceManager init failed: {}", result.error().message);
+        pass.failed += assets.size();
+        return;
+    }
+    configure(resources, options);
+
+    std::vector<Vengine::LoadTask> tasks;
+    for (const auto& asset : assets) {
+        tasks.push_back({asset.name, asset.fileName, getTypeName(asset.type)});
+    }
+
+    resetPeakRss();
+    auto start = Clock::now();
+    auto state = resources.loadBatch(tasks);
+    resources.wait(*state);
+    if (options.gl) {
+        glFinish();
+    }
+    pass.seconds.push_back(secondsSince(start));
+    pass.peakRssKb = std::max(pass.peakRssKb, readStatusKb("VmHWM"));
+    pass.failed += state->getFailedCount();
+}
+
+// hidden window, its context stays current on this thread for the uploads
+auto initGl() -> GLFWwindow* {
+    if (glfwInit() == 0) {
+        return nullptr;
+    }
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    auto* window = glfwCreateWindow(64, 64, "resource_bench", nullptr, nullptr);
+    if (window == nullptr) {
+        glfwTerminate();
+        return nullptr;
+    }
+    glfwMakeContextCurrent(window);
+    if (gladLoadGLLoader(reinterpret_cast<GLADloadproc>(glfwGetProcAddress)) == 0) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return nullptr;
+    }
+    return window;
+}
+
+auto escapeJson(const std::string& text) -> std::string {
+    std::string out;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            out += fmt::format("\\u{:04x}", static_cast<int>(c));
+        } else {
+            out += c;
+        }
+    }
+    return out;
+}
+
+// null for stages that did not run
+auto stageJson(double seconds, uint64_t bytes) -> std::string {
+    if (seconds < 0.0) {
+        return "null";
+    }
+    return fmt::format("{{\"seconds\": {:.6f}, \"mbPerSecond\": {:.2f}}}", seconds, getMbPerSecond(bytes, seconds));
+}
+
+auto writeJson(const std::string& fileName,
+               const Options& options,
+               size_t workerCount,
+               bool peakRssReset,
+               const std::vector<Asset>& assets,
+               const std::vector<AssetResult>& results,
+               const std::vector<PassResult>& passes,
+               uint64_t totalBytes) -> bool {
+    std::string json = "{\n";
+    fmt::format_to(std::back_inserter(json),
+                   "  \"runs\": {},\n  \"cache\": {},\n  \"gl\": {},\n  \"workers\": {},\n  \"peakRssReset\": {},\n",
+                   options.runs,
+                   options.cache,
+                   options.gl,
+                   workerCount,
+                   peakRssReset);
+    fmt::format_to(std::back_inserter(json),
+                   "  \"processPeakRssKb\": {},\n  \"totalBytes\": {},\n  \"assets\": [\n",
+                   getProcessPeakRssKb(),
+                   totalBytes);
+
+    for (size_t i = 0; i < assets.size(); ++i) {
+        const auto& asset = assets[i];
+        const auto& result = results[i];
+        auto stage = [&result](double StageTimes::*field) {
+            std::vector<double> values;
+            for (const auto& run : result.runs) {
+                values.push_back(run.*field);
+            }
+            return median(values);
+        };
+        fmt::format_to(std::back_inserter(json),
+                       "    {{\"name\": \"{}\", \"type\": \"{}\", \"file\": \"{}\", \"bytes\": {}, \"synthetic\": {}, "
+                       "\"cpuBytes\": {}, \"gpuBytes\": {}, \"failed\": {},\n",
+                       escapeJson(asset.name),
+                       getTypeName(asset.type),
+                       escapeJson(asset.path.generic_string()),
+                       asset.bytes,
+                       asset.synthetic,
+                       result.cpuBytes,
+                       result.gpuBytes,
+                       result.failed);
+        fmt::format_to(std::back_inserter(json),
+                       "     \"read\": {}, \"decode\": {}, \"build\": {}, \"upload\": {}}}{}\n",
+                       stageJson(stage(&StageTimes::read), asset.bytes),
+                       stageJson(stage(&StageTimes::decode), asset.bytes),
+                       stageJson(stage(&StageTimes::build), asset.bytes),
+                       stageJson(stage(&StageTimes::upload), asset.bytes),
+                       i + 1 < assets.size() ? "," : "");
+    }
+
+    json += "  ],\n  \"passes\": [\n";
+    for (size_t i = 0; i < passes.size(); ++i) {
+        const auto& pass = passes[i];
+        auto seconds = median(pass.seconds);
+        std::string runs;
+        for (auto run : pass.seconds) {
+            runs += fmt::format("{}{:.6f}", runs.empty() ? "" : ", ", run);
+        }
+        fmt::format_to(std::back_inserter(json),
+                       "    {{\"name\": \"{}\", \"seconds\": {:.6f}, \"mbPerSecond\": {:.2f}, \"peakRssKb\": {}, "
+                       "\"failed\": {}, \"runs\": [{}]}}{}\n",
+                       pass.name,
+                       seconds,
+                       getMbPerSecond(totalBytes, seconds),
+                       pass.peakRssKb,
+                       pass.failed,
+                       runs,
+                       i + 1 < passes.size() ? "," : "");
+    }
+    json += "  ]\n}\n";
+
+    if (fileName == "-") {
+        fmt::print("{}", json);
+        return true;
+    }
+    std::ofstream out(fileName, std::ios::binary);
+    out << json;
+    return static_cast<bool>(out);
+}
+
+auto formatStage(double seconds, uint64_t bytes) -> std::string {
+    if (seconds < 0.0) {
+        return fmt::format("{:>20}", "-");
+    }
+    return fmt::format("{:>8.2f} ms {:>6.0f} MB/s", seconds * 1000.0, getMbPerSecond(bytes, seconds));
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--runs" && i + 1 < argc) {
+            options.runs = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--no-cache") {
+            options.cache = false;
+        } else if (arg == "--gl") {
+            options.gl = true;
+        } else if (arg == "--synthetic" && i + 1 < argc) {
+            options.syntheticSize = static_cast<uint32_t>(std::clamp(std::stoi(argv[++i]), 4, 16384));
+        } else if (arg == "--no-synthetic") {
+            options.syntheticSize = 0;
+        } else if (arg == "--json" && i + 1 < argc) {
+            options.json = argv[++i];
+        } else {
+            spdlog::error(
+                "usage: resource_bench [--runs n] [--no-cache] [--gl] [--synthetic size | --no-synthetic] [--json file]");
+            return 1;
+        }
+    }
+
+    // the json may go to stdout, keep the log out of it
+    if (options.json == "-") {
+        spdlog::set_level(spdlog::level::warn);
+    }
+
+    GLFWwindow* window = nullptr;
+    if (options.gl) {
+        window = initGl();
+        if (window == nullptr) {
+            spdlog::warn("No OpenGL context, running without uploads");
+            options.gl = false;
+        }
+    }
+
+    auto assets = collectAssets(options);
+    if (assets.empty()) {
+        spdlog::error("Nothing to load, run it from the directory with resources/ or without --no-synthetic");
+        return 1;
+    }
+    uint64_t totalBytes = 0;
+    for (const auto& asset : assets) {
+        totalBytes += asset.bytes;
+    }
+
+    auto threadManager = std::make_shared<Vengine::ThreadManager>();
+    bool peakRssReset = resetPeakRss();
+    spdlog::info("{} assets, {:.1f} MB, {} workers, {} runs, cache {}, {}",
+                 assets.size(),
+                 static_cast<double>(totalBytes) / (1024.0 * 1024.0),
+                 threadManager->getWorkerCount(),
+                 options.runs,
+                 options.cache ? "on" : "off",
+                 options.gl ? "uploading" : "no uploads");
+
+    Vengine::TextureCache textureCache;
+    textureCache.setEnabled(options.cache);
+    Vengine::MeshLoader meshLoader;
+    meshLoader.setThreadManager(threadManager);
+    meshLoader.setResidency(getResidency(options));
+    meshLoader.getCache().setEnabled(options.cache);
+
+    std::vector<AssetResult> results(assets.size());
+    std::vector<PassResult> passes = {{"stages"}, {"sync"}, {"async"}};
+    for (int run = 0; run < options.runs; ++run) {
+        resetPeakRss();
+        auto start = Clock::now();
+        for (size_t i = 0; i < assets.size(); ++i) {
+            measureStages(assets[i], options, textureCache, meshLoader, results[i]);
+        }
+        passes[0].seconds.push_back(secondsSince(start));
+        passes[0].peakRssKb = std::max(passes[0].peakRssKb, readStatusKb("VmHWM"));
+
+        runSync(assets, options, threadManager, passes[1]);
+        runAsync(assets, options, threadManager, passes[2]);
+    }
+    for (const auto& result : results) {
+        passes[0].failed += result.failed;
+    }
+
+    for (size_t i = 0; i < assets.size(); ++i) {
+        const auto& asset = assets[i];
+        const auto& result = results[i];
+        auto stage = [&result](double StageTimes::*field) {
+            std::vector<double> values;
+            for (const auto& run : result.runs) {
+                values.push_back(run.*field);
+            }
+            return median(values);
+        };
+        spdlog::info("{:<40} {:>8.2f} MB  read {}  decode {}  build {}  upload {}",
+                     asset.name,
+                     static_cast<double>(asset.bytes) / (1024.0 * 1024.0),
+                     formatStage(stage(&StageTimes::read), asset.bytes),
+                     formatStage(stage(&StageTimes::decode), asset.bytes),
+                     formatStage(stage(&StageTimes::build), asset.bytes),
+                     formatStage(stage(&StageTimes::upload), asset.bytes));
+    }
+    for (const auto& pass : passes) {
+        auto seconds = median(pass.seconds);
+        spdlog::info("{:<8} {:>9.2f} ms {:>8.1f} MB/s, peak rss {:.1f} MB, {} failed",
+                     pass.name,
+                     seconds * 1000.0,
+                     getMbPerSecond(totalBytes, seconds),
+                     static_cast<double>(pass.peakRssKb) / 1024.0,
+                     pass.failed);
+    }
+    spdlog::info("texture cache {} hits / {} misses, mesh cache {} hits / {} misses",
+                 textureCache.getHits(),
+                 textureCache.getMisses(),
+                 meshLoader.getCache().getHits(),
+                 meshLoader.getCache().getMisses());
+
+    bool written = true;
+    if (!options.json.empty()) {
+        written = writeJson(options.json, options, threadManager->getWorkerCount(), peakRssReset, assets, results,
+                            passes, totalBytes);
+        if (!written) {
+            spdlog::error("Could not write {}", options.json);
+        }
+    }
+
+    if (window != nullptr) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+    }
+
+    bool failed = std::any_of(passes.begin(), passes.end(), [](const PassResult& pass) { return pass.failed > 0; });
+    return failed || !written ? 1 : 0;
+}
@@ -18,9 +18,12 @@ App::App() {
     m_vengine->renderer->setVSync(true);
 
     auto defaultShader = m_vengine->resourceManager->get<Vengine::Shader>("default");
-    m_vengine->resourceManager->loadModelAsync("cube", "box.obj", defaultShader);
-    m_vengine->resourceManager->loadAsync<Vengine::Script>("camera", "camera.lua");
-    m_vengine->threadManager->waitForCompletion();
+    // the scene only needs the camera script to start, the cube shows up once it is ready. the
+    // script gets its own state, waiting on m_sceneLoad would wait for the cube and its textures too
+    m_sceneLoad = std::make_shared<Vengine::LoadState>();
+    m_vengine->resourceManager->loadModelAsync(m_sceneLoad, "cube", "box.obj", defaultShader);
+    auto camera = m_vengine->resourceManager->loadAsync<Vengine::Script>("camera", "camera.lua");
+    m_vengine->resourceManager->wait(*camera.getState());
 
     m_vengine->addScene<EditorScene>("Scene1");
     m_vengine->loadScene("Scene1");
@@ -102,9 +105,16 @@ void App::statsPanel(const std::shared_ptr<Vengine::Vengine>& vengine) {
     ImGui::Text("Draw Calls: %zu", drawCalls);
     ImGui::Text("Vertices: %zu", vertexCount);
     ImGui::Text("Triangles: %zu", triangleCount);
+    ImGui::Text("Culled by clusters: %zu", vengine->renderer->getClusterCulledTriangleCount());
 
     // resource Manager Stats
     ImGui::SeparatorText("Resources");
+    if (m_sceneLoad && !m_sceneLoad->isDone()) {
+        ImGui::ProgressBar(m_sceneLoad->getProgress(), ImVec2(-1.0f, 0.0f), "Loading scene assets");
+    }
+    if (m_sceneLoad && m_sceneLoad->hasFailed()) {
+        ImGui::Text("%zu scene assets failed to load", m_sceneLoad->getFailedCount());
+    }
     auto textureCount = vengine->resourceManager->getLoadedCount<Vengine::Texture>();
     auto meshCount = vengine->resourceManager->getLoadedCount<Vengine::Mesh>();
     auto modelCount = vengine->resourceManager->getLoadedCount<Vengine::Model>();
@@ -117,6 +127,75 @@ void App::statsPanel(const std::shared_ptr<Vengine::Vengine>& vengine) {
     ImGui::Text("Shaders: %zu", shaderCount);
     ImGui::Text("Scripts: %zu", scriptCount);
     ImGui::Text("Sounds: %zu", soundCount);
+    bool hotReload = vengine->resourceManager->isHotReloadEnabled();
+    if (ImGui::Checkbox("Hot Reload", &hotReload)) {
+        vengine->resourceManager->setHotReload(hotReload);
+    }
+    ImGui::SameLine();
+    ImGui::Text("%zu files watched, %zu reloads",
+                vengine->resourceManager->getWatchedFileCount(),
+                vengine->resourceManager->getHotReloadCount());
+    if (const auto* ring = vengine->resourceManager->getUploadRing()) {
+        ImGui::Text("Upload ring: %.2f / %.2f MB",
+                    static_cast<double>(ring->getUsedBytes()) / (1024.0 * 1024.0),
+                    static_cast<double>(ring->getSize()) / (1024.0 * 1024.0));
+    }
+    bool sharedUploads = vengine->resourceManager->getUploadMode() == Vengine::UploadMode::SharedContext;
+    if (ImGui::Checkbox("Upload Thread", &sharedUploads)) {
+        vengine->resourceManager->setUploadMode(sharedUploads ? Vengine::UploadMode::SharedContext
+                                                              : Vengine::UploadMode::MainThread);
+    }
+    if (const auto* uploadThread = vengine->resourceManager->getUploadThread()) {
+        ImGui::SameLine();
+        ImGui::Text("%zu uploaded on the shared context", uploadThread->getUploadedCount());
+    }
+    if (ImGui::TreeNode("Memory")) {
+        for (const auto& usage : vengine->resourceManager->getUsage()) {
+            ImGui::Text("%s: %zu (%zu in use), cpu %.2f MB, gpu %.2f MB, %zu evicted",
+                        usage.type.c_str(),
+                        usage.count,
+                        usage.referenced,
+                        static_cast<double>(usage.cpuBytes) / (1024.0 * 1024.0),
+                        static_cast<double>(usage.gpuBytes) / (1024.0 * 1024.0),
+                        usage.evicted);
+            if (usage.duplicates > 0) {
+                ImGui::Text("  %zu duplicates sharing content, %.2f MB saved",
+                            usage.duplicates,
+                            static_cast<double>(usage.bytesSaved) / (1024.0 * 1024.0));
+            }
+            int budgetMb = static_cast<int>(usage.budgetBytes / (1024 * 1024));
+            auto label = usage.type + " Budget (MB, 0 = off)";
+            if (ImGui::SliderInt(label.c_str(), &budgetMb, 0, 4096)) {
+                vengine->resourceManager->setBudget(usage.type, static_cast<uint64_t>(budgetMb) * 1024 * 1024);
+            }
+        }
+        ImGui::TreePop();
+    }
+
+    auto& streamer = vengine->resourceManager->getTextureStreamer();
+    ImGui::SeparatorText("Texture Streaming");
+    ImGui::Text("Resident: %.1f / %.1f MB, %zu textures, %u loading",
+                static_cast<double>(streamer.getResidentBytes()) / (1024.0 * 1024.0),
+                static_cast<double>(streamer.getBudget()) / (1024.0 * 1024.0),
+                streamer.getStreamedCount(),
+                streamer.getLoadsInFlight());
+    int budgetMb = static_cast<int>(streamer.getBudget() / (1024 * 1024));
+    if (ImGui::SliderInt("Texture Budget (MB)", &budgetMb, 16, 4096)) {
+        streamer.setBudget(static_cast<uint64_t>(budgetMb) * 1024 * 1024);
+    }
+    if (ImGui::TreeNode("Streamed Textures")) {
+        for (const auto& info : streamer.getStats()) {
+            ImGui::Text("%s: mip %u (wants %u, tail %u, %u levels) %.2f MB%s",
+                        info.name.c_str(),
+                        info.residentLevel,
+                        info.requestedLevel,
+                        info.tailLevel,
+                        info.levelCount,
+                        static_cast<double>(info.residentBytes) / (1024.0 * 1024.0),
+                        info.loading ? ", loading" : "");
+        }
+        ImGui::TreePop();
+    }
 
     // thread Manager Stats
     auto workerCount = vengine->threadManager->getWorkerCount();
@@ -124,10 +203,33 @@ void App::statsPanel(const std::shared_ptr<Vengine::Vengine>& vengine) {
     auto completedTasks = vengine->threadManager->getCompletedTasks();
     auto completedMainThreadTasks = vengine->threadManager->getCompletedMainThreadTasks();
     ImGui::SeparatorText("Threading");
-    ImGui::Text("Workers: %zu", workerCount);
+    ImGui::Text("Workers: %zu (%zu physical / %zu logical cores)",
+                workerCount,
+                vengine->threadManager->getTopology().physicalCount(),
+                vengine->threadManager->getTopology().logicalCount);
     ImGui::Text("Active Tasks: %zu", activeTasks);
     ImGui::Text("Completed Tasks: %zu", completedTasks);
     ImGui::Text("Completed Main Thread Tasks: %zu", completedMainThreadTasks);
+    ImGui::Text("Main Thread Tasks: %zu in %.3f ms, %zu deferred",
+                vengine->threadManager->getLastMainThreadTasksRun(),
+                static_cast<double>(vengine->threadManager->getLastMainThreadFrameTime()) / 1000.0,
+                vengine->threadManager->getDeferredMainThreadTaskCount());
+    int budgetUs = static_cast<int>(vengine->threadManager->getMainThreadBudget().count());
+    if (ImGui::SliderInt("Main Thread Budget (us)", &budgetUs, 0, 16000)) {
+        vengine->threadManager->setMainThreadBudget(std::chrono::microseconds(budgetUs));
+    }
+    auto& profiler = vengine->threadManager->getProfiler();
+    bool profilerEnabled = profiler.isEnabled();
+    if (ImGui::Checkbox("Profile Tasks", &profilerEnabled)) {
+        profiler.setEnabled(profilerEnabled);
+    }
+    if (profilerEnabled) {
+        ImGui::SameLine();
+        if (ImGui::Button("Export Trace")) {
+            profiler.exportChromeTrace("task_trace.json");
+            profiler.logSummary();
+        }
+    }
 
     // Scene Stats
     ImGui::SeparatorText("Scene");
@@ -14,6 +14,8 @@ class App {
 
    private:
     std::shared_ptr<Vengine::Vengine> m_vengine;
+    // everything the editor scene loads, for the progress bar in the stats panel
+    std::shared_ptr<Vengine::LoadState> m_sceneLoad;
 
     auto entitiesPanel(const std::shared_ptr<Vengine::Vengine>& vengine) -> void;
     auto entityNode(const std::shared_ptr<Vengine::Vengine>& vengine, Vengine::EntityId entityId) -> void;
@@ -4,7 +4,8 @@ namespace Veditor {
 
 void EditorScene::load(Vengine::Vengine& vengine) {
     // cam
-    auto camScript = vengine.resourceManager->get<Vengine::Script>("camera");
+    // both are loaded async in App, the handles resolve once the loads are done
+    auto camScript = vengine.resourceManager->getHandle<Vengine::Script>("camera");
     auto editorCamId = vengine.ecs->createEntity();
     auto editorCam = vengine.ecs->getEntity(editorCamId);
     editorCam.addComponent<Vengine::TagComponent>("editor.camera");
@@ -21,7 +22,7 @@ void EditorScene::load(Vengine::Vengine& vengine) {
     camComp->aspectRatio = static_cast<float>(vengine.window->getWidth()) / static_cast<float>(vengine.window->getHeight());
 
     // cube
-    auto cubeModel = vengine.resourceManager->get<Vengine::Model>("cube");
+    auto cubeModel = vengine.resourceManager->getHandle<Vengine::Model>("cube");
     auto cubeId = vengine.ecs->createEntity();
     auto cube = vengine.ecs->getEntity(cubeId);
     cube.addComponent<Vengine::TagComponent>("cube");
@@ -29,12 +29,14 @@ App::App() {
     m_vengine->resourceManager->loadAsync<Vengine::Texture>("aquariumTexture", "aquarium.png");
     m_vengine->resourceManager->loadAsync<Vengine::Texture>("test_texture", "test.jpg");
     m_vengine->resourceManager->loadAsync<Vengine::Texture>("test_texture2", "test2.jpg");
-    m_vengine->resourceManager->loadAsync<Vengine::Texture>("skybox_right", "skybox/cube_right.png");
-    m_vengine->resourceManager->loadAsync<Vengine::Texture>("skybox_left", "skybox/cube_left.png");
-    m_vengine->resourceManager->loadAsync<Vengine::Texture>("skybox_top", "skybox/cube_up.png");
-    m_vengine->resourceManager->loadAsync<Vengine::Texture>("skybox_bottom", "skybox/cube_down.png");
-    m_vengine->resourceManager->loadAsync<Vengine::Texture>("skybox_back", "skybox/cube_back.png");
-    m_vengine->resourceManager->loadAsync<Vengine::Texture>("skybox_front", "skybox/cube_front.png");
+    // the skybox copies its faces on the gpu, they have to be finalized before the scene loads
+    auto skyboxLoad = std::make_shared<Vengine::LoadState>();
+    m_vengine->resourceManager->loadAsync<Vengine::Texture>(skyboxLoad, "skybox_right", "skybox/cube_right.png");
+    m_vengine->resourceManager->loadAsync<Vengine::Texture>(skyboxLoad, "skybox_left", "skybox/cube_left.png");
+    m_vengine->resourceManager->loadAsync<Vengine::Texture>(skyboxLoad, "skybox_top", "skybox/cube_up.png");
+    m_vengine->resourceManager->loadAsync<Vengine::Texture>(skyboxLoad, "skybox_bottom", "skybox/cube_down.png");
+    m_vengine->resourceManager->loadAsync<Vengine::Texture>(skyboxLoad, "skybox_back", "skybox/cube_back.png");
+    m_vengine->resourceManager->loadAsync<Vengine::Texture>(skyboxLoad, "skybox_front", "skybox/cube_front.png");
 
     m_vengine->resourceManager->loadModelAsync("table_____________________", "table.blend", defaultShader);
     // lua scripts
@@ -53,8 +55,9 @@ App::App() {
     m_vengine->resourceManager->load<Vengine::Shader>("skybox", "resources/shaders/skybox.vert", "resources/shaders/skybox.frag");
 
 
-    // sleep until skybox textures are loaded
+    // sleep until the scripts are loaded, and the skybox textures finalized on this thread
     m_vengine->threadManager->waitForCompletion();
+    m_vengine->resourceManager->wait(*skyboxLoad);
 
     // -------------------- ACTIONS ---------------------
     m_vengine->actions->add("quit", [this]() { m_vengine->isRunning = false; });
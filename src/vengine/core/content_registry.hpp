@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace Vengine {
+
+// the first live resource for each content hash. a load whose content hashes to something that
+// is already registered shares that resource's gpu object instead of decoding and uploading again.
+// entries are weak, the registry never keeps anything alive
+template <typename T>
+class ContentRegistry {
+   public:
+    // the live resource registered for hash, or nullptr after registering candidate for it
+    auto findOrAdd(uint64_t hash, const std::shared_ptr<T>& candidate) -> std::shared_ptr<T> {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto& entry = m_entries[hash];
+        if (auto existing = entry.lock(); existing && existing != candidate) {
+            return existing;
+        }
+        entry = candidate;
+        return nullptr;
+    }
+
+    // the live resource registered for hash, nullptr if there is none
+    [[nodiscard]] auto find(uint64_t hash) const -> std::shared_ptr<T> {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_entries.find(hash);
+        return it != m_entries.end() ? it->second.lock() : nullptr;
+    }
+
+    // drops every entry of resource, its content is about to change (hot reload)
+    auto remove(const T* resource) -> void {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::erase_if(m_entries, [resource](const auto& entry) { return entry.second.lock().get() == resource; });
+    }
+
+    // forgets resources that are gone
+    auto prune() -> void {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::erase_if(m_entries, [](const auto& entry) { return entry.second.expired(); });
+    }
+
+    [[nodiscard]] auto size() const -> size_t {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_entries.size();
+    }
+
+   private:
+    mutable std::mutex m_mutex;
+    std::unordered_map<uint64_t, std::weak_ptr<T>> m_entries;
+};
+
+}  // namespace Vengine
@@ -0,0 +1,208 @@
+#include "cpu_topology.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <thread>
+#include <spdlog/spdlog.h>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace Vengine {
+
+namespace {
+
+auto readFirstLine(const std::filesystem::path& path, std::string& out) -> bool {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+    return static_cast<bool>(std::getline(file, out));
+}
+
+auto readNumber(const std::filesystem::path& path, uint32_t& out) -> bool {
+    std::string line;
+    if (!readFirstLine(path, line)) {
+        return false;
+    }
+    try {
+        out = static_cast<uint32_t>(std::stoul(line));
+    } catch (const std::exception&) {
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+auto parseCpuList(const std::string& list) -> std::vector<uint32_t> {
+    std::vector<uint32_t> cpus;
+    std::stringstream stream(list);
+    std::string range;
+
+    while (std::getline(stream, range, ',')) {
+        range.erase(std::remove_if(range.begin(), range.end(), [](unsigned char c) { return std::isspace(c); }),
+                    range.end());
+        if (range.empty()) {
+            continue;
+        }
+
+        try {
+            auto dash = range.find('-');
+            if (dash == std::string::npos) {
+                cpus.push_back(static_cast<uint32_t>(std::stoul(range)));
+                continue;
+            }
+            auto first = static_cast<uint32_t>(std::stoul(range.substr(0, dash)));
+            auto last = static_cast<uint32_t>(std::stoul(range.substr(dash + 1)));
+            for (uint32_t cpu = first; cpu <= last; ++cpu) {
+                cpus.push_back(cpu);
+            }
+        } catch (const std::exception&) {
+            spdlog::warn("CpuTopology: invalid cpu list entry '{}'", range);
+        }
+    }
+
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return cpus;
+}
+
+auto CpuTopology::fallback(size_t logicalCount) -> CpuTopology {
+    CpuTopology topology;
+    topology.logicalCount = std::max<size_t>(1, logicalCount);
+    for (size_t i = 0; i < topology.logicalCount; ++i) {
+        PhysicalCore core;
+        core.coreId = static_cast<uint32_t>(i);
+        core.logicalCpus.push_back(static_cast<uint32_t>(i));
+        topology.cores.push_back(std::move(core));
+    }
+    return topology;
+}
+
+auto CpuTopology::fromSysfs(const std::string& root) -> CpuTopology {
+    CpuTopology topology;
+
+    std::string onlineList;
+    if (!readFirstLine(std::filesystem::path(root) / "online", onlineList)) {
+        return topology;
+    }
+
+    // (package, core) -> siblings. core ids are only unique within a package
+    std::map<std::pair<uint32_t, uint32_t>, PhysicalCore> cores;
+    for (auto cpu : parseCpuList(onlineList)) {
+        auto topologyDir = std::filesystem::path(root) / ("cpu" + std::to_string(cpu)) / "topology";
+
+        PhysicalCore core;
+        if (!readNumber(topologyDir / "core_id", core.coreId)) {
+            core.coreId = cpu;
+        }
+        readNumber(topologyDir / "physical_package_id", core.packageId);
+
+        auto& entry = cores[{core.packageId, core.coreId}];
+        entry.packageId = core.packageId;
+        entry.coreId = core.coreId;
+        entry.logicalCpus.push_back(cpu);
+        ++topology.logicalCount;
+    }
+
+    for (auto& [key, core] : cores) {
+        std::sort(core.logicalCpus.begin(), core.logicalCpus.end());
+        topology.cores.push_back(std::move(core));
+    }
+    return topology;
+}
+
+auto CpuTopology::restrictedTo(const std::vector<uint32_t>& allowed) const -> CpuTopology {
+    CpuTopology topology;
+    for (const auto& core : cores) {
+        PhysicalCore kept = core;
+        std::erase_if(kept.logicalCpus,
+                      [&allowed](uint32_t cpu) { return !std::binary_search(allowed.begin(), allowed.end(), cpu); });
+        if (kept.logicalCpus.empty()) {
+            continue;
+        }
+        topology.logicalCount += kept.logicalCpus.size();
+        topology.cores.push_back(std::move(kept));
+    }
+    return topology;
+}
+
+auto CpuTopology::detect() -> CpuTopology {
+#ifdef __linux__
+    auto topology = fromSysfs("/sys/devices/system/cpu");
+    if (topology.cores.empty()) {
+        spdlog::warn("CpuTopology: could not read /sys, assuming no smt");
+        topology = fallback(std::thread::hardware_concurrency());
+    }
+
+    // the workers only get to run where the process may, an online cpu outside the mask is no help
+    std::vector<uint32_t> allowed;
+    if (getCurrentThreadAffinity(allowed)) {
+        auto restricted = topology.restrictedTo(allowed);
+        if (!restricted.cores.empty()) {
+            topology = std::move(restricted);
+        }
+    }
+    spdlog::debug("CpuTopology: {} physical cores, {} logical cpus", topology.physicalCount(), topology.logicalCount);
+    return topology;
+#else
+    return fallback(std::thread::hardware_concurrency());
+#endif
+}
+
+auto setCurrentThreadName(const std::string& name) -> bool {
+#ifdef __linux__
+    return pthread_setname_np(pthread_self(), name.substr(0, 15).c_str()) == 0;
+#else
+    (void)name;
+    return false;
+#endif
+}
+
+auto setCurrentThreadAffinity(const std::vector<uint32_t>& cpus) -> bool {
+#ifdef __linux__
+    if (cpus.empty()) {
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (auto cpu : cpus) {
+        if (cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpus;
+    return false;
+#endif
+}
+
+auto getCurrentThreadAffinity(std::vector<uint32_t>& cpus) -> bool {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) != 0) {
+        return false;
+    }
+    cpus.clear();
+    for (uint32_t cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &set)) {
+            cpus.push_back(cpu);
+        }
+    }
+    return !cpus.empty();
+#else
+    (void)cpus;
+    return false;
+#endif
+}
+
+}  // namespace Vengine
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Vengine {
+
+struct PhysicalCore {
+    uint32_t packageId = 0;
+    uint32_t coreId = 0;
+    std::vector<uint32_t> logicalCpus;  // smt siblings, sorted
+};
+
+// physical cores sorted by package and core id. on linux this comes from /sys, limited to the cpus
+// the process may run on, everywhere else (or when /sys is not readable) every logical cpu is
+// treated as its own core.
+struct CpuTopology {
+    std::vector<PhysicalCore> cores;
+    size_t logicalCount = 0;
+
+    [[nodiscard]] auto physicalCount() const -> size_t {
+        return cores.size();
+    }
+
+    [[nodiscard]] static auto detect() -> CpuTopology;
+    // root is normally /sys/devices/system/cpu, tests point it at a fake tree
+    [[nodiscard]] static auto fromSysfs(const std::string& root) -> CpuTopology;
+    [[nodiscard]] static auto fallback(size_t logicalCount) -> CpuTopology;
+
+    // only the cpus in allowed, cores left without any are dropped
+    [[nodiscard]] auto restrictedTo(const std::vector<uint32_t>& allowed) const -> CpuTopology;
+};
+
+// parses the kernel cpu list format, "0-3,8,10-11"
+auto parseCpuList(const std::string& list) -> std::vector<uint32_t>;
+
+// these only do something on linux, they return false where unsupported.
+// names longer than 15 characters are cut, that is the pthread limit
+auto setCurrentThreadName(const std::string& name) -> bool;
+auto setCurrentThreadAffinity(const std::vector<uint32_t>& cpus) -> bool;
+// the cpus the calling thread may run on, sorted. taskset, cgroups and containers narrow it down
+auto getCurrentThreadAffinity(std::vector<uint32_t>& cpus) -> bool;
+
+}  // namespace Vengine
@@ -1,9 +1,20 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 
 namespace Vengine {
 
+// what a resource keeps once it is finalized. the cpu copy is only worth its memory for whoever
+// reads the data back (cpu side picking, collision shapes from a mesh, ...), the default drops it
+// right after the upload. cpu only resources are never uploaded at all
+enum class Residency { GpuOnly, CpuAndGpu, CpuOnly };
+
+struct ResourceMemory {
+    uint64_t cpuBytes = 0;
+    uint64_t gpuBytes = 0;
+};
+
 class IResource {
    public:
     virtual ~IResource() = default;
@@ -15,7 +26,30 @@ class IResource {
     }
 
     [[nodiscard]] virtual auto needsMainThreadInit() const -> bool {
-        return m_needsMainThreadInit;
+        return m_needsMainThreadInit && m_residency != Residency::CpuOnly;
+    }
+
+    // before load, the ResourceManager sets its per type default
+    auto setResidency(Residency residency) -> void {
+        m_residency = residency;
+    }
+    [[nodiscard]] auto getResidency() const -> Residency {
+        return m_residency;
+    }
+
+    // rough guess of what finalizeOnMainThread costs in microseconds, used for the main thread frame budget
+    [[nodiscard]] virtual auto getFinalizeCostHint() const -> uint32_t {
+        return 0;
+    }
+
+    // what the resource holds right now, for the per type accounting and budgets
+    [[nodiscard]] virtual auto getMemoryUsage() const -> ResourceMemory {
+        return {};
+    }
+
+    // the resource whose gpu object this one shares (same content), see ContentRegistry
+    [[nodiscard]] virtual auto getDuplicateOf() const -> const IResource* {
+        return nullptr;
     }
 
     virtual auto finalizeOnMainThread() -> bool {
@@ -26,9 +60,25 @@ class IResource {
         return true;
     }
 
+    // UploadMode::SharedContext. uploadShared is the part of finalizeOnMainThread that only makes
+    // objects every context in the share group sees (buffers, textures), it runs on the upload
+    // thread. finishUpload runs on the main thread once that upload is complete on the gpu, it
+    // makes the result visible and creates what can't be shared (vertex arrays). resources that
+    // can't split it up answer false to supportsSharedUpload and finalize on the main thread
+    [[nodiscard]] virtual auto supportsSharedUpload() const -> bool {
+        return false;
+    }
+    virtual auto uploadShared() -> bool {
+        return false;
+    }
+    virtual auto finishUpload() -> bool {
+        return true;
+    }
+
    protected:
     bool m_isLoaded = false;
     bool m_needsMainThreadInit = false;
+    Residency m_residency = Residency::GpuOnly;
 };
 
 }  // namespace Vengine
\ No newline at end of file
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+#include "vengine/core/resource_handle.hpp"
+#include "vengine/core/wait_group.hpp"
+
+namespace Vengine {
+
+// one async load, or a batch of them, together with everything they pull in (model -> mesh and
+// material textures -> main thread finalize). dependencies are only known once their parent is
+// loaded, so the total can grow while the load runs and progress may step back a little
+class LoadState {
+   public:
+    // counted into by the worker tasks, main thread finalizes and dependent loads
+    [[nodiscard]] auto getGroup() const -> const std::shared_ptr<WaitGroup>& {
+        return m_group;
+    }
+
+    [[nodiscard]] auto isDone() const -> bool {
+        return m_group->isDone();
+    }
+
+    [[nodiscard]] auto getPending() const -> size_t {
+        return m_group->getPending();
+    }
+
+    [[nodiscard]] auto getTotal() const -> size_t {
+        return m_group->getTotal();
+    }
+
+    // 0..1, 1 for a state nothing was added to
+    [[nodiscard]] auto getProgress() const -> float {
+        auto total = getTotal();
+        if (total == 0) {
+            return 1.0f;
+        }
+        auto pending = std::min(getPending(), total);
+        return static_cast<float>(total - pending) / static_cast<float>(total);
+    }
+
+    // resources of the load itself that failed, a missing texture of a model doesn't count
+    auto markFailed() -> void {
+        m_failed.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] auto getFailedCount() const -> size_t {
+        return m_failed.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] auto hasFailed() const -> bool {
+        return getFailedCount() > 0;
+    }
+
+   private:
+    std::shared_ptr<WaitGroup> m_group = std::make_shared<WaitGroup>();
+    std::atomic<size_t> m_failed{0};
+};
+
+// what the async loads return, the handle plus the state of the load behind it.
+// converts to the plain Handle for storing in components
+template <typename T>
+class LoadHandle {
+   public:
+    LoadHandle() = default;
+    LoadHandle(Handle<T> handle, std::shared_ptr<LoadState> state) : m_handle(handle), m_state(std::move(state)) {
+    }
+
+    [[nodiscard]] auto getHandle() const -> Handle<T> {
+        return m_handle;
+    }
+
+    operator Handle<T>() const {
+        return m_handle;
+    }
+
+    [[nodiscard]] auto getState() const -> const std::shared_ptr<LoadState>& {
+        return m_state;
+    }
+
+    [[nodiscard]] auto isValid() const -> bool {
+        return m_handle.isValid();
+    }
+
+    // finished, successfully or not
+    [[nodiscard]] auto isDone() const -> bool {
+        return !m_state || m_state->isDone();
+    }
+
+    [[nodiscard]] auto hasFailed() const -> bool {
+        return !m_handle.isValid() || (m_state && m_state->hasFailed());
+    }
+
+    [[nodiscard]] auto getProgress() const -> float {
+        return m_state ? m_state->getProgress() : 1.0f;
+    }
+
+   private:
+    Handle<T> m_handle;
+    std::shared_ptr<LoadState> m_state;
+};
+
+}  // namespace Vengine
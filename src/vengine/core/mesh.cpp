@@ -2,24 +2,143 @@
 
 #include <glad/glad.h>
 #include <spdlog/spdlog.h>
+#include <algorithm>
 #include <cstddef>
+#include <cstring>
+#include <limits>
 
+#include "vengine/core/content_registry.hpp"
 #include "vengine/renderer/vertex_array.hpp"
+#include "vengine/utils/hash.hpp"
 
 namespace Vengine {
 
 Mesh::Mesh(const std::vector<float>& vertices, const std::vector<uint32_t>& indices, VertexLayout layout)
-    : m_vertices(vertices), m_indices(indices), m_useIndices(!indices.empty()), m_layout(layout) {
+    : m_vertices(vertices), m_indices(indices), m_useIndices(!indices.empty()), m_layout(layout), m_gpuLayout(layout) {
+    countElements();
+}
+
+Mesh::Mesh(std::vector<float>&& vertices, std::vector<uint32_t>&& indices, VertexLayout layout)
+    : m_vertices(std::move(vertices)),
+      m_indices(std::move(indices)),
+      m_useIndices(!m_indices.empty()),
+      m_layout(layout),
+      m_gpuLayout(layout) {
+    countElements();
+}
+
+auto Mesh::countElements() -> void {
+    int floatsPerVertex = getFloatsPerVertex();
+    m_vertexCount = floatsPerVertex == 0 ? 0 : m_vertices.size() / static_cast<size_t>(floatsPerVertex);
+    m_indexCount = m_indices.size();
+}
+
+auto Mesh::pack() -> void {
+    if (!m_compact || m_vertices.empty() || !m_layout.isFloats() || m_residency == Residency::CpuOnly) {
+        return;
+    }
+    m_gpuLayout = chooseCompactLayout(m_vertices.data(), m_vertexCount, m_layout);
+    if (m_gpuLayout != m_layout) {
+        m_packedVertices.resize(m_vertexCount * m_gpuLayout.stride);
+        packVertices(m_vertices.data(), m_vertexCount, m_layout, m_gpuLayout, m_packedVertices.data());
+    }
+    if (m_useIndices && m_vertexCount <= std::numeric_limits<uint16_t>::max() + size_t{1}) {
+        m_shortIndices.resize(m_indices.size());
+        std::transform(m_indices.begin(), m_indices.end(), m_shortIndices.begin(),
+                       [](uint32_t index) { return static_cast<uint16_t>(index); });
+        m_indexSize = sizeof(uint16_t);
+    }
+
+    // the bounds are known by now, nothing else needs the floats before the upload
+    if (m_residency == Residency::GpuOnly) {
+        if (!m_packedVertices.empty()) {
+            m_vertices = {};
+        }
+        if (!m_shortIndices.empty()) {
+            m_indices = {};
+        }
+    }
+}
+
+auto Mesh::getUploadVertices() const -> const void* {
+    if (!m_packedVertices.empty()) {
+        return m_packedVertices.data();
+    }
+    return m_vertices.empty() ? nullptr : m_vertices.data();
+}
+
+auto Mesh::getUploadIndices() const -> const void* {
+    if (!m_shortIndices.empty()) {
+        return m_shortIndices.data();
+    }
+    return m_indices.empty() ? nullptr : m_indices.data();
+}
+
+auto Mesh::stageUpload() -> void {
+    if (!m_uploadRing || m_residency == Residency::CpuOnly || !getUploadVertices()) {
+        return;
+    }
+    auto vertexBytes = m_vertexCount * m_gpuLayout.stride;
+    auto indexOffset = (vertexBytes + UploadRing::ALIGNMENT - 1) / UploadRing::ALIGNMENT * UploadRing::ALIGNMENT;
+    auto indexBytes = m_useIndices ? m_indexCount * m_indexSize : 0;
+    m_staging = m_uploadRing->allocate(indexBytes > 0 ? indexOffset + indexBytes : vertexBytes);
+    if (!m_staging) {
+        return;
+    }
+    std::memcpy(m_staging.data(), getUploadVertices(), vertexBytes);
+    if (indexBytes > 0) {
+        std::memcpy(m_staging.data() + indexOffset, getUploadIndices(), indexBytes);
+    }
+    m_packedVertices = {};
+    m_shortIndices = {};
+    if (m_residency == Residency::GpuOnly) {
+        m_vertices = {};
+        m_indices = {};
+    }
+}
+
+auto Mesh::deduplicate(ContentRegistry<Mesh>& registry) -> bool {
+    if (m_vertices.empty()) {
+        return false;
+    }
+    static_assert(std::has_unique_object_representations_v<VertexLayout>, "VertexLayout has padding, can't hash it");
+    uint64_t hash = hash64(&m_layout, sizeof(m_layout));
+    hash = hash64(m_vertices.data(), m_vertices.size() * sizeof(float), hash);
+    hash = hash64(m_indices.data(), m_indices.size() * sizeof(uint32_t), hash);
+
+    auto original = registry.findOrAdd(hash, shared_from_this());
+    if (!original) {
+        return false;
+    }
+    if (!m_hasBounds) {
+        auto [boundsMin, boundsMax] = getBounds();
+        setBounds(boundsMin, boundsMax);
+    }
+    m_original = std::move(original);
+    m_vertices = {};
+    m_indices = {};
+    return true;
 }
 
 auto Mesh::load(const std::string& fileName) -> bool {
+    // a duplicate has no geometry of its own to check or upload
+    if (m_original) {
+        m_needsMainThreadInit = false;
+        return true;
+    }
+
+    // models load their meshes when they create them, ResourceManager::load comes by a second time
+    if (m_staging || !m_packedVertices.empty()) {
+        return true;
+    }
+
     int floatsPerVertex = getFloatsPerVertex();
     // spdlog::debug("Constructor Mesh. Indices: {}, Vertices: {}, Layout: (Pos:{}, Tex:{}, Norm:{}), FloatsPerVertex: {}",
     //               m_indices.size(),
     //               m_vertices.size() / static_cast<size_t>(floatsPerVertex),
-    //               m_layout.hasPosition,
-    //               m_layout.hasTexCoords,
-    //               m_layout.hasNormals,
+    //               m_layout.has(VertexAttribute::Position),
+    //               m_layout.has(VertexAttribute::TexCoords),
+    //               m_layout.has(VertexAttribute::Normal),
     //               floatsPerVertex);
 
     if (m_vertices.empty() || (m_vertices.size() % static_cast<size_t>(floatsPerVertex) != 0)) {
@@ -28,25 +147,80 @@ auto Mesh::load(const std::string& fileName) -> bool {
                       floatsPerVertex);
     }
 
+    // bounds once here on the worker, the renderer asks for them every frame
+    if (!m_hasBounds && m_layout.has(VertexAttribute::Position) && !m_vertices.empty()) {
+        auto [boundsMin, boundsMax] = getBounds();
+        setBounds(boundsMin, boundsMax);
+    }
+
+    pack();
+    stageUpload();
     m_needsMainThreadInit = true;
     return true;
 }
 
 auto Mesh::finalizeOnMainThread() -> bool {
+    // the original uploads through whoever loaded it
+    if (m_original) {
+        return true;
+    }
+    return createBuffers() && createVertexArray();
+}
+
+auto Mesh::supportsSharedUpload() const -> bool {
+    // staged data is copied on the main context, its fences live there
+    return !m_original && !m_staging && getUploadVertices();
+}
+
+auto Mesh::uploadShared() -> bool {
+    return createBuffers();
+}
+
+auto Mesh::finishUpload() -> bool {
+    return createVertexArray();
+}
+
+auto Mesh::createBuffers() -> bool {
     // Validate input data
-    if (m_vertices.empty()) {
+    if (!getUploadVertices() && !m_staging) {
         spdlog::error("Cannot finalize mesh: no vertex data");
         return false;
     }
 
-    // Create vertex buffer
-    m_vertexBuffer = std::make_shared<VertexBuffer>(m_vertices.data(), m_vertices.size() * sizeof(float));
+    // Create vertex buffer, staged data is copied over on the gpu
+    auto vertexBytes = m_vertexCount * m_gpuLayout.stride;
+    m_vertexBuffer = std::make_shared<VertexBuffer>(m_staging ? nullptr : getUploadVertices(), vertexBytes);
     if (!m_vertexBuffer || m_vertexBuffer->getId() == 0) {
         spdlog::error("Failed to create vertex buffer");
+        m_staging.reset();
         return false;
     }
+    if (m_staging) {
+        glCopyNamedBufferSubData(m_staging.getBuffer(), m_vertexBuffer->getId(),
+                                 static_cast<GLintptr>(m_staging.getOffset()), 0, static_cast<GLsizeiptr>(vertexBytes));
+    }
 
-    // Create vertex array
+    // Create index buffer if needed
+    if (m_useIndices && m_indexCount > 0) {
+        m_indexBuffer = std::make_shared<IndexBuffer>(m_staging ? nullptr : getUploadIndices(), m_indexCount,
+                                                      m_indexSize == sizeof(uint16_t) ? GL_UNSIGNED_SHORT
+                                                                                      : GL_UNSIGNED_INT);
+        if (m_staging) {
+            auto indexOffset = (vertexBytes + UploadRing::ALIGNMENT - 1) / UploadRing::ALIGNMENT * UploadRing::ALIGNMENT;
+            glCopyNamedBufferSubData(m_staging.getBuffer(), m_indexBuffer->getId(),
+                                     static_cast<GLintptr>(m_staging.getOffset() + indexOffset), 0,
+                                     static_cast<GLsizeiptr>(m_indexCount * m_indexSize));
+        }
+    } else {
+        spdlog::warn("Mesh created without indices.");
+    }  
+    m_staging.reset();
+    m_gpuBytes = vertexBytes + (m_indexBuffer ? m_indexCount * m_indexSize : 0);
+    return true;
+}
+
+// vertex arrays are not shared between contexts, this always runs on the main thread
+auto Mesh::createVertexArray() -> bool {
     m_vertexArray = std::make_shared<VertexArray>();
     if (!m_vertexArray || m_vertexArray->getID() == 0) {
         spdlog::error("Failed to create vertex array");
@@ -54,32 +228,62 @@ auto Mesh::finalizeOnMainThread() -> bool {
     }
     
     // Add buffer to vertex array
-    m_vertexArray->addVertexBuffer(m_vertexBuffer, m_layout);
-    
-    // Create index buffer if needed
-    if (m_useIndices && !m_indices.empty()) {
-        m_indexBuffer = std::make_shared<IndexBuffer>(m_indices.data(), m_indices.size());
+    m_vertexArray->addVertexBuffer(m_vertexBuffer, m_gpuLayout);
+    if (m_indexBuffer) {
         m_vertexArray->addIndexBuffer(m_indexBuffer);
-    } else {
-        spdlog::warn("Mesh created without indices.");
-    }  
+    }
 
     m_needsMainThreadInit = false;
     
     // Log successful initialization
-    int floatsPerVertex = getFloatsPerVertex();
     spdlog::debug("Mesh finalized successfully: VAO ID: {}, Vertices: {}, Indices: {}",
                 m_vertexArray->getID(), 
-                m_vertices.size() / static_cast<size_t>(floatsPerVertex),
-                m_indices.size());
+                m_vertexCount,
+                m_indexCount);
+
+    // bounds and counts are kept, the geometry itself only lives on the gpu from here on
+    if (!m_hasBounds && m_layout.has(VertexAttribute::Position)) {
+        auto [boundsMin, boundsMax] = getBounds();
+        setBounds(boundsMin, boundsMax);
+    }
+    m_packedVertices = {};
+    m_shortIndices = {};
+    if (m_residency == Residency::GpuOnly) {
+        m_vertices = {};
+        m_indices = {};
+    }
                 
     return true;
 }
 
+auto Mesh::getFinalizeCostHint() const -> uint32_t {
+    // staged meshes only record two buffer copies
+    if (m_staging) {
+        return 10;
+    }
+    // buffer uploads, assumes roughly 2 GB/s
+    auto bytes = m_vertexCount * m_gpuLayout.stride + m_indexCount * m_indexSize;
+    return static_cast<uint32_t>(bytes / 2000);
+}
+
+auto Mesh::getMemoryUsage() const -> ResourceMemory {
+    ResourceMemory memory;
+    memory.cpuBytes = m_vertices.capacity() * sizeof(float) + m_indices.capacity() * sizeof(uint32_t) +
+                      m_packedVertices.capacity() + m_shortIndices.capacity() * sizeof(uint16_t) +
+                      m_meshlets.capacity() * sizeof(Meshlet) + m_meshletBounds.getMemoryUsage();
+    // the vertex array comes last, on the main thread, the buffers may still be on their way
+    if (m_vertexArray) {
+        memory.gpuBytes = m_gpuBytes;
+    }
+    return memory;
+}
+
 auto Mesh::unload() -> bool {
+    m_original.reset();
     m_vertexArray.reset();
     m_vertexBuffer.reset();
     m_indexBuffer.reset();
+    m_staging.reset();
 
     return true;
 }
@@ -89,31 +293,39 @@ Mesh::~Mesh() {
 }
 
 [[nodiscard]] auto Mesh::getFloatsPerVertex() const -> int {
-    int count = 0;
+    return m_layout.calculateStride() / static_cast<int>(sizeof(float));
+}
 
-    if (m_layout.hasPosition) {
-        count += 3;
-    }
-    if (m_layout.hasTexCoords) {
-        count += 2;
-    }
-    if (m_layout.hasNormals) {
-        count += 3;
-    }
+[[nodiscard]] auto Mesh::getVertexCount() const -> size_t {
+    return m_original ? m_original->getVertexCount() : m_vertexCount;
+}
 
-    return count;
+auto Mesh::getSubmeshLod(size_t submesh, size_t level) const -> IndexRange {
+    const auto& target = m_submeshes[submesh];
+    if (level == 0 || target.lods.empty()) {
+        return {target.indexOffset, target.indexCount};
+    }
+    return target.lods[std::min(level, target.lods.size()) - 1];
 }
 
-[[nodiscard]] auto Mesh::getVertexCount() const -> size_t {
-    int floatsPerVertex = getFloatsPerVertex();
-    if (floatsPerVertex == 0) {
-        return 0;
+auto Mesh::getLod(size_t level) const -> IndexRange {
+    if (m_submeshes.empty()) {
+        return {0, static_cast<uint32_t>(m_indexCount)};
     }
-    return m_vertices.size() / static_cast<size_t>(floatsPerVertex);
+    IndexRange range{std::numeric_limits<uint32_t>::max(), 0};
+    for (size_t i = 0; i < m_submeshes.size(); i++) {
+        auto lod = getSubmeshLod(i, level);
+        range.indexOffset = std::min(range.indexOffset, lod.indexOffset);
+        range.indexCount += lod.indexCount;
+    }
+    return range;
 }
 
 [[nodiscard]] auto Mesh::getBounds() const -> std::pair<glm::vec3, glm::vec3> {
-    if (m_vertices.empty() || !m_layout.hasPosition) {
+    if (m_hasBounds) {
+        return {m_boundsMin, m_boundsMax};
+    }
+    if (m_vertices.empty() || !m_layout.has(VertexAttribute::Position)) {
         return {glm::vec3(0.0f), glm::vec3(0.0f)};
     }
 
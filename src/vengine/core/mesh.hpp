@@ -4,39 +4,89 @@
 #include <glm/glm.hpp>
 // #include "vertex_array.hpp"
 #include "vengine/core/i_resource.hpp"
+#include "vengine/core/meshlets.hpp"
 #include "vengine/renderer/vertex_buffer.hpp"
 #include "vengine/renderer/index_buffer.hpp"
 #include "vengine/renderer/vertex_layout.hpp"
+#include "vengine/renderer/upload_ring.hpp"
 
 namespace Vengine {
 
 class VertexArray;
+template <typename T>
+class ContentRegistry;
+
+struct IndexRange {
+    uint32_t indexOffset = 0;
+    uint32_t indexCount = 0;
+};
 
 struct Submesh {
     uint32_t indexOffset;
     uint32_t indexCount;
     std::string materialName;  
+    std::vector<IndexRange> lods;  // level 1 and up
+    // level 0 as Mesh::getMeshlets()[firstMeshlet, firstMeshlet + meshletCount), empty if not split
+    uint32_t firstMeshlet = 0;
+    uint32_t meshletCount = 0;
 };
 
-class Mesh : public IResource {
+class Mesh : public IResource, public std::enable_shared_from_this<Mesh> {
    public:
+    // level 0 is the mesh as imported, MeshLoader generates up to 4 coarser ones
+    static constexpr size_t MAX_LOD_LEVELS = 5;
+
     Mesh() = default;
     Mesh(const std::vector<float>& vertices, const std::vector<uint32_t>& indices, VertexLayout layout);
+    Mesh(std::vector<float>&& vertices, std::vector<uint32_t>&& indices, VertexLayout layout);
     ~Mesh() override;
 
     auto load(const std::string& fileName) -> bool override;
     auto unload() -> bool override;
     auto finalizeOnMainThread() -> bool override;
+    [[nodiscard]] auto getFinalizeCostHint() const -> uint32_t override;
+    [[nodiscard]] auto getMemoryUsage() const -> ResourceMemory override;
+    [[nodiscard]] auto supportsSharedUpload() const -> bool override;
+    auto uploadShared() -> bool override;
+    auto finishUpload() -> bool override;
+    [[nodiscard]] auto needsMainThreadInit() const -> bool override {
+        return m_original ? m_original->needsMainThreadInit()
+                          : m_needsMainThreadInit && m_residency != Residency::CpuOnly;
+    }
+
+    // before load(). vertices and indices are staged through the ring on the worker then
+    auto setUploadRing(UploadRing* ring) -> void {
+        m_uploadRing = ring;
+    }
 
+    // before load(). load() then picks the smallest vertex formats that keep the data close enough
+    // (see chooseCompactLayout) and 16-bit indices where they fit, the cpu copy stays floats
+    auto setCompactVertices(bool compact) -> void {
+        m_compact = compact;
+    }
+
+    // before load(). if a mesh with the same vertices, indices and layout is registered already,
+    // this one drops its geometry and draws with that mesh's buffers, submeshes and bounds stay its own
+    auto deduplicate(ContentRegistry<Mesh>& registry) -> bool;
+    [[nodiscard]] auto getDuplicateOf() const -> const IResource* override {
+        return m_original.get();
+    }
+
+    // computed from the vertices unless known already (mesh cache)
     [[nodiscard]] auto getBounds() const -> std::pair<glm::vec3, glm::vec3>;
+    auto setBounds(const glm::vec3& min, const glm::vec3& max) -> void {
+        m_boundsMin = min;
+        m_boundsMax = max;
+        m_hasBounds = true;
+    }
     [[nodiscard]] auto getVertexArray() const -> const std::shared_ptr<VertexArray>& {
-        return m_vertexArray;
+        return m_original ? m_original->getVertexArray() : m_vertexArray;
     }
     [[nodiscard]] auto getVertexBuffer() const -> const std::shared_ptr<VertexBuffer>& {
-        return m_vertexBuffer;
+        return m_original ? m_original->getVertexBuffer() : m_vertexBuffer;
     }
     [[nodiscard]] auto getIndexBuffer() const -> const std::shared_ptr<IndexBuffer>& {
-        return m_indexBuffer;
+        return m_original ? m_original->getIndexBuffer() : m_indexBuffer;
     }
     [[nodiscard]] auto useIndices() const -> bool {
         return m_useIndices;
@@ -44,15 +94,21 @@ class Mesh : public IResource {
     [[nodiscard]] auto getVertexCount() const -> size_t;
     [[nodiscard]] auto getFloatsPerVertex() const -> int;
 
+    // of the cpu copy, always floats()
     [[nodiscard]] auto getVertexLayout() const -> const VertexLayout& {
         return m_layout;
     }
+    // of the vertex buffer
+    [[nodiscard]] auto getGpuVertexLayout() const -> const VertexLayout& {
+        return m_original ? m_original->getGpuVertexLayout() : m_gpuLayout;
+    }
 
+    // empty once a Residency::GpuOnly mesh is uploaded
     [[nodiscard]] auto getVerticesRaw() const -> const std::vector<float>& {
-        return m_vertices;
+        return m_original ? m_original->getVerticesRaw() : m_vertices;
     }
     [[nodiscard]] auto getIndicesRaw() const -> const std::vector<uint32_t>& {
-        return m_indices;
+        return m_original ? m_original->getIndicesRaw() : m_indices;
     }
 
     [[nodiscard]] auto getSubmeshes() const -> const std::vector<Submesh>& {
@@ -63,16 +119,71 @@ class Mesh : public IResource {
         m_submeshes.push_back(submesh);
     }
 
+    // per level from 1, how far its surface may be from level 0's in model units. every
+    // submesh has a range for each level
+    auto setLodErrors(std::vector<float> errors) -> void {
+        m_lodErrors = std::move(errors);
+    }
+    [[nodiscard]] auto getLodCount() const -> size_t {
+        return m_lodErrors.size() + 1;
+    }
+    [[nodiscard]] auto getLodError(size_t level) const -> float {
+        return level == 0 ? 0.0f : m_lodErrors[level - 1];
+    }
+    [[nodiscard]] auto getSubmeshLod(size_t submesh, size_t level) const -> IndexRange;
+    // every submesh at once, the levels are laid out one after the other
+    [[nodiscard]] auto getLod(size_t level) const -> IndexRange;
+
+    // clusters of level 0 the renderer culls one by one, see Submesh::firstMeshlet
+    auto setMeshlets(std::vector<Meshlet> meshlets) -> void {
+        m_meshlets = std::move(meshlets);
+        m_meshletBounds.assign(m_meshlets);
+    }
+    [[nodiscard]] auto getMeshlets() const -> const std::vector<Meshlet>& {
+        return m_meshlets;
+    }
+    [[nodiscard]] auto getMeshletBounds() const -> const MeshletBounds& {
+        return m_meshletBounds;
+    }
+
    private:
-    std::vector<float> m_vertices;  // keep raw data for who knows what?
+    auto countElements() -> void;
+    auto pack() -> void;
+    auto stageUpload() -> void;
+    // what goes into the buffers, the packed copies if pack() made them
+    [[nodiscard]] auto getUploadVertices() const -> const void*;
+    [[nodiscard]] auto getUploadIndices() const -> const void*;
+    // the buffers can be made on any context of the share group, the vertex array only on the main one
+    auto createBuffers() -> bool;
+    auto createVertexArray() -> bool;
+
+    std::vector<float> m_vertices;  // until the upload, or for good with Residency::CpuAndGpu
     std::vector<uint32_t> m_indices;
+    std::vector<uint8_t> m_packedVertices;  // in m_gpuLayout, only until the upload
+    std::vector<uint16_t> m_shortIndices;    // same
+    size_t m_vertexCount = 0;
+    size_t m_indexCount = 0;
+    uint64_t m_gpuBytes = 0;
     std::shared_ptr<VertexArray> m_vertexArray;
     std::shared_ptr<VertexBuffer> m_vertexBuffer;
     std::shared_ptr<IndexBuffer> m_indexBuffer;
     bool m_useIndices = false;
     VertexLayout m_layout;
+    VertexLayout m_gpuLayout;
+    uint32_t m_indexSize = sizeof(uint32_t);
+    bool m_compact = false;
+    UploadRing* m_uploadRing = nullptr;
+    UploadBlock m_staging;  // vertices, then indices at an aligned offset
 
     std::vector<Submesh> m_submeshes;
+    std::vector<float> m_lodErrors;
+    std::vector<Meshlet> m_meshlets;
+    MeshletBounds m_meshletBounds;
+    std::shared_ptr<Mesh> m_original;
+
+    bool m_hasBounds = false;
+    glm::vec3 m_boundsMin = glm::vec3(0.0f);
+    glm::vec3 m_boundsMax = glm::vec3(0.0f);
 };
 
 }  // namespace Vengine
\ No newline at end of file
@@ -0,0 +1,427 @@
+#include "mesh_cache.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <thread>
+#include <spdlog/spdlog.h>
+
+#include "vengine/utils/file_stamp.hpp"
+#include "vengine/utils/hash.hpp"
+#include "vengine/utils/vfs.hpp"
+
+namespace Vengine {
+
+namespace {
+
+constexpr char MAGIC[4] = {'V', 'M', 'S', 'H'};
+
+// written as is, the cache is a local build artifact so native (little) endian is fine
+struct VmeshHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t importFlags;
+    uint32_t layoutBits;
+    uint64_t sourceSize;
+    int64_t sourceMtime;
+    uint64_t sourceHash;
+    uint64_t vertexFloatCount;
+    uint64_t indexCount;
+    uint64_t tableBytes;  // submesh, material and embedded texture tables after the index data
+    uint32_t submeshCount;
+    uint32_t materialCount;
+    uint32_t textureCount;
+    uint32_t lodCount;
+    float boundsMin[3];
+    float boundsMax[3];
+    uint32_t meshletCount;
+    uint32_t reserved;
+};
+static_assert(sizeof(VmeshHeader) == 112, "VmeshHeader layout changed, bump MeshCache::VERSION");
+
+// the tables are a plain sequence of fields, strings and blobs are length prefixed
+class TableWriter {
+   public:
+    template <typename T>
+    auto write(const T& value) -> void {
+        const auto* bytes = reinterpret_cast<const uint8_t*>(&value);
+        m_bytes.insert(m_bytes.end(), bytes, bytes + sizeof(T));
+    }
+
+    auto writeBytes(const void* data, size_t size) -> void {
+        write(static_cast<uint64_t>(size));
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        m_bytes.insert(m_bytes.end(), bytes, bytes + size);
+    }
+
+    auto writeString(const std::string& value) -> void {
+        writeBytes(value.data(), value.size());
+    }
+
+    [[nodiscard]] auto getBytes() const -> const std::vector<uint8_t>& {
+        return m_bytes;
+    }
+
+   private:
+    std::vector<uint8_t> m_bytes;
+};
+
+// every read is bounds checked, a corrupt table fails instead of reading past the mapping
+class TableReader {
+   public:
+    TableReader(const uint8_t* begin, const uint8_t* end) : m_cursor(begin), m_end(end) {
+    }
+
+    template <typename T>
+    auto read(T& value) -> bool {
+        if (static_cast<size_t>(m_end - m_cursor) < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&value, m_cursor, sizeof(T));
+        m_cursor += sizeof(T);
+        return true;
+    }
+
+    auto readString(std::string& value) -> bool {
+        uint64_t size = 0;
+        if (!read(size) || static_cast<uint64_t>(m_end - m_cursor) < size) {
+            return false;
+        }
+        value.assign(reinterpret_cast<const char*>(m_cursor), static_cast<size_t>(size));
+        m_cursor += size;
+        return true;
+    }
+
+    auto readBytes(std::vector<uint8_t>& value) -> bool {
+        uint64_t size = 0;
+        if (!read(size) || static_cast<uint64_t>(m_end - m_cursor) < size) {
+            return false;
+        }
+        value.assign(m_cursor, m_cursor + size);
+        m_cursor += size;
+        return true;
+    }
+
+   private:
+    const uint8_t* m_cursor;
+    const uint8_t* m_end;
+};
+
+enum MaterialFlags : uint32_t {
+    HAS_DIFFUSE = 1u << 0,
+    HAS_AMBIENT = 1u << 1,
+    HAS_SPECULAR = 1u << 2,
+    HAS_SHININESS = 1u << 3,
+};
+
+auto writeTables(const MeshCacheData& data, TableWriter& writer) -> void {
+    for (const auto& submesh : data.submeshes) {
+        writer.write(submesh.indexOffset);
+        writer.write(submesh.indexCount);
+        writer.writeString(submesh.materialName);
+        for (size_t level = 0; level < data.lodErrors.size(); level++) {
+            const auto lod = level < submesh.lods.size() ? submesh.lods[level] : MeshCacheLod{};
+            writer.write(lod.indexOffset);
+            writer.write(lod.indexCount);
+        }
+        writer.write(submesh.firstMeshlet);
+        writer.write(submesh.meshletCount);
+    }
+    for (auto error : data.lodErrors) {
+        writer.write(error);
+    }
+    for (const auto& meshlet : data.meshlets) {
+        writer.write(meshlet);
+    }
+
+    for (const auto& material : data.materials) {
+        uint32_t flags = (material.hasDiffuse ? HAS_DIFFUSE : 0u) | (material.hasAmbient ? HAS_AMBIENT : 0u) |
+                         (material.hasSpecular ? HAS_SPECULAR : 0u) | (material.hasShininess ? HAS_SHININESS : 0u);
+        writer.writeString(material.name);
+        writer.write(flags);
+        writer.write(material.diffuse);
+        writer.write(material.ambient);
+        writer.write(material.specular);
+        writer.write(material.shininess);
+        writer.writeString(material.diffuseTexture);
+        writer.write(material.embeddedTexture);
+    }
+
+    for (const auto& texture : data.embeddedTextures) {
+        writer.write(texture.width);
+        writer.write(texture.height);
+        writer.writeString(texture.formatHint);
+        writer.writeBytes(texture.data.data(), texture.data.size());
+    }
+}
+
+auto readTables(const VmeshHeader& header, TableReader& reader, MeshCacheData& out) -> bool {
+    // every entry takes more than a byte, keeps a broken count from allocating gigabytes
+    if (uint64_t{header.submeshCount} + header.materialCount + header.textureCount + header.lodCount +
+            header.meshletCount >
+        header.tableBytes) {
+        return false;
+    }
+
+    out.submeshes.clear();
+    out.submeshes.resize(header.submeshCount);
+    for (auto& submesh : out.submeshes) {
+        if (!reader.read(submesh.indexOffset) || !reader.read(submesh.indexCount) ||
+            !reader.readString(submesh.materialName)) {
+            return false;
+        }
+        submesh.lods.resize(header.lodCount);
+        for (auto& lod : submesh.lods) {
+            if (!reader.read(lod.indexOffset) || !reader.read(lod.indexCount)) {
+                return false;
+            }
+        }
+        if (!reader.read(submesh.firstMeshlet) || !reader.read(submesh.meshletCount) ||
+            uint64_t{submesh.firstMeshlet} + submesh.meshletCount > header.meshletCount) {
+            return false;
+        }
+    }
+    out.lodErrors.resize(header.lodCount);
+    for (auto& error : out.lodErrors) {
+        if (!reader.read(error)) {
+            return false;
+        }
+    }
+    out.meshlets.resize(header.meshletCount);
+    for (auto& meshlet : out.meshlets) {
+        if (!reader.read(meshlet)) {
+            return false;
+        }
+    }
+
+    out.materials.clear();
+    out.materials.resize(header.materialCount);
+    for (auto& material : out.materials) {
+        uint32_t flags = 0;
+        if (!reader.readString(material.name) || !reader.read(flags) || !reader.read(material.diffuse) ||
+            !reader.read(material.ambient) || !reader.read(material.specular) || !reader.read(material.shininess) ||
+            !reader.readString(material.diffuseTexture) || !reader.read(material.embeddedTexture)) {
+            return false;
+        }
+        material.hasDiffuse = (flags & HAS_DIFFUSE) != 0;
+        material.hasAmbient = (flags & HAS_AMBIENT) != 0;
+        material.hasSpecular = (flags & HAS_SPECULAR) != 0;
+        material.hasShininess = (flags & HAS_SHININESS) != 0;
+    }
+
+    out.embeddedTextures.clear();
+    out.embeddedTextures.resize(header.textureCount);
+    for (auto& texture : out.embeddedTextures) {
+        if (!reader.read(texture.width) || !reader.read(texture.height) || !reader.readString(texture.formatHint) ||
+            !reader.readBytes(texture.data)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// every range inside the index data and every index inside the vertices, a stale or corrupt
+// entry would draw out of bounds otherwise
+auto checkRanges(const MeshCacheData& data) -> bool {
+    auto floatsPerVertex = static_cast<size_t>(data.layout.calculateStride()) / sizeof(float);
+    if (floatsPerVertex == 0 || data.vertices.size() % floatsPerVertex != 0) {
+        return false;
+    }
+    auto vertexCount = data.vertices.size() / floatsPerVertex;
+    auto pastVertices = [vertexCount](uint32_t index) { return index >= vertexCount; };
+    if (std::any_of(data.indices.begin(), data.indices.end(), pastVertices)) {
+        return false;
+    }
+
+    auto inIndices = [&data](uint32_t offset, uint32_t count) {
+        return uint64_t{offset} + count <= data.indices.size();
+    };
+    for (const auto& submesh : data.submeshes) {
+        if (!inIndices(submesh.indexOffset, submesh.indexCount)) {
+            return false;
+        }
+        for (const auto& lod : submesh.lods) {
+            if (!inIndices(lod.indexOffset, lod.indexCount)) {
+                return false;
+            }
+        }
+    }
+    return std::all_of(data.meshlets.begin(), data.meshlets.end(), [&inIndices](const Meshlet& meshlet) {
+        return inIndices(meshlet.indexOffset, meshlet.indexCount);
+    });
+}
+
+auto toLayoutBits(const VertexLayout& layout) -> uint32_t {
+    return (layout.has(VertexAttribute::Position) ? 1u : 0u) | (layout.has(VertexAttribute::TexCoords) ? 2u : 0u) |
+           (layout.has(VertexAttribute::Normal) ? 4u : 0u);
+}
+
+// patches just the mtime of the stamp, the rest of the entry is still right
+auto rewriteSourceMtime(const std::filesystem::path& path, int64_t mtime) -> bool {
+    std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+    if (!file.is_open()) {
+        return false;
+    }
+    file.seekp(static_cast<std::streamoff>(offsetof(VmeshHeader, sourceMtime)));
+    file.write(reinterpret_cast<const char*>(&mtime), sizeof(mtime));
+    return static_cast<bool>(file);
+}
+
+auto fromLayoutBits(uint32_t bits) -> VertexLayout {
+    return VertexLayout::floats((bits & 1u) != 0, (bits & 2u) != 0, (bits & 4u) != 0);
+}
+
+}  // namespace
+
+MeshCache::MeshCache(std::filesystem::path directory) : m_directory(std::move(directory)) {
+}
+
+auto MeshCache::getCachePath(const std::filesystem::path& source) const -> std::filesystem::path {
+    // the path hash keeps same named files from different folders apart
+    auto name = source.filename().string() + "." + hashToString(hash64(source.generic_string())) + ".vmesh";
+    return m_directory / name;
+}
+
+auto MeshCache::load(const std::filesystem::path& source, uint32_t importFlags, MeshCacheData& out) -> bool {
+    if (!m_enabled) {
+        return false;
+    }
+
+    auto miss = [this]() {
+        m_misses.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    };
+
+    // a shipped pack can carry the cache entries too
+    auto file = Vfs::open(getCachePath(source));
+    if (!file.isOpen() || file.size() < sizeof(VmeshHeader)) {
+        return miss();
+    }
+
+    VmeshHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION ||
+        header.importFlags != importFlags) {
+        return miss();
+    }
+
+    FileStamp current;
+    if (!matchesFileStamp(source, FileStamp{header.sourceSize, header.sourceMtime, header.sourceHash}, &current)) {
+        return miss();
+    }
+
+    size_t vertexBytes = static_cast<size_t>(header.vertexFloatCount) * sizeof(float);
+    size_t indexBytes = static_cast<size_t>(header.indexCount) * sizeof(uint32_t);
+    if (file.size() != sizeof(VmeshHeader) + vertexBytes + indexBytes + header.tableBytes) {
+        spdlog::warn("MeshCache: {} is truncated, ignoring it", getCachePath(source).string());
+        return miss();
+    }
+
+    const uint8_t* cursor = file.data() + sizeof(VmeshHeader);
+    out.layout = fromLayoutBits(header.layoutBits);
+    out.vertices.resize(header.vertexFloatCount);
+    std::memcpy(out.vertices.data(), cursor, vertexBytes);
+    cursor += vertexBytes;
+    out.indices.resize(header.indexCount);
+    std::memcpy(out.indices.data(), cursor, indexBytes);
+    cursor += indexBytes;
+
+    TableReader reader(cursor, file.data() + file.size());
+    if (!readTables(header, reader, out) || !checkRanges(out)) {
+        spdlog::warn("MeshCache: {} has a corrupt table, ignoring it", getCachePath(source).string());
+        return miss();
+    }
+
+    std::memcpy(out.boundsMin.data(), header.boundsMin, sizeof(header.boundsMin));
+    std::memcpy(out.boundsMax.data(), header.boundsMax, sizeof(header.boundsMax));
+
+    // touched but the same content, the source got hashed this time. with the new mtime in the
+    // header the next load is back to size + mtime. entries in a pack are left as they are
+    if (current.mtime != header.sourceMtime && !file.isPacked()) {
+        file = {};
+        rewriteSourceMtime(getCachePath(source), current.mtime);
+    }
+
+    m_hits.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+auto MeshCache::store(const std::filesystem::path& source, uint32_t importFlags, const MeshCacheData& data) -> bool {
+    if (!m_enabled) {
+        return false;
+    }
+
+    VmeshHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.importFlags = importFlags;
+    header.layoutBits = toLayoutBits(data.layout);
+
+    FileStamp stamp;
+    if (!readFileStamp(source, stamp)) {
+        spdlog::warn("MeshCache: could not read source {}", source.string());
+        return false;
+    }
+    header.sourceSize = stamp.size;
+    header.sourceMtime = stamp.mtime;
+    header.sourceHash = stamp.hash;
+    header.vertexFloatCount = data.vertices.size();
+    header.indexCount = data.indices.size();
+    header.submeshCount = static_cast<uint32_t>(data.submeshes.size());
+    header.lodCount = static_cast<uint32_t>(data.lodErrors.size());
+    header.meshletCount = static_cast<uint32_t>(data.meshlets.size());
+    std::memcpy(header.boundsMin, data.boundsMin.data(), sizeof(header.boundsMin));
+    std::memcpy(header.boundsMax, data.boundsMax.data(), sizeof(header.boundsMax));
+
+    header.materialCount = static_cast<uint32_t>(data.materials.size());
+    header.textureCount = static_cast<uint32_t>(data.embeddedTextures.size());
+
+    TableWriter tables;
+    writeTables(data, tables);
+    header.tableBytes = tables.getBytes().size();
+
+    std::error_code error;
+    std::filesystem::create_directories(m_directory, error);
+    if (error) {
+        spdlog::warn("MeshCache: could not create {}: {}", m_directory.string(), error.message());
+        return false;
+    }
+
+    // write next to the target and rename, two threads importing the same file never see half a file
+    auto cachePath = getCachePath(source);
+    auto tempPath = cachePath;
+    tempPath += ".tmp" + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            spdlog::warn("MeshCache: could not write {}", tempPath.string());
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(data.vertices.data()),
+                   static_cast<std::streamsize>(data.vertices.size() * sizeof(float)));
+        file.write(reinterpret_cast<const char*>(data.indices.data()),
+                   static_cast<std::streamsize>(data.indices.size() * sizeof(uint32_t)));
+        file.write(reinterpret_cast<const char*>(tables.getBytes().data()),
+                   static_cast<std::streamsize>(tables.getBytes().size()));
+        if (!file.good()) {
+            file.close();
+            std::filesystem::remove(tempPath, error);
+            return false;
+        }
+    }
+
+    std::filesystem::rename(tempPath, cachePath, error);
+    if (error) {
+        spdlog::warn("MeshCache: could not move {} into place: {}", cachePath.string(), error.message());
+        std::filesystem::remove(tempPath, error);
+        return false;
+    }
+
+    spdlog::debug("MeshCache: wrote {}", cachePath.string());
+    return true;
+}
+
+}  // namespace Vengine
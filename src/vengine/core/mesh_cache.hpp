@@ -0,0 +1,109 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "vengine/core/meshlets.hpp"
+#include "vengine/renderer/vertex_layout.hpp"
+
+namespace Vengine {
+
+struct MeshCacheLod {
+    uint32_t indexOffset = 0;
+    uint32_t indexCount = 0;
+};
+
+struct MeshCacheSubmesh {
+    uint32_t indexOffset = 0;
+    uint32_t indexCount = 0;
+    std::string materialName;
+    std::vector<MeshCacheLod> lods;  // level 1 and up, one per MeshCacheData::lodErrors entry
+    // level 0 split into MeshCacheData::meshlets[firstMeshlet, firstMeshlet + meshletCount), 0 for
+    // submeshes too small to be worth culling in pieces
+    uint32_t firstMeshlet = 0;
+    uint32_t meshletCount = 0;
+};
+
+// material as found in the source file, turned into a Material by the ModelLoader
+struct MeshCacheMaterial {
+    std::string name;
+    std::array<float, 3> diffuse = {0.7f, 0.7f, 0.7f};
+    std::array<float, 3> ambient = {1.0f, 1.0f, 1.0f};
+    std::array<float, 3> specular = {0.5f, 0.5f, 0.5f};
+    float shininess = 32.0f;
+    bool hasDiffuse = false;
+    bool hasAmbient = false;
+    bool hasSpecular = false;
+    bool hasShininess = false;
+    std::string diffuseTexture;     // path as written in the source file, relative to the model
+    int32_t embeddedTexture = -1;  // index into MeshCacheData::embeddedTextures
+};
+
+// same convention as aiTexture: height 0 means data is a compressed file (png, jpg, ...) of width bytes,
+// otherwise data is width * height bgra texels
+struct MeshCacheTexture {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::string formatHint;
+    std::vector<uint8_t> data;
+};
+
+// everything MeshLoader produces from an import, without any gl objects
+struct MeshCacheData {
+    VertexLayout layout;
+    std::vector<float> vertices;  // interleaved in a VertexLayout::floats() layout, packed when uploaded
+    std::vector<uint32_t> indices;  // every lod level after the previous one, level 0 first
+    std::vector<MeshCacheSubmesh> submeshes;
+    std::vector<float> lodErrors;  // per level from 1, how far its surface may be off in model units
+    std::vector<Meshlet> meshlets;  // index offsets into indices like the submeshes'
+    std::vector<MeshCacheMaterial> materials;
+    std::vector<MeshCacheTexture> embeddedTextures;
+    std::array<float, 3> boundsMin = {};
+    std::array<float, 3> boundsMax = {};
+};
+
+// preprocessed meshes as .vmesh files, so a start-up does not run assimp again.
+// an entry is valid as long as the format version and import flags match and the source file
+// is unchanged. size + mtime are checked first, if only the mtime differs the source content
+// hash decides. files are memory mapped and copied once into MeshCacheData.
+class MeshCache {
+   public:
+    static constexpr uint32_t VERSION = 5;  // 3: optimized index and vertex order, 4: lods, 5: meshlets
+
+    explicit MeshCache(std::filesystem::path directory = "cache/meshes");
+
+    auto load(const std::filesystem::path& source, uint32_t importFlags, MeshCacheData& out) -> bool;
+    auto store(const std::filesystem::path& source, uint32_t importFlags, const MeshCacheData& data) -> bool;
+
+    [[nodiscard]] auto getCachePath(const std::filesystem::path& source) const -> std::filesystem::path;
+    [[nodiscard]] auto getDirectory() const -> const std::filesystem::path& {
+        return m_directory;
+    }
+
+    auto setEnabled(bool enabled) -> void {
+        m_enabled = enabled;
+    }
+    [[nodiscard]] auto isEnabled() const -> bool {
+        return m_enabled;
+    }
+
+    [[nodiscard]] auto getHits() const -> size_t {
+        return m_hits.load(std::memory_order_relaxed);
+    }
+    [[nodiscard]] auto getMisses() const -> size_t {
+        return m_misses.load(std::memory_order_relaxed);
+    }
+
+   private:
+    std::filesystem::path m_directory;
+    bool m_enabled = true;
+
+    std::atomic<size_t> m_hits{0};
+    std::atomic<size_t> m_misses{0};
+};
+
+}  // namespace Vengine
@@ -1,13 +1,24 @@
 #include "mesh_loader.hpp"
 #include <cstddef>
 
+#include <array>
+#include <cmath>
 #include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <assimp/IOStream.hpp>
+#include <assimp/IOSystem.hpp>
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 
 #include <spdlog/spdlog.h>
+#include "vengine/core/mesh_optimizer.hpp"
+#include "vengine/core/meshlets.hpp"
 #include "vengine/renderer/vertex_layout.hpp"
+#include "vengine/utils/vfs.hpp"
 
 namespace Vengine {
 
@@ -19,131 +30,558 @@ MeshLoader::~MeshLoader() {
     spdlog::debug("Destructor MeshLoader");
 }
 
+namespace {
+
+constexpr uint32_t IMPORT_FLAGS = aiProcess_Triangulate |           // ensure triangles
+                                  aiProcess_GenSmoothNormals |      // generate normals if not present
+                                  aiProcess_FlipUVs |               // flip tex coords (opengl needs this)
+                                  aiProcess_CalcTangentSpace |      // ??
+                                  aiProcess_JoinIdenticalVertices |
+                                  aiProcess_ValidateDataStructure;
+
+// vertices per conversion task, a 1M vertex mesh makes 16 of them
+constexpr unsigned int VERTEX_CHUNK_SIZE = 65536;
+
+// every level targets half the triangles of the one before. a level is dropped if it saves less
+// than 20%, or once the surface would move more than LOD_MAX_ERROR of the bounds' diagonal
+constexpr size_t LOD_MAX_LEVELS = Mesh::MAX_LOD_LEVELS - 1;
+constexpr float LOD_MIN_REDUCTION = 0.8f;
+constexpr float LOD_MAX_ERROR = 0.02f;
+// smaller submeshes are cheap enough as they are
+constexpr uint32_t LOD_MIN_TRIANGLES = 64;
+
+// submeshes split into meshlets for cluster culling, about 10 of them at this size. smaller ones
+// are drawn whole, culling them in pieces would cost more than it saves
+constexpr uint32_t MESHLET_MIN_TRIANGLES = 1024;
+
+auto toArray(const aiColor3D& color) -> std::array<float, 3> {
+    return {color.r, color.g, color.b};
+}
+
+// material descriptions and embedded texture blobs, read from the same scene as the geometry
+auto extractMaterials(const aiScene* scene, MeshCacheData& out) -> void {
+    out.embeddedTextures.clear();
+    out.embeddedTextures.reserve(scene->mNumTextures);
+    for (unsigned int i = 0; i < scene->mNumTextures; i++) {
+        const aiTexture* texture = scene->mTextures[i];
+        spdlog::debug("Embedded texture {}: {}x{}, format: {}", i, texture->mWidth, texture->mHeight,
+                      texture->achFormatHint);
+
+        MeshCacheTexture& embedded = out.embeddedTextures.emplace_back();
+        embedded.width = texture->mWidth;
+        embedded.height = texture->mHeight;
+        embedded.formatHint = texture->achFormatHint;
+        // compressed textures keep their byte size in mWidth
+        size_t byteCount = texture->mHeight == 0 ? texture->mWidth
+                                                 : static_cast<size_t>(texture->mWidth) * texture->mHeight * sizeof(aiTexel);
+        const auto* bytes = reinterpret_cast<const uint8_t*>(texture->pcData);
+        embedded.data.assign(bytes, bytes + byteCount);
+    }
+
+    out.materials.clear();
+    out.materials.reserve(scene->mNumMaterials);
+    for (unsigned int i = 0; i < scene->mNumMaterials; i++) {
+        aiMaterial* aiMat = scene->mMaterials[i];
+        MeshCacheMaterial& material = out.materials.emplace_back();
+
+        // same fallback name the submeshes use
+        aiString name;
+        if (aiMat->Get(AI_MATKEY_NAME, name) == AI_SUCCESS) {
+            material.name = name.C_Str();
+        } else {
+            material.name = "material_" + std::to_string(i);
+        }
+
+        aiColor3D color;
+        if (aiMat->Get(AI_MATKEY_COLOR_DIFFUSE, color) == AI_SUCCESS) {
+            material.diffuse = toArray(color);
+            material.hasDiffuse = true;
+        }
+        if (aiMat->Get(AI_MATKEY_COLOR_AMBIENT, color) == AI_SUCCESS) {
+            material.ambient = toArray(color);
+            material.hasAmbient = true;
+        }
+        if (aiMat->Get(AI_MATKEY_COLOR_SPECULAR, color) == AI_SUCCESS) {
+            material.specular = toArray(color);
+            material.hasSpecular = true;
+        }
+        material.hasShininess = aiMat->Get(AI_MATKEY_SHININESS, material.shininess) == AI_SUCCESS;
+
+        aiString texturePath;
+        if (aiMat->GetTexture(aiTextureType_DIFFUSE, 0, &texturePath) == AI_SUCCESS && texturePath.length > 0) {
+            // embedded textures are referenced as "*<index>"
+            if (texturePath.C_Str()[0] == '*') {
+                int textureIndex = std::atoi(texturePath.C_Str() + 1);
+                if (textureIndex >= 0 && textureIndex < static_cast<int>(scene->mNumTextures)) {
+                    material.embeddedTexture = textureIndex;
+                } else {
+                    spdlog::error("Invalid embedded texture index: {}", textureIndex);
+                }
+            } else {
+                material.diffuseTexture = texturePath.C_Str();
+            }
+        }
+    }
+}
+
+// a file assimp opened through VfsIOSystem, reads come out of the mapping (or the decompressed entry)
+class VfsIOStream : public Assimp::IOStream {
+   public:
+    explicit VfsIOStream(VfsFile file) : m_file(std::move(file)) {
+    }
+
+    auto Read(void* buffer, size_t size, size_t count) -> size_t override {
+        if (size == 0) {
+            return 0;
+        }
+        size_t items = std::min(count, (m_file.size() - m_position) / size);
+        std::memcpy(buffer, m_file.data() + m_position, items * size);
+        m_position += items * size;
+        return items;
+    }
+
+    auto Write(const void* /*buffer*/, size_t /*size*/, size_t /*count*/) -> size_t override {
+        return 0;
+    }
+
+    // offsets are unsigned, wrapping around does what a negative offset would
+    auto Seek(size_t offset, aiOrigin origin) -> aiReturn override {
+        size_t target = offset;
+        if (origin == aiOrigin_CUR) {
+            target = m_position + offset;
+        } else if (origin == aiOrigin_END) {
+            target = m_file.size() + offset;
+        }
+        if (target > m_file.size()) {
+            return aiReturn_FAILURE;
+        }
+        m_position = target;
+        return aiReturn_SUCCESS;
+    }
+
+    [[nodiscard]] auto Tell() const -> size_t override {
+        return m_position;
+    }
+
+    [[nodiscard]] auto FileSize() const -> size_t override {
+        return m_file.size();
+    }
+
+    auto Flush() -> void override {
+    }
+
+   private:
+    VfsFile m_file;
+    size_t m_position = 0;
+};
+
+// the model and everything it references (.mtl, .bin) come from the Vfs, packed or loose
+class VfsIOSystem : public Assimp::IOSystem {
+   public:
+    auto Exists(const char* file) const -> bool override {
+        return Vfs::exists(file);
+    }
+
+    [[nodiscard]] auto getOsSeparator() const -> char override {
+        return '/';
+    }
+
+    auto Open(const char* file, const char* mode) -> Assimp::IOStream* override {
+        if (std::strchr(mode, 'w') || std::strchr(mode, 'a')) {
+            return nullptr;
+        }
+        auto vfsFile = Vfs::open(file);
+        if (!vfsFile.isOpen()) {
+            return nullptr;
+        }
+        return new VfsIOStream(std::move(vfsFile));
+    }
+
+    auto Close(Assimp::IOStream* stream) -> void override {
+        delete stream;
+    }
+};
+
+}  // namespace
+
 auto MeshLoader::loadModel(const std::string& filename) -> std::shared_ptr<Mesh> {
+    MeshCacheData data;
+    if (!loadModelData(filename, data)) {
+        return nullptr;
+    }
+    return createMesh(data, filename);
+}
+
+auto MeshLoader::loadModelData(const std::string& filename, MeshCacheData& out) -> bool {
     assert(!filename.empty() && "Filename cannot be empty");
     auto modelPath = getModelPath(filename);
-    
+
+    if (m_cache.load(modelPath, IMPORT_FLAGS, out)) {
+        spdlog::debug("Loaded mesh {} from cache", filename);
+        return true;
+    }
+    if (!importMesh(modelPath, out)) {
+        return false;
+    }
+    m_cache.store(modelPath, IMPORT_FLAGS, out);
+    return true;
+}
+
+auto MeshLoader::createMesh(MeshCacheData& data, const std::string& filename) -> std::shared_ptr<Mesh> {
+    auto result = std::make_shared<Mesh>(std::move(data.vertices), std::move(data.indices), data.layout);
+    result->setResidency(m_residency.load(std::memory_order_relaxed));
+    result->setUploadRing(m_uploadRing.load(std::memory_order_relaxed));
+    result->setCompactVertices(m_compactVertices.load(std::memory_order_relaxed));
+    for (auto& submesh : data.submeshes) {
+        std::vector<IndexRange> lods;
+        for (const auto& lod : submesh.lods) {
+            lods.push_back({lod.indexOffset, lod.indexCount});
+        }
+        result->addSubmesh(Submesh{submesh.indexOffset, submesh.indexCount, std::move(submesh.materialName),
+                                   std::move(lods), submesh.firstMeshlet, submesh.meshletCount});
+    }
+    result->setLodErrors(std::move(data.lodErrors));
+    result->setMeshlets(std::move(data.meshlets));
+    result->setBounds(glm::vec3(data.boundsMin[0], data.boundsMin[1], data.boundsMin[2]),
+                      glm::vec3(data.boundsMax[0], data.boundsMax[1], data.boundsMax[2]));
+
+    if (m_registry && result->deduplicate(*m_registry)) {
+        spdlog::debug("Mesh {} has the same geometry as one loaded before, sharing its buffers", filename);
+    }
+    result->load(filename);
+
+    return result;
+}
+
+auto MeshLoader::importMesh(const std::filesystem::path& modelPath, MeshCacheData& out) -> bool {
     Assimp::Importer importer;
-    
-    const aiScene* scene = importer.ReadFile(
-        modelPath.string(),
-        aiProcess_Triangulate |           // ensure triangles
-        aiProcess_GenSmoothNormals |      // generate normals if not present
-        aiProcess_FlipUVs |               // flip tex coords (opengl needs this)
-        aiProcess_CalcTangentSpace |      // ??
-        aiProcess_JoinIdenticalVertices |
-        aiProcess_ValidateDataStructure  
-    );
+    importer.SetIOHandler(new VfsIOSystem());  // the importer owns it
+
+    const aiScene* scene = importer.ReadFile(modelPath.string(), IMPORT_FLAGS);
     
     if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
         spdlog::error("Assimp error: {}", importer.GetErrorString());
-        return nullptr;
+        return false;
     }
     
-    std::vector<float> vertices;
-    std::vector<uint32_t> indices;
-    std::vector<Submesh> submeshes;
-    
-    bool hasTexCoords = false;
-    bool hasNormals = true;  // always true i guess
-    
+    std::vector<float>& vertices = out.vertices;
+    std::vector<uint32_t>& indices = out.indices;
+    std::vector<MeshCacheSubmesh>& submeshes = out.submeshes;
+
+    // every submesh gets pos + tex + normal, normals are always there due to aiProcess_GenSmoothNormals
+    auto layout = VertexLayout::floats(true, true, true);
+    out.layout = layout;
+    const auto floatsPerVertex = static_cast<size_t>(layout.calculateStride()) / sizeof(float);
+
+    // sizes first, every submesh knows where its data goes and the buffers are allocated once
+    std::vector<size_t> firstVertices(scene->mNumMeshes);
     size_t totalVertexCount = 0;
+    size_t totalIndexCount = 0;
+    submeshes.resize(scene->mNumMeshes);
     for (unsigned int i = 0; i < scene->mNumMeshes; i++) {
-        aiMesh* mesh = scene->mMeshes[i];
-        size_t submeshStartIndex = indices.size();
-        
+        const aiMesh* mesh = scene->mMeshes[i];
+        firstVertices[i] = totalVertexCount;
+        totalVertexCount += mesh->mNumVertices;
+
+        auto& submesh = submeshes[i];
+        submesh.indexOffset = static_cast<uint32_t>(totalIndexCount);
+        for (unsigned int j = 0; j < mesh->mNumFaces; j++) {
+            totalIndexCount += mesh->mFaces[j].mNumIndices;
+        }
+        submesh.indexCount = static_cast<uint32_t>(totalIndexCount - submesh.indexOffset);
+
         // get material name for mesh
-        std::string materialName;
         if (mesh->mMaterialIndex < scene->mNumMaterials) {
             aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
             aiString name;
             if (material->Get(AI_MATKEY_NAME, name) == AI_SUCCESS) {
-                materialName = name.C_Str();
+                submesh.materialName = name.C_Str();
             } else {
-                materialName = "material_" + std::to_string(mesh->mMaterialIndex);
+                submesh.materialName = "material_" + std::to_string(mesh->mMaterialIndex);
             }
-            
-            m_materialCache[std::to_string(mesh->mMaterialIndex)] = materialName;
-        }
-        
-        size_t vertexStartIndex = vertices.size() / 8;  // 8 = 3 pos + 2 tex + 3 norm
-        hasTexCoords = mesh->mTextureCoords[0] != nullptr;
-        
-        // process vertices
-        for (unsigned int j = 0; j < mesh->mNumVertices; j++) {
-            // position
-            vertices.push_back(mesh->mVertices[j].x);
-            vertices.push_back(mesh->mVertices[j].y);
-            vertices.push_back(mesh->mVertices[j].z);
-            
-            // texture coordinates 
-            if (hasTexCoords) {
-                vertices.push_back(mesh->mTextureCoords[0][j].x);
-                vertices.push_back(mesh->mTextureCoords[0][j].y);
-            } else {
-                // defaults
-                vertices.push_back(0.0f);
-                vertices.push_back(0.0f);
+        }
+    }
+    vertices.resize(totalVertexCount * floatsPerVertex);
+    indices.resize(totalIndexCount);
+
+    // the conversion is a straight copy, big submeshes are split so one huge mesh spreads over
+    // the workers too. each chunk keeps its own bounds, merged at the end
+    struct Chunk {
+        unsigned int mesh = 0;
+        unsigned int begin = 0;
+        unsigned int end = 0;
+        std::array<float, 3> boundsMin{};
+        std::array<float, 3> boundsMax{};
+    };
+    std::vector<Chunk> chunks;
+    for (unsigned int i = 0; i < scene->mNumMeshes; i++) {
+        auto count = scene->mMeshes[i]->mNumVertices;
+        for (unsigned int begin = 0; begin < count; begin += VERTEX_CHUNK_SIZE) {
+            chunks.push_back({i, begin, std::min(count, begin + VERTEX_CHUNK_SIZE)});
+        }
+    }
+
+    auto fillVertices = [&](Chunk& chunk) {
+        const aiMesh* mesh = scene->mMeshes[chunk.mesh];
+        const aiVector3D* texCoords = mesh->mTextureCoords[0];
+        const aiVector3D* normals = mesh->mNormals;
+        float* dst = vertices.data() + (firstVertices[chunk.mesh] + chunk.begin) * floatsPerVertex;
+        chunk.boundsMin = {mesh->mVertices[chunk.begin].x, mesh->mVertices[chunk.begin].y, mesh->mVertices[chunk.begin].z};
+        chunk.boundsMax = chunk.boundsMin;
+        for (unsigned int j = chunk.begin; j < chunk.end; j++, dst += floatsPerVertex) {
+            const auto& position = mesh->mVertices[j];
+            dst[0] = position.x;
+            dst[1] = position.y;
+            dst[2] = position.z;
+            dst[3] = texCoords ? texCoords[j].x : 0.0f;
+            dst[4] = texCoords ? texCoords[j].y : 0.0f;
+            dst[5] = normals ? normals[j].x : 0.0f;
+            dst[6] = normals ? normals[j].y : 0.0f;
+            dst[7] = normals ? normals[j].z : 0.0f;
+            for (size_t axis = 0; axis < 3; ++axis) {
+                chunk.boundsMin[axis] = std::min(chunk.boundsMin[axis], dst[axis]);
+                chunk.boundsMax[axis] = std::max(chunk.boundsMax[axis], dst[axis]);
             }
-            
-            // normals (always present due to aiProcess_GenSmoothNormals)
-            vertices.push_back(mesh->mNormals[j].x);
-            vertices.push_back(mesh->mNormals[j].y);
-            vertices.push_back(mesh->mNormals[j].z);
         }
-        
-        totalVertexCount += mesh->mNumVertices;
-        
-        // indices
+    };
+    auto fillIndices = [&](unsigned int i) {
+        const aiMesh* mesh = scene->mMeshes[i];
+        auto base = static_cast<uint32_t>(firstVertices[i]);
+        uint32_t* dst = indices.data() + submeshes[i].indexOffset;
         for (unsigned int j = 0; j < mesh->mNumFaces; j++) {
-            aiFace face = mesh->mFaces[j];
+            const aiFace& face = mesh->mFaces[j];
             for (unsigned int k = 0; k < face.mNumIndices; k++) {
-                indices.push_back(face.mIndices[k] + static_cast<uint32_t>(vertexStartIndex));
+                *dst++ = face.mIndices[k] + base;
             }
         }
-        
-        Submesh submesh;
-        submesh.indexOffset = static_cast<uint32_t>(submeshStartIndex);
-        submesh.indexCount = static_cast<uint32_t>(indices.size() - submeshStartIndex);
-        submesh.materialName = materialName;
-        submeshes.push_back(submesh);
-        
-        // spdlog::debug("Processed mesh {} with {} vertices, {} indices, material: {}", 
-                    //  i, mesh->mNumVertices, mesh->mNumFaces * 3, materialName);
+    };
+
+    runTasks(
+        chunks.size() + scene->mNumMeshes,
+        [&](size_t i) {
+            if (i < chunks.size()) {
+                fillVertices(chunks[i]);
+            } else {
+                fillIndices(static_cast<unsigned int>(i - chunks.size()));
+            }
+        },
+        "Convert mesh");
+
+    // reorder the triangles for the post-transform cache, then for overdraw, then the vertices in
+    // the order they are fetched. submeshes only reference their own vertices, so they are
+    // optimized on their own with local indices. the result goes into the .vmesh cache, this
+    // only runs on import
+    // points and lines have nothing to gain and aren't triangle lists
+    std::vector<bool> triangleLists(scene->mNumMeshes);
+    for (unsigned int i = 0; i < scene->mNumMeshes; i++) {
+        const aiMesh* mesh = scene->mMeshes[i];
+        triangleLists[i] = mesh->mPrimitiveTypes == aiPrimitiveType_TRIANGLE && mesh->mNumFaces >= 2;
     }
-    
-    // Validate vertex data consistency
-    VertexLayout layout;
-    layout.hasPosition = true;
-    layout.hasTexCoords = true; 
-    layout.hasNormals = hasNormals;
-
-    int floatsPerVertex = layout.calculateStride() / static_cast<int>(sizeof(float));
-    size_t expectedFloats = totalVertexCount * static_cast<size_t>(floatsPerVertex);
-    
-    if (vertices.size() != expectedFloats) {
-        spdlog::warn("Vertex data inconsistency detected. Expected {} floats but got {}. Fixing...", 
-                    expectedFloats, vertices.size());
-        
-        // fix vertex data if necessary 
-        if (vertices.size() > expectedFloats) {
-            vertices.resize(expectedFloats);
-        } else if (vertices.size() < expectedFloats) {
-            vertices.resize(expectedFloats, 0.0f);
+    std::vector<VertexCacheStats> statsBefore(scene->mNumMeshes);
+    std::vector<VertexCacheStats> statsAfter(scene->mNumMeshes);
+    std::vector<std::vector<Meshlet>> submeshMeshlets(scene->mNumMeshes);
+    runTasks(
+        scene->mNumMeshes,
+        [&](size_t i) {
+            const aiMesh* mesh = scene->mMeshes[i];
+            if (!triangleLists[i]) {
+                return;
+            }
+            const auto& submesh = submeshes[i];
+            uint32_t* range = indices.data() + submesh.indexOffset;
+            size_t count = submesh.indexCount;
+            size_t vertexCount = mesh->mNumVertices;
+            float* submeshVertices = vertices.data() + firstVertices[i] * floatsPerVertex;
+            auto base = static_cast<uint32_t>(firstVertices[i]);
+
+            for (size_t j = 0; j < count; j++) {
+                range[j] -= base;
+            }
+            statsBefore[i] = analyzeVertexCache(range, count, vertexCount);
+            std::vector<size_t> clusterStarts;
+            optimizeVertexCache(range, count, vertexCount, &clusterStarts);
+            optimizeOverdraw(range, count, submeshVertices, floatsPerVertex, vertexCount, clusterStarts);
+            // big ones are split into meshlets for the renderer to cull. that regroups the triangles
+            // once more, the meshlets themselves still come in about the order from above
+            if (count / 3 >= MESHLET_MIN_TRIANGLES) {
+                submeshMeshlets[i] = buildMeshlets(range, count, submeshVertices, floatsPerVertex, vertexCount);
+                for (auto& meshlet : submeshMeshlets[i]) {
+                    meshlet.indexOffset += submesh.indexOffset;
+                }
+            }
+            optimizeVertexFetch(submeshVertices, floatsPerVertex, vertexCount, range, count);
+            statsAfter[i] = analyzeVertexCache(range, count, vertexCount);
+            for (size_t j = 0; j < count; j++) {
+                range[j] += base;
+            }
+        },
+        "Optimize mesh");
+
+    VertexCacheStats before;
+    VertexCacheStats after;
+    for (unsigned int i = 0; i < scene->mNumMeshes; i++) {
+        before.misses += statsBefore[i].misses;
+        before.triangles += statsBefore[i].triangles;
+        before.vertices += statsBefore[i].vertices;
+        after.misses += statsAfter[i].misses;
+        after.triangles += statsAfter[i].triangles;
+        after.vertices += statsAfter[i].vertices;
+    }
+    if (before.triangles > 0) {
+        spdlog::info("Optimized {}: ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}", modelPath.filename().string(),
+                     before.getAcmr(), after.getAcmr(), before.getAtvr(), after.getAtvr());
+    }
+
+    out.meshlets.clear();
+    for (unsigned int i = 0; i < scene->mNumMeshes; i++) {
+        submeshes[i].firstMeshlet = static_cast<uint32_t>(out.meshlets.size());
+        submeshes[i].meshletCount = static_cast<uint32_t>(submeshMeshlets[i].size());
+        out.meshlets.insert(out.meshlets.end(), submeshMeshlets[i].begin(), submeshMeshlets[i].end());
+    }
+    if (!out.meshlets.empty()) {
+        spdlog::debug("Split {} into {} meshlets", modelPath.filename().string(), out.meshlets.size());
+    }
+
+    extractMaterials(scene, out);
+
+    // bounds go into the cache so nobody has to walk the vertices for them again
+    if (!chunks.empty()) {
+        out.boundsMin = chunks.front().boundsMin;
+        out.boundsMax = chunks.front().boundsMax;
+        for (const auto& chunk : chunks) {
+            for (size_t axis = 0; axis < 3; ++axis) {
+                out.boundsMin[axis] = std::min(out.boundsMin[axis], chunk.boundsMin[axis]);
+                out.boundsMax[axis] = std::max(out.boundsMax[axis], chunk.boundsMax[axis]);
+            }
         }
     }
     
+    generateLods(out, triangleLists);
+
     spdlog::debug("Created mesh with {} vertices, {} indices, {} submeshes", 
-                 vertices.size() / static_cast<size_t>(floatsPerVertex), indices.size(), submeshes.size());
-    
-    auto result = std::make_shared<Mesh>(vertices, indices, layout);
-    for (const auto& submesh : submeshes) {
-        result->addSubmesh(submesh);
+                 totalVertexCount, indices.size(), submeshes.size());
+
+    return true;
+}
+
+// the calling worker helps with the tasks while it waits, so this can't starve the pool
+auto MeshLoader::runTasks(size_t count, const std::function<void(size_t)>& task, const char* name) -> void {
+    if (!m_threadManager || count < 2) {
+        for (size_t i = 0; i < count; i++) {
+            task(i);
+        }
+        return;
+    }
+    auto group = std::make_shared<WaitGroup>();
+    for (size_t i = 0; i < count; i++) {
+        m_threadManager->enqueueTask([&task, i]() { task(i); }, name, TaskPriority::High, group);
     }
+    m_threadManager->wait(group);
+}
 
-    result->load(filename);
-    
-    return result;
+auto MeshLoader::generateLods(MeshCacheData& data, const std::vector<bool>& triangleLists) -> void {
+    const size_t floatsPerVertex = data.layout.calculateStride() / sizeof(float);
+    const auto diagonal = std::hypot(data.boundsMax[0] - data.boundsMin[0], data.boundsMax[1] - data.boundsMin[1],
+                                     data.boundsMax[2] - data.boundsMin[2]);
+    const float maxError = diagonal * LOD_MAX_ERROR;
+    const size_t submeshCount = data.submeshes.size();
+
+    // every submesh on its own, each level simplified from the one before. levels only reference
+    // the submesh's own vertices, so all of them share the vertex buffer
+    struct Level {
+        std::vector<uint32_t> indices;
+        float error = 0.0f;
+    };
+    std::vector<std::vector<Level>> levels(submeshCount);
+    runTasks(
+        submeshCount,
+        [&](size_t i) {
+            const auto& submesh = data.submeshes[i];
+            if (!triangleLists[i] || submesh.indexCount / 3 < LOD_MIN_TRIANGLES) {
+                return;
+            }
+            const uint32_t* range = data.indices.data() + submesh.indexOffset;
+            auto [first, last] = std::minmax_element(range, range + submesh.indexCount);
+            uint32_t base = *first;
+            size_t vertexCount = *last - base + 1;
+            const float* positions = data.vertices.data() + base * floatsPerVertex;
+
+            std::vector<uint32_t> current(range, range + submesh.indexCount);
+            for (auto& index : current) {
+                index -= base;
+            }
+            float error = 0.0f;
+            for (size_t level = 1; level <= LOD_MAX_LEVELS && error < maxError; level++) {
+                auto target = current.size() / 6 * 3;
+                auto result = simplifyMesh(current.data(), current.size(), positions, floatsPerVertex, vertexCount,
+                                           target, maxError - error);
+                if (static_cast<float>(result.indexCount) > static_cast<float>(current.size()) * LOD_MIN_REDUCTION) {
+                    break;
+                }
+                current.resize(result.indexCount);
+                optimizeVertexCache(current.data(), current.size(), vertexCount);
+                // simplified from the level before, so the errors add up
+                error += result.error;
+                Level next{current, error};
+                for (auto& index : next.indices) {
+                    index += base;
+                }
+                levels[i].push_back(std::move(next));
+            }
+        },
+        "Generate lods");
+
+    // a submesh that ran out of levels draws its last one in the levels after. a level has to
+    // save enough of the whole mesh to be worth the memory
+    size_t previousCount = data.indices.size();
+    size_t lodIndexCount = 0;
+    data.lodErrors.clear();
+    for (size_t level = 1; level <= LOD_MAX_LEVELS; level++) {
+        size_t count = 0;
+        float error = 0.0f;
+        for (size_t i = 0; i < submeshCount; i++) {
+            if (levels[i].empty()) {
+                count += data.submeshes[i].indexCount;
+                continue;
+            }
+            const auto& last = levels[i][std::min(level, levels[i].size()) - 1];
+            count += last.indices.size();
+            error = std::max(error, last.error);
+        }
+        if (static_cast<float>(count) > static_cast<float>(previousCount) * LOD_MIN_REDUCTION) {
+            break;
+        }
+        data.lodErrors.push_back(error);
+        previousCount = count;
+        lodIndexCount += count;
+    }
+    if (data.lodErrors.empty()) {
+        return;
+    }
+
+    // level after level, so one level is one contiguous range for whole mesh draws
+    auto baseCount = data.indices.size();
+    data.indices.reserve(baseCount + lodIndexCount);
+    for (size_t level = 1; level <= data.lodErrors.size(); level++) {
+        for (size_t i = 0; i < submeshCount; i++) {
+            auto& submesh = data.submeshes[i];
+            MeshCacheLod lod{static_cast<uint32_t>(data.indices.size()), 0};
+            if (levels[i].empty()) {
+                // nothing to simplify, level 0 again
+                for (uint32_t j = 0; j < submesh.indexCount; j++) {
+                    data.indices.push_back(data.indices[submesh.indexOffset + j]);
+                }
+            } else {
+                const auto& indices = levels[i][std::min(level, levels[i].size()) - 1].indices;
+                data.indices.insert(data.indices.end(), indices.begin(), indices.end());
+            }
+            lod.indexCount = static_cast<uint32_t>(data.indices.size() - lod.indexOffset);
+            submesh.lods.push_back(lod);
+        }
+    }
+
+    spdlog::info("Generated {} lods: {} -> {} triangles, error up to {:.4f}", data.lodErrors.size(), baseCount / 3,
+                 previousCount / 3, data.lodErrors.back());
 }
 
 auto MeshLoader::createPlane(float width, float height, int widthSegments, int heightSegments) -> std::shared_ptr<Mesh> {
@@ -155,6 +593,10 @@ auto MeshLoader::createPlane(float width, float height, int widthSegments, int h
 
     float segmentWidth = width / static_cast<float>(widthSegments);
     float segmentHeight = height / static_cast<float>(heightSegments);
+    auto columns = static_cast<size_t>(widthSegments);
+    auto rows = static_cast<size_t>(heightSegments);
+    vertices.reserve((columns + 1) * (rows + 1) * 5);
+    indices.reserve(columns * rows * 6);
 
     // generate vertices
     for (int iy = 0; iy <= heightSegments; ++iy) {
@@ -198,10 +640,19 @@ auto MeshLoader::createPlane(float width, float height, int widthSegments, int h
         }
     }
 
-    return std::make_shared<Mesh>(vertices, indices, VertexLayout{true, true, false});
+    auto plane = std::make_shared<Mesh>(std::move(vertices), std::move(indices), VertexLayout::floats(true, true, false));
+    plane->setResidency(m_residency.load(std::memory_order_relaxed));
+    plane->setUploadRing(m_uploadRing.load(std::memory_order_relaxed));
+    plane->setCompactVertices(m_compactVertices.load(std::memory_order_relaxed));
+    return plane;
 }
 
 auto MeshLoader::getModelPath(const std::string& filename) -> std::filesystem::path {
+    // names are relative to resources/models, absolute paths (tools, benchmarks) are taken as they are
+    std::filesystem::path path(filename);
+    if (path.is_absolute()) {
+        return path;
+    }
     return std::filesystem::path("resources/models") / filename;
 }
 
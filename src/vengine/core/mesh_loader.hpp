@@ -1,11 +1,17 @@
 #pragma once
 
+#include <atomic>
 #include <string>
 #include <memory>
 #include <filesystem>
+#include <functional>
 #include <unordered_map>
+#include <vector>
 
+#include "vengine/core/content_registry.hpp"
 #include "vengine/core/mesh.hpp"
+#include "vengine/core/mesh_cache.hpp"
+#include "vengine/core/thread_manager.hpp"
 
 namespace Vengine {
 
@@ -14,13 +20,58 @@ class MeshLoader {
     MeshLoader();
     ~MeshLoader();
     auto loadModel(const std::string& filename) -> std::shared_ptr<Mesh>;
+    // mesh, submeshes and material descriptions from one import (or the cache), no gl objects
+    auto loadModelData(const std::string& filename, MeshCacheData& out) -> bool;
+    // moves the geometry out of data, materials and embedded textures stay
+    auto createMesh(MeshCacheData& data, const std::string& filename) -> std::shared_ptr<Mesh>;
     auto createPlane(float width = 100.0f, float height = 100.0f, int widthSegments = 1,
                      int heightSegments = 1) -> std::shared_ptr<Mesh>;
     auto getModelPath(const std::string& filename) -> std::filesystem::path;
 
+    [[nodiscard]] auto getCache() -> MeshCache& {
+        return m_cache;
+    }
+
+    // imports convert their vertices on the workers when set, inline otherwise
+    auto setThreadManager(std::shared_ptr<ThreadManager> threadManager) -> void {
+        m_threadManager = std::move(threadManager);
+    }
+
+    // identical geometry from different files shares one set of buffers when set
+    auto setContentRegistry(ContentRegistry<Mesh>* registry) -> void {
+        m_registry = registry;
+    }
+
+    // applied to every mesh it creates, see Residency
+    auto setResidency(Residency residency) -> void {
+        m_residency.store(residency, std::memory_order_relaxed);
+    }
+
+    // meshes it creates stage their upload through the ring, set before loading anything
+    auto setUploadRing(UploadRing* ring) -> void {
+        m_uploadRing.store(ring, std::memory_order_relaxed);
+    }
+
+    // meshes it creates pack their vertices and indices into the smallest formats that fit, see
+    // Mesh::setCompactVertices. on by default
+    auto setCompactVertices(bool compact) -> void {
+        m_compactVertices.store(compact, std::memory_order_relaxed);
+    }
+
    private:
+    // full assimp import, only runs when the .vmesh cache has nothing usable
+    auto importMesh(const std::filesystem::path& modelPath, MeshCacheData& out) -> bool;
+    // simplified levels appended to data.indices, see MeshCacheData::lodErrors
+    auto generateLods(MeshCacheData& data, const std::vector<bool>& triangleLists) -> void;
+    // task(0..count-1) on the thread manager, inline without one
+    auto runTasks(size_t count, const std::function<void(size_t)>& task, const char* name) -> void;
 
-    std::unordered_map<std::string, std::string> m_materialCache;
+    MeshCache m_cache;
+    std::shared_ptr<ThreadManager> m_threadManager;
+    ContentRegistry<Mesh>* m_registry = nullptr;
+    std::atomic<Residency> m_residency{Residency::GpuOnly};
+    std::atomic<UploadRing*> m_uploadRing{nullptr};
+    std::atomic<bool> m_compactVertices{true};
 };
 
 }  // namespace Vengine
\ No newline at end of file
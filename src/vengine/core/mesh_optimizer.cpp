@@ -0,0 +1,493 @@
+#include "mesh_optimizer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+
+namespace Vengine {
+
+namespace {
+
+using Vec3 = std::array<float, 3>;
+
+auto sub(const Vec3& a, const Vec3& b) -> Vec3 {
+    return {a[0] - b[0], a[1] - b[1], a[2] - b[2]};
+}
+
+auto cross(const Vec3& a, const Vec3& b) -> Vec3 {
+    return {a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0]};
+}
+
+auto dot(const Vec3& a, const Vec3& b) -> float {
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+auto getPosition(const float* positions, size_t stride, uint32_t index) -> Vec3 {
+    const float* p = positions + static_cast<size_t>(index) * stride;
+    return {p[0], p[1], p[2]};
+}
+
+// symmetric 4x4 of the summed plane equations, weighted by triangle area
+struct Quadric {
+    double xx = 0, xy = 0, xz = 0, xw = 0, yy = 0, yz = 0, yw = 0, zz = 0, zw = 0, ww = 0;
+    double weight = 0;
+
+    auto addPlane(const Vec3& normal, float d, double area) -> void {
+        double x = normal[0], y = normal[1], z = normal[2], w = d;
+        xx += area * x * x, xy += area * x * y, xz += area * x * z, xw += area * x * w;
+        yy += area * y * y, yz += area * y * z, yw += area * y * w;
+        zz += area * z * z, zw += area * z * w;
+        ww += area * w * w;
+        weight += area;
+    }
+
+    auto operator+=(const Quadric& other) -> Quadric& {
+        xx += other.xx, xy += other.xy, xz += other.xz, xw += other.xw;
+        yy += other.yy, yz += other.yz, yw += other.yw;
+        zz += other.zz, zw += other.zw, ww += other.ww;
+        weight += other.weight;
+        return *this;
+    }
+
+    // area weighted squared distance of p to the planes
+    [[nodiscard]] auto evaluate(const Vec3& p) const -> double {
+        double x = p[0], y = p[1], z = p[2];
+        return xx * x * x + 2 * xy * x * y + 2 * xz * x * z + 2 * xw * x + yy * y * y + 2 * yz * y * z +
+               2 * yw * y + zz * z * z + 2 * zw * z + ww;
+    }
+};
+
+struct PositionHash {
+    auto operator()(const std::array<uint32_t, 3>& bits) const -> size_t {
+        return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+    }
+};
+
+auto getEdgeKey(uint32_t a, uint32_t b) -> uint64_t {
+    return (static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b);
+}
+
+}  // namespace
+
+auto analyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize)
+    -> VertexCacheStats {
+    VertexCacheStats stats;
+    stats.triangles = indexCount / 3;
+
+    // a vertex is cached if fewer than cacheSize misses happened since its own
+    std::vector<uint32_t> missTime(vertexCount, 0);
+    uint32_t time = cacheSize + 1;
+    for (size_t i = 0; i < stats.triangles * 3; ++i) {
+        auto vertex = indices[i];
+        if (missTime[vertex] == 0) {
+            stats.vertices++;
+        }
+        if (time - missTime[vertex] > cacheSize) {
+            missTime[vertex] = time++;
+            stats.misses++;
+        }
+    }
+    return stats;
+}
+
+auto optimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount, std::vector<size_t>* clusterStarts,
+                         uint32_t cacheSize) -> void {
+    size_t triangleCount = indexCount / 3;
+    if (clusterStarts) {
+        clusterStarts->assign(1, 0);
+    }
+    if (triangleCount == 0) {
+        return;
+    }
+
+    // triangles around every vertex, live counts the ones not emitted yet
+    std::vector<uint32_t> live(vertexCount, 0);
+    for (size_t i = 0; i < triangleCount * 3; ++i) {
+        live[indices[i]]++;
+    }
+    std::vector<uint32_t> offsets(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; ++v) {
+        offsets[v + 1] = offsets[v] + live[v];
+    }
+    std::vector<uint32_t> adjacency(triangleCount * 3);
+    {
+        std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < triangleCount * 3; ++i) {
+            adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+    }
+
+    std::vector<uint32_t> cacheTime(vertexCount, 0);
+    std::vector<uint8_t> emitted(triangleCount, 0);
+    std::vector<uint32_t> deadEnd;
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> result;
+    deadEnd.reserve(triangleCount * 3);
+    result.reserve(triangleCount * 3);
+
+    uint32_t time = cacheSize + 1;
+    size_t cursor = 0;
+    int64_t fanning = indices[0];
+    while (fanning >= 0) {
+        // every triangle left around the fanning vertex, as they were
+        candidates.clear();
+        auto vertex = static_cast<uint32_t>(fanning);
+        for (auto a = offsets[vertex]; a < offsets[vertex + 1]; ++a) {
+            auto triangle = adjacency[a];
+            if (emitted[triangle]) {
+                continue;
+            }
+            emitted[triangle] = 1;
+            for (size_t k = 0; k < 3; ++k) {
+                auto corner = indices[triangle * 3 + k];
+                result.push_back(corner);
+                deadEnd.push_back(corner);
+                candidates.push_back(corner);
+                live[corner]--;
+                if (time - cacheTime[corner] > cacheSize) {
+                    cacheTime[corner] = time++;
+                }
+            }
+        }
+
+        // next is the candidate that will still be in the cache once its own triangles are out,
+        // the one that went in the longest ago among those
+        int64_t next = -1;
+        int64_t bestPriority = -1;
+        for (auto candidate : candidates) {
+            if (live[candidate] == 0) {
+                continue;
+            }
+            int64_t priority = 0;
+            if (time - cacheTime[candidate] + 2 * live[candidate] <= cacheSize) {
+                priority = time - cacheTime[candidate];
+            }
+            if (priority > bestPriority) {
+                bestPriority = priority;
+                next = candidate;
+            }
+        }
+
+        if (next < 0) {
+            // dead end, a recent vertex with triangles left or the next one in input order
+            while (!deadEnd.empty() && next < 0) {
+                auto recent = deadEnd.back();
+                deadEnd.pop_back();
+                if (live[recent] > 0) {
+                    next = recent;
+                }
+            }
+            while (next < 0 && cursor < vertexCount) {
+                if (live[cursor] > 0) {
+                    next = static_cast<int64_t>(cursor);
+                }
+                ++cursor;
+            }
+            // starting over from something out of the cache, a natural cut for the overdraw pass
+            if (clusterStarts && next >= 0 && time - cacheTime[static_cast<size_t>(next)] > cacheSize &&
+                result.size() < triangleCount * 3) {
+                clusterStarts->push_back(result.size());
+            }
+        }
+        fanning = next;
+    }
+
+    std::memcpy(indices, result.data(), result.size() * sizeof(uint32_t));
+}
+
+auto optimizeOverdraw(uint32_t* indices, size_t indexCount, const float* positions, size_t stride, size_t vertexCount,
+                      const std::vector<size_t>& clusterStarts, float threshold, size_t clusterSize) -> void {
+    size_t triangleCount = indexCount / 3;
+    if (triangleCount < 2) {
+        return;
+    }
+
+    // hard cuts from the cache pass, plus one every clusterSize triangles
+    std::vector<size_t> starts{0};
+    size_t hard = 0;
+    for (size_t i = 3; i < triangleCount * 3; i += 3) {
+        while (hard < clusterStarts.size() && clusterStarts[hard] < i) {
+            hard++;
+        }
+        bool isHard = hard < clusterStarts.size() && clusterStarts[hard] == i;
+        if (isHard || (i - starts.back()) / 3 >= clusterSize) {
+            starts.push_back(i);
+        }
+    }
+    if (starts.size() < 2) {
+        return;
+    }
+    starts.push_back(triangleCount * 3);
+
+    // area weighted centroid of everything and of every cluster, plus the cluster's average normal
+    auto clusterCount = starts.size() - 1;
+    std::vector<Vec3> centroids(clusterCount, Vec3{});
+    std::vector<Vec3> normals(clusterCount, Vec3{});
+    std::vector<float> areas(clusterCount, 0.0f);
+    Vec3 meshCentroid{};
+    float meshArea = 0.0f;
+    for (size_t c = 0; c < clusterCount; ++c) {
+        for (size_t i = starts[c]; i < starts[c + 1]; i += 3) {
+            auto a = getPosition(positions, stride, indices[i]);
+            auto b = getPosition(positions, stride, indices[i + 1]);
+            auto d = getPosition(positions, stride, indices[i + 2]);
+            auto normal = cross(sub(b, a), sub(d, a));
+            float area = std::sqrt(dot(normal, normal));
+            for (size_t axis = 0; axis < 3; ++axis) {
+                centroids[c][axis] += (a[axis] + b[axis] + d[axis]) / 3.0f * area;
+                normals[c][axis] += normal[axis];
+            }
+            areas[c] += area;
+        }
+        for (size_t axis = 0; axis < 3; ++axis) {
+            meshCentroid[axis] += centroids[c][axis];
+        }
+        meshArea += areas[c];
+    }
+    if (meshArea <= 0.0f) {
+        return;
+    }
+    for (auto& value : meshCentroid) {
+        value /= meshArea;
+    }
+
+    // outward facing clusters far from the center first, they are the likely occluders
+    std::vector<float> keys(clusterCount, 0.0f);
+    for (size_t c = 0; c < clusterCount; ++c) {
+        if (areas[c] <= 0.0f) {
+            continue;
+        }
+        Vec3 centroid = {centroids[c][0] / areas[c], centroids[c][1] / areas[c], centroids[c][2] / areas[c]};
+        float length = std::sqrt(dot(normals[c], normals[c]));
+        if (length > 0.0f) {
+            keys[c] = dot(sub(centroid, meshCentroid), normals[c]) / length;
+        }
+    }
+    std::vector<size_t> order(clusterCount);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&keys](size_t a, size_t b) { return keys[a] > keys[b]; });
+
+    std::vector<uint32_t> sorted;
+    sorted.reserve(triangleCount * 3);
+    for (auto c : order) {
+        sorted.insert(sorted.end(), indices + starts[c], indices + starts[c + 1]);
+    }
+
+    // every cut costs a few cache misses, keep the old order if that got out of hand
+    auto before = analyzeVertexCache(indices, triangleCount * 3, vertexCount).getAcmr();
+    auto after = analyzeVertexCache(sorted.data(), sorted.size(), vertexCount).getAcmr();
+    if (after > before * threshold) {
+        return;
+    }
+    std::memcpy(indices, sorted.data(), sorted.size() * sizeof(uint32_t));
+}
+
+auto simplifyMesh(uint32_t* indices, size_t indexCount, const float* positions, size_t stride, size_t vertexCount,
+                  size_t targetIndexCount, float targetError) -> SimplifyResult {
+    std::vector<uint32_t> result(indices, indices + indexCount / 3 * 3);
+    SimplifyResult simplified{result.size(), 0.0f};
+    if (result.size() <= targetIndexCount) {
+        return simplified;
+    }
+
+    // seams: a position shared by vertices that differ in other attributes. moving one side
+    // would tear the mesh open, so both stay
+    std::vector<uint8_t> locked(vertexCount, 0);
+    {
+        std::unordered_map<std::array<uint32_t, 3>, uint32_t, PositionHash> firstAtPosition;
+        firstAtPosition.reserve(vertexCount);
+        for (uint32_t v = 0; v < vertexCount; ++v) {
+            std::array<uint32_t, 3> bits{};
+            std::memcpy(bits.data(), positions + static_cast<size_t>(v) * stride, sizeof(bits));
+            auto [it, added] = firstAtPosition.try_emplace(bits, v);
+            if (!added) {
+                locked[v] = 1;
+                locked[it->second] = 1;
+            }
+        }
+    }
+
+    // borders: edges with only one triangle (or more than two, non-manifold) keep their vertices,
+    // they are what the silhouette of an open mesh is made of
+    {
+        std::unordered_map<uint64_t, uint32_t> edgeUses;
+        edgeUses.reserve(result.size());
+        for (size_t i = 0; i < result.size(); i += 3) {
+            for (size_t k = 0; k < 3; ++k) {
+                edgeUses[getEdgeKey(result[i + k], result[i + (k + 1) % 3])]++;
+            }
+        }
+        for (const auto& [key, uses] : edgeUses) {
+            if (uses != 2) {
+                locked[key >> 32] = 1;
+                locked[key & 0xffffffffu] = 1;
+            }
+        }
+    }
+
+    std::vector<Quadric> quadrics(vertexCount);
+    for (size_t i = 0; i < result.size(); i += 3) {
+        auto a = getPosition(positions, stride, result[i]);
+        auto normal = cross(sub(getPosition(positions, stride, result[i + 1]), a),
+                            sub(getPosition(positions, stride, result[i + 2]), a));
+        float length = std::sqrt(dot(normal, normal));
+        if (length <= 0.0f) {
+            continue;
+        }
+        normal = {normal[0] / length, normal[1] / length, normal[2] / length};
+        for (size_t k = 0; k < 3; ++k) {
+            quadrics[result[i + k]].addPlane(normal, -dot(normal, a), length * 0.5);
+        }
+    }
+
+    struct Collapse {
+        uint32_t from;
+        uint32_t to;
+        double errorSquared;
+    };
+    std::vector<Collapse> collapses;
+    std::vector<uint32_t> offsets(vertexCount + 1);
+    std::vector<uint32_t> adjacency;
+    std::vector<uint8_t> touched(vertexCount);
+    std::vector<uint32_t> collapseTo(vertexCount);
+    double maxErrorSquared = static_cast<double>(targetError) * targetError;
+    double reachedSquared = 0.0;
+
+    // passes of independent collapses, cheapest first. a collapse locks its neighbourhood for the
+    // rest of the pass so every check sees the triangles as they are
+    while (result.size() > targetIndexCount) {
+        std::fill(offsets.begin(), offsets.end(), 0);
+        for (auto v : result) {
+            offsets[v + 1]++;
+        }
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+        adjacency.resize(result.size());
+        {
+            std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+            for (size_t i = 0; i < result.size(); ++i) {
+                adjacency[fill[result[i]]++] = static_cast<uint32_t>(i / 3);
+            }
+        }
+
+        collapses.clear();
+        for (size_t i = 0; i < result.size(); i += 3) {
+            for (size_t k = 0; k < 3; ++k) {
+                uint32_t a = result[i + k];
+                uint32_t b = result[i + (k + 1) % 3];
+                for (auto [from, to] : {std::pair{a, b}, std::pair{b, a}}) {
+                    if (locked[from]) {
+                        continue;
+                    }
+                    Quadric merged = quadrics[from];
+                    merged += quadrics[to];
+                    double error = 0.0;
+                    if (merged.weight > 0.0) {
+                        error = merged.evaluate(getPosition(positions, stride, to)) / merged.weight;
+                    }
+                    collapses.push_back({from, to, std::max(error, 0.0)});
+                }
+            }
+        }
+        std::sort(collapses.begin(), collapses.end(),
+                  [](const Collapse& a, const Collapse& b) { return a.errorSquared < b.errorSquared; });
+
+        std::fill(touched.begin(), touched.end(), 0);
+        std::iota(collapseTo.begin(), collapseTo.end(), 0);
+        size_t trianglesToRemove = (result.size() - targetIndexCount) / 3;
+        size_t removed = 0;
+        for (const auto& collapse : collapses) {
+            if (collapse.errorSquared > maxErrorSquared || removed >= trianglesToRemove) {
+                break;
+            }
+            if (touched[collapse.from] || touched[collapse.to]) {
+                continue;
+            }
+
+            // none of the triangles that stay may turn over
+            bool flips = false;
+            size_t dying = 0;
+            auto target = getPosition(positions, stride, collapse.to);
+            for (auto a = offsets[collapse.from]; a < offsets[collapse.from + 1] && !flips; ++a) {
+                const uint32_t* triangle = result.data() + adjacency[a] * 3;
+                if (triangle[0] == collapse.to || triangle[1] == collapse.to || triangle[2] == collapse.to) {
+                    dying++;
+                    continue;
+                }
+                std::array<Vec3, 3> before{};
+                std::array<Vec3, 3> after{};
+                for (size_t k = 0; k < 3; ++k) {
+                    before[k] = getPosition(positions, stride, triangle[k]);
+                    after[k] = triangle[k] == collapse.from ? target : before[k];
+                }
+                auto normalBefore = cross(sub(before[1], before[0]), sub(before[2], before[0]));
+                auto normalAfter = cross(sub(after[1], after[0]), sub(after[2], after[0]));
+                flips = dot(normalBefore, normalAfter) <= 0.0f;
+            }
+            if (flips) {
+                continue;
+            }
+
+            for (auto a = offsets[collapse.from]; a < offsets[collapse.from + 1]; ++a) {
+                const uint32_t* triangle = result.data() + adjacency[a] * 3;
+                touched[triangle[0]] = touched[triangle[1]] = touched[triangle[2]] = 1;
+            }
+            collapseTo[collapse.from] = collapse.to;
+            quadrics[collapse.to] += quadrics[collapse.from];
+            reachedSquared = std::max(reachedSquared, collapse.errorSquared);
+            removed += dying;
+        }
+        if (removed == 0) {
+            break;
+        }
+
+        size_t write = 0;
+        for (size_t i = 0; i < result.size(); i += 3) {
+            uint32_t a = collapseTo[result[i]];
+            uint32_t b = collapseTo[result[i + 1]];
+            uint32_t c = collapseTo[result[i + 2]];
+            if (a != b && b != c && a != c) {
+                result[write++] = a;
+                result[write++] = b;
+                result[write++] = c;
+            }
+        }
+        result.resize(write);
+    }
+
+    std::memcpy(indices, result.data(), result.size() * sizeof(uint32_t));
+    simplified.indexCount = result.size();
+    simplified.error = static_cast<float>(std::sqrt(reachedSquared));
+    return simplified;
+}
+
+auto optimizeVertexFetch(float* vertices, size_t stride, size_t vertexCount, uint32_t* indices, size_t indexCount)
+    -> void {
+    constexpr auto UNUSED = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> remap(vertexCount, UNUSED);
+    uint32_t next = 0;
+    for (size_t i = 0; i < indexCount; ++i) {
+        auto& index = indices[i];
+        if (remap[index] == UNUSED) {
+            remap[index] = next++;
+        }
+        index = remap[index];
+    }
+    for (auto& target : remap) {
+        if (target == UNUSED) {
+            target = next++;
+        }
+    }
+
+    std::vector<float> reordered(vertexCount * stride);
+    for (size_t v = 0; v < vertexCount; ++v) {
+        std::memcpy(reordered.data() + static_cast<size_t>(remap[v]) * stride, vertices + v * stride,
+                    stride * sizeof(float));
+    }
+    std::memcpy(vertices, reordered.data(), reordered.size() * sizeof(float));
+}
+
+}  // namespace Vengine
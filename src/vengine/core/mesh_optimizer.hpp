@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Vengine {
+
+// import time reordering of triangle lists, no gl. indices are local to the range passed in,
+// every index < vertexCount. winding is kept, triangles only move as a whole
+
+// post-transform cache of a typical gpu, what the orderings are tuned for and measured against
+constexpr uint32_t VERTEX_CACHE_SIZE = 16;
+
+struct VertexCacheStats {
+    size_t misses = 0;
+    size_t triangles = 0;
+    size_t vertices = 0;  // referenced at least once
+    // average cache miss ratio, transformed vertices per triangle. 0.5 is the limit for big grids, 3 the worst
+    [[nodiscard]] auto getAcmr() const -> float {
+        return triangles == 0 ? 0.0f : static_cast<float>(misses) / static_cast<float>(triangles);
+    }
+    // average transform to vertex ratio, 1 means every vertex is transformed exactly once
+    [[nodiscard]] auto getAtvr() const -> float {
+        return vertices == 0 ? 0.0f : static_cast<float>(misses) / static_cast<float>(vertices);
+    }
+};
+
+// simulated fifo cache
+[[nodiscard]] auto analyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount,
+                                      uint32_t cacheSize = VERTEX_CACHE_SIZE) -> VertexCacheStats;
+
+// tipsify (Sander et al. 2007), linear time. clusterStarts, if given, gets the first index of every
+// run that started over from a vertex outside the cache, the overdraw pass sorts those runs
+auto optimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount,
+                         std::vector<size_t>* clusterStarts = nullptr, uint32_t cacheSize = VERTEX_CACHE_SIZE) -> void;
+
+// after optimizeVertexCache. sorts clusters so the ones facing outwards are drawn first and hide
+// what is behind them. runs are cut to at least clusterSize triangles so even a closed mesh has
+// something to sort. the result is thrown away if the acmr got worse than threshold times before.
+// positions are 3 floats every stride floats, indexed like the indices
+auto optimizeOverdraw(uint32_t* indices, size_t indexCount, const float* positions, size_t stride, size_t vertexCount,
+                      const std::vector<size_t>& clusterStarts, float threshold = 1.05f, size_t clusterSize = 256)
+    -> void;
+
+struct SimplifyResult {
+    size_t indexCount = 0;
+    float error = 0.0f;  // furthest any collapse moved the surface, in position units
+};
+
+// quadric error metric simplification (Garland & Heckbert 1997). vertices collapse into a
+// neighbour, so the result only references existing vertices and can share the vertex buffer.
+// border and uv seam vertices (same position, other attributes) stay put. stops at
+// targetIndexCount or before a collapse would move the surface more than targetError. the
+// simplified triangles are written to the front of indices
+auto simplifyMesh(uint32_t* indices, size_t indexCount, const float* positions, size_t stride, size_t vertexCount,
+                  size_t targetIndexCount, float targetError) -> SimplifyResult;
+
+// vertices in the order they are first used, indices remapped to match. unused ones go to the end.
+// vertices is vertexCount * stride floats
+auto optimizeVertexFetch(float* vertices, size_t stride, size_t vertexCount, uint32_t* indices, size_t indexCount)
+    -> void;
+
+}  // namespace Vengine
@@ -0,0 +1,335 @@
+#include "meshlets.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Vengine {
+
+namespace {
+
+using Vec3 = std::array<float, 3>;
+
+constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+auto sub(const Vec3& a, const Vec3& b) -> Vec3 {
+    return {a[0] - b[0], a[1] - b[1], a[2] - b[2]};
+}
+
+auto cross(const Vec3& a, const Vec3& b) -> Vec3 {
+    return {a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0]};
+}
+
+auto dot(const Vec3& a, const Vec3& b) -> float {
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+auto getPosition(const float* positions, size_t stride, uint32_t index) -> Vec3 {
+    const float* p = positions + static_cast<size_t>(index) * stride;
+    return {p[0], p[1], p[2]};
+}
+
+// sphere around the box of the vertices, close enough to the minimal one for a small cluster.
+// the cone opens from the average triangle facing to the normal furthest off
+auto computeBounds(Meshlet& meshlet, const uint32_t* indices, const std::vector<uint32_t>& vertices,
+                   const float* positions, size_t stride) -> void {
+    Vec3 boundsMin = getPosition(positions, stride, vertices.front());
+    Vec3 boundsMax = boundsMin;
+    for (auto vertex : vertices) {
+        auto p = getPosition(positions, stride, vertex);
+        for (size_t axis = 0; axis < 3; ++axis) {
+            boundsMin[axis] = std::min(boundsMin[axis], p[axis]);
+            boundsMax[axis] = std::max(boundsMax[axis], p[axis]);
+        }
+    }
+    for (size_t axis = 0; axis < 3; ++axis) {
+        meshlet.center[axis] = (boundsMin[axis] + boundsMax[axis]) * 0.5f;
+    }
+    float radiusSquared = 0.0f;
+    for (auto vertex : vertices) {
+        auto offset = sub(getPosition(positions, stride, vertex), meshlet.center);
+        radiusSquared = std::max(radiusSquared, dot(offset, offset));
+    }
+    meshlet.radius = std::sqrt(radiusSquared);
+
+    // degenerate triangles don't show up on screen, they have no say in the facing
+    std::vector<Vec3> normals;
+    Vec3 axis{};
+    for (uint32_t i = 0; i < meshlet.indexCount; i += 3) {
+        const uint32_t* triangle = indices + meshlet.indexOffset + i;
+        auto a = getPosition(positions, stride, triangle[0]);
+        auto normal = cross(sub(getPosition(positions, stride, triangle[1]), a),
+                            sub(getPosition(positions, stride, triangle[2]), a));
+        float length = std::sqrt(dot(normal, normal));
+        if (length <= 0.0f) {
+            continue;
+        }
+        normal = {normal[0] / length, normal[1] / length, normal[2] / length};
+        normals.push_back(normal);
+        axis = {axis[0] + normal[0], axis[1] + normal[1], axis[2] + normal[2]};
+    }
+    float axisLength = std::sqrt(dot(axis, axis));
+    meshlet.coneAxis = {};
+    meshlet.coneCutoff = 0.0f;
+    if (normals.empty() || axisLength <= 1e-6f) {
+        return;
+    }
+    axis = {axis[0] / axisLength, axis[1] / axisLength, axis[2] / axisLength};
+    float cutoff = 1.0f;
+    for (const auto& normal : normals) {
+        cutoff = std::min(cutoff, dot(axis, normal));
+    }
+    meshlet.coneAxis = axis;
+    meshlet.coneCutoff = std::max(cutoff, 0.0f);
+}
+
+}  // namespace
+
+auto buildMeshlets(uint32_t* indices, size_t indexCount, const float* positions, size_t stride, size_t vertexCount,
+                   size_t maxVertices, size_t maxTriangles) -> std::vector<Meshlet> {
+    std::vector<Meshlet> meshlets;
+    const size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0) {
+        return meshlets;
+    }
+    maxVertices = std::max<size_t>(maxVertices, 3);
+    maxTriangles = std::max<size_t>(maxTriangles, 1);
+
+    // triangles around every vertex
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+    for (size_t i = 0; i < triangleCount * 3; ++i) {
+        adjacencyOffsets[indices[i] + 1]++;
+    }
+    for (size_t v = 0; v < vertexCount; ++v) {
+        adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+    }
+    std::vector<uint32_t> adjacency(triangleCount * 3);
+    {
+        std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for (size_t i = 0; i < triangleCount * 3; ++i) {
+            adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+    }
+
+    std::vector<uint8_t> emitted(triangleCount, 0);
+    std::vector<uint32_t> liveTriangles(vertexCount, 0);  // not emitted yet, around the vertex
+    for (uint32_t v = 0; v < vertexCount; ++v) {
+        liveTriangles[v] = adjacencyOffsets[v + 1] - adjacencyOffsets[v];
+    }
+    std::vector<uint32_t> vertexMeshlet(vertexCount, NONE);   // last meshlet the vertex went into
+    std::vector<uint32_t> candidateMeshlet(triangleCount, NONE);  // last meshlet it was a candidate of
+    std::vector<uint32_t> output;
+    output.reserve(triangleCount * 3);
+    std::vector<uint32_t> meshletVertices;
+    std::vector<uint32_t> candidates;
+    std::array<double, 3> positionSum{};
+
+    auto triangleCenter = [&](uint32_t triangle) {
+        Vec3 center{};
+        for (size_t k = 0; k < 3; ++k) {
+            auto p = getPosition(positions, stride, indices[triangle * 3 + k]);
+            center = {center[0] + p[0], center[1] + p[1], center[2] + p[2]};
+        }
+        return Vec3{center[0] / 3.0f, center[1] / 3.0f, center[2] / 3.0f};
+    };
+
+    size_t nextSeed = 0;
+    while (true) {
+        // the next meshlet starts next to the last one, at the triangle with the fewest unused
+        // neighbours. that eats along the edge of what is left instead of leaving small fragments
+        uint32_t seed = NONE;
+        uint32_t seedScore = NONE;
+        for (auto triangle : candidates) {
+            if (emitted[triangle]) {
+                continue;
+            }
+            uint32_t score = 0;
+            for (size_t k = 0; k < 3; ++k) {
+                score += liveTriangles[indices[triangle * 3 + k]];
+            }
+            if (score < seedScore) {
+                seed = triangle;
+                seedScore = score;
+            }
+        }
+        if (seed == NONE) {
+            while (nextSeed < triangleCount && emitted[nextSeed]) {
+                nextSeed++;
+            }
+            if (nextSeed == triangleCount) {
+                break;
+            }
+            seed = static_cast<uint32_t>(nextSeed);
+        }
+
+        auto id = static_cast<uint32_t>(meshlets.size());
+        Meshlet meshlet;
+        meshlet.indexOffset = static_cast<uint32_t>(output.size());
+        meshletVertices.clear();
+        candidates.clear();
+        positionSum = {};
+
+        auto addTriangle = [&](uint32_t triangle) {
+            emitted[triangle] = 1;
+            for (size_t k = 0; k < 3; ++k) {
+                uint32_t vertex = indices[triangle * 3 + k];
+                output.push_back(vertex);
+                liveTriangles[vertex]--;
+                if (vertexMeshlet[vertex] == id) {
+                    continue;
+                }
+                vertexMeshlet[vertex] = id;
+                meshletVertices.push_back(vertex);
+                auto p = getPosition(positions, stride, vertex);
+                for (size_t axis = 0; axis < 3; ++axis) {
+                    positionSum[axis] += p[axis];
+                }
+                for (uint32_t j = adjacencyOffsets[vertex]; j < adjacencyOffsets[vertex + 1]; ++j) {
+                    uint32_t neighbour = adjacency[j];
+                    if (!emitted[neighbour] && candidateMeshlet[neighbour] != id) {
+                        candidateMeshlet[neighbour] = id;
+                        candidates.push_back(neighbour);
+                    }
+                }
+            }
+        };
+
+        addTriangle(seed);
+        for (size_t triangles = 1; triangles < maxTriangles; ++triangles) {
+            // fewest new vertices first, then the one closest to the middle so the meshlet grows round
+            auto count = static_cast<double>(meshletVertices.size());
+            Vec3 middle{static_cast<float>(positionSum[0] / count), static_cast<float>(positionSum[1] / count),
+                        static_cast<float>(positionSum[2] / count)};
+            uint32_t best = NONE;
+            size_t bestNew = 4;
+            float bestDistance = std::numeric_limits<float>::max();
+            for (size_t c = 0; c < candidates.size();) {
+                uint32_t triangle = candidates[c];
+                if (emitted[triangle]) {
+                    candidates[c] = candidates.back();
+                    candidates.pop_back();
+                    continue;
+                }
+                ++c;
+                size_t newVertices = 0;
+                for (size_t k = 0; k < 3; ++k) {
+                    newVertices += vertexMeshlet[indices[triangle * 3 + k]] != id ? 1 : 0;
+                }
+                if (meshletVertices.size() + newVertices > maxVertices || newVertices > bestNew) {
+                    continue;
+                }
+                auto offset = sub(triangleCenter(triangle), middle);
+                float distance = dot(offset, offset);
+                if (newVertices < bestNew || distance < bestDistance) {
+                    best = triangle;
+                    bestNew = newVertices;
+                    bestDistance = distance;
+                }
+            }
+            if (best == NONE) {
+                break;
+            }
+            addTriangle(best);
+        }
+
+        meshlet.indexCount = static_cast<uint32_t>(output.size() - meshlet.indexOffset);
+        computeBounds(meshlet, output.data(), meshletVertices, positions, stride);
+        meshlets.push_back(meshlet);
+    }
+
+    std::copy(output.begin(), output.end(), indices);
+    return meshlets;
+}
+
+auto MeshletBounds::assign(const std::vector<Meshlet>& meshlets) -> void {
+    for (auto* component : {&centerX, &centerY, &centerZ, &radius, &coneX, &coneY, &coneZ, &coneCutoff, &coneSine}) {
+        component->resize(meshlets.size());
+    }
+    for (size_t i = 0; i < meshlets.size(); ++i) {
+        const auto& meshlet = meshlets[i];
+        centerX[i] = meshlet.center[0];
+        centerY[i] = meshlet.center[1];
+        centerZ[i] = meshlet.center[2];
+        radius[i] = meshlet.radius;
+        coneX[i] = meshlet.coneAxis[0];
+        coneY[i] = meshlet.coneAxis[1];
+        coneZ[i] = meshlet.coneAxis[2];
+        coneCutoff[i] = std::clamp(meshlet.coneCutoff, 0.0f, 1.0f);
+        coneSine[i] = std::sqrt(1.0f - coneCutoff[i] * coneCutoff[i]);
+    }
+}
+
+auto makeMeshletCullView(const std::array<float, 16>& clip, const std::array<float, 3>& cameraPosition,
+                         bool cullBackfaces) -> MeshletCullView {
+    // Gribb & Hartmann, the planes are sums of the clip matrix rows. with the model matrix in
+    // there they come out in model space
+    auto row = [&clip](size_t r) {
+        return std::array<float, 4>{clip[r], clip[4 + r], clip[8 + r], clip[12 + r]};
+    };
+    MeshletCullView view;
+    auto w = row(3);
+    for (size_t axis = 0; axis < 3; ++axis) {
+        auto r = row(axis);
+        for (size_t k = 0; k < 4; ++k) {
+            view.planes[axis * 2][k] = w[k] + r[k];
+            view.planes[axis * 2 + 1][k] = w[k] - r[k];
+        }
+    }
+    for (size_t p = 0; p < 6; ++p) {
+        const auto& plane = view.planes[p];
+        view.planeLengths[p] = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+    }
+    view.cameraPosition = cameraPosition;
+    view.cullBackfaces = cullBackfaces;
+    return view;
+}
+
+auto cullMeshlets(const MeshletBounds& bounds, size_t first, size_t count, const MeshletCullView& view,
+                  uint8_t* __restrict visible) -> size_t {
+    const float* __restrict centerX = bounds.centerX.data() + first;
+    const float* __restrict centerY = bounds.centerY.data() + first;
+    const float* __restrict centerZ = bounds.centerZ.data() + first;
+    const float* __restrict radius = bounds.radius.data() + first;
+    const float* __restrict coneX = bounds.coneX.data() + first;
+    const float* __restrict coneY = bounds.coneY.data() + first;
+    const float* __restrict coneZ = bounds.coneZ.data() + first;
+    const float* __restrict coneCutoff = bounds.coneCutoff.data() + first;
+    const float* __restrict coneSine = bounds.coneSine.data() + first;
+    const auto& planes = view.planes;
+    const auto& lengths = view.planeLengths;
+    const auto [cameraX, cameraY, cameraZ] = view.cameraPosition;
+    const float backfaces = view.cullBackfaces ? 1.0f : 0.0f;
+
+    // no branches and no sqrt in here, so an optimized build turns it into simd over several meshlets
+    size_t visibleCount = 0;
+    for (size_t i = 0; i < count; ++i) {
+        float x = centerX[i];
+        float y = centerY[i];
+        float z = centerZ[i];
+        float r = radius[i];
+        bool inside = true;
+        for (size_t p = 0; p < 6; ++p) {
+            float distance = planes[p][0] * x + planes[p][1] * y + planes[p][2] * z + planes[p][3];
+            inside &= distance >= -r * lengths[p];
+        }
+
+        // every triangle faces away if even the normal at the edge of the cone, turned as far
+        // towards the camera as it goes, still points away from every point of the sphere:
+        // dot(axis, v) * cos - |v x axis| * sin > r, with v from the camera to the center.
+        // squared on both sides, cutoff 0 never passes since r >= 0
+        float vx = x - cameraX;
+        float vy = y - cameraY;
+        float vz = z - cameraZ;
+        float along = vx * coneX[i] + vy * coneY[i] + vz * coneZ[i];
+        float across = vx * vx + vy * vy + vz * vz - along * along;
+        float margin = along * coneCutoff[i] - r;
+        bool backfacing = (margin > 0.0f) & (margin * margin > across * coneSine[i] * coneSine[i]) &
+                          (backfaces > 0.0f);
+
+        visible[i] = static_cast<uint8_t>(inside & !backfacing);
+        visibleCount += visible[i];
+    }
+    return visibleCount;
+}
+
+}  // namespace Vengine
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Vengine {
+
+// small clusters of a triangle list that are culled on their own, no gl. a meshlet is one
+// contiguous range of the index buffer, so visible ones are drawn as plain index ranges
+
+// what mesh shading hardware is tuned for, small enough that a partly visible mesh drops most of
+// its triangles, big enough that culling and draw commands stay cheap
+constexpr size_t MESHLET_MAX_VERTICES = 64;
+constexpr size_t MESHLET_MAX_TRIANGLES = 124;
+
+struct Meshlet {
+    uint32_t indexOffset = 0;
+    uint32_t indexCount = 0;
+    std::array<float, 3> center{};  // bounding sphere, model space
+    float radius = 0.0f;
+    std::array<float, 3> coneAxis{};  // average facing of the triangles
+    // cos of the angle between the axis and the triangle normal furthest from it. 0 when the
+    // normals spread over a half space or more, those meshlets are never backface culled
+    float coneCutoff = 0.0f;
+};
+
+// splits indices (local, every index < vertexCount) into meshlets and reorders them so each one is
+// contiguous, meshlet offsets are relative to indices. triangles are grown from the first unused
+// one in the current order, taking the neighbour that adds the fewest vertices, so the previous
+// order is roughly kept. positions are 3 floats every stride floats
+auto buildMeshlets(uint32_t* indices, size_t indexCount, const float* positions, size_t stride, size_t vertexCount,
+                   size_t maxVertices = MESHLET_MAX_VERTICES, size_t maxTriangles = MESHLET_MAX_TRIANGLES)
+    -> std::vector<Meshlet>;
+
+// meshlet bounds one array per component, the culling loop runs over plain floats and vectorizes
+struct MeshletBounds {
+    std::vector<float> centerX, centerY, centerZ, radius;
+    std::vector<float> coneX, coneY, coneZ, coneCutoff, coneSine;
+
+    auto assign(const std::vector<Meshlet>& meshlets) -> void;
+    [[nodiscard]] auto size() const -> size_t {
+        return radius.size();
+    }
+    [[nodiscard]] auto getMemoryUsage() const -> size_t {
+        return radius.capacity() * sizeof(float) * 9;
+    }
+};
+
+// one instance as the meshlets see it, everything in their model space
+struct MeshletCullView {
+    // xyz points inside. not normalized, the sphere test scales the radius by the plane's length
+    // instead, which keeps it exact under non-uniform scale
+    std::array<std::array<float, 4>, 6> planes{};
+    std::array<float, 6> planeLengths{};
+    std::array<float, 3> cameraPosition{};
+    // only exact for transforms that keep the winding, mirrored instances have to turn it off
+    bool cullBackfaces = false;
+};
+
+// clip is projection * view * model, column major like glm. cameraPosition in model space
+[[nodiscard]] auto makeMeshletCullView(const std::array<float, 16>& clip, const std::array<float, 3>& cameraPosition,
+                                       bool cullBackfaces) -> MeshletCullView;
+
+// visible[i] = 1 for meshlet first + i if it may be visible, 0 if it is outside the frustum or all
+// of its triangles face away from the camera. returns how many are visible
+auto cullMeshlets(const MeshletBounds& bounds, size_t first, size_t count, const MeshletCullView& view,
+                  uint8_t* visible) -> size_t;
+
+}  // namespace Vengine
@@ -25,9 +25,8 @@ auto Model::finalizeOnMainThread() -> bool {
 }
 
 auto Model::unload() -> bool {
-    if (m_mesh) {
-        m_mesh->unload();
-    }
+    // deduplicated meshes draw with this one's buffers, the last owner frees them
+    m_mesh.reset();
     m_defaultMaterial.reset();
     m_materials.clear();
     return true;
@@ -41,6 +40,13 @@ auto Model::getMaterialForSubmesh(const std::string& submeshName) const -> std::
     return m_defaultMaterial;
 }
 
+auto Model::isReady() const -> bool {
+    if (!m_mesh || m_mesh->needsMainThreadInit()) {
+        return false;
+    }
+    return !m_pendingTextures || m_pendingTextures->isDone();
+}
+
 auto Model::setMaterial(const std::string& submeshName, std::shared_ptr<Material> material) -> void {
     m_materials[submeshName] = std::move(material);
 }
@@ -5,6 +5,7 @@
 #include "vengine/core/mesh.hpp"
 #include "vengine/renderer/material.hpp"
 #include "vengine/core/i_resource.hpp"
+#include "vengine/core/wait_group.hpp"
 
 namespace Vengine {
 
@@ -17,21 +18,34 @@ public:
     auto finalizeOnMainThread() -> bool override;
     auto unload() -> bool override;
     [[nodiscard]] auto needsMainThreadInit() const -> bool override { return m_mesh && m_mesh->needsMainThreadInit(); }
+    [[nodiscard]] auto getFinalizeCostHint() const -> uint32_t override { return m_mesh ? m_mesh->getFinalizeCostHint() : 0; }
+    // the mesh only, material textures are resources of their own
+    [[nodiscard]] auto getMemoryUsage() const -> ResourceMemory override { return m_mesh ? m_mesh->getMemoryUsage() : ResourceMemory{}; }
+    [[nodiscard]] auto getDuplicateOf() const -> const IResource* override { return m_mesh ? m_mesh->getDuplicateOf() : nullptr; }
+    // the mesh is all a model uploads
+    [[nodiscard]] auto supportsSharedUpload() const -> bool override { return m_mesh && m_mesh->supportsSharedUpload(); }
+    auto uploadShared() -> bool override { return m_mesh && m_mesh->uploadShared(); }
+    auto finishUpload() -> bool override { return m_mesh && m_mesh->finishUpload(); }
 
     // Getters
     [[nodiscard]] auto getMesh() const -> std::shared_ptr<Mesh> { return m_mesh; }
     [[nodiscard]] auto getDefaultMaterial() const -> std::shared_ptr<Material> { return m_defaultMaterial; }
     [[nodiscard]] auto getMaterialForSubmesh(const std::string& submeshName) const -> std::shared_ptr<Material>;
+    // mesh uploaded and every material texture finalized (or failed)
+    [[nodiscard]] auto isReady() const -> bool;
+    [[nodiscard]] auto getPendingTextureCount() const -> size_t { return m_pendingTextures ? m_pendingTextures->getPending() : 0; }
     
     // Setters
     auto setMesh(std::shared_ptr<Mesh> mesh) -> void { m_mesh = std::move(mesh); }
     auto setDefaultMaterial(std::shared_ptr<Material> material) -> void { m_defaultMaterial = std::move(material); }
     auto setMaterial(const std::string& submeshName, std::shared_ptr<Material> material) -> void;
+    auto setPendingTextures(std::shared_ptr<WaitGroup> group) -> void { m_pendingTextures = std::move(group); }
 
 private:
     std::shared_ptr<Mesh> m_mesh;
     std::shared_ptr<Material> m_defaultMaterial;
     std::unordered_map<std::string, std::shared_ptr<Material>> m_materials;
+    std::shared_ptr<WaitGroup> m_pendingTextures;
 };
 
 }  // namespace Vengine
\ No newline at end of file
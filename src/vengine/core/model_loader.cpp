@@ -1,16 +1,15 @@
 #include "model_loader.hpp"
 
-#include <assimp/Importer.hpp>
-#include <assimp/scene.h>
-#include <assimp/postprocess.h>
 #include <algorithm>
 
 #include <cstddef>
+#include <cstdlib>
 #include <fstream>
 #include <sstream>
 #include <spdlog/spdlog.h>
 #include "vengine/core/resource_manager.hpp"
 #include "vengine/core/resources.hpp"
+#include "vengine/utils/vfs.hpp"
 
 namespace Vengine {
 
@@ -23,35 +22,39 @@ ModelLoader::~ModelLoader() {
     spdlog::debug("Destructor ModelLoader");
 }
 
-auto ModelLoader::loadModel(const std::string& filename, const std::shared_ptr<Shader>& defaultShader) -> std::shared_ptr<Model> {
+auto ModelLoader::loadModel(const std::string& filename,
+                            const std::shared_ptr<Shader>& defaultShader,
+                            const std::shared_ptr<WaitGroup>& group) -> std::shared_ptr<Model> {
     auto model = std::make_shared<Model>();
-    
-    // Load the mesh 
-    auto mesh = m_meshLoader->loadModel(filename);
-    if (!mesh) {
+
+    // one import (or cache hit) gives geometry and material descriptions together
+    MeshCacheData data;
+    if (!m_meshLoader->loadModelData(filename, data)) {
         spdlog::error("Failed to load mesh for model: {}", filename);
         return nullptr;
     }
-    
-    // Set the mesh to the model
-    model->setMesh(mesh);
-    
+    model->setMesh(m_meshLoader->createMesh(data, filename));
+
+    // every texture decodes as its own worker task, the group tells when all of them are done
+    auto pendingTextures = std::make_shared<WaitGroup>(group);
+    model->setPendingTextures(pendingTextures);
+
+    auto modelPath = m_meshLoader->getModelPath(filename);
     std::unordered_map<std::string, std::shared_ptr<Material>> materials;
-    
-    // First try to load materials from Assimp scene
-    materials = loadMaterialsFromAssimp(filename, defaultShader);
-    
+    for (const auto& description : data.materials) {
+        materials[description.name] = createMaterial(description, data, modelPath, defaultShader, pendingTextures);
+    }
+
     // If no materials were loaded from Assimp and it's an OBJ file, try MTL as fallback
     if (materials.empty()) {
-        auto modelPath = m_meshLoader->getModelPath(filename);
         auto extension = modelPath.extension().string();
         if (extension == ".obj" || extension == ".OBJ") {
             auto mtlPath = modelPath;
             mtlPath.replace_extension(".mtl");
             
             // Check if MTL file exists
-            if (std::filesystem::exists(mtlPath)) {
-                materials = loadMaterialsFromMtl(mtlPath, defaultShader);
+            if (Vfs::exists(mtlPath)) {
+                materials = loadMaterialsFromMtl(mtlPath, defaultShader, pendingTextures);
             }
         }
     }
@@ -74,246 +77,133 @@ auto ModelLoader::loadModel(const std::string& filename, const std::shared_ptr<S
     return model;
 }
 
-auto ModelLoader::loadMaterialsFromAssimp(const std::string& filename, 
-                                         std::shared_ptr<Shader> defaultShader) 
-    -> std::unordered_map<std::string, std::shared_ptr<Material>> {
-    
-    std::unordered_map<std::string, std::shared_ptr<Material>> materials;
-    
-    // Get the model path
-    auto modelPath = m_meshLoader->getModelPath(filename);
-    auto modelDir = modelPath.parent_path();
-    
-    // Load the scene again with Assimp to access materials
-    Assimp::Importer importer;
-    const aiScene* scene = importer.ReadFile(
-        modelPath.string(),
-        aiProcess_Triangulate |
-        aiProcess_GenSmoothNormals |
-        aiProcess_FlipUVs |
-        aiProcess_CalcTangentSpace |
-        aiProcess_JoinIdenticalVertices
-    );
-    
-    if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
-        spdlog::error("Assimp error in material loading: {}", importer.GetErrorString());
-        return materials;
+auto ModelLoader::createMaterial(const MeshCacheMaterial& description,
+                                 const MeshCacheData& data,
+                                 const std::filesystem::path& modelPath,
+                                 std::shared_ptr<Shader> defaultShader,
+                                 const std::shared_ptr<WaitGroup>& pendingTextures) -> std::shared_ptr<Material> {
+    auto material = std::make_shared<Material>(std::move(defaultShader));
+
+    if (description.hasDiffuse) {
+        glm::vec3 diffuse(description.diffuse[0], description.diffuse[1], description.diffuse[2]);
+        material->setVec3("uDiffuse", diffuse);
+        material->setVec4("uColor", glm::vec4(diffuse, 1.0f));
     }
-    
-    // Log embedded texture information
-    if (scene->mNumTextures > 0) {
-        spdlog::info("Model has {} embedded textures", scene->mNumTextures);
-        for (unsigned int i = 0; i < scene->mNumTextures; i++) {
-            const aiTexture* texture = scene->mTextures[i];
-            spdlog::debug("Embedded texture {}: {}x{}, format: {}", 
-                i, texture->mWidth, texture->mHeight, texture->achFormatHint);
-        }
+    if (description.hasAmbient) {
+        material->setVec3("uAmbient", glm::vec3(description.ambient[0], description.ambient[1], description.ambient[2]));
     }
-    
-    // Process all materials
-    for (unsigned int i = 0; i < scene->mNumMaterials; i++) {
-        aiMaterial* aiMat = scene->mMaterials[i];
-        aiString name;
-        aiMat->Get(AI_MATKEY_NAME, name);
-        
-        std::string matName = name.length > 0 ? name.C_Str() : "material_" + std::to_string(i);
-        
-        auto material = std::make_shared<Material>(defaultShader);
-        
-        // Extract diffuse color
-        aiColor3D diffuseColor(0.7f, 0.7f, 0.7f);
-        if (aiMat->Get(AI_MATKEY_COLOR_DIFFUSE, diffuseColor) == AI_SUCCESS) {
-            material->setVec3("uDiffuse", glm::vec3(diffuseColor.r, diffuseColor.g, diffuseColor.b));
-            material->setVec4("uColor", glm::vec4(diffuseColor.r, diffuseColor.g, diffuseColor.b, 1.0f));
-        }
-        
-        // Extract ambient color
-        aiColor3D ambientColor(1.0f, 1.0f, 1.0f);
-        if (aiMat->Get(AI_MATKEY_COLOR_AMBIENT, ambientColor) == AI_SUCCESS) {
-            material->setVec3("uAmbient", glm::vec3(ambientColor.r, ambientColor.g, ambientColor.b));
-        }
-        
-        // Extract specular color
-        aiColor3D specularColor(0.5f, 0.5f, 0.5f);
-        if (aiMat->Get(AI_MATKEY_COLOR_SPECULAR, specularColor) == AI_SUCCESS) {
-            material->setVec3("uSpecular", glm::vec3(specularColor.r, specularColor.g, specularColor.b));
-        }
-        
-        // Extract shininess
-        float shininess = 32.0f;
-        if (aiMat->Get(AI_MATKEY_SHININESS, shininess) == AI_SUCCESS) {
-            material->setFloat("uShininess", shininess);
-        }
-        
-        // Check for diffuse textures
-        aiString texturePath;
-        if (aiMat->GetTexture(aiTextureType_DIFFUSE, 0, &texturePath) == AI_SUCCESS) {
-            std::string texName = matName + "_diffuse";
-            bool textureLoaded = false;
-            
-            // Check if this is an embedded texture (path starts with '*')
-            if (texturePath.length > 0 && texturePath.C_Str()[0] == '*') {
-                spdlog::info("Found embedded texture reference: {}", texturePath.C_Str());
-                
-                // Extract texture index from the path (remove the '*')
-                int textureIndex = std::stoi(texturePath.C_Str() + 1);
-                
-                if (textureIndex >= 0 && textureIndex < static_cast<int>(scene->mNumTextures)) {
-                    // Get the embedded texture
-                    const aiTexture* texture = scene->mTextures[textureIndex];
-                    
-                    // Extract and create texture
-                    auto extractedTexture = extractEmbeddedTexture(texture, texName);
-                    if (extractedTexture) {
-                        material->setBool("uUseTexture", true);
-                        material->setTexture("uTexture", extractedTexture);
-                        textureLoaded = true;
-                        spdlog::info("Successfully loaded embedded texture for material: {}", matName);
-                    }
-                } else {
-                    spdlog::error("Invalid embedded texture index: {}", textureIndex);
-                }
-            }
-            
-            // If no embedded texture was loaded, try loading from file
-            if (!textureLoaded) {
-                std::filesystem::path texFilePath = modelDir / texturePath.C_Str();
-                
-                // Normalize path for Windows
-                std::string fullTexPath = texFilePath.string();
-                std::replace(fullTexPath.begin(), fullTexPath.end(), '\\', '/');
-                
-                spdlog::debug("Loading texture from path: {}", fullTexPath);
-                
-                // Try to load the texture
-                if (std::filesystem::exists(texFilePath)) {
-                    if (!m_resourceManager->isLoaded(texName)) {
-                        m_resourceManager->load<Texture>(texName, fullTexPath);
-                    }
-                    
-                    auto texture = m_resourceManager->get<Texture>(texName);
-                    if (texture) {
-                        material->setBool("uUseTexture", true);
-                        material->setTexture("uTexture", texture);
-                        spdlog::debug("Successfully loaded texture for material: {}", matName);
-                    } else {
-                        material->setBool("uUseTexture", false);
-                        spdlog::error("Failed to load texture: {}", fullTexPath);
-                    }
-                } else {
-                    spdlog::error("Texture file does not exist: {}", fullTexPath);
-                    material->setBool("uUseTexture", false);
-                }
-            }
+    if (description.hasSpecular) {
+        material->setVec3("uSpecular",
+                          glm::vec3(description.specular[0], description.specular[1], description.specular[2]));
+    }
+    if (description.hasShininess) {
+        material->setFloat("uShininess", description.shininess);
+    }
+
+    // textures load on the workers, the material shows its color until they are on the gpu
+    std::shared_ptr<Texture> texture;
+    if (description.embeddedTexture >= 0 &&
+        static_cast<size_t>(description.embeddedTexture) < data.embeddedTextures.size()) {
+        // embedded textures belong to their file, materials of the same model share them by index
+        auto texName = modelPath.generic_string() + "*" + std::to_string(description.embeddedTexture);
+        texture = loadEmbeddedTexture(data.embeddedTextures[description.embeddedTexture], texName, pendingTextures);
+    } else if (!description.diffuseTexture.empty()) {
+        // Normalize path for Windows
+        std::string texturePath = description.diffuseTexture;
+        std::replace(texturePath.begin(), texturePath.end(), '\\', '/');
+        auto fullTexPath = modelPath.parent_path() / texturePath;
+
+        if (Vfs::exists(fullTexPath)) {
+            texture = loadTextureFile(fullTexPath, pendingTextures);
         } else {
-            material->setBool("uUseTexture", false);
+            spdlog::error("Texture file does not exist: {}", fullTexPath.string());
         }
-        
-        // Add the material
-        materials[matName] = material;
     }
-    
-    return materials;
+
+    if (texture) {
+        material->setBool("uUseTexture", true);
+        material->setTexture("uTexture", texture);
+    } else {
+        material->setBool("uUseTexture", false);
+    }
+    return material;
 }
 
-auto ModelLoader::extractEmbeddedTexture(const aiTexture* texture, const std::string& texName) 
+auto ModelLoader::loadTextureFile(const std::filesystem::path& path, const std::shared_ptr<WaitGroup>& pendingTextures)
     -> std::shared_ptr<Texture> {
-    
-    if (!texture) {
-        spdlog::error("Null texture pointer");
-        return nullptr;
-    }
-    
-    // Create shared pointer for raw image data
-    std::shared_ptr<Texture> resultTexture = nullptr;
-    
-    // Check if the texture is already loaded
-    if (m_resourceManager->isLoaded(texName)) {
-        return m_resourceManager->get<Texture>(texName);
-    }
-    
-    // Check if the texture is compressed (stored in a common format)
-    if (texture->mHeight == 0) {
-        spdlog::info("Processing compressed embedded texture ({} format), size: {} bytes", 
-                   texture->achFormatHint, texture->mWidth);
-        
-        // mWidth contains the size in bytes for compressed textures
-        int width;
-        int height;
-        int channels;
-        
-        // Decode the compressed texture data
-        unsigned char* pixels = stbi_load_from_memory(
-            reinterpret_cast<const stbi_uc*>(texture->pcData),
-            static_cast<int>(texture->mWidth), // Size in bytesx
-            &width, &height, &channels, 4 // Force RGBA
-        );
-        
-        if (pixels) {
-            spdlog::info("Decoded embedded texture: {}x{}, channels: {}", width, height, channels);
-            
-            // Create a texture resource from the decoded data
-            resultTexture = std::make_shared<Texture>();
-            resultTexture->setRawData(pixels, width, height, 4);
-            resultTexture->setName(texName);
-            
-            // Register in resource manager
-            m_resourceManager->add<Texture>(texName, resultTexture);
-            
-            // Clean up stbi allocated data after texture is created
-            stbi_image_free(pixels);
-        } else {
-            spdlog::error("Failed to decode embedded texture: {}", stbi_failure_reason());
+    // named by the normalized path, so every material and model using the file shares one decode
+    auto texName = path.lexically_normal().generic_string();
+    return m_resourceManager->getOrLoadAsync<Texture>(texName, texName, pendingTextures);
+}
+
+auto ModelLoader::loadEmbeddedTexture(const MeshCacheTexture& embedded,
+                                      const std::string& texName,
+                                      const std::shared_ptr<WaitGroup>& pendingTextures) -> std::shared_ptr<Texture> {
+    // the blob is copied into the task, the import data is gone by the time it runs
+    auto blob = std::make_shared<MeshCacheTexture>(embedded);
+    return m_resourceManager->getOrCreateAsync<Texture>(texName, [blob, texName](Texture& texture) {
+        texture.setName(texName);
+
+        // a compressed blob hashes like the image file it was, so it also matches that file on disk
+        uint64_t seed = blob->height == 0 ? 0 : (static_cast<uint64_t>(blob->width) << 32) | blob->height;
+        if (texture.deduplicate(hash64(blob->data.data(), blob->data.size(), seed))) {
+            return true;
         }
-    } 
-    else {
-        // Uncompressed texture with raw pixel data
-        spdlog::info("Processing uncompressed embedded texture: {}x{}", 
-                   texture->mWidth, texture->mHeight);
-        
-        // Create texture from raw data
-        unsigned char* pixels = new unsigned char[static_cast<unsigned long long>(texture->mWidth * texture->mHeight * 4)];
-        
-        // Copy pixel data (assuming RGBA for now)
-        for (unsigned int y = 0; y < texture->mHeight; ++y) {
-            for (unsigned int x = 0; x < texture->mWidth; ++x) {
-                aiTexel& texel = texture->pcData[y * texture->mWidth + x];
-                unsigned char* pixel = &pixels[static_cast<size_t>((y * texture->mWidth + x) * 4)];
-                
-                pixel[0] = texel.r;
-                pixel[1] = texel.g;
-                pixel[2] = texel.b;
-                pixel[3] = texel.a;
+
+        // Check if the texture is compressed (stored in a common format)
+        if (blob->height == 0) {
+            int width;
+            int height;
+            int channels;
+            unsigned char* pixels = stbi_load_from_memory(blob->data.data(),
+                                                          static_cast<int>(blob->data.size()),
+                                                          &width, &height, &channels, 4);  // Force RGBA
+            if (!pixels) {
+                spdlog::error("Failed to decode embedded texture {} ({}): {}", texName, blob->formatHint,
+                              stbi_failure_reason());
+                return false;
             }
+            texture.adoptRawData(pixels, width, height, 4);
+            return true;
         }
-        
-        // Create a texture resource from the raw data
-        resultTexture = std::make_shared<Texture>();
-        resultTexture->setRawData(pixels, static_cast<int>(texture->mWidth), static_cast<int>(texture->mHeight), 4);
-        resultTexture->setName(texName);
-        
-        // Register in resource manager
-        m_resourceManager->add<Texture>(texName, resultTexture);
-        
-        // Clean up allocated data after texture is created
-        delete[] pixels;
-    }
-    
-    return resultTexture;
+
+        // Uncompressed texture, aiTexel is bgra
+        size_t texelCount = static_cast<size_t>(blob->width) * blob->height;
+        if (blob->data.size() < texelCount * 4) {
+            spdlog::error("Embedded texture {} is truncated", texName);
+            return false;
+        }
+        // malloc like stb_image, the texture takes it over
+        auto* pixels = static_cast<unsigned char*>(std::malloc(texelCount * 4));
+        if (!pixels) {
+            return false;
+        }
+        for (size_t i = 0; i < texelCount; ++i) {
+            const uint8_t* texel = &blob->data[i * 4];
+            pixels[i * 4 + 0] = texel[2];
+            pixels[i * 4 + 1] = texel[1];
+            pixels[i * 4 + 2] = texel[0];
+            pixels[i * 4 + 3] = texel[3];
+        }
+        texture.adoptRawData(pixels, static_cast<int>(blob->width), static_cast<int>(blob->height), 4);
+        return true;
+    }, pendingTextures);
 }
 
 auto ModelLoader::loadMaterialsFromMtl(const std::filesystem::path& mtlPath, 
-                                      std::shared_ptr<Shader> defaultShader) 
+                                      std::shared_ptr<Shader> defaultShader,
+                                      const std::shared_ptr<WaitGroup>& pendingTextures) 
     -> std::unordered_map<std::string, std::shared_ptr<Material>> {
     
     std::unordered_map<std::string, std::shared_ptr<Material>> materials;
     std::string currentMaterial;
     
-    std::ifstream file(mtlPath);
-    if (!file.is_open()) {
+    auto mtlFile = Vfs::open(mtlPath);
+    if (!mtlFile.isOpen()) {
         spdlog::error("Failed to open MTL file: {}", mtlPath.string());
         return materials;
     }
+    std::istringstream file{std::string(mtlFile.view())};
     
     std::string line;
     glm::vec3 ambient(0.1f);
@@ -343,15 +233,8 @@ auto ModelLoader::loadMaterialsFromMtl(const std::filesystem::path& mtlPath,
                 
                 // Handle texture if present
                 if (!diffuseTexture.empty()) {
-                    std::string textureName = currentMaterial + "_diffuse";
                     std::string texturePath = getTexturePath(mtlPath, diffuseTexture);
-                    
-                    auto texture = m_resourceManager->get<Texture>(textureName);
-                    if (!texture) {
-                        // Load the texture if not already loaded
-                        m_resourceManager->load<Texture>(textureName, texturePath);
-                        texture = m_resourceManager->get<Texture>(textureName);
-                    }
+                    auto texture = loadTextureFile(texturePath, pendingTextures);
                     
                     if (texture) {
                         material->setBool("uUseTexture", true);
@@ -401,14 +284,8 @@ auto ModelLoader::loadMaterialsFromMtl(const std::filesystem::path& mtlPath,
         material->setFloat("uShininess", shininess);
         
         if (!diffuseTexture.empty()) {
-            std::string textureName = currentMaterial + "_diffuse";
             std::string texturePath = getTexturePath(mtlPath, diffuseTexture);
-            
-            auto texture = m_resourceManager->get<Texture>(textureName);
-            if (!texture) {
-                m_resourceManager->load<Texture>(textureName, texturePath);
-                texture = m_resourceManager->get<Texture>(textureName);
-            }
+            auto texture = loadTextureFile(texturePath, pendingTextures);
             
             if (texture) {
                 material->setBool("uUseTexture", true);
@@ -438,13 +315,13 @@ auto ModelLoader::createDefaultMaterial(std::shared_ptr<Shader> defaultShader) -
 auto ModelLoader::getTexturePath(const std::filesystem::path& mtlPath, const std::string& textureName) -> std::string {
     // Try to find the texture in multiple possible locations
     auto texturePath = mtlPath.parent_path() / textureName;
-    if (std::filesystem::exists(texturePath)) {
+    if (Vfs::exists(texturePath)) {
         return texturePath.string();
     }
     
     // Try the textures subfolder
     texturePath = mtlPath.parent_path() / "textures" / textureName;
-    if (std::filesystem::exists(texturePath)) {
+    if (Vfs::exists(texturePath)) {
         return texturePath.string();
     }
     
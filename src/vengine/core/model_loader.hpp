@@ -2,9 +2,6 @@
 #include <memory>
 #include <string>
 #include <filesystem>
-#include <assimp/Importer.hpp>
-#include <assimp/scene.h>
-#include <assimp/postprocess.h>
 #include "vengine/core/model.hpp"
 #include "vengine/core/mesh_loader.hpp"
 #include "vengine/core/shader.hpp"
@@ -18,16 +15,28 @@ class ModelLoader {
     ModelLoader(std::shared_ptr<MeshLoader> meshLoader, ResourceManager* resourceManager);
     ~ModelLoader();
 
-    auto loadModel(const std::string& filename, const std::shared_ptr<Shader>& defaultShader) -> std::shared_ptr<Model>;
+    // the material texture loads also count into group when given
+    auto loadModel(const std::string& filename,
+                   const std::shared_ptr<Shader>& defaultShader,
+                   const std::shared_ptr<WaitGroup>& group = nullptr) -> std::shared_ptr<Model>;
 
    private:
-    auto loadMaterialsFromMtl(const std::filesystem::path& mtlPath, std::shared_ptr<Shader> defaultShader)
+    auto loadMaterialsFromMtl(const std::filesystem::path& mtlPath,
+                              std::shared_ptr<Shader> defaultShader,
+                              const std::shared_ptr<WaitGroup>& pendingTextures)
         -> std::unordered_map<std::string, std::shared_ptr<Material>>;
-    auto extractEmbeddedTexture(const aiTexture* texture, const std::string& texName) -> std::shared_ptr<Texture>;
+    auto createMaterial(const MeshCacheMaterial& description,
+                        const MeshCacheData& data,
+                        const std::filesystem::path& modelPath,
+                        std::shared_ptr<Shader> defaultShader,
+                        const std::shared_ptr<WaitGroup>& pendingTextures) -> std::shared_ptr<Material>;
+    auto loadTextureFile(const std::filesystem::path& path, const std::shared_ptr<WaitGroup>& pendingTextures)
+        -> std::shared_ptr<Texture>;
+    auto loadEmbeddedTexture(const MeshCacheTexture& embedded,
+                             const std::string& texName,
+                             const std::shared_ptr<WaitGroup>& pendingTextures) -> std::shared_ptr<Texture>;
     auto createDefaultMaterial(std::shared_ptr<Shader> defaultShader) -> std::shared_ptr<Material>;
     auto getTexturePath(const std::filesystem::path& mtlPath, const std::string& textureName) -> std::string;
-    auto loadMaterialsFromAssimp(const std::string& filename, std::shared_ptr<Shader> defaultShader)
-        -> std::unordered_map<std::string, std::shared_ptr<Material>>;
 
     std::shared_ptr<MeshLoader> m_meshLoader;
     ResourceManager* m_resourceManager;
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace Vengine {
+
+struct MpscQueueStats {
+    size_t pushed = 0;
+    size_t popped = 0;
+    size_t failedPushes = 0;  // queue was full
+    size_t highWaterMark = 0;
+};
+
+// bounded lock-free queue, any number of threads push, exactly one thread pops.
+// every cell carries a sequence number (vyukov style) so producers only race on one cas
+// and the consumer never touches a shared counter. meant for worker -> main thread messages.
+template <typename T>
+class MpscQueue {
+   public:
+    // capacity is rounded up to a power of two
+    explicit MpscQueue(size_t capacity = 1024) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        m_mask = size - 1;
+        m_cells = std::make_unique<Cell[]>(size);
+        for (size_t i = 0; i < size; ++i) {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~MpscQueue() {
+        // destroy whatever was never popped
+        size_t position = m_dequeuePosition.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = m_cells[position & m_mask];
+            if (cell.sequence.load(std::memory_order_acquire) != position + 1) {
+                break;
+            }
+            std::launder(reinterpret_cast<T*>(cell.storage))->~T();
+            cell.sequence.store(position + m_mask + 1, std::memory_order_relaxed);
+            ++position;
+        }
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    auto operator=(const MpscQueue&) -> MpscQueue& = delete;
+
+    // any thread. returns false if the queue is full, value is left untouched then
+    template <typename U>
+    auto tryPush(U&& value) -> bool {
+        size_t position = m_enqueuePosition.load(std::memory_order_relaxed);
+        Cell* cell = nullptr;
+
+        while (true) {
+            cell = &m_cells[position & m_mask];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+
+            if (diff == 0) {
+                if (m_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                m_failedPushes.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            } else {
+                position = m_enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+
+        new (cell->storage) T(std::forward<U>(value));
+        cell->sequence.store(position + 1, std::memory_order_release);
+
+        m_pushed.fetch_add(1, std::memory_order_relaxed);
+        size_t dequeue = m_dequeuePosition.load(std::memory_order_relaxed);
+        size_t size = position + 1 > dequeue ? position + 1 - dequeue : 0;
+        size_t highWaterMark = m_highWaterMark.load(std::memory_order_relaxed);
+        while (size > highWaterMark &&
+               !m_highWaterMark.compare_exchange_weak(highWaterMark, size, std::memory_order_relaxed)) {
+        }
+        return true;
+    }
+
+    // consumer thread only
+    auto tryPop(T& out) -> bool {
+        size_t position = m_dequeuePosition.load(std::memory_order_relaxed);
+        Cell& cell = m_cells[position & m_mask];
+        size_t sequence = cell.sequence.load(std::memory_order_acquire);
+
+        if (static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1) < 0) {
+            return false;
+        }
+
+        T* value = std::launder(reinterpret_cast<T*>(cell.storage));
+        out = std::move(*value);
+        value->~T();
+
+        cell.sequence.store(position + m_mask + 1, std::memory_order_release);
+        m_dequeuePosition.store(position + 1, std::memory_order_relaxed);
+        m_popped.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // approximate while producers are active
+    [[nodiscard]] auto size() const -> size_t {
+        size_t enqueue = m_enqueuePosition.load(std::memory_order_relaxed);
+        size_t dequeue = m_dequeuePosition.load(std::memory_order_relaxed);
+        return enqueue > dequeue ? enqueue - dequeue : 0;
+    }
+
+    [[nodiscard]] auto empty() const -> bool {
+        return size() == 0;
+    }
+
+    [[nodiscard]] auto capacity() const -> size_t {
+        return m_mask + 1;
+    }
+
+    [[nodiscard]] auto getStats() const -> MpscQueueStats {
+        MpscQueueStats stats;
+        stats.pushed = m_pushed.load(std::memory_order_relaxed);
+        stats.popped = m_popped.load(std::memory_order_relaxed);
+        stats.failedPushes = m_failedPushes.load(std::memory_order_relaxed);
+        stats.highWaterMark = m_highWaterMark.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+   private:
+    struct Cell {
+        std::atomic<size_t> sequence{0};
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    std::unique_ptr<Cell[]> m_cells;
+    size_t m_mask = 0;
+
+    // producers and consumer on separate cache lines
+    alignas(64) std::atomic<size_t> m_enqueuePosition{0};
+    alignas(64) std::atomic<size_t> m_dequeuePosition{0};
+
+    alignas(64) std::atomic<size_t> m_pushed{0};
+    std::atomic<size_t> m_failedPushes{0};
+    std::atomic<size_t> m_highWaterMark{0};
+    alignas(64) std::atomic<size_t> m_popped{0};
+};
+
+}  // namespace Vengine
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+namespace Vengine {
+
+// typed reference into the ResourceManager. cheap to copy and store in components,
+// resolving it is an array index plus a generation check, no string hashing and no lock.
+// a handle to a resource that got unloaded simply resolves to nullptr.
+template <typename T>
+struct Handle {
+    static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+
+    uint32_t index = INVALID_INDEX;
+    uint32_t generation = 0;
+
+    [[nodiscard]] auto isValid() const -> bool {
+        return index != INVALID_INDEX;
+    }
+
+    explicit operator bool() const {
+        return isValid();
+    }
+
+    auto operator==(const Handle& other) const -> bool = default;
+};
+
+}  // namespace Vengine
+
+template <typename T>
+struct std::hash<Vengine::Handle<T>> {
+    auto operator()(const Vengine::Handle<T>& handle) const noexcept -> size_t {
+        return std::hash<uint64_t>{}((static_cast<uint64_t>(handle.generation) << 32) | handle.index);
+    }
+};
@@ -8,11 +8,14 @@
 #endif
 #include <stb_image.h>
 
+#include <algorithm>
 #include <spdlog/spdlog.h>
 #include <tl/expected.hpp>
 #include <vengine/core/error.hpp>
 
 #include "resources.hpp"
+#include "vengine/utils/file_stamp.hpp"
+#include "vengine/utils/vfs.hpp"
 
 namespace Vengine {
 
@@ -25,11 +28,18 @@ auto ResourceManager::init(std::shared_ptr<ThreadManager> threadManager) -> tl::
     m_resourceRoot = std::filesystem::path("resources");
 
     m_meshLoader = std::make_shared<MeshLoader>();
+    m_meshLoader->setContentRegistry(&m_meshRegistry);
     m_modelLoader = std::make_unique<ModelLoader>(m_meshLoader, this);
     // NOWUSETHEOMDELLOADER GOGOGOGOGOGO
     m_threadManager = std::move(threadManager);
+    m_meshLoader->setThreadManager(m_threadManager);
+    m_textureStreamer = std::make_unique<TextureStreamer>(m_threadManager);
 
-    if (!std::filesystem::exists(m_resourceRoot)) {
+    // a pack next to the executable replaces the loose files, see tools/asset_pack.cpp
+    if (std::filesystem::exists(RESOURCE_PACK) && !Vfs::mount(RESOURCE_PACK)) {
+        spdlog::warn("Could not mount {}, falling back to loose files", RESOURCE_PACK);
+    }
+    if (!std::filesystem::exists(m_resourceRoot) && Vfs::getMountCount() == 0) {
         return tl::unexpected(Error{"Resource root does not exist"});
     }
 
@@ -41,21 +51,362 @@ auto ResourceManager::init(std::shared_ptr<ThreadManager> threadManager) -> tl::
     return {};
 }
 
+auto ResourceManager::initUploadRing(size_t size) -> bool {
+    // compressed textures without s3tc get decompressed at upload time and are not staged, the
+    // answer is cached for the workers here while the context is current. without it there is no
+    // point in encoding what gets imported from here on
+    if (!Texture::supportsS3tc()) {
+        m_textureCache.setImportCompression(TextureCompression::None);
+    }
+
+    auto ring = std::make_shared<UploadRing>();
+    if (!ring->init(size)) {
+        return false;
+    }
+    m_uploadRing = std::move(ring);
+    m_meshLoader->setUploadRing(getStagingRing());
+    return true;
+}
+
+auto ResourceManager::setUploadMode(UploadMode mode) -> bool {
+    bool started = true;
+    if (mode == UploadMode::SharedContext) {
+        if (!m_uploadThread) {
+            m_uploadThread = std::make_unique<UploadThread>(m_threadManager);
+        }
+        started = m_uploadThread->start();
+    }
+    // the thread stays up when going back, it just gets nothing new
+    m_uploadMode.store(started ? mode : UploadMode::MainThread, std::memory_order_release);
+    m_meshLoader->setUploadRing(getStagingRing());
+    return started;
+}
+
+auto ResourceManager::finalizeAsync(const std::shared_ptr<IResource>& resource,
+                                    const std::string& name,
+                                    std::function<void(bool)> done) -> void {
+    if (getUploadMode() == UploadMode::SharedContext && resource->supportsSharedUpload()) {
+        m_uploadThread->submit(resource, name, [name, done = std::move(done)](bool finalized) {
+            if (!finalized) {
+                spdlog::error("Failed to upload resource on the upload thread: {}", name);
+            }
+            done(finalized);
+        });
+        return;
+    }
+    m_threadManager->enqueueMainThreadTask(
+        [resource, name, done = std::move(done)]() {
+            bool finalized = resource->finalizeOnMainThread();
+            if (!finalized) {
+                spdlog::error("Failed to finalize resource on main thread: {}", name);
+            }
+            done(finalized);
+        },
+        "Finalize resource: " + name,
+        TaskPriority::Normal,
+        resource->getFinalizeCostHint());
+}
+
 ResourceManager::~ResourceManager() {
     spdlog::debug("Destructor ResourceManager");
 
-    for (auto& [type, resources] : m_resources) {
-        for (auto& [name, resource] : resources) {
-            resource->unload();
-        }
+    // whatever it still has uploads before the resources go away
+    if (m_uploadThread) {
+        m_uploadThread->stop();
+    }
+
+    for (const auto& resources : m_ownedStorages) {
+        resources->forEach([](const std::string&, const std::shared_ptr<IResource>& resource) { resource->unload(); });
     }
 
     ma_engine_uninit(&m_audioEngine);
 }
 
+auto ResourceManager::joinPendingLoad(const std::string& key, const std::shared_ptr<WaitGroup>& group) -> void {
+    if (!group) {
+        return;
+    }
+    // no entry means the load is already done
+    if (auto it = m_pendingLoads.find(key); it != m_pendingLoads.end()) {
+        group->add();
+        it->second.push_back(group);
+    }
+}
+
+auto ResourceManager::finishPendingLoad(const std::string& key) -> void {
+    std::vector<std::shared_ptr<WaitGroup>> waiting;
+    {
+        std::lock_guard<std::mutex> lock(m_pendingLoadsMutex);
+        if (auto it = m_pendingLoads.find(key); it != m_pendingLoads.end()) {
+            waiting = std::move(it->second);
+            m_pendingLoads.erase(it);
+        }
+    }
+    for (const auto& group : waiting) {
+        group->done();
+    }
+}
+
+auto ResourceManager::update() -> void {
+    auto frame = m_frame.fetch_add(1, std::memory_order_relaxed) + 1;
+    {
+        std::lock_guard<std::mutex> lock(m_storageMutex);
+        for (const auto& resources : m_ownedStorages) {
+            resources->setFrame(frame);
+        }
+    }
+    if (frame % TRIM_INTERVAL == 0) {
+        trim(m_graceFrames);
+    }
+    // after this frame's finalizes, their copies go behind this frame's fence
+    if (m_uploadRing) {
+        m_uploadRing->update();
+    }
+    pollHotReload();
+}
+
+auto ResourceManager::addHotReload(const std::filesystem::path& path, std::function<bool()> reload) -> void {
+    // served from a pack, there is no file to edit
+    if (FileStamp stamp; path.empty() || Vfs::statPacked(path, stamp)) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(m_hotReloadMutex);
+    if (m_fileWatcher.watch(path)) {
+        m_hotReloads[FileWatcher::normalize(path)].push_back(std::move(reload));
+    }
+}
+
+auto ResourceManager::watchFile(const std::shared_ptr<Shader>& shader) -> void {
+    auto reload = [this, weak = std::weak_ptr<Shader>(shader)]() {
+        auto shader = weak.lock();
+        if (shader) {
+            reloadShader(shader);
+        }
+        return shader != nullptr;
+    };
+    addHotReload(shader->getVertexFile(), reload);
+    addHotReload(shader->getFragmentFile(), reload);
+}
+
+auto ResourceManager::watchFile(const std::shared_ptr<Script>& script) -> void {
+    addHotReload(script->getPath(), [this, weak = std::weak_ptr<Script>(script)]() {
+        auto script = weak.lock();
+        if (script) {
+            reloadScript(script);
+        }
+        return script != nullptr;
+    });
+}
+
+auto ResourceManager::watchFile(const std::shared_ptr<Texture>& texture) -> void {
+    addHotReload(texture->getSourcePath(), [this, weak = std::weak_ptr<Texture>(texture)]() {
+        auto texture = weak.lock();
+        if (texture) {
+            reloadTexture(texture);
+        }
+        return texture != nullptr;
+    });
+}
+
+auto ResourceManager::pollHotReload() -> void {
+    std::vector<std::filesystem::path> changed;
+    std::lock_guard<std::mutex> lock(m_hotReloadMutex);
+    // drained even when off, turning it back on doesn't replay old saves
+    m_fileWatcher.poll(changed);
+    if (!m_hotReload.load(std::memory_order_relaxed)) {
+        return;
+    }
+    for (const auto& path : changed) {
+        auto it = m_hotReloads.find(path.string());
+        if (it == m_hotReloads.end()) {
+            continue;
+        }
+        spdlog::info("{} changed, reloading", path.string());
+        std::erase_if(it->second, [](const auto& reload) { return !reload(); });
+    }
+}
+
+// the reloads read (and decode) on a worker and only swap on the main thread, high priority so
+// an edit shows up within a frame or two of the save even while the workers are busy loading
+
+auto ResourceManager::reloadShader(const std::shared_ptr<Shader>& shader) -> void {
+    m_threadManager->enqueueTask(
+        [this, shader]() {
+            auto vertexSource = Shader::readFile(shader->getVertexFile());
+            auto fragmentSource = Shader::readFile(shader->getFragmentFile());
+            if (!vertexSource || !fragmentSource) {
+                spdlog::error("Reloading shader {} failed: {}",
+                              shader->getName(),
+                              (vertexSource ? fragmentSource : vertexSource).error().message);
+                return;
+            }
+            m_threadManager->enqueueMainThreadTask(
+                [this, shader, vertexSource = std::move(vertexSource.value()),
+                 fragmentSource = std::move(fragmentSource.value())]() {
+                    if (shader->reload(vertexSource, fragmentSource)) {
+                        m_hotReloadCount.fetch_add(1, std::memory_order_relaxed);
+                    }
+                },
+                "Swap shader: " + shader->getName(),
+                TaskPriority::High);
+        },
+        "Reload shader: " + shader->getName(),
+        TaskPriority::High);
+}
+
+auto ResourceManager::reloadScript(const std::shared_ptr<Script>& script) -> void {
+    m_threadManager->enqueueTask(
+        [this, script]() {
+            auto file = Vfs::open(script->getPath());
+            if (!file.isOpen()) {
+                spdlog::error("Reloading script {} failed, can't read it", script->getPath());
+                return;
+            }
+            m_threadManager->enqueueMainThreadTask(
+                [this, script, source = std::string(file.view())]() {
+                    script->setSource(source);
+                    m_hotReloadCount.fetch_add(1, std::memory_order_relaxed);
+                    spdlog::info("Reloaded script {}", script->getPath());
+                },
+                "Swap script: " + script->getPath(),
+                TaskPriority::High);
+        },
+        "Reload script: " + script->getPath(),
+        TaskPriority::High);
+}
+
+auto ResourceManager::reloadTexture(const std::shared_ptr<Texture>& texture) -> void {
+    m_threadManager->enqueueTask(
+        [this, texture]() {
+            // the old content is on its way out, nothing may share it from here on
+            m_textureRegistry.remove(texture.get());
+
+            auto fresh = std::make_shared<Texture>();
+            fresh->setName(texture->getName());
+            fresh->setCache(&m_textureCache);
+            fresh->setContentRegistry(&m_textureRegistry);
+            fresh->setUploadRing(getStagingRing());
+            fresh->setStreaming(texture->getStreamingTailSize());
+            if (!fresh->load(texture->getSourcePath().string())) {
+                spdlog::error("Reloading texture {} failed, keeping the old one", texture->getName());
+                return;
+            }
+
+            m_threadManager->enqueueMainThreadTask(
+                [this, texture, fresh]() {
+                    if (fresh->needsMainThreadInit() && !fresh->finalizeOnMainThread()) {
+                        spdlog::error("Reloading texture {} failed, keeping the old one", texture->getName());
+                        return;
+                    }
+
+                    // textures that were sharing the old content load their own files again
+                    std::vector<std::shared_ptr<Texture>> sharing;
+                    storage<Texture>().forEach([&](const std::string&, const std::shared_ptr<IResource>& resource) {
+                        auto other = std::static_pointer_cast<Texture>(resource);
+                        if (other->getDuplicateOf() == texture.get()) {
+                            sharing.push_back(std::move(other));
+                        }
+                    });
+
+                    texture->replaceWith(fresh);
+                    if (fresh->isStreamable() && m_textureStreamer && m_textureStreamer->isEnabled()) {
+                        m_textureStreamer->add(fresh);
+                    }
+                    m_hotReloadCount.fetch_add(1, std::memory_order_relaxed);
+                    spdlog::info("Reloaded texture {}", texture->getName());
+
+                    for (const auto& other : sharing) {
+                        reloadTexture(other);
+                    }
+                },
+                "Swap texture: " + texture->getName(),
+                TaskPriority::High,
+                fresh->getFinalizeCostHint());
+        },
+        "Reload texture: " + texture->getName(),
+        TaskPriority::High);
+}
+
+auto ResourceManager::trim(uint32_t graceFrames) -> void {
+    auto frame = m_frame.load(std::memory_order_relaxed);
+    std::vector<ResourceUsage> usage;
+    for (const auto& source : m_referenceSources) {
+        source(*this);
+    }
+
+    for (uint32_t typeId = 0; typeId < MAX_RESOURCE_TYPES; ++typeId) {
+        auto* resources = m_storages[typeId].load(std::memory_order_acquire);
+        if (!resources) {
+            continue;
+        }
+
+        ResourceUsage typeUsage;
+        typeUsage.type = resources->getTypeName();
+        typeUsage.budgetBytes = m_budgets[typeId].load(std::memory_order_relaxed);
+
+        auto entries = resources->getEntries();
+        std::vector<std::pair<size_t, ResourceMemory>> candidates;
+        for (size_t i = 0; i < entries.size(); ++i) {
+            const auto& entry = entries[i];
+            auto memory = entry.resource->getMemoryUsage();
+            typeUsage.count++;
+            typeUsage.cpuBytes += memory.cpuBytes;
+            typeUsage.gpuBytes += memory.gpuBytes;
+            if (const auto* original = entry.resource->getDuplicateOf()) {
+                auto saved = original->getMemoryUsage();
+                typeUsage.duplicates++;
+                typeUsage.bytesSaved += saved.cpuBytes + saved.gpuBytes;
+            }
+            if (entry.referenced) {
+                typeUsage.referenced++;
+            } else if (frame - std::min(frame, entry.lastUsedFrame) >= graceFrames) {
+                candidates.emplace_back(i, memory);
+            }
+        }
+
+        auto budget = typeUsage.budgetBytes;
+        if (budget > 0 && typeUsage.cpuBytes + typeUsage.gpuBytes > budget) {
+            std::sort(candidates.begin(), candidates.end(), [&entries](const auto& a, const auto& b) {
+                return entries[a.first].lastUsedFrame < entries[b.first].lastUsedFrame;
+            });
+            for (const auto& [index, memory] : candidates) {
+                if (typeUsage.cpuBytes + typeUsage.gpuBytes <= budget) {
+                    break;
+                }
+                const auto& entry = entries[index];
+                if (auto released = resources->releaseResource(entry.name)) {
+                    released->unload();
+                }
+                spdlog::debug("Evicted {} {} ({} bytes)", typeUsage.type, entry.name, memory.cpuBytes + memory.gpuBytes);
+                typeUsage.cpuBytes -= memory.cpuBytes;
+                typeUsage.gpuBytes -= memory.gpuBytes;
+                typeUsage.count--;
+                m_evictedCounts[typeId]++;
+            }
+        }
+        typeUsage.evicted = m_evictedCounts[typeId];
+        usage.push_back(std::move(typeUsage));
+    }
+
+    m_usage = std::move(usage);
+    m_textureRegistry.prune();
+    m_meshRegistry.prune();
+}
+
+auto ResourceManager::setBudget(const std::string& type, uint64_t bytes) -> bool {
+    for (uint32_t typeId = 0; typeId < MAX_RESOURCE_TYPES; ++typeId) {
+        auto* resources = m_storages[typeId].load(std::memory_order_acquire);
+        if (resources && resources->getTypeName() == type) {
+            m_budgets[typeId].store(bytes, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
 auto ResourceManager::loadModel(const std::string& name,
                                 const std::string& fileName,
-                                std::shared_ptr<Shader> defaultShader) -> bool {
+                                std::shared_ptr<Shader> defaultShader) -> Handle<Model> {
     assert(!fileName.empty() && "Filename cannot be empty");
     assert(!name.empty() && "Name cannot be empty");
 
@@ -64,50 +415,99 @@ auto ResourceManager::loadModel(const std::string& name,
     auto model = m_modelLoader->loadModel(fileName, defaultShader);
     if (!model) {
         spdlog::error("Failed to load model: {}", fileName);
-        return false;
+        return {};
     }
 
     model->load(fileName);
 
-    {
-        std::lock_guard<std::mutex> lock(m_resourceMutex);
-        m_resources[std::type_index(typeid(Model))][name] = model;
-    }
+    auto& models = storage<Model>();
+    auto handle = models.acquire(name);
+    models.publish(handle, model);
 
     if (model->needsMainThreadInit()) {
         model->finalizeOnMainThread();
     }
 
-    return true;
+    return handle;
 }
 
 auto ResourceManager::loadModelAsync(const std::string& name,
                                      const std::string& fileName,
-                                     std::shared_ptr<Shader> defaultShader) -> void {
+                                     std::shared_ptr<Shader> defaultShader) -> LoadHandle<Model> {
+    return loadModelAsync(std::make_shared<LoadState>(), name, fileName, std::move(defaultShader));
+}
+
+auto ResourceManager::loadModelAsync(const std::shared_ptr<LoadState>& state,
+                                     const std::string& name,
+                                     const std::string& fileName,
+                                     std::shared_ptr<Shader> defaultShader) -> LoadHandle<Model> {
+    assert(state != nullptr && "LoadState cannot be null");
     assert(!fileName.empty() && "Filename cannot be empty");
     assert(!name.empty() && "Name cannot be empty");
 
     spdlog::debug("Loading model async: {} from file: {}", name, fileName);
 
-    m_threadManager->enqueueTask([this, name, fileName, defaultShader]() {
-        auto model = m_modelLoader->loadModel(fileName, defaultShader);
-        if (!model) {
-            spdlog::error("Failed to load model: {}", fileName);
-            return;
-        }
+    auto handle = storage<Model>().acquire(name);
+    auto group = state->getGroup();
+    m_threadManager->enqueueTask(
+        [this, handle, name, fileName, defaultShader, state, group]() {
+            // the material textures count into the state through the model's own group
+            auto model = m_modelLoader->loadModel(fileName, defaultShader, group);
+            if (!model) {
+                spdlog::error("Failed to load model: {}", fileName);
+                storage<Model>().releaseIfEmpty(handle);
+                state->markFailed();
+                return;
+            }
 
-        model->load(fileName);
+            model->load(fileName);
 
-        {
-            std::lock_guard<std::mutex> lock(m_resourceMutex);
-            m_resources[std::type_index(typeid(Model))][name] = model;
-        }
+            // like loadAsync, published once the mesh is uploaded
+            if (model->needsMainThreadInit()) {
+                group->add();
+                finalizeAsync(model, name, [this, handle, model, state, group](bool finalized) {
+                    if (finalized) {
+                        storage<Model>().publish(handle, model);
+                    } else {
+                        storage<Model>().releaseIfEmpty(handle);
+                        state->markFailed();
+                    }
+                    group->done();
+                });
+            } else {
+                storage<Model>().publish(handle, model);
+            }
+        },
+        "Load model: " + name,
+        TaskPriority::Normal,
+        group);
+    return {handle, state};
+}
 
-        if (model->needsMainThreadInit()) {
-            m_threadManager->enqueueMainThreadTask([model, name]() { model->finalizeOnMainThread(); },
-                                                   "Finalize model: " + name);
+auto ResourceManager::loadBatch(const std::vector<LoadTask>& tasks, std::shared_ptr<Shader> defaultShader)
+    -> std::shared_ptr<LoadState> {
+    auto state = std::make_shared<LoadState>();
+    for (const auto& task : tasks) {
+        if (task.type == "Model") {
+            loadModelAsync(state, task.name, task.fileName, defaultShader);
+        } else if (task.type == "Texture") {
+            loadAsync<Texture>(state, task.name, task.fileName);
+        } else if (task.type == "Mesh") {
+            loadAsync<Mesh>(state, task.name, task.fileName);
+        } else if (task.type == "Sound") {
+            loadAsync<Sound>(state, task.name, task.fileName);
+        } else if (task.type == "Script") {
+            loadAsync<Script>(state, task.name, task.fileName);
+        } else {
+            spdlog::error("Cannot batch load {} of unknown type {}", task.name, task.type);
+            state->markFailed();
         }
-    });
+    }
+    return state;
+}
+
+auto ResourceManager::wait(const LoadState& state) -> void {
+    m_threadManager->waitOnMainThread(*state.getGroup());
 }
 
 }  // namespace Vengine
\ No newline at end of file
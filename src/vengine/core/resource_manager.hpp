@@ -1,38 +1,66 @@
 #pragma once
 
 #include <filesystem>
+#include <functional>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 #include <tl/expected.hpp>
 #include "vengine/core/error.hpp"
 #include "vengine/core/thread_manager.hpp"
 #include "vengine/core/model_loader.hpp"
 
+#include "vengine/core/load_handle.hpp"
 #include "vengine/core/mesh_loader.hpp"
+#include "vengine/core/resource_handle.hpp"
+#include "vengine/core/resource_storage.hpp"
 #include "resources.hpp"
-#include <typeindex>
+#include "vengine/core/texture_streamer.hpp"
+#include "vengine/renderer/upload_thread.hpp"
+#include "vengine/utils/file_watcher.hpp"
+#include <array>
 #include <tuple>
-#include <unordered_map>
 #include <glad/glad.h>
 #include <spdlog/spdlog.h>
 
 namespace Vengine {
 
+// one entry of loadBatch(), type is what getUsage() reports ("Texture", "Model", ...)
 struct LoadTask {
     std::string name;
     std::string fileName;
     std::string type;
 };
 
-// TODO split resources map into different types
+// per type totals, what ResourceManager::getUsage() reports
+struct ResourceUsage {
+    std::string type;
+    size_t count = 0;
+    size_t referenced = 0;  // held by something besides the manager, never evicted
+    uint64_t cpuBytes = 0;
+    uint64_t gpuBytes = 0;
+    uint64_t budgetBytes = 0;  // cpu + gpu, 0 is no budget
+    size_t evicted = 0;
+    size_t duplicates = 0;  // loads that share another resource's content
+    uint64_t bytesSaved = 0;  // what those duplicates would hold on their own
+};
+
+// resources live in one ResourceStorage per type. load/add return a Handle that components can
+// keep, get(handle) is lock free and hands out a pointer for the current frame. lock(handle) and
+// the name based calls are for load and bind time.
 class ResourceManager {
    public:
+    static constexpr size_t MAX_RESOURCE_TYPES = 32;
+    static constexpr const char* RESOURCE_PACK = "resources.vpak";
+
     ResourceManager();
     ~ResourceManager();
     auto init(std::shared_ptr<ThreadManager> threadManager) -> tl::expected<void, Error>;
 
+    // returns an invalid handle if loading failed
     template <typename T, typename... Args>
-    auto load(const std::string& name, const std::string& fileName, Args&&... loadArgs) -> bool {
+    auto load(const std::string& name, const std::string& fileName, Args&&... loadArgs) -> Handle<T> {
         assert(!fileName.empty() && "Filename cannot be empty");
         assert(!name.empty() && "Name cannot be empty");
 
@@ -51,7 +79,7 @@ class ResourceManager {
             }
             if (!resource) {
                 spdlog::error("Failed to load mesh: {}", fileName);
-                return false;
+                return {};
             }
         }
 
@@ -62,37 +90,64 @@ class ResourceManager {
         if (!resource) {
             resource = std::make_shared<T>();
         }
+        resource->setResidency(getResidency<T>());
 
         if constexpr (std::is_same_v<T, Sound>) {
             resource->setEngine(&m_audioEngine);
         }
+        if constexpr (std::is_same_v<T, Texture>) {
+            resource->setCache(&m_textureCache);
+            resource->setContentRegistry(&m_textureRegistry);
+            resource->setUploadRing(getStagingRing());
+        }
 
-        if (resource->load(fileName)) {
-            {
-                std::lock_guard<std::mutex> lock(m_resourceMutex);
-                m_resources[std::type_index(typeid(T))][name] = resource;
-            }
+        if (!resource->load(fileName)) {
+            spdlog::error("Failed to load {} resource: {}", typeid(T).name(), name);
+            return {};
+        }
 
-            if (resource->needsMainThreadInit()) {
-                if (!resource->finalizeOnMainThread()) {
-                    spdlog::error("Failed to finalize resource on main thread: {}", name);
-                }
+        auto& resources = storage<T>();
+        auto handle = resources.acquire(name);
+        resources.publish(handle, resource);
+
+        if (resource->needsMainThreadInit()) {
+            if (!resource->finalizeOnMainThread()) {
+                spdlog::error("Failed to finalize resource on main thread: {}", name);
             }
-        } else {
-            spdlog::error("Failed to load {} resource: {}", typeid(T).name(), name);
-            return false;
         }
-        return true;
+        watchForHotReload(resource);
+        return handle;
+    }
+
+    // the handle is valid right away and resolves to nullptr until the load is done,
+    // the state tells when it is done (finalize included) and whether it failed
+    template <typename T, typename... Args>
+    auto loadAsync(const std::string& name, const std::string& fileName, Args&&... loadArgs) -> LoadHandle<T> {
+        return loadAsync<T>(std::make_shared<LoadState>(), name, fileName, std::forward<Args>(loadArgs)...);
     }
 
+    // same, counted into state. several loads on one state make a batch
     template <typename T, typename... Args>
-    auto loadAsync(const std::string& name, const std::string& fileName, Args&&... loadArgs) -> void {
+    auto loadAsync(const std::shared_ptr<LoadState>& state,
+                   const std::string& name,
+                   const std::string& fileName,
+                   Args&&... loadArgs) -> LoadHandle<T> {
+        assert(state != nullptr && "LoadState cannot be null");
         assert(!fileName.empty() && "Filename cannot be empty");
         assert(!name.empty() && "Name cannot be empty");
 
+        auto handle = storage<T>().acquire(name);
         auto argsSize = sizeof...(loadArgs);
+        auto group = state->getGroup();
         m_threadManager->enqueueTask(
-            [this, name, fileName, argsSize, loadArgsTuple = std::make_tuple(std::forward<Args>(loadArgs)...)]() {
+            [this,
+             handle,
+             name,
+             fileName,
+             argsSize,
+             state,
+             group,
+             loadArgsTuple = std::make_tuple(std::forward<Args>(loadArgs)...)]() {
                 spdlog::debug("Loading resource: {} from file: {}", name, fileName);
                 std::shared_ptr<T> resource;
 
@@ -109,6 +164,9 @@ class ResourceManager {
                     }
                     if (!resource) {
                         spdlog::error("Failed to load mesh: {}", fileName);
+                        // like load(), a failed load leaves nothing registered under name
+                        storage<T>().releaseIfEmpty(handle);
+                        state->markFailed();
                         return;
                     }
                 }
@@ -119,103 +177,468 @@ class ResourceManager {
                 if (!resource) {
                     resource = std::make_shared<T>();
                 }
+                resource->setResidency(getResidency<T>());
 
                 if constexpr (std::is_same_v<T, Sound>) {
                     resource->setEngine(&m_audioEngine);
                 }
+                if constexpr (std::is_same_v<T, Texture>) {
+                    resource->setCache(&m_textureCache);
+                    resource->setContentRegistry(&m_textureRegistry);
+                    resource->setUploadRing(getStagingRing());
+                }
 
                 if (resource->load(fileName)) {
-                    {
-                        std::lock_guard<std::mutex> lock(m_resourceMutex);
-                        m_resources[std::type_index(typeid(T))][name] = resource;
-                    }
+                    watchForHotReload(resource);
 
                     if (resource->needsMainThreadInit()) {
-                        m_threadManager->enqueueMainThreadTask(
-                            [resource, name]() {
-                                if (resource->finalizeOnMainThread()) {
-                                    // spdlog::info("Finalized resource on main thread: {}", name);
-                                } else {
-                                    spdlog::error("Failed to finalize resource on main thread: {}", name);
-                                }
-                            },
-                            "Finalize resource: " + name);
+                        // published once its gpu objects exist, the handle resolves to nullptr until then.
+                        // added while this task still holds the group, so it can't reach zero in between
+                        group->add();
+                        finalizeAsync(resource, name, [this, handle, resource, state, group](bool finalized) {
+                            if (finalized) {
+                                storage<T>().publish(handle, resource);
+                            } else {
+                                storage<T>().releaseIfEmpty(handle);
+                                state->markFailed();
+                            }
+                            group->done();
+                        });
+                    } else {
+                        storage<T>().publish(handle, resource);
                     }
                 } else {
                     spdlog::error("Failed to load {} resource: {}", typeid(T).name(), name);
+                    storage<T>().releaseIfEmpty(handle);
+                    state->markFailed();
                 }
             },
+            "Load " + std::string(typeid(T).name()) + ": " + name,
+            TaskPriority::Normal,
+            group);
+        return {handle, state};
+    }
+
+    // the resource registered under name, or a new empty one that fill() loads on a worker.
+    // the object is there right away so a material can point at it, the data shows up once it is
+    // finalized. concurrent callers with the same name all get the same object and fill runs once.
+    // group, if given, is held until that load is finished (finalize included), whoever started it
+    template <typename T>
+    auto getOrCreateAsync(const std::string& name,
+                          std::function<bool(T&)> fill,
+                          const std::shared_ptr<WaitGroup>& group = nullptr) -> std::shared_ptr<T> {
+        assert(!name.empty() && "Name cannot be empty");
+
+        auto& resources = storage<T>();
+        auto key = pendingLoadKey<T>(name);
+        std::shared_ptr<T> resource;
+        Handle<T> handle;
+        {
+            // registering and joining happen under one lock, a joiner can't miss a load that is running
+            std::lock_guard<std::mutex> lock(m_pendingLoadsMutex);
+            handle = resources.acquire(name);
+            if (auto existing = resources.lock(handle)) {
+                joinPendingLoad(key, group);
+                return existing;
+            }
+
+            resource = std::make_shared<T>();
+            resource->setResidency(getResidency<T>());
+            if constexpr (std::is_same_v<T, Sound>) {
+                resource->setEngine(&m_audioEngine);
+            }
+            if constexpr (std::is_same_v<T, Texture>) {
+                // material textures stream, ones loaded by name (skybox, ui) stay fully resident
+                resource->setCache(&m_textureCache);
+                resource->setContentRegistry(&m_textureRegistry);
+                resource->setUploadRing(getStagingRing());
+                if (m_textureStreamer && m_textureStreamer->isEnabled()) {
+                    resource->setStreaming(m_textureStreamer->getConfig().tailSize);
+                }
+            }
+            auto published = resources.publishIfEmpty(handle, resource);
+            if (published != resource) {
+                return published;
+            }
+
+            if constexpr (std::is_same_v<T, Texture>) {
+                if (m_textureStreamer && m_textureStreamer->isEnabled()) {
+                    m_textureStreamer->add(resource);
+                }
+            }
+
+            auto& waiting = m_pendingLoads[key];
+            if (group) {
+                group->add();
+                waiting.push_back(group);
+            }
+        }
+
+        m_threadManager->enqueueTask(
+            [this, resource, handle, name, key, fill = std::move(fill)]() {
+                if (!fill(*resource)) {
+                    spdlog::error("Failed to load {} resource: {}", typeid(T).name(), name);
+                    // holders keep the empty object, the name is free for another try
+                    storage<T>().releaseIfHolds(handle, resource.get());
+                    finishPendingLoad(key);
+                    return;
+                }
+                watchForHotReload(resource);
+                if (!resource->needsMainThreadInit()) {
+                    finishPendingLoad(key);
+                    return;
+                }
+                finalizeAsync(resource, name, [this, key](bool) { finishPendingLoad(key); });
+            },
             "Load " + std::string(typeid(T).name()) + ": " + name);
+        return resource;
     }
 
     template <typename T>
-    auto add(const std::string& name, std::shared_ptr<T> resource) -> void {
+    auto getOrLoadAsync(const std::string& name,
+                        const std::string& fileName,
+                        const std::shared_ptr<WaitGroup>& group = nullptr) -> std::shared_ptr<T> {
+        assert(!fileName.empty() && "Filename cannot be empty");
+        return getOrCreateAsync<T>(
+            name, [fileName](T& resource) { return resource.load(fileName); }, group);
+    }
+
+    template <typename T>
+    auto add(const std::string& name, std::shared_ptr<T> resource) -> Handle<T> {
+        auto& resources = storage<T>();
+        auto handle = resources.acquire(name);
+        resources.publish(handle, resource);
+
         if (resource->needsMainThreadInit()) {
-            m_threadManager->enqueueMainThreadTask(
-                [resource, name]() {
-                    if (resource->finalizeOnMainThread()) {
-                        // spdlog::info("Finalized resource on main thread: {}", name);
-                    } else {
-                        spdlog::error("Failed to finalize resource on main thread: {}", name);
-                    }
-                },
-                "Finalize resource: " + name);
+            finalizeAsync(resource, name, [](bool) {});
         }
-        std::lock_guard<std::mutex> lock(m_resourceMutex);
-        m_resources[std::type_index(typeid(T))][name] = resource;
+        return handle;
     }
 
-    auto isLoaded(const std::string& name) -> bool {
-        std::lock_guard<std::mutex> lock(m_resourceMutex);
+    // main thread. drops name from the registry and unloads it, refused while anything still
+    // holds the resource (a material, a model, a load in flight)
+    template <typename T>
+    auto unload(const std::string& name) -> bool {
+        auto& resources = storage<T>();
+        auto handle = resources.find(name);
+        auto resource = resources.lock(handle);
+        if (!resource) {
+            return false;
+        }
+        // one count is the slot, one is ours
+        if (resource.use_count() > 2) {
+            spdlog::warn("Not unloading {} {}, it is still in use", resourceTypeName<T>(), name);
+            return false;
+        }
+        resources.release(name);
+        resource->unload();
+        return true;
+    }
 
-        return std::any_of(m_resources.begin(), m_resources.end(), [&name](const auto& pair) {
-            const auto& resources = pair.second;
-            return resources.find(name) != resources.end();
-        });
+    // main thread, once a frame. stamps the frame into the storages so get() can track use,
+    // every TRIM_INTERVAL frames the usage is recounted and types over budget are trimmed
+    auto update() -> void;
+    // evicts resources that nothing references and that were not resolved for graceFrames,
+    // least recently used first, from every type over its budget
+    auto trim(uint32_t graceFrames) -> void;
+    auto trim() -> void {
+        trim(m_graceFrames);
     }
 
+    // handles hold no shared_ptr, so whoever keeps them has to say so. trim() runs every source
+    // before it looks at the storages, a source calls markReferenced() for each handle it holds
+    auto addReferenceSource(std::function<void(ResourceManager&)> source) -> void {
+        m_referenceSources.push_back(std::move(source));
+    }
     template <typename T>
-    auto get(const std::string& name) -> std::shared_ptr<T> {
-        std::lock_guard<std::mutex> lock(m_resourceMutex);
-        auto typeIt = m_resources.find(std::type_index(typeid(T)));
-        if (typeIt != m_resources.end()) {
-            auto& innerMap = typeIt->second;
-            auto it = innerMap.find(name);
-            if (it != innerMap.end()) {
-                return std::static_pointer_cast<T>(it->second);
+    auto markReferenced(Handle<T> handle) -> void {
+        storage<T>().markReferenced(handle);
+    }
+
+    // cpu + gpu bytes for a type, 0 turns the budget off
+    template <typename T>
+    auto setBudget(uint64_t bytes) -> void {
+        m_budgets[resourceTypeId<T>()].store(bytes, std::memory_order_relaxed);
+    }
+    template <typename T>
+    [[nodiscard]] auto getBudget() const -> uint64_t {
+        return m_budgets[resourceTypeId<T>()].load(std::memory_order_relaxed);
+    }
+    // by the name getUsage() reports, for the editor
+    auto setBudget(const std::string& type, uint64_t bytes) -> bool;
+
+    // what resources of type T loaded from here on keep after their upload, GpuOnly by default.
+    // only the types that upload something (Texture, Mesh) look at it
+    template <typename T>
+    auto setResidency(Residency residency) -> void {
+        m_residencies[resourceTypeId<T>()].store(residency, std::memory_order_relaxed);
+        if constexpr (std::is_same_v<T, Mesh>) {
+            // the meshes of models come straight from the loader
+            m_meshLoader->setResidency(residency);
+        }
+    }
+    template <typename T>
+    [[nodiscard]] auto getResidency() const -> Residency {
+        return m_residencies[resourceTypeId<T>()].load(std::memory_order_relaxed);
+    }
+
+    // meshes loaded from here on upload half floats, packed normals and 16-bit indices where
+    // the data allows it. on by default
+    auto setCompactMeshes(bool compact) -> void {
+        m_meshLoader->setCompactVertices(compact);
+    }
+
+    auto setEvictionGraceFrames(uint32_t frames) -> void {
+        m_graceFrames = frames;
+    }
+
+    // as of the last update() or trim()
+    [[nodiscard]] auto getUsage() const -> const std::vector<ResourceUsage>& {
+        return m_usage;
+    }
+
+    template <typename T>
+    auto isLoaded(const std::string& name) -> bool {
+        return storage<T>().contains(name);
+    }
+
+    // any type with this name, prefer isLoaded<T>
+    auto isLoaded(const std::string& name) -> bool {
+        for (const auto& storage : m_storages) {
+            auto* resources = storage.load(std::memory_order_acquire);
+            if (resources && resources->contains(name)) {
+                return true;
             }
         }
-        return nullptr;
+        return false;
+    }
+
+    // valid for names that are loaded or still loading, invalid otherwise
+    template <typename T>
+    auto getHandle(const std::string& name) -> Handle<T> {
+        return storage<T>().find(name);
+    }
+
+    // lock free, nullptr while the resource is still loading or after it got unloaded. the
+    // pointer is good until the end of the frame, lock() it to keep the resource around longer
+    template <typename T>
+    auto get(Handle<T> handle) -> T* {
+        return storage<T>().get(handle);
+    }
+
+    template <typename T>
+    auto lock(Handle<T> handle) -> std::shared_ptr<T> {
+        return storage<T>().lock(handle);
+    }
+
+    template <typename T>
+    auto get(const std::string& name) -> std::shared_ptr<T> {
+        auto& resources = storage<T>();
+        return resources.lock(resources.find(name));
     }
 
     auto loadModel(const std::string& name,
                    const std::string& fileName,
-                   std::shared_ptr<Shader> defaultShader = nullptr) -> bool;
+                   std::shared_ptr<Shader> defaultShader = nullptr) -> Handle<Model>;
+    // done once the mesh is uploaded and every material texture is finalized
     auto loadModelAsync(const std::string& name,
                         const std::string& fileName,
-                        std::shared_ptr<Shader> defaultShader = nullptr) -> void;
+                        std::shared_ptr<Shader> defaultShader = nullptr) -> LoadHandle<Model>;
+    auto loadModelAsync(const std::shared_ptr<LoadState>& state,
+                        const std::string& name,
+                        const std::string& fileName,
+                        std::shared_ptr<Shader> defaultShader = nullptr) -> LoadHandle<Model>;
+
+    // starts every task on one state, a scene can wait for its own assets instead of the whole queue.
+    // models get defaultShader, unknown types count as failed
+    auto loadBatch(const std::vector<LoadTask>& tasks, std::shared_ptr<Shader> defaultShader = nullptr)
+        -> std::shared_ptr<LoadState>;
+
+    // main thread, blocks until state is done. runs main thread tasks (finalizes) and helps the
+    // workers in the meantime, so it doesn't wait for the next frame to make progress
+    auto wait(const LoadState& state) -> void;
 
     template <typename T>
     auto getLoadedCount() -> size_t {
-        std::lock_guard<std::mutex> lock(m_resourceMutex);
-        auto typeIt = m_resources.find(std::type_index(typeid(T)));
-        if (typeIt != m_resources.end()) {
-            return typeIt->second.size();
-        }
-        return 0;
+        return storage<T>().getLoadedCount();
+    }
+
+    [[nodiscard]] auto getTextureCache() -> TextureCache& {
+        return m_textureCache;
+    }
+
+    // set up by init()
+    [[nodiscard]] auto getMeshCache() -> MeshCache& {
+        return m_meshLoader->getCache();
+    }
+
+    // set up by init()
+    [[nodiscard]] auto getTextureStreamer() -> TextureStreamer& {
+        return *m_textureStreamer;
+    }
+
+    // main thread, once the renderer has loaded gl. textures and meshes loaded from then on copy
+    // their data into a persistently mapped ring on the worker, finalizing only records a copy
+    // from there. without it, or whenever the ring is full, uploads are direct as before
+    auto initUploadRing(size_t size = UploadRing::DEFAULT_SIZE) -> bool;
+    // nullptr until initUploadRing() worked
+    [[nodiscard]] auto getUploadRing() const -> const UploadRing* {
+        return m_uploadRing.get();
+    }
+
+    // main thread, applies to loads finalized from now on. SharedContext needs a context that can
+    // share with the current one, false and staying on MainThread if the driver won't give us one
+    auto setUploadMode(UploadMode mode) -> bool;
+    [[nodiscard]] auto getUploadMode() const -> UploadMode {
+        return m_uploadMode.load(std::memory_order_acquire);
+    }
+    // nullptr until SharedContext was selected once
+    [[nodiscard]] auto getUploadThread() const -> const UploadThread* {
+        return m_uploadThread.get();
+    }
+
+    // shaders, scripts and textures loaded from files are watched, update() reloads the ones that
+    // changed on disk: read and decoded on a worker, swapped in on the main thread. anything
+    // holding the resource keeps its pointer and sees the new content. on by default
+    auto setHotReload(bool enabled) -> void {
+        m_hotReload.store(enabled, std::memory_order_relaxed);
+    }
+    [[nodiscard]] auto isHotReloadEnabled() const -> bool {
+        return m_hotReload.load(std::memory_order_relaxed);
+    }
+    [[nodiscard]] auto getHotReloadCount() const -> size_t {
+        return m_hotReloadCount.load(std::memory_order_relaxed);
+    }
+    [[nodiscard]] auto getWatchedFileCount() -> size_t {
+        std::lock_guard<std::mutex> lock(m_hotReloadMutex);
+        return m_fileWatcher.getWatchedCount();
     }
 
    private:
     std::filesystem::path m_resourceRoot;
-    std::unordered_map<std::type_index, std::unordered_map<std::string, std::shared_ptr<IResource>>> m_resources;
+
+    // indexed by resourceTypeId<T>(), a storage is created on first use and never removed
+    std::array<std::atomic<IResourceStorage*>, MAX_RESOURCE_TYPES> m_storages{};
+    std::vector<std::unique_ptr<IResourceStorage>> m_ownedStorages;
+    std::mutex m_storageMutex;
 
     std::shared_ptr<ThreadManager> m_threadManager;
-    std::mutex m_resourceMutex;
+
+    // getOrCreateAsync loads in flight, with the groups waiting on each
+    std::unordered_map<std::string, std::vector<std::shared_ptr<WaitGroup>>> m_pendingLoads;
+    std::mutex m_pendingLoadsMutex;
+
+    template <typename T>
+    static auto pendingLoadKey(const std::string& name) -> std::string {
+        return std::to_string(resourceTypeId<T>()) + "/" + name;
+    }
+    // joinPendingLoad runs under m_pendingLoadsMutex, finishPendingLoad takes it itself
+    auto joinPendingLoad(const std::string& key, const std::shared_ptr<WaitGroup>& group) -> void;
+    auto finishPendingLoad(const std::string& key) -> void;
 
     std::shared_ptr<MeshLoader> m_meshLoader;
     std::unique_ptr<ModelLoader> m_modelLoader;
+    TextureCache m_textureCache;
+    ContentRegistry<Texture> m_textureRegistry;
+    ContentRegistry<Mesh> m_meshRegistry;
+    std::unique_ptr<TextureStreamer> m_textureStreamer;
+    std::shared_ptr<UploadRing> m_uploadRing;  // staged blocks keep it alive too
+    std::unique_ptr<UploadThread> m_uploadThread;  // started on first use, lives until shutdown
+    std::atomic<UploadMode> m_uploadMode{UploadMode::MainThread};
+
+    // runs done(finalized) on the main thread once resource is ready to draw, finalized on the
+    // main thread or on the upload thread depending on the mode
+    auto finalizeAsync(const std::shared_ptr<IResource>& resource,
+                       const std::string& name,
+                       std::function<void(bool)> done) -> void;
+    // staging is copied on the main context, the upload thread uploads straight from memory
+    [[nodiscard]] auto getStagingRing() const -> UploadRing* {
+        return getUploadMode() == UploadMode::MainThread ? m_uploadRing.get() : nullptr;
+    }
 
     ma_engine m_audioEngine;
+
+    // watched file -> reloads of what was loaded from it, each returns false once its resource is gone
+    FileWatcher m_fileWatcher;
+    std::unordered_map<std::string, std::vector<std::function<bool()>>> m_hotReloads;
+    std::mutex m_hotReloadMutex;
+    std::atomic<bool> m_hotReload{true};
+    std::atomic<size_t> m_hotReloadCount{0};
+
+    template <typename T>
+    auto watchForHotReload(const std::shared_ptr<T>& resource) -> void {
+        if constexpr (std::is_same_v<T, Shader> || std::is_same_v<T, Script> || std::is_same_v<T, Texture>) {
+            watchFile(resource);
+        }
+    }
+    auto watchFile(const std::shared_ptr<Shader>& shader) -> void;
+    auto watchFile(const std::shared_ptr<Script>& script) -> void;
+    auto watchFile(const std::shared_ptr<Texture>& texture) -> void;
+    auto addHotReload(const std::filesystem::path& path, std::function<bool()> reload) -> void;
+    auto pollHotReload() -> void;
+    auto reloadShader(const std::shared_ptr<Shader>& shader) -> void;
+    auto reloadScript(const std::shared_ptr<Script>& script) -> void;
+    auto reloadTexture(const std::shared_ptr<Texture>& texture) -> void;
+
+    static constexpr uint64_t TRIM_INTERVAL = 30;
+    std::atomic<uint64_t> m_frame{1};
+    uint32_t m_graceFrames = 300;
+    std::vector<std::function<void(ResourceManager&)>> m_referenceSources;
+    std::array<std::atomic<uint64_t>, MAX_RESOURCE_TYPES> m_budgets{};
+    std::array<std::atomic<Residency>, MAX_RESOURCE_TYPES> m_residencies{};
+    std::array<size_t, MAX_RESOURCE_TYPES> m_evictedCounts{};
+    std::vector<ResourceUsage> m_usage;
+
+    static auto nextResourceTypeId() -> uint32_t {
+        static std::atomic<uint32_t> nextId{0};
+        return nextId.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    template <typename T>
+    static auto resourceTypeId() -> uint32_t {
+        static const uint32_t id = nextResourceTypeId();
+        return id;
+    }
+
+    template <typename T>
+    static auto resourceTypeName() -> std::string {
+        if constexpr (std::is_same_v<T, Texture>) {
+            return "Texture";
+        } else if constexpr (std::is_same_v<T, Mesh>) {
+            return "Mesh";
+        } else if constexpr (std::is_same_v<T, Model>) {
+            return "Model";
+        } else if constexpr (std::is_same_v<T, Shader>) {
+            return "Shader";
+        } else if constexpr (std::is_same_v<T, Sound>) {
+            return "Sound";
+        } else if constexpr (std::is_same_v<T, Script>) {
+            return "Script";
+        } else {
+            return typeid(T).name();
+        }
+    }
+
+    template <typename T>
+    auto storage() -> ResourceStorage<T>& {
+        uint32_t typeId = resourceTypeId<T>();
+        assert(typeId < MAX_RESOURCE_TYPES && "Too many resource types, raise MAX_RESOURCE_TYPES");
+
+        if (auto* existing = m_storages[typeId].load(std::memory_order_acquire)) {
+            return *static_cast<ResourceStorage<T>*>(existing);
+        }
+
+        std::lock_guard<std::mutex> lock(m_storageMutex);
+        if (auto* existing = m_storages[typeId].load(std::memory_order_relaxed)) {
+            return *static_cast<ResourceStorage<T>*>(existing);
+        }
+        auto created = std::make_unique<ResourceStorage<T>>(resourceTypeName<T>());
+        created->setFrame(m_frame.load(std::memory_order_relaxed));
+        auto* rawStorage = created.get();
+        m_ownedStorages.push_back(std::move(created));
+        m_storages[typeId].store(rawStorage, std::memory_order_release);
+        return *rawStorage;
+    }
 };
 
 }  // namespace Vengine
\ No newline at end of file
@@ -0,0 +1,366 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "vengine/core/i_resource.hpp"
+#include "vengine/core/resource_handle.hpp"
+
+namespace Vengine {
+
+// one resource as the eviction pass sees it
+struct ResourceStorageEntry {
+    std::string name;
+    std::shared_ptr<IResource> resource;
+    uint64_t lastUsedFrame = 0;
+    bool referenced = false;  // someone besides the storage holds a shared_ptr, or marked its handle
+};
+
+// type erased part, for the few places that go over every resource type
+class IResourceStorage {
+   public:
+    virtual ~IResourceStorage() = default;
+
+    [[nodiscard]] virtual auto getTypeName() const -> const std::string& = 0;
+    // stamped into a slot whenever get() resolves it, also frees what was retired RETIRE_FRAMES ago
+    virtual auto setFrame(uint64_t frame) -> void = 0;
+    [[nodiscard]] virtual auto getEntries() const -> std::vector<ResourceStorageEntry> = 0;
+    virtual auto releaseResource(const std::string& name) -> std::shared_ptr<IResource> = 0;
+
+    [[nodiscard]] virtual auto contains(const std::string& name) const -> bool = 0;
+    [[nodiscard]] virtual auto getLoadedCount() const -> size_t = 0;
+    virtual auto forEach(const std::function<void(const std::string&, const std::shared_ptr<IResource>&)>& func) const
+        -> void = 0;
+};
+
+// dense per type array of resources. slots live in fixed size chunks that never move, so a
+// reader only needs the chunk pointer, the slot generation and an atomic load of a raw pointer,
+// no lock and no refcount. the owning shared_ptr, names, the free list and chunk allocation are
+// writer side and sit behind m_mutex. a resource that gets replaced or released is retired, the
+// storage keeps its shared_ptr for RETIRE_FRAMES more frames so a pointer from get() stays valid
+// for the rest of the frame it was resolved in.
+template <typename T>
+class ResourceStorage : public IResourceStorage {
+   public:
+    static constexpr uint32_t CHUNK_SIZE = 256;
+    static constexpr uint32_t MAX_CHUNKS = 1024;
+    static constexpr uint64_t RETIRE_FRAMES = 2;
+
+    explicit ResourceStorage(std::string typeName = "") : m_typeName(std::move(typeName)) {
+    }
+    ResourceStorage(const ResourceStorage&) = delete;
+    auto operator=(const ResourceStorage&) -> ResourceStorage& = delete;
+
+    // handle for name, the slot is reserved if the name is new. the slot stays empty until publish()
+    auto acquire(const std::string& name) -> Handle<T> {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+
+        if (auto it = m_nameToIndex.find(name); it != m_nameToIndex.end()) {
+            return makeHandle(it->second);
+        }
+
+        uint32_t index = 0;
+        if (!m_freeSlots.empty()) {
+            index = m_freeSlots.back();
+            m_freeSlots.pop_back();
+        } else {
+            index = m_slotCount;
+            uint32_t chunkIndex = index / CHUNK_SIZE;
+            if (chunkIndex >= MAX_CHUNKS) {
+                return {};
+            }
+            if (m_chunks[chunkIndex].load(std::memory_order_relaxed) == nullptr) {
+                m_ownedChunks.push_back(std::make_unique<Chunk>());
+                m_chunks[chunkIndex].store(m_ownedChunks.back().get(), std::memory_order_release);
+            }
+            ++m_slotCount;
+        }
+
+        m_nameToIndex[name] = index;
+        slotAt(index).name = name;
+        return makeHandle(index);
+    }
+
+    // makes the resource visible to readers, replaces whatever was in the slot before
+    auto publish(Handle<T> handle, std::shared_ptr<T> resource) -> bool {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        Slot* slot = findSlot(handle);
+        if (!slot) {
+            return false;
+        }
+
+        bool wasEmpty = slot->owner == nullptr;
+        slot->resource.store(resource.get(), std::memory_order_release);
+        auto previous = std::exchange(slot->owner, std::move(resource));
+        if (previous != slot->owner) {
+            retire(std::move(previous));
+        }
+        slot->lastUsed.store(m_frame.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        if (wasEmpty) {
+            m_loadedCount.fetch_add(1, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    // publish unless someone got there first, returns whatever ends up in the slot
+    // (nullptr for a stale handle). lets concurrent loaders agree on a single object per name
+    auto publishIfEmpty(Handle<T> handle, std::shared_ptr<T> resource) -> std::shared_ptr<T> {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        Slot* slot = findSlot(handle);
+        if (!slot) {
+            return nullptr;
+        }
+
+        if (slot->owner) {
+            return slot->owner;
+        }
+        slot->owner = resource;
+        slot->resource.store(resource.get(), std::memory_order_release);
+        slot->lastUsed.store(m_frame.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        m_loadedCount.fetch_add(1, std::memory_order_relaxed);
+        return resource;
+    }
+
+    // frees the slot, outstanding handles resolve to nullptr afterwards. the resource itself
+    // lives on as long as someone still holds a shared_ptr to it, and at least RETIRE_FRAMES
+    auto release(const std::string& name) -> std::shared_ptr<T> {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        auto it = m_nameToIndex.find(name);
+        if (it == m_nameToIndex.end()) {
+            return nullptr;
+        }
+
+        return releaseSlot(it);
+    }
+
+    // gives up a slot acquire() reserved for a load that failed. a slot that got a resource in
+    // the meantime (an earlier load of the same name, another loader) stays
+    auto releaseIfEmpty(Handle<T> handle) -> bool {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        Slot* slot = findSlot(handle);
+        if (!slot || slot->owner) {
+            return false;
+        }
+        releaseSlot(m_nameToIndex.find(slot->name));
+        return true;
+    }
+
+    // frees the slot if it still holds resource, for an object published before its load ran
+    // (getOrCreateAsync) that then failed. whatever replaced it in the meantime stays
+    auto releaseIfHolds(Handle<T> handle, const T* resource) -> bool {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        Slot* slot = findSlot(handle);
+        if (!slot || slot->owner.get() != resource) {
+            return false;
+        }
+        releaseSlot(m_nameToIndex.find(slot->name));
+        return true;
+    }
+
+    // lock free, safe from any thread. marks the slot as used this frame. the pointer is good for
+    // the frame it was resolved in, use lock() to hold on to the resource for longer
+    [[nodiscard]] auto get(Handle<T> handle) const -> T* {
+        const Slot* slot = findSlot(handle);
+        auto resource = resolve(slot, handle);
+        if (!resource) {
+            return nullptr;
+        }
+        // only write when it changes, the renderer resolves the same handles every frame
+        auto frame = m_frame.load(std::memory_order_relaxed);
+        if (slot->lastUsed.load(std::memory_order_relaxed) != frame) {
+            slot->lastUsed.store(frame, std::memory_order_relaxed);
+        }
+        return resource;
+    }
+
+    // counts as referenced in getEntries() for the rest of the frame, for holders that only keep
+    // a handle. main thread, right before the entries are read
+    auto markReferenced(Handle<T> handle) const -> void {
+        if (const Slot* slot = findSlot(handle)) {
+            slot->markedFrame.store(m_frame.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+    }
+
+    // the owning pointer, takes the lock. for load and bind time, not for every frame
+    [[nodiscard]] auto lock(Handle<T> handle) const -> std::shared_ptr<T> {
+        std::shared_lock<std::shared_mutex> readLock(m_mutex);
+        const Slot* slot = findSlot(handle);
+        return slot ? slot->owner : nullptr;
+    }
+
+    // string lookups, meant for load and bind time only
+    [[nodiscard]] auto find(const std::string& name) const -> Handle<T> {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        auto it = m_nameToIndex.find(name);
+        if (it == m_nameToIndex.end()) {
+            return {};
+        }
+        return makeHandle(it->second);
+    }
+
+    [[nodiscard]] auto contains(const std::string& name) const -> bool override {
+        auto handle = find(name);
+        return resolve(findSlot(handle), handle) != nullptr;
+    }
+
+    [[nodiscard]] auto getLoadedCount() const -> size_t override {
+        return m_loadedCount.load(std::memory_order_relaxed);
+    }
+
+    auto forEach(const std::function<void(const std::string&, const std::shared_ptr<IResource>&)>& func) const
+        -> void override {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        for (const auto& [name, index] : m_nameToIndex) {
+            if (const auto& resource = slotAt(index).owner) {
+                func(name, resource);
+            }
+        }
+    }
+
+    [[nodiscard]] auto getTypeName() const -> const std::string& override {
+        return m_typeName;
+    }
+
+    auto setFrame(uint64_t frame) -> void override {
+        m_frame.store(frame, std::memory_order_relaxed);
+        if (m_retiredCount.load(std::memory_order_relaxed) == 0) {
+            return;
+        }
+
+        // dropped outside the lock, the last reference may unload the resource
+        std::vector<std::shared_ptr<T>> expired;
+        {
+            std::unique_lock<std::shared_mutex> lock(m_mutex);
+            auto it = m_retired.begin();
+            while (it != m_retired.end() && it->first + RETIRE_FRAMES <= frame) {
+                expired.push_back(std::move(it->second));
+                ++it;
+            }
+            m_retired.erase(m_retired.begin(), it);
+            m_retiredCount.store(m_retired.size(), std::memory_order_relaxed);
+        }
+    }
+
+    [[nodiscard]] auto getEntries() const -> std::vector<ResourceStorageEntry> override {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        std::vector<ResourceStorageEntry> entries;
+        entries.reserve(m_nameToIndex.size());
+        for (const auto& [name, index] : m_nameToIndex) {
+            const Slot& slot = slotAt(index);
+            auto resource = slot.owner;
+            if (!resource) {
+                continue;
+            }
+            // one count is the slot, one is the copy we just made
+            bool referenced = resource.use_count() > 2 ||
+                              slot.markedFrame.load(std::memory_order_relaxed) == m_frame.load(std::memory_order_relaxed);
+            entries.push_back({name, std::move(resource), slot.lastUsed.load(std::memory_order_relaxed), referenced});
+        }
+        return entries;
+    }
+
+    auto releaseResource(const std::string& name) -> std::shared_ptr<IResource> override {
+        return release(name);
+    }
+
+   private:
+    struct Slot {
+        std::atomic<uint32_t> generation{1};  // starts at 1 so a default handle never matches
+        std::atomic<T*> resource{nullptr};
+        mutable std::atomic<uint64_t> lastUsed{0};
+        mutable std::atomic<uint64_t> markedFrame{UINT64_MAX};
+        std::shared_ptr<T> owner;  // writer side only, what resource points at
+        std::string name;  // writer side only
+    };
+    static_assert(std::atomic<T*>::is_always_lock_free);
+
+    struct Chunk {
+        std::array<Slot, CHUNK_SIZE> slots;
+    };
+
+    static auto resolve(const Slot* slot, Handle<T> handle) -> T* {
+        if (!slot) {
+            return nullptr;
+        }
+        auto resource = slot->resource.load(std::memory_order_acquire);
+        if (slot->generation.load(std::memory_order_acquire) != handle.generation) {
+            return nullptr;
+        }
+        return resource;
+    }
+
+    // under m_mutex
+    auto releaseSlot(typename std::unordered_map<std::string, uint32_t>::iterator it) -> std::shared_ptr<T> {
+        uint32_t index = it->second;
+        Slot& slot = slotAt(index);
+        // bump first, a reader that saw the old generation re-checks it after loading the pointer
+        slot.generation.fetch_add(1, std::memory_order_acq_rel);
+        slot.resource.store(nullptr, std::memory_order_release);
+        slot.markedFrame.store(UINT64_MAX, std::memory_order_relaxed);
+        auto resource = std::move(slot.owner);
+        if (resource) {
+            m_loadedCount.fetch_sub(1, std::memory_order_relaxed);
+            retire(resource);
+        }
+        slot.name.clear();
+
+        m_nameToIndex.erase(it);
+        m_freeSlots.push_back(index);
+        return resource;
+    }
+
+    // under m_mutex. kept until the frame is RETIRE_FRAMES further, readers may still use it
+    auto retire(std::shared_ptr<T> resource) -> void {
+        if (!resource) {
+            return;
+        }
+        m_retired.emplace_back(m_frame.load(std::memory_order_relaxed), std::move(resource));
+        m_retiredCount.store(m_retired.size(), std::memory_order_relaxed);
+    }
+
+    auto makeHandle(uint32_t index) const -> Handle<T> {
+        return Handle<T>{index, slotAt(index).generation.load(std::memory_order_relaxed)};
+    }
+
+    auto slotAt(uint32_t index) const -> Slot& {
+        return m_chunks[index / CHUNK_SIZE].load(std::memory_order_acquire)->slots[index % CHUNK_SIZE];
+    }
+
+    auto findSlot(Handle<T> handle) const -> Slot* {
+        if (!handle.isValid() || handle.index / CHUNK_SIZE >= MAX_CHUNKS) {
+            return nullptr;
+        }
+        Chunk* chunk = m_chunks[handle.index / CHUNK_SIZE].load(std::memory_order_acquire);
+        if (!chunk) {
+            return nullptr;
+        }
+        Slot& slot = chunk->slots[handle.index % CHUNK_SIZE];
+        if (slot.generation.load(std::memory_order_acquire) != handle.generation) {
+            return nullptr;
+        }
+        return &slot;
+    }
+
+    std::array<std::atomic<Chunk*>, MAX_CHUNKS> m_chunks{};
+    std::atomic<size_t> m_loadedCount{0};
+    std::atomic<uint64_t> m_frame{0};
+    std::string m_typeName;
+
+    mutable std::shared_mutex m_mutex;
+    std::vector<std::unique_ptr<Chunk>> m_ownedChunks;
+    std::unordered_map<std::string, uint32_t> m_nameToIndex;
+    std::vector<uint32_t> m_freeSlots;
+    uint32_t m_slotCount = 0;
+    std::vector<std::pair<uint64_t, std::shared_ptr<T>>> m_retired;  // frame retired in, oldest first
+    std::atomic<size_t> m_retiredCount{0};
+};
+
+}  // namespace Vengine
@@ -1,6 +1,12 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <optional>
 #include <string>
+#include <utility>
 #include <filesystem>
 #include <fstream>
 #include <spdlog/spdlog.h>
@@ -11,11 +17,17 @@
 #include <miniaudio.h>
 #include <stb_image.h>
 #include "i_resource.hpp"
+#include "vengine/core/content_registry.hpp"
+#include "vengine/core/texture_cache.hpp"
+#include "vengine/renderer/upload_ring.hpp"
+#include "vengine/utils/file_stamp.hpp"
+#include "vengine/utils/hash.hpp"
+#include "vengine/utils/vfs.hpp"
 // #include "mesh.hpp" // creates circular includes..
 
 namespace Vengine {
 
-class Texture : public IResource {
+class Texture : public IResource, public std::enable_shared_from_this<Texture> {
    public:
     struct RawImageData {
         unsigned char* pixels = nullptr;
@@ -24,55 +36,185 @@ class Texture : public IResource {
         int channels = 0;
     };
 
+    // the texture cache is used when set, the ResourceManager does that like the audio engine for sounds
+    auto setCache(TextureCache* cache) -> void {
+        m_cache = cache;
+    }
+
+    // uploads are staged through the ring when set, ResourceManager sets this too
+    auto setUploadRing(UploadRing* ring) -> void {
+        m_uploadRing = ring;
+    }
+
+    // textures with the same content share one gpu texture, ResourceManager sets this too
+    auto setContentRegistry(ContentRegistry<Texture>* registry) -> void {
+        m_registry = registry;
+    }
+
+    // worker side, before decoding. true if a texture with the same content (and streaming mode)
+    // is loaded already, this one then forwards to it and has nothing to upload itself.
+    // otherwise this one is registered for the content once its decode succeeded
+    auto deduplicate(uint64_t contentHash) -> bool {
+        if (!m_registry) {
+            return false;
+        }
+        m_contentKey = hash64(&contentHash, sizeof(contentHash), m_streamingTailSize);
+        auto original = m_registry->find(*m_contentKey);
+        if (!original || original.get() == this) {
+            return false;
+        }
+        spdlog::debug("Texture {} has the same content as {}, sharing it", m_name, original->getName());
+        m_original = std::move(original);
+        m_needsMainThreadInit = false;
+        m_isLoaded = true;
+        return true;
+    }
+
+    [[nodiscard]] auto getOriginal() const -> const std::shared_ptr<Texture>& {
+        return m_original;
+    }
+    [[nodiscard]] auto getDuplicateOf() const -> const IResource* override {
+        return m_isReplaced ? nullptr : m_original.get();
+    }
+
+    // hot reload, main thread, replacement is loaded and finalized. this one drops its own data
+    // and forwards to replacement from now on, so materials keep the pointer they have.
+    // textures that were sharing this one's content follow along, the ResourceManager reloads
+    // those from their own files right after
+    auto replaceWith(std::shared_ptr<Texture> replacement) -> void {
+        unload();
+        m_streamable = false;
+        m_levels.clear();
+        m_original = std::move(replacement);
+        m_isReplaced = true;
+        m_isLoaded = true;
+    }
+
+    // the file it was loaded from, empty for textures made from memory
+    [[nodiscard]] auto getSourcePath() const -> const std::filesystem::path& {
+        return m_sourcePath;
+    }
+    [[nodiscard]] auto getStreamingTailSize() const -> uint32_t {
+        return m_streamingTailSize;
+    }
+
+    // streamed textures only get the levels up to tailSize texels on load, the TextureStreamer
+    // brings in the rest when they are on screen. needs the cache, 0 keeps every level resident
+    auto setStreaming(uint32_t tailSize) -> void {
+        m_streamingTailSize = tailSize;
+    }
+
     auto load(const std::string& fileName) -> bool override {
-        auto folder = std::filesystem::path("resources/textures");
-        auto fullPath = folder / fileName;
+        // names are relative to resources/textures, model textures come with their full path
+        auto fullPath = std::filesystem::path(fileName);
+        if (!Vfs::exists(fullPath)) {
+            fullPath = std::filesystem::path("resources/textures") / fileName;
+        }
+
+        if (m_name.empty()) {
+            m_name = fileName;
+        }
+        m_sourcePath = fullPath;
+
+        // the raw file bytes, the same image under another name or path decodes only once
+        if (FileStamp stamp; m_registry && readFileStamp(fullPath, stamp) && deduplicate(stamp.hash)) {
+            return true;
+        }
+
+        // a cached .vtex already has every mip level, nothing to decode or generate
+        auto imageData = std::make_shared<TextureData>();
+        if (m_cache && m_cache->load(fullPath, *imageData, m_streamingTailSize)) {
+            m_streamable = m_streamingTailSize > 0;
+            setImageData(std::move(imageData));
+            stageUpload();
+            return true;
+        }
 
         if (!m_rawData) {
             m_rawData = std::make_shared<RawImageData>();
         }
 
-        m_rawData->pixels =
-            stbi_load(fullPath.string().c_str(), &m_rawData->width, &m_rawData->height, &m_rawData->channels, 0);
+        auto file = Vfs::open(fullPath);
+        if (file.isOpen()) {
+            m_rawData->pixels = stbi_load_from_memory(file.data(),
+                                                      static_cast<int>(file.size()),
+                                                      &m_rawData->width,
+                                                      &m_rawData->height,
+                                                      &m_rawData->channels,
+                                                      0);
+        }
 
         if (!m_rawData->pixels) {
             spdlog::error("Failed to load texture from file: {}", fullPath.string());
             return false;
         }
 
+        if (m_cache) {
+            // build the chain here on the worker instead of glGenerateMipmap on the main thread
+            *imageData = buildTexture(m_rawData->pixels,
+                                      static_cast<uint32_t>(m_rawData->width),
+                                      static_cast<uint32_t>(m_rawData->height),
+                                      m_rawData->channels,
+                                      m_cache->getImportCompression());
+            // the streamer reads the big levels back from the cache, so only stream what got stored
+            bool stored = m_cache->store(fullPath, *imageData);
+            if (m_streamingTailSize > 0 && stored) {
+                m_streamable = true;
+                dropLevels(*imageData, getLevelForSize(*imageData, m_streamingTailSize));
+            }
+            stbi_image_free(m_rawData->pixels);
+            m_rawData.reset();
+            setImageData(std::move(imageData));
+            stageUpload();
+            return true;
+        }
+
         m_width = m_rawData->width;
         m_height = m_rawData->height;
+        m_channels = m_rawData->channels;
         m_needsMainThreadInit = true;
         m_isLoaded = true;
+        stageUpload();
+        registerContent();
         // spdlog::info("Loaded texture data from: {}", fullPath.string());
 
         return true;
     }
 
-    auto setRawData(unsigned char* data, int width, int height, int channels) -> void {
-        // Create the RawImageData struct if it doesn't exist
+    auto setImageData(std::shared_ptr<TextureData> imageData) -> void {
+        m_width = static_cast<int>(imageData->width);
+        m_height = static_cast<int>(imageData->height);
+        m_channels = imageData->format == TextureFormat::BC1 ? 3 : 4;
+        m_imageData = std::move(imageData);
+        m_needsMainThreadInit = true;
+        m_isLoaded = true;
+        registerContent();
+    }
+
+    // takes over pixels, malloc'd or from stb_image (unload() frees them with stbi_image_free).
+    // no copy, the caller must not touch or free them afterwards
+    auto adoptRawData(unsigned char* pixels, int width, int height, int channels) -> void {
+        if (m_rawData && m_rawData->pixels) {
+            stbi_image_free(m_rawData->pixels);
+        }
         if (!m_rawData) {
             m_rawData = std::make_shared<RawImageData>();
         }
 
-        // Make a copy of the data
-        size_t dataSize = width * height * channels;
-        unsigned char* dataCopy = new unsigned char[dataSize];
-        std::memcpy(dataCopy, data, dataSize);
-
-        // Store in the RawImageData struct
-        m_rawData->pixels = dataCopy;
+        m_imageData.reset();
+        m_rawData->pixels = pixels;
         m_rawData->width = width;
         m_rawData->height = height;
         m_rawData->channels = channels;
 
-        // Also update the member variables
         m_width = width;
         m_height = height;
         m_channels = channels;
 
         m_needsMainThreadInit = true;
         m_isLoaded = true;
+        stageUpload();
+        registerContent();
     }
 
     auto setName(const std::string& name) -> void {
@@ -81,38 +223,44 @@ class Texture : public IResource {
 
     // send data to gpu
     auto finalizeOnMainThread() -> bool override {
-        if (!m_needsMainThreadInit || !m_rawData) {
+        if (!m_needsMainThreadInit || (!m_rawData && !m_imageData)) {
             return false;
         }
 
+        if (m_streamable && m_imageData) {
+            uploadStreamedTail();
+            m_needsMainThreadInit = false;
+            return true;
+        }
+
         if (m_id == 0) {
             glGenTextures(1, &m_id);
         }
 
-        glBindTexture(GL_TEXTURE_2D, m_id);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        GLenum format = (m_rawData->channels == 4) ? GL_RGBA : GL_RGB;
-        glTexImage2D(GL_TEXTURE_2D,
-                     0,
-                     format,
-                     m_rawData->width,
-                     m_rawData->height,
-                     0,
-                     format,
-                     GL_UNSIGNED_BYTE,
-                     m_rawData->pixels);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        // TODO reactivate i guess. for now the skybox needs the data on reload the scene
-        // free memory after upload
-        // stbi_image_free(m_rawData->pixels);
-        // m_rawData.reset();
+        uploadTexture(m_id);
+        releaseCpuCopy();
+        m_needsMainThreadInit = false;
+        return true;
+    }
 
+    // the shared context only ever fills a texture nobody draws with yet, finishUpload swaps it in
+    [[nodiscard]] auto supportsSharedUpload() const -> bool override {
+        return !m_streamable && !m_staging && (m_rawData || m_imageData);
+    }
+    auto uploadShared() -> bool override {
+        if (!m_needsMainThreadInit || (!m_rawData && !m_imageData)) {
+            return false;
+        }
+        glGenTextures(1, &m_sharedId);
+        uploadTexture(m_sharedId);
+        return true;
+    }
+    auto finishUpload() -> bool override {
+        if (m_id != 0) {
+            glDeleteTextures(1, &m_id);
+        }
+        m_id = std::exchange(m_sharedId, 0);
+        releaseCpuCopy();
         m_needsMainThreadInit = false;
         return true;
     }
@@ -121,49 +269,409 @@ class Texture : public IResource {
         if (!m_isLoaded) {
             return false;
         }
-        glDeleteTextures(1, &m_id);
+        if (m_id != 0) {
+            glDeleteTextures(1, &m_id);
+        }
         m_id = 0;
+        // a reloaded version goes with it unless something else shares it by now
+        if (m_isReplaced && m_original.use_count() == 1) {
+            m_original->unload();
+        }
+        m_original.reset();
+        m_isReplaced = false;
+        if (m_rawData && m_rawData->pixels) {
+            stbi_image_free(m_rawData->pixels);
+        }
+        m_rawData.reset();
+        m_imageData.reset();
+        m_staging.reset();
+        m_gpuBytes = 0;
         m_isLoaded = false;
 
         return true;
     }
 
+    // upload plus mipmap generation, assumes roughly 1 GB/s. staged uploads only record a copy
+    [[nodiscard]] auto getFinalizeCostHint() const -> uint32_t override {
+        if (m_staging) {
+            return m_imageData ? 20 : 200;
+        }
+        if (m_imageData) {
+            return static_cast<uint32_t>(m_imageData->bytes.size() / 1000);
+        }
+        if (m_streamable) {
+            return 0;
+        }
+        if (!m_rawData) {
+            return 0;
+        }
+        auto bytes = static_cast<uint64_t>(m_rawData->width) * m_rawData->height * m_rawData->channels;
+        return static_cast<uint32_t>(bytes * 4 / 3 / 1000);
+    }
+
+    [[nodiscard]] auto getMemoryUsage() const -> ResourceMemory override {
+        if (m_isReplaced) {
+            return m_original->getMemoryUsage();
+        }
+        ResourceMemory memory;
+        if (m_rawData && m_rawData->pixels) {
+            memory.cpuBytes += static_cast<uint64_t>(m_rawData->width) * m_rawData->height * m_rawData->channels;
+        }
+        if (m_imageData) {
+            memory.cpuBytes += m_imageData->bytes.size();
+        }
+        if (m_id == 0) {
+            return memory;
+        }
+        memory.gpuBytes = m_streamable ? getResidentBytes(m_residentLevel) : m_gpuBytes;
+        return memory;
+    }
+
+    // duplicates answer with the original's data from here on
     [[nodiscard]] auto getTextureID() const -> GLuint {
-        return m_id;
+        return m_original ? m_original->getTextureID() : m_id;
     }
 
     [[nodiscard]] auto getRawData() const -> std::shared_ptr<RawImageData> {
-        return m_rawData;
+        return m_original ? m_original->getRawData() : m_rawData;
+    }
+
+    // set for textures that came through the texture cache, getRawData() is empty for those
+    [[nodiscard]] auto getImageData() const -> std::shared_ptr<TextureData> {
+        return m_original ? m_original->getImageData() : m_imageData;
     }
 
     [[nodiscard]] auto getPixels() const -> unsigned char* {
-        return m_rawData ? m_rawData->pixels : nullptr;
+        auto rawData = getRawData();
+        return rawData ? rawData->pixels : nullptr;
     }
 
     [[nodiscard]] auto getFormat() const -> GLenum {
-        return (m_channels == 4) ? GL_RGBA : GL_RGB;
+        return (getChannels() == 4) ? GL_RGBA : GL_RGB;
     }
 
     [[nodiscard]] auto getChannels() const -> int {
-        return m_channels;
+        return m_original ? m_original->getChannels() : m_channels;
     }
 
     [[nodiscard]] auto getWidth() const -> int {
-        return m_width;
+        return m_original ? m_original->getWidth() : m_width;
     }
 
     [[nodiscard]] auto getHeight() const -> int {
-        return m_height;
+        return m_original ? m_original->getHeight() : m_height;
+    }
+
+    [[nodiscard]] auto getName() const -> const std::string& {
+        return m_name;
+    }
+
+    // unique for the whole run, unlike the address a freed texture leaves behind
+    [[nodiscard]] auto getSerial() const -> uint64_t {
+        return m_serial;
+    }
+
+    [[nodiscard]] auto isStreamable() const -> bool {
+        return m_streamable;
+    }
+
+    // streaming state, valid once a streamed texture is on the gpu. levels below the resident
+    // level are not allocated at all
+    [[nodiscard]] auto getLevelCount() const -> uint32_t {
+        return static_cast<uint32_t>(m_levels.size());
+    }
+    [[nodiscard]] auto getResidentLevel() const -> uint32_t {
+        return m_residentLevel;
+    }
+    // the level it was loaded with, eviction never goes coarser than that
+    [[nodiscard]] auto getTailLevel() const -> uint32_t {
+        return m_tailLevel;
+    }
+    [[nodiscard]] auto getLevelSize(uint32_t level) const -> uint32_t {
+        return std::max(m_levels[level].width, m_levels[level].height);
+    }
+    // gpu memory of levels [level, count)
+    [[nodiscard]] auto getResidentBytes(uint32_t level) const -> uint64_t {
+        uint64_t bytes = 0;
+        for (auto i = level; i < m_levels.size(); ++i) {
+            bytes += getMipByteSize(m_gpuFormat, m_levels[i].width, m_levels[i].height);
+        }
+        return bytes;
+    }
+
+    // worker side of streaming, levels [firstLevel, endLevel) from the .vtex
+    auto loadLevels(uint32_t firstLevel, uint32_t endLevel, TextureData& out) const -> bool {
+        return m_cache && m_streamable && m_cache->loadLevels(m_sourcePath, firstLevel, endLevel, out);
+    }
+
+    // main thread. reallocates the texture with levels [level, count): levels that are already
+    // resident are copied over on the gpu, the missing ones come from data. dropping levels only
+    // copies, so evicting actually gives the memory back instead of just clamping BASE_LEVEL
+    auto setResidentLevel(uint32_t level, const TextureData* data) -> bool {
+        auto count = getLevelCount();
+        uint32_t oldLevel = m_id != 0 ? m_residentLevel : count;
+        if (level >= count || level == oldLevel) {
+            return false;
+        }
+        if (level < oldLevel && (!data || data->firstLevel > level || data->mips.size() != count)) {
+            return false;
+        }
+
+        std::optional<TextureData> decoded;
+        if (level < oldLevel && data->format != m_gpuFormat) {
+            decoded = decompressTexture(*data);
+            data = &*decoded;
+        }
+
+        GLuint id = 0;
+        glCreateTextures(GL_TEXTURE_2D, 1, &id);
+        glTextureStorage2D(id, static_cast<GLsizei>(count - level), getInternalFormat(m_gpuFormat),
+                           static_cast<GLsizei>(m_levels[level].width), static_cast<GLsizei>(m_levels[level].height));
+        glTextureParameteri(id, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTextureParameteri(id, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTextureParameteri(id, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTextureParameteri(id, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+        for (auto i = std::max(level, oldLevel); i < count; ++i) {
+            glCopyImageSubData(m_id, GL_TEXTURE_2D, static_cast<GLint>(i - oldLevel), 0, 0, 0, id, GL_TEXTURE_2D,
+                               static_cast<GLint>(i - level), 0, 0, 0, static_cast<GLsizei>(m_levels[i].width),
+                               static_cast<GLsizei>(m_levels[i].height), 1);
+        }
+        for (auto i = level; i < oldLevel; ++i) {
+            const auto& mip = m_levels[i];
+            const auto* pixels = data->getMipData(i);
+            if (m_gpuFormat == TextureFormat::RGBA8) {
+                glTextureSubImage2D(id, static_cast<GLint>(i - level), 0, 0, static_cast<GLsizei>(mip.width),
+                                    static_cast<GLsizei>(mip.height), GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+            } else {
+                glCompressedTextureSubImage2D(id, static_cast<GLint>(i - level), 0, 0, static_cast<GLsizei>(mip.width),
+                                              static_cast<GLsizei>(mip.height), getInternalFormat(m_gpuFormat),
+                                              static_cast<GLsizei>(data->mips[i].size), pixels);
+            }
+        }
+
+        if (m_id != 0) {
+            glDeleteTextures(1, &m_id);
+        }
+        m_id = id;
+        m_residentLevel = level;
+        return true;
+    }
+
+    // s3tc is an extension even in 4.5 core, every desktop driver has it but check once anyway
+    static auto supportsS3tc() -> bool {
+        static const bool supported = []() {
+            GLint count = 0;
+            glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+            for (GLint i = 0; i < count; ++i) {
+                const auto* name = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+                if (name && std::strcmp(name, "GL_EXT_texture_compression_s3tc") == 0) {
+                    return true;
+                }
+            }
+            return false;
+        }();
+        return supported;
+    }
+
+    // internal format for glTexImage2D / glCompressedTexImage2D
+    static auto getInternalFormat(TextureFormat format) -> GLenum {
+        switch (format) {
+            case TextureFormat::BC1:
+                return COMPRESSED_RGB_S3TC_DXT1;
+            case TextureFormat::BC3:
+                return COMPRESSED_RGBA_S3TC_DXT5;
+            default:
+                return GL_RGBA8;
+        }
     }
 
    private:
+    static constexpr GLenum COMPRESSED_RGB_S3TC_DXT1 = 0x83F0;
+    static constexpr GLenum COMPRESSED_RGBA_S3TC_DXT5 = 0x83F3;
+
+    // only decoded textures are registered, a failed one never has anything forwarded to it.
+    // one that lost a race against a concurrent decode of the same content keeps its own data
+    auto registerContent() -> void {
+        if (m_registry && m_contentKey) {
+            m_registry->findOrAdd(*m_contentKey, shared_from_this());
+        }
+    }
+
+    // first upload of a streamed texture, just the tail levels. the cpu copy goes away after
+    auto uploadStreamedTail() -> void {
+        m_levels = m_imageData->mips;
+        m_gpuFormat = isBlockCompressed(m_imageData->format) && !supportsS3tc() ? TextureFormat::RGBA8
+                                                                                 : m_imageData->format;
+        m_tailLevel = m_imageData->firstLevel;
+        if (m_id != 0) {
+            glDeleteTextures(1, &m_id);
+            m_id = 0;
+        }
+        setResidentLevel(m_tailLevel, m_imageData.get());
+        m_imageData.reset();
+    }
+
+    // worker side, right after the data is in memory. copies what finalizeOnMainThread would
+    // upload into the staging ring, the main thread then only records a copy out of it. GpuOnly
+    // textures drop their cpu copy here already. nothing happens if the ring is full, the upload
+    // is direct then. streamed textures go through the streamer as before
+    auto stageUpload() -> void {
+        if (!m_uploadRing || m_streamable || m_residency == Residency::CpuOnly) {
+            return;
+        }
+        if (m_imageData) {
+            // those get decompressed on the main thread, the ring owner checked s3tc up front
+            if (isBlockCompressed(m_imageData->format) && !supportsS3tc()) {
+                return;
+            }
+            m_staging = m_uploadRing->allocate(m_imageData->bytes.size());
+            if (!m_staging) {
+                return;
+            }
+            std::memcpy(m_staging.data(), m_imageData->bytes.data(), m_imageData->bytes.size());
+            if (m_residency == Residency::GpuOnly) {
+                // the mip layout is still needed for the upload
+                m_imageData->bytes = {};
+            }
+            return;
+        }
+        if (m_rawData && m_rawData->pixels) {
+            auto bytes = static_cast<size_t>(m_rawData->width) * m_rawData->height * m_rawData->channels;
+            m_staging = m_uploadRing->allocate(bytes);
+            if (!m_staging) {
+                return;
+            }
+            std::memcpy(m_staging.data(), m_rawData->pixels, bytes);
+            if (m_residency == Residency::GpuOnly) {
+                stbi_image_free(m_rawData->pixels);
+                m_rawData->pixels = nullptr;
+            }
+        }
+    }
+
+    // everything but the streamed path, into id
+    auto uploadTexture(GLuint id) -> void {
+        glBindTexture(GL_TEXTURE_2D, id);
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+        if (m_imageData) {
+            uploadImageData();
+            return;
+        }
+
+        // staged pixels are read from the ring, the pointer is an offset into the bound unpack buffer
+        const void* pixels = m_rawData->pixels;
+        if (m_staging) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_staging.getBuffer());
+            pixels = reinterpret_cast<const void*>(m_staging.getOffset());
+        }
+        GLenum format = (m_rawData->channels == 4) ? GL_RGBA : GL_RGB;
+        glTexImage2D(GL_TEXTURE_2D,
+                     0,
+                     format,
+                     m_rawData->width,
+                     m_rawData->height,
+                     0,
+                     format,
+                     GL_UNSIGNED_BYTE,
+                     pixels);
+        if (m_staging) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            m_staging.reset();
+        }
+        glGenerateMipmap(GL_TEXTURE_2D);
+        // drivers pad rgb to rgba, plus a third for the mips
+        m_gpuBytes = static_cast<uint64_t>(m_width) * m_height * 4 * 4 / 3;
+    }
+
+    // after the upload, on the main thread (getMemoryUsage looks at the data from there)
+    auto releaseCpuCopy() -> void {
+        if (m_residency != Residency::GpuOnly) {
+            return;
+        }
+        // the skybox copies its faces on the gpu, nothing reads the pixels back
+        if (m_rawData && m_rawData->pixels) {
+            stbi_image_free(m_rawData->pixels);
+        }
+        m_rawData.reset();
+        m_imageData.reset();
+    }
+
+    // every level as stored, no glGenerateMipmap
+    auto uploadImageData() -> void {
+        // the cpu copy stays as it is, this can run on the upload thread
+        const TextureData* data = m_imageData.get();
+        std::optional<TextureData> decoded;
+        if (!m_staging && isBlockCompressed(data->format) && !supportsS3tc()) {
+            spdlog::warn("Texture {}: no s3tc support, decompressing on the cpu", m_name);
+            decoded = decompressTexture(*data);
+            data = &*decoded;
+        }
+        m_gpuBytes = m_staging ? m_staging.size() : data->bytes.size();
+
+        // staged levels are read from the ring, the pointers are offsets into the bound unpack buffer
+        if (m_staging) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_staging.getBuffer());
+        }
+        const auto& mips = data->mips;
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(mips.size()) - 1);
+        for (size_t level = 0; level < mips.size(); ++level) {
+            const auto& mip = mips[level];
+            auto offset = mip.offset - mips[data->firstLevel].offset;
+            const void* pixels = m_staging ? reinterpret_cast<const void*>(m_staging.getOffset() + offset)
+                                           : data->getMipData(level);
+            if (data->format == TextureFormat::RGBA8) {
+                glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), GL_RGBA8, static_cast<GLsizei>(mip.width),
+                             static_cast<GLsizei>(mip.height), 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+            } else {
+                glCompressedTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), getInternalFormat(data->format),
+                                       static_cast<GLsizei>(mip.width), static_cast<GLsizei>(mip.height), 0,
+                                       static_cast<GLsizei>(mip.size), pixels);
+            }
+        }
+        if (m_staging) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            m_staging.reset();
+        }
+    }
+
     GLuint m_id = 0;
     int m_width = 0;
     int m_height = 0;
     std::string m_name;
+    TextureCache* m_cache = nullptr;
+    ContentRegistry<Texture>* m_registry = nullptr;
+    std::optional<uint64_t> m_contentKey;  // set by deduplicate(), registered under once decoded
+    UploadRing* m_uploadRing = nullptr;
+    UploadBlock m_staging;  // filled on the worker, copied from and dropped in finalizeOnMainThread
+    GLuint m_sharedId = 0;  // filled on the upload thread, becomes m_id in finishUpload
+    std::shared_ptr<Texture> m_original;
+    bool m_isReplaced = false;  // m_original is a reloaded version, not a duplicate
+    std::shared_ptr<TextureData> m_imageData;
     std::shared_ptr<RawImageData> m_rawData;
+
+    uint64_t m_gpuBytes = 0;  // what the last upload allocated, streamed textures count their levels instead
+
+    uint32_t m_streamingTailSize = 0;
+    bool m_streamable = false;
+    std::filesystem::path m_sourcePath;
+    std::vector<TextureMip> m_levels;
+    TextureFormat m_gpuFormat = TextureFormat::RGBA8;
+    uint32_t m_residentLevel = 0;
+    uint32_t m_tailLevel = 0;
     std::shared_ptr<unsigned char> m_rawPixels = nullptr;
     int m_channels = 0;
+    uint64_t m_serial = nextSerial();
+
+    static auto nextSerial() -> uint64_t {
+        static std::atomic<uint64_t> next{1};
+        return next.fetch_add(1, std::memory_order_relaxed);
+    }
 };
 
 class Sound : public IResource {
@@ -184,11 +692,26 @@ class Sound : public IResource {
         auto folder = std::filesystem::path("resources/sounds");
         auto fullPath = folder / fileName;
 
-        ma_result result = ma_sound_init_from_file(m_engine, fullPath.string().c_str(), 0, nullptr, nullptr, &m_sound);
+        // decoded from the mapping or the pack, miniaudio never opens the file itself
+        m_file = Vfs::open(fullPath);
+        m_fileSize = m_file.size();
+        ma_result result = MA_DOES_NOT_EXIST;
+        if (m_file.isOpen()) {
+            result = ma_decoder_init_memory(m_file.data(), m_file.size(), nullptr, &m_decoder);
+            if (result == MA_SUCCESS) {
+                result = ma_sound_init_from_data_source(m_engine, &m_decoder, 0, nullptr, &m_sound);
+                if (result != MA_SUCCESS) {
+                    ma_decoder_uninit(&m_decoder);
+                }
+            }
+        }
 
         if (result != MA_SUCCESS) {
+            m_file = {};
             // why do we need do it like this here with cpp23?
-            spdlog::error(fmt::runtime("Failed to load sound: {} (Error code: {})"), fullPath.string());
+            spdlog::error(fmt::runtime("Failed to load sound: {} (Error code: {})"),
+                          fullPath.string(),
+                          static_cast<int>(result));
             return false;
         }
 
@@ -202,10 +725,17 @@ class Sound : public IResource {
         }
 
         ma_sound_uninit(&m_sound);
+        ma_decoder_uninit(&m_decoder);
+        m_file = {};
         m_isLoaded = false;
         return true;
     }
 
+    // the encoded file stays mapped while the sound lives
+    [[nodiscard]] auto getMemoryUsage() const -> ResourceMemory override {
+        return {m_isLoaded ? m_fileSize : 0, 0};
+    }
+
     auto play() -> bool {
         if (!m_isLoaded || !m_engine) {
             return false;
@@ -257,7 +787,10 @@ class Sound : public IResource {
 
    private:
     ma_sound m_sound{};
+    ma_decoder m_decoder{};
     ma_engine* m_engine{};
+    VfsFile m_file;
+    uint64_t m_fileSize = 0;
 };
 
 class Script : public IResource {
@@ -267,12 +800,12 @@ class Script : public IResource {
     auto load(const std::string& fileName) -> bool override {
         auto folder = std::filesystem::path("resources/scripts");
         auto fullPath = folder / fileName;
-        std::ifstream file(fullPath);
-        if (!file.is_open()) {
+        auto file = Vfs::open(fullPath);
+        if (!file.isOpen()) {
             spdlog::error("Failed to load script: {}", fullPath.string());
             return false;
         }
-        m_source.assign((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        m_source.assign(file.view());
         m_isLoaded = true;
         m_path = fullPath.string();
         return true;
@@ -284,6 +817,10 @@ class Script : public IResource {
         return true;
     }
 
+    [[nodiscard]] auto getMemoryUsage() const -> ResourceMemory override {
+        return {m_source.capacity(), 0};
+    }
+
     [[nodiscard]] auto getSource() const -> const std::string& {
         return m_source;
     }
@@ -291,9 +828,20 @@ class Script : public IResource {
         return m_path;
     }
 
+    // hot reload, main thread. the ScriptSystem sees the new version and rebuilds the
+    // environments of every entity running this script
+    auto setSource(std::string source) -> void {
+        m_source = std::move(source);
+        m_version++;
+    }
+    [[nodiscard]] auto getVersion() const -> uint32_t {
+        return m_version;
+    }
+
    private:
     std::string m_source;
     std::string m_path;
+    uint32_t m_version = 0;
 };
 
 }  // namespace Vengine
\ No newline at end of file
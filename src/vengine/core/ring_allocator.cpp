@@ -0,0 +1,107 @@
+#include "ring_allocator.hpp"
+
+namespace Vengine {
+
+namespace {
+
+auto alignUp(size_t value, size_t alignment) -> size_t {
+    return alignment > 1 ? (value + alignment - 1) / alignment * alignment : value;
+}
+
+}  // namespace
+
+auto RingAllocator::reset(size_t capacity) -> void {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_capacity = capacity;
+    m_entries.clear();
+}
+
+auto RingAllocator::allocate(size_t size, size_t alignment) -> std::optional<RingRange> {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (size == 0 || size > m_capacity) {
+        return std::nullopt;
+    }
+
+    size_t offset = 0;
+    if (!m_entries.empty()) {
+        const auto& oldest = m_entries.front();
+        const auto& newest = m_entries.back();
+        auto start = alignUp(newest.end, alignment);
+        if (newest.begin >= oldest.begin) {
+            // free is the end of the buffer, then the start up to the oldest range
+            if (start + size <= m_capacity) {
+                offset = start;
+            } else if (size <= oldest.begin) {
+                offset = 0;
+            } else {
+                return std::nullopt;
+            }
+        } else if (start + size <= oldest.begin) {
+            // wrapped, free is the gap between the newest and the oldest range
+            offset = start;
+        } else {
+            return std::nullopt;
+        }
+    }
+
+    Entry entry;
+    entry.begin = offset;
+    entry.end = offset + size;
+    entry.id = m_nextId++;
+    m_entries.push_back(entry);
+    return RingRange{offset, size, entry.id};
+}
+
+auto RingAllocator::release(uint64_t id) -> void {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // the newest are the likeliest, the main thread uploads what just finished loading
+    for (auto it = m_entries.rbegin(); it != m_entries.rend(); ++it) {
+        if (it->id == id) {
+            it->released = true;
+            return;
+        }
+    }
+}
+
+auto RingAllocator::fence(uint64_t fenceId) -> bool {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    bool tagged = false;
+    for (auto& entry : m_entries) {
+        if (entry.released && entry.fence == 0) {
+            entry.fence = fenceId;
+            tagged = true;
+        }
+    }
+    return tagged;
+}
+
+auto RingAllocator::retire(uint64_t fenceId) -> void {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    while (!m_entries.empty()) {
+        const auto& oldest = m_entries.front();
+        if (!oldest.released || oldest.fence == 0 || oldest.fence > fenceId) {
+            break;
+        }
+        m_entries.pop_front();
+    }
+}
+
+auto RingAllocator::getUsedBytes() const -> size_t {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_entries.empty()) {
+        return 0;
+    }
+    const auto& oldest = m_entries.front();
+    const auto& newest = m_entries.back();
+    if (newest.begin >= oldest.begin) {
+        return newest.end - oldest.begin;
+    }
+    return m_capacity - oldest.begin + newest.end;
+}
+
+auto RingAllocator::getLiveCount() const -> size_t {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries.size();
+}
+
+}  // namespace Vengine
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+namespace Vengine {
+
+struct RingRange {
+    size_t offset = 0;
+    size_t size = 0;
+    uint64_t id = 0;
+};
+
+// the bookkeeping of a staging ring, kept free of gl so it can be tested. ranges are handed out in
+// ring order and come back in any order: release() once the cpu is done with one (the gpu copy is
+// issued), fence() tags everything released since the last call with a fence, retire() frees the
+// ranges whose fence passed. space only comes back from the oldest range on, one range still in
+// use holds up everything allocated after it. any thread
+class RingAllocator {
+   public:
+    explicit RingAllocator(size_t capacity = 0) : m_capacity(capacity) {
+    }
+
+    // forgets every range, only while nothing is in flight
+    auto reset(size_t capacity) -> void;
+
+    // nothing if size doesn't fit until older ranges are retired, or never fits at all
+    auto allocate(size_t size, size_t alignment = 256) -> std::optional<RingRange>;
+    auto release(uint64_t id) -> void;
+    // false if nothing was released since the last fence, no fence needed then
+    auto fence(uint64_t fenceId) -> bool;
+    // every fence up to fenceId completed
+    auto retire(uint64_t fenceId) -> void;
+
+    [[nodiscard]] auto getCapacity() const -> size_t {
+        return m_capacity;
+    }
+    // from the oldest live range to the newest, padding included
+    [[nodiscard]] auto getUsedBytes() const -> size_t;
+    [[nodiscard]] auto getLiveCount() const -> size_t;
+
+   private:
+    struct Entry {
+        size_t begin = 0;
+        size_t end = 0;
+        uint64_t id = 0;
+        bool released = false;
+        uint64_t fence = 0;  // 0 until fenced
+    };
+
+    mutable std::mutex m_mutex;
+    size_t m_capacity = 0;
+    uint64_t m_nextId = 1;
+    std::deque<Entry> m_entries;  // ring order, oldest first
+};
+
+}  // namespace Vengine
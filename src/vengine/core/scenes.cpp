@@ -34,6 +34,10 @@ void Scenes::load(const std::string& name, Vengine& vengine) {
             m_currentScene->getEntities()->removeNonPersistentEntities();
             it->second->setEntities(m_currentScene->getEntities());
 
+            // whatever only the old scene used is unreferenced now, types over budget drop what
+            // also went unused for the grace period. the new scene may still pick up the rest
+            vengine.resourceManager->trim();
+
             // reset jolt by hand if it exists
             auto joltSystem = vengine.ecs->getSystem<PhysicsSystem>("PhysicsSystem");
             if (joltSystem) {
@@ -9,11 +9,12 @@
 #include <glad/glad.h>
 #include <tl/expected.hpp>
 #include "vengine/core/error.hpp"
+#include "vengine/utils/vfs.hpp"
 
 namespace Vengine {
 
 Shader::Shader(std::string name, const std::string& vertexFile, const std::string& fragmentFile)
-    : m_name(std::move(name)) {
+    : m_name(std::move(name)), m_vertexFile(vertexFile), m_fragmentFile(fragmentFile) {
     spdlog::debug("Constructor Shader: {}", m_name);
     // TODO put this into a init() function so we can cut execution on error, right?
     assert(!m_name.empty() && "Shader name is empty");
@@ -24,38 +25,20 @@ Shader::Shader(std::string name, const std::string& vertexFile, const std::strin
     auto vertexSource = readFile(vertexFile);
     if (!vertexSource) {
         spdlog::error("{}", vertexSource.error().message);
+        return;
     }
     auto fragmentSource = readFile(fragmentFile);
     if (!fragmentSource) {
         spdlog::error("{}", fragmentSource.error().message);
+        return;
     }
 
-    auto vertexShader = compileShader(GL_VERTEX_SHADER, vertexSource.value());
-    if (!vertexShader) {
-        spdlog::error("{}", vertexShader.error().message);
+    auto program = linkProgram(vertexSource.value(), fragmentSource.value());
+    if (!program) {
+        spdlog::error("{}", program.error().message);
+        return;
     }
-
-    auto fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentSource.value());
-    if (!fragmentShader) {
-        spdlog::error("{}", fragmentShader.error().message);
-    }
-
-    m_id = glCreateProgram();
-    glAttachShader(m_id, vertexShader.value());
-    glAttachShader(m_id, fragmentShader.value());
-    glLinkProgram(m_id);
-
-    int success;
-    glGetProgramiv(m_id, GL_LINK_STATUS, &success);
-    if (success == 0) {
-        std::string infoLog;
-        infoLog.resize(512);  // Pre-allocate space
-        glGetProgramInfoLog(m_id, 512, nullptr, infoLog.data());
-        spdlog::error("{}", "Shader program linking failed: " + infoLog);
-    }
-
-    glDeleteShader(vertexShader.value());
-    glDeleteShader(fragmentShader.value());
+    m_id = program.value();
 }
 
 Shader::~Shader() {
@@ -85,21 +68,65 @@ auto Shader::unbind() -> void {
         std::string infoLog;
         infoLog.resize(512);
         glGetShaderInfoLog(shader, 512, nullptr, infoLog.data());
+        glDeleteShader(shader);
         return tl::unexpected(Error{"Shader compilation failed: " + infoLog});
     }
 
     return shader;
 }
 
+[[nodiscard]] auto Shader::linkProgram(const std::string& vertexSource, const std::string& fragmentSource)
+    -> tl::expected<GLuint, Error> {
+    auto vertexShader = compileShader(GL_VERTEX_SHADER, vertexSource);
+    if (!vertexShader) {
+        return tl::unexpected(vertexShader.error());
+    }
+    auto fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
+    if (!fragmentShader) {
+        glDeleteShader(vertexShader.value());
+        return tl::unexpected(fragmentShader.error());
+    }
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertexShader.value());
+    glAttachShader(program, fragmentShader.value());
+    glLinkProgram(program);
+    glDeleteShader(vertexShader.value());
+    glDeleteShader(fragmentShader.value());
+
+    int success;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (success == 0) {
+        std::string infoLog;
+        infoLog.resize(512);  // Pre-allocate space
+        glGetProgramInfoLog(program, 512, nullptr, infoLog.data());
+        glDeleteProgram(program);
+        return tl::unexpected(Error{"Shader program linking failed: " + infoLog});
+    }
+    return program;
+}
+
+auto Shader::reload(const std::string& vertexSource, const std::string& fragmentSource) -> bool {
+    auto program = linkProgram(vertexSource, fragmentSource);
+    if (!program) {
+        spdlog::error("Reloading shader {} failed, keeping the old one: {}", m_name, program.error().message);
+        return false;
+    }
+    if (m_id != 0) {
+        glDeleteProgram(m_id);
+    }
+    m_id = program.value();
+    spdlog::info("Reloaded shader {}", m_name);
+    return true;
+}
+
 [[nodiscard]] auto Shader::readFile(const std::string& path) -> tl::expected<std::string, Error> {
-    std::ifstream file(path);
-    if (!file) {
+    auto file = Vfs::open(path);
+    if (!file.isOpen()) {
         return tl::unexpected(Error{"Could not open file: " + path});
         // throw std::runtime_error("Could not open file: " + path);
     }
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    return buffer.str();
+    return std::string(file.view());
 }
 
 [[nodiscard]] auto Shader::getName() -> const std::string& {
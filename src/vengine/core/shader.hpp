@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <glad/glad.h>
 #include <glm/glm.hpp>
@@ -36,14 +37,32 @@ class Shader : public IResource {
     auto setUniformVec3(const std::string& name, const glm::vec3& value) const -> void;
 
     [[nodiscard]] auto getName() -> const std::string&;
+    [[nodiscard]] auto getVertexFile() const -> const std::string& {
+        return m_vertexFile;
+    }
+    [[nodiscard]] auto getFragmentFile() const -> const std::string& {
+        return m_fragmentFile;
+    }
+
+    // hot reload, main thread. builds a new program from the sources and swaps it in, materials
+    // hold this object and set their uniforms on every bind so they pick it up as is. uniform
+    // locations are looked up per call, nothing cached against the old program needs dropping.
+    // on a compile or link error the old program stays, a typo while editing doesn't blank the screen
+    auto reload(const std::string& vertexSource, const std::string& fragmentSource) -> bool;
+
+    // any thread
+    [[nodiscard]] static auto readFile(const std::string& path) -> tl::expected<std::string, Error>;
 
    private:
     GLuint m_id = 0;
     std::string m_name;
+    std::string m_vertexFile;
+    std::string m_fragmentFile;
 
     // functions
-    [[nodiscard]] auto readFile(const std::string& path) -> tl::expected<std::string, Error>;
     [[nodiscard]] auto compileShader(GLuint type, const std::string& source) -> tl::expected<GLuint, Error>;
+    [[nodiscard]] auto linkProgram(const std::string& vertexSource, const std::string& fragmentSource)
+        -> tl::expected<GLuint, Error>;
 };
 
 }  // namespace Vengine
\ No newline at end of file
@@ -0,0 +1,279 @@
+#include "task_profiler.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <spdlog/spdlog.h>
+
+namespace Vengine {
+
+namespace {
+
+std::atomic<uint64_t> g_nextProfilerInstance{1};
+
+struct ThreadCache {
+    uint64_t instanceId = 0;
+    void* buffer = nullptr;
+};
+
+thread_local ThreadCache t_cache;
+thread_local std::string t_threadName;
+
+auto escapeJson(const char* text) -> std::string {
+    std::string result;
+    for (const char* c = text; *c != '\0'; ++c) {
+        switch (*c) {
+            case '"':
+                result += "\\\"";
+                break;
+            case '\\':
+                result += "\\\\";
+                break;
+            case '\n':
+                result += "\\n";
+                break;
+            default:
+                if (static_cast<unsigned char>(*c) >= 0x20) {
+                    result += *c;
+                }
+        }
+    }
+    return result;
+}
+
+auto bucketLabel(size_t bucket) -> std::string {
+    if (bucket == 0) {
+        return "< 1 us";
+    }
+    return "< " + std::to_string(uint64_t{1} << bucket) + " us";
+}
+
+}  // namespace
+
+auto TaskHistogram::add(uint64_t valueNs) -> void {
+    uint64_t valueUs = valueNs / 1000;
+    size_t bucket = valueUs == 0 ? 0 : static_cast<size_t>(std::bit_width(valueUs));
+    bucket = std::min(bucket, BUCKET_COUNT - 1);
+
+    ++buckets[bucket];
+    ++count;
+    totalNs += valueNs;
+    maxNs = std::max(maxNs, valueNs);
+}
+
+auto TaskHistogram::averageUs() const -> double {
+    if (count == 0) {
+        return 0.0;
+    }
+    return static_cast<double>(totalNs) / static_cast<double>(count) / 1000.0;
+}
+
+auto TaskHistogram::percentileUs(double percentile) const -> double {
+    if (count == 0) {
+        return 0.0;
+    }
+    auto target = static_cast<uint64_t>(percentile * static_cast<double>(count));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        seen += buckets[i];
+        if (seen > target || seen == count) {
+            return static_cast<double>(uint64_t{1} << i);
+        }
+    }
+    return static_cast<double>(maxNs) / 1000.0;
+}
+
+TaskProfiler::TaskProfiler() : m_instanceId(g_nextProfilerInstance.fetch_add(1)) {
+}
+
+TaskProfiler::~TaskProfiler() = default;
+
+auto TaskProfiler::setThreadName(const std::string& name) -> void {
+    t_threadName = name;
+
+    std::lock_guard<std::mutex> lock(m_buffersMutex);
+    if (auto* buffer = findThreadBuffer()) {
+        buffer->name = name;
+    }
+}
+
+auto TaskProfiler::findThreadBuffer() -> ThreadBuffer* {
+    auto id = std::this_thread::get_id();
+    for (const auto& buffer : m_buffers) {
+        if (buffer->owner == id) {
+            return buffer.get();
+        }
+    }
+    return nullptr;
+}
+
+auto TaskProfiler::getThreadBuffer() -> ThreadBuffer* {
+    if (t_cache.instanceId == m_instanceId) {
+        return static_cast<ThreadBuffer*>(t_cache.buffer);
+    }
+
+    // the cache holds one profiler, a thread that records into several comes back here whenever
+    // it switches. it gets its old buffer back, a new one only for its first event
+    ThreadBuffer* rawBuffer = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(m_buffersMutex);
+        rawBuffer = findThreadBuffer();
+        if (!rawBuffer) {
+            auto buffer = std::make_unique<ThreadBuffer>();
+            rawBuffer = buffer.get();
+            rawBuffer->threadId = static_cast<uint32_t>(m_buffers.size());
+            rawBuffer->owner = std::this_thread::get_id();
+            rawBuffer->name = t_threadName.empty() ? "Thread " + std::to_string(rawBuffer->threadId) : t_threadName;
+            m_buffers.push_back(std::move(buffer));
+        }
+    }
+
+    t_cache.instanceId = m_instanceId;
+    t_cache.buffer = rawBuffer;
+    return rawBuffer;
+}
+
+auto TaskProfiler::record(const std::string& name, uint64_t enqueueNs, uint64_t startNs, uint64_t endNs) -> void {
+    auto* buffer = getThreadBuffer();
+
+    uint64_t index = buffer->head.load(std::memory_order_relaxed);
+    Slot& slot = buffer->slots[index % RING_CAPACITY];
+
+    uint64_t sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.event.enqueueNs = enqueueNs == 0 ? startNs : enqueueNs;
+    slot.event.startNs = startNs;
+    slot.event.endNs = endNs;
+    slot.event.threadId = buffer->threadId;
+    size_t length = std::min(name.size(), TaskEvent::MAX_NAME_LENGTH);
+    std::memcpy(slot.event.name, name.data(), length);
+    slot.event.name[length] = '\0';
+
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+    buffer->head.store(index + 1, std::memory_order_release);
+}
+
+auto TaskProfiler::collect() const -> std::vector<TaskEvent> {
+    std::vector<TaskEvent> events;
+    std::lock_guard<std::mutex> lock(m_buffersMutex);
+
+    for (const auto& buffer : m_buffers) {
+        uint64_t head = buffer->head.load(std::memory_order_acquire);
+        uint64_t first = head > RING_CAPACITY ? head - RING_CAPACITY : 0;
+        first = std::max(first, buffer->tail.load(std::memory_order_acquire));
+
+        for (uint64_t i = first; i < head; ++i) {
+            const Slot& slot = buffer->slots[i % RING_CAPACITY];
+
+            uint64_t before = slot.sequence.load(std::memory_order_acquire);
+            TaskEvent event = slot.event;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            uint64_t after = slot.sequence.load(std::memory_order_relaxed);
+
+            // skip slots the owning thread is overwriting right now
+            if (before != after || (before & 1) != 0) {
+                continue;
+            }
+            events.push_back(event);
+        }
+    }
+
+    return events;
+}
+
+auto TaskProfiler::getSummary() const -> TaskProfilerSummary {
+    TaskProfilerSummary summary;
+    for (const auto& event : collect()) {
+        summary.queueLatency.add(event.queueLatencyNs());
+        summary.duration.add(event.durationNs());
+    }
+
+    std::lock_guard<std::mutex> lock(m_buffersMutex);
+    for (const auto& buffer : m_buffers) {
+        uint64_t recorded = buffer->head.load(std::memory_order_acquire) - buffer->tail.load(std::memory_order_acquire);
+        if (recorded > RING_CAPACITY) {
+            summary.droppedEvents += recorded - RING_CAPACITY;
+        }
+    }
+    return summary;
+}
+
+auto TaskProfiler::logSummary() const -> void {
+    auto summary = getSummary();
+    spdlog::info("TaskProfiler: {} tasks, {} dropped", summary.duration.count, summary.droppedEvents);
+    spdlog::info("TaskProfiler: queue latency avg {:.1f} us, p50 < {:.0f} us, p99 < {:.0f} us, max {:.1f} us",
+                 summary.queueLatency.averageUs(),
+                 summary.queueLatency.percentileUs(0.5),
+                 summary.queueLatency.percentileUs(0.99),
+                 static_cast<double>(summary.queueLatency.maxNs) / 1000.0);
+    spdlog::info("TaskProfiler: duration avg {:.1f} us, p50 < {:.0f} us, p99 < {:.0f} us, max {:.1f} us",
+                 summary.duration.averageUs(),
+                 summary.duration.percentileUs(0.5),
+                 summary.duration.percentileUs(0.99),
+                 static_cast<double>(summary.duration.maxNs) / 1000.0);
+
+    for (size_t i = 0; i < TaskHistogram::BUCKET_COUNT; ++i) {
+        if (summary.queueLatency.buckets[i] == 0 && summary.duration.buckets[i] == 0) {
+            continue;
+        }
+        spdlog::info("TaskProfiler: {:>12} | queued {:>6} | ran {:>6}",
+                     bucketLabel(i),
+                     summary.queueLatency.buckets[i],
+                     summary.duration.buckets[i]);
+    }
+}
+
+auto TaskProfiler::exportChromeTrace(const std::string& path) const -> bool {
+    auto events = collect();
+
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        spdlog::error("TaskProfiler: failed to open trace file: {}", path);
+        return false;
+    }
+
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+    bool first = true;
+    {
+        std::lock_guard<std::mutex> lock(m_buffersMutex);
+        for (const auto& buffer : m_buffers) {
+            file << (first ? "" : ",\n") << R"({"name":"thread_name","ph":"M","pid":1,"tid":)" << buffer->threadId
+                 << R"(,"args":{"name":")" << escapeJson(buffer->name.c_str()) << "\"}}";
+            first = false;
+        }
+    }
+
+    uint64_t origin = UINT64_MAX;
+    for (const auto& event : events) {
+        origin = std::min(origin, event.enqueueNs);
+    }
+
+    // timestamps are microseconds in the chrome format. fixed, the default 6 digits turn anything
+    // past a second into 1.23457e+06 and events snap together in the viewer
+    file << std::fixed << std::setprecision(3);
+    for (const auto& event : events) {
+        file << (first ? "" : ",\n") << R"({"name":")" << escapeJson(event.name) << R"(","cat":"task","ph":"X","pid":1)"
+             << ",\"tid\":" << event.threadId << ",\"ts\":" << static_cast<double>(event.startNs - origin) / 1000.0
+             << ",\"dur\":" << static_cast<double>(event.durationNs()) / 1000.0
+             << ",\"args\":{\"queue_us\":" << static_cast<double>(event.queueLatencyNs()) / 1000.0 << "}}";
+        first = false;
+    }
+
+    file << "\n]}\n";
+    spdlog::info("TaskProfiler: wrote {} task events to {}", events.size(), path);
+    return file.good();
+}
+
+auto TaskProfiler::clear() -> void {
+    std::lock_guard<std::mutex> lock(m_buffersMutex);
+    for (const auto& buffer : m_buffers) {
+        buffer->tail.store(buffer->head.load(std::memory_order_acquire), std::memory_order_release);
+    }
+}
+
+}  // namespace Vengine
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Vengine {
+
+struct TaskEvent {
+    static constexpr size_t MAX_NAME_LENGTH = 63;
+
+    uint64_t enqueueNs = 0;
+    uint64_t startNs = 0;
+    uint64_t endNs = 0;
+    uint32_t threadId = 0;
+    char name[MAX_NAME_LENGTH + 1] = {};
+
+    [[nodiscard]] auto queueLatencyNs() const -> uint64_t {
+        return startNs > enqueueNs ? startNs - enqueueNs : 0;
+    }
+    [[nodiscard]] auto durationNs() const -> uint64_t {
+        return endNs > startNs ? endNs - startNs : 0;
+    }
+};
+
+// bucket i counts values in [2^(i-1), 2^i) microseconds, bucket 0 is everything below 1 us
+struct TaskHistogram {
+    static constexpr size_t BUCKET_COUNT = 24;
+
+    std::array<uint64_t, BUCKET_COUNT> buckets = {};
+    uint64_t count = 0;
+    uint64_t totalNs = 0;
+    uint64_t maxNs = 0;
+
+    auto add(uint64_t valueNs) -> void;
+    [[nodiscard]] auto averageUs() const -> double;
+    // approximated from the buckets, returns the upper bound of the bucket in microseconds
+    [[nodiscard]] auto percentileUs(double percentile) const -> double;
+};
+
+struct TaskProfilerSummary {
+    TaskHistogram queueLatency;
+    TaskHistogram duration;
+    uint64_t droppedEvents = 0;
+};
+
+// per-task timings of the ThreadManager. every thread writes into its own ring buffer,
+// single producer, so recording is a few stores and no lock. when disabled the ThreadManager
+// only pays the isEnabled() branch.
+class TaskProfiler {
+   public:
+    static constexpr size_t RING_CAPACITY = 4096;
+
+    TaskProfiler();
+    ~TaskProfiler();
+    TaskProfiler(const TaskProfiler&) = delete;
+    auto operator=(const TaskProfiler&) -> TaskProfiler& = delete;
+
+    auto setEnabled(bool enabled) -> void {
+        m_enabled.store(enabled, std::memory_order_relaxed);
+    }
+    [[nodiscard]] auto isEnabled() const -> bool {
+        return m_enabled.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] static auto now() -> uint64_t {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                         std::chrono::steady_clock::now().time_since_epoch())
+                                         .count());
+    }
+
+    // names the calling thread in the trace, threads that never call this get "Thread <id>"
+    auto setThreadName(const std::string& name) -> void;
+    auto record(const std::string& name, uint64_t enqueueNs, uint64_t startNs, uint64_t endNs) -> void;
+
+    // copies everything still in the ring buffers, oldest first per thread
+    [[nodiscard]] auto collect() const -> std::vector<TaskEvent>;
+    [[nodiscard]] auto getSummary() const -> TaskProfilerSummary;
+    auto logSummary() const -> void;
+    // chrome://tracing and ui.perfetto.dev json format
+    auto exportChromeTrace(const std::string& path) const -> bool;
+    auto clear() -> void;
+
+   private:
+    struct Slot {
+        std::atomic<uint64_t> sequence{0};  // odd while the owning thread writes the slot
+        TaskEvent event;
+    };
+
+    struct ThreadBuffer {
+        uint32_t threadId = 0;
+        std::thread::id owner;  // the one thread that writes it
+        std::string name;
+        std::atomic<uint64_t> head{0};
+        std::atomic<uint64_t> tail{0};  // moved up to head by clear()
+        std::array<Slot, RING_CAPACITY> slots;
+    };
+
+    auto getThreadBuffer() -> ThreadBuffer*;
+    // under m_buffersMutex, nullptr if this thread never recorded into this profiler
+    auto findThreadBuffer() -> ThreadBuffer*;
+
+    std::atomic<bool> m_enabled{false};
+    uint64_t m_instanceId = 0;
+
+    // only taken when the thread local cache misses, first event of a thread or a thread
+    // switching between profilers
+    mutable std::mutex m_buffersMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> m_buffers;
+};
+
+}  // namespace Vengine
@@ -0,0 +1,214 @@
+#include "texture_cache.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <thread>
+#include <spdlog/spdlog.h>
+
+#include "vengine/utils/file_stamp.hpp"
+#include "vengine/utils/hash.hpp"
+#include "vengine/utils/vfs.hpp"
+
+namespace Vengine {
+
+namespace {
+
+constexpr char MAGIC[4] = {'V', 'T', 'E', 'X'};
+
+// header, mipCount VtexMip entries, then the level data back to back. native endian like .vmesh
+struct VtexHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t format;
+    uint32_t mipCount;
+    uint32_t width;
+    uint32_t height;
+    uint64_t sourceSize;
+    int64_t sourceMtime;
+    uint64_t sourceHash;
+    uint64_t dataBytes;
+};
+static_assert(sizeof(VtexHeader) == 56, "VtexHeader layout changed, bump TextureCache::VERSION");
+
+struct VtexMip {
+    uint32_t width;
+    uint32_t height;
+    uint64_t offset;
+    uint64_t size;
+};
+static_assert(sizeof(VtexMip) == 24, "VtexMip layout changed, bump TextureCache::VERSION");
+
+auto isValidFormat(uint32_t format) -> bool {
+    return format <= static_cast<uint32_t>(TextureFormat::BC3);
+}
+
+}  // namespace
+
+TextureCache::TextureCache(std::filesystem::path directory) : m_directory(std::move(directory)) {
+}
+
+auto TextureCache::getCachePath(const std::filesystem::path& source) const -> std::filesystem::path {
+    auto name = source.filename().string() + "." + hashToString(hash64(source.generic_string())) + ".vtex";
+    return m_directory / name;
+}
+
+auto TextureCache::load(const std::filesystem::path& source, TextureData& out, uint32_t maxSize) -> bool {
+    return read(source, out, [maxSize](const TextureData& data) {
+        uint32_t first = maxSize == 0 ? 0 : getLevelForSize(data, maxSize);
+        return std::pair{first, static_cast<uint32_t>(data.mips.size())};
+    });
+}
+
+auto TextureCache::loadLevels(const std::filesystem::path& source, uint32_t firstLevel, uint32_t endLevel,
+                              TextureData& out) -> bool {
+    return read(source, out, [firstLevel, endLevel](const TextureData& data) {
+        auto count = static_cast<uint32_t>(data.mips.size());
+        return std::pair{std::min(firstLevel, count - 1), std::clamp(endLevel, firstLevel + 1, count)};
+    });
+}
+
+auto TextureCache::read(const std::filesystem::path& source, TextureData& out, const LevelRange& range) -> bool {
+    if (!m_enabled) {
+        return false;
+    }
+
+    auto miss = [this]() {
+        m_misses.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    };
+
+    // a shipped pack can carry the cache entries too
+    auto file = Vfs::open(getCachePath(source));
+    if (!file.isOpen() || file.size() < sizeof(VtexHeader)) {
+        return miss();
+    }
+
+    VtexHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION ||
+        !isValidFormat(header.format) || header.mipCount != getMipCount(header.width, header.height)) {
+        return miss();
+    }
+
+    if (!matchesFileStamp(source, FileStamp{header.sourceSize, header.sourceMtime, header.sourceHash})) {
+        return miss();
+    }
+
+    size_t tableBytes = static_cast<size_t>(header.mipCount) * sizeof(VtexMip);
+    if (file.size() != sizeof(VtexHeader) + tableBytes + header.dataBytes) {
+        spdlog::warn("TextureCache: {} is truncated, ignoring it", getCachePath(source).string());
+        return miss();
+    }
+
+    out.format = static_cast<TextureFormat>(header.format);
+    out.width = header.width;
+    out.height = header.height;
+    out.mips.resize(header.mipCount);
+
+    // the levels have to be the chain of the header's size, back to back from offset 0,
+    // the copy below relies on that
+    const uint8_t* cursor = file.data() + sizeof(VtexHeader);
+    uint32_t width = header.width;
+    uint32_t height = header.height;
+    uint64_t offset = 0;
+    for (auto& mip : out.mips) {
+        VtexMip entry;
+        std::memcpy(&entry, cursor, sizeof(entry));
+        cursor += sizeof(entry);
+        if (entry.width != width || entry.height != height || entry.offset != offset ||
+            entry.size != getMipByteSize(out.format, width, height) || entry.size > header.dataBytes - offset) {
+            spdlog::warn("TextureCache: {} has a corrupt mip table, ignoring it", getCachePath(source).string());
+            return miss();
+        }
+        mip = TextureMip{entry.width, entry.height, entry.offset, entry.size};
+        offset += entry.size;
+        width = std::max(1u, width / 2);
+        height = std::max(1u, height / 2);
+    }
+    if (offset != header.dataBytes) {
+        spdlog::warn("TextureCache: {} has a corrupt mip table, ignoring it", getCachePath(source).string());
+        return miss();
+    }
+
+    // only the requested levels are copied out of the mapping, they are contiguous in the file
+    auto [first, end] = range(out);
+    uint64_t begin = out.mips[first].offset;
+    uint64_t last = out.mips[end - 1].offset + out.mips[end - 1].size;
+    out.firstLevel = first;
+    out.bytes.assign(cursor + begin, cursor + last);
+
+    m_hits.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+auto TextureCache::store(const std::filesystem::path& source, const TextureData& data) -> bool {
+    if (!m_enabled) {
+        return false;
+    }
+
+    VtexHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.format = static_cast<uint32_t>(data.format);
+    header.mipCount = static_cast<uint32_t>(data.mips.size());
+    header.width = data.width;
+    header.height = data.height;
+    header.dataBytes = data.bytes.size();
+
+    FileStamp stamp;
+    if (!readFileStamp(source, stamp)) {
+        spdlog::warn("TextureCache: could not read source {}", source.string());
+        return false;
+    }
+    header.sourceSize = stamp.size;
+    header.sourceMtime = stamp.mtime;
+    header.sourceHash = stamp.hash;
+
+    std::vector<VtexMip> table;
+    table.reserve(data.mips.size());
+    for (const auto& mip : data.mips) {
+        table.push_back(VtexMip{mip.width, mip.height, mip.offset, mip.size});
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(m_directory, error);
+    if (error) {
+        spdlog::warn("TextureCache: could not create {}: {}", m_directory.string(), error.message());
+        return false;
+    }
+
+    // same temp file + rename as the mesh cache, concurrent writers never leave half a file
+    auto cachePath = getCachePath(source);
+    auto tempPath = cachePath;
+    tempPath += ".tmp" + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            spdlog::warn("TextureCache: could not write {}", tempPath.string());
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(table.data()),
+                   static_cast<std::streamsize>(table.size() * sizeof(VtexMip)));
+        file.write(reinterpret_cast<const char*>(data.bytes.data()), static_cast<std::streamsize>(data.bytes.size()));
+        if (!file.good()) {
+            file.close();
+            std::filesystem::remove(tempPath, error);
+            return false;
+        }
+    }
+
+    std::filesystem::rename(tempPath, cachePath, error);
+    if (error) {
+        spdlog::warn("TextureCache: could not move {} into place: {}", cachePath.string(), error.message());
+        std::filesystem::remove(tempPath, error);
+        return false;
+    }
+
+    spdlog::debug("TextureCache: wrote {}", cachePath.string());
+    return true;
+}
+
+}  // namespace Vengine
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <utility>
+
+#include "vengine/core/texture_data.hpp"
+
+namespace Vengine {
+
+// decoded textures with their full mip chain as .vtex files, so a start-up neither decodes
+// png/jpg nor generates mips. entries are written by the texture_import tool or on a miss at
+// runtime and stay valid while the source is unchanged. the stored format is whatever the writer
+// picked, a runtime miss never overwrites an offline compressed entry for an unchanged source
+class TextureCache {
+   public:
+    static constexpr uint32_t VERSION = 1;
+
+    explicit TextureCache(std::filesystem::path directory = "cache/textures");
+
+    // maxSize > 0 skips the levels larger than that, what a streamed texture starts with
+    auto load(const std::filesystem::path& source, TextureData& out, uint32_t maxSize = 0) -> bool;
+    // just levels [firstLevel, endLevel), the streamer reading the mips a texture is missing.
+    // out.mips still describes the whole chain
+    auto loadLevels(const std::filesystem::path& source, uint32_t firstLevel, uint32_t endLevel, TextureData& out)
+        -> bool;
+    auto store(const std::filesystem::path& source, const TextureData& data) -> bool;
+
+    [[nodiscard]] auto getCachePath(const std::filesystem::path& source) const -> std::filesystem::path;
+    [[nodiscard]] auto getDirectory() const -> const std::filesystem::path& {
+        return m_directory;
+    }
+
+    // what textures imported at runtime are encoded to, the import tool picks its own. Auto by
+    // default, the resource manager turns it off when the driver has no s3tc
+    auto setImportCompression(TextureCompression compression) -> void {
+        m_importCompression = compression;
+    }
+    [[nodiscard]] auto getImportCompression() const -> TextureCompression {
+        return m_importCompression;
+    }
+
+    auto setEnabled(bool enabled) -> void {
+        m_enabled = enabled;
+    }
+    [[nodiscard]] auto isEnabled() const -> bool {
+        return m_enabled;
+    }
+
+    [[nodiscard]] auto getHits() const -> size_t {
+        return m_hits.load(std::memory_order_relaxed);
+    }
+    [[nodiscard]] auto getMisses() const -> size_t {
+        return m_misses.load(std::memory_order_relaxed);
+    }
+
+   private:
+    using LevelRange = std::function<std::pair<uint32_t, uint32_t>(const TextureData&)>;
+    auto read(const std::filesystem::path& source, TextureData& out, const LevelRange& range) -> bool;
+
+    std::filesystem::path m_directory;
+    TextureCompression m_importCompression = TextureCompression::Auto;
+    bool m_enabled = true;
+
+    std::atomic<size_t> m_hits{0};
+    std::atomic<size_t> m_misses{0};
+};
+
+}  // namespace Vengine
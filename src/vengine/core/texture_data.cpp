@@ -0,0 +1,551 @@
+#include "texture_data.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <queue>
+
+namespace Vengine {
+
+namespace {
+
+constexpr uint32_t BLOCK_SIZE = 4;
+constexpr uint32_t BLOCK_TEXELS = BLOCK_SIZE * BLOCK_SIZE;
+
+auto getBlockBytes(TextureFormat format) -> uint32_t {
+    return format == TextureFormat::BC1 ? 8 : 16;
+}
+
+auto toRgba(const uint8_t* texel, int channels, uint8_t* out) -> void {
+    switch (channels) {
+        case 1:
+            out[0] = out[1] = out[2] = texel[0];
+            out[3] = 255;
+            break;
+        case 2:
+            out[0] = out[1] = out[2] = texel[0];
+            out[3] = texel[1];
+            break;
+        case 3:
+            std::memcpy(out, texel, 3);
+            out[3] = 255;
+            break;
+        default:
+            std::memcpy(out, texel, 4);
+            break;
+    }
+}
+
+auto to565(const float* color) -> uint16_t {
+    auto quantize = [](float value, float maxValue) {
+        return static_cast<uint16_t>(std::clamp(std::lround(value * maxValue / 255.0f), 0L, static_cast<long>(maxValue)));
+    };
+    return static_cast<uint16_t>((quantize(color[0], 31.0f) << 11) | (quantize(color[1], 63.0f) << 5) |
+                                 quantize(color[2], 31.0f));
+}
+
+// bit replication, so 31 maps to 255 and 0 to 0
+auto from565(uint16_t value, int* out) -> void {
+    int r = (value >> 11) & 31;
+    int g = (value >> 5) & 63;
+    int b = value & 31;
+    out[0] = (r << 3) | (r >> 2);
+    out[1] = (g << 2) | (g >> 4);
+    out[2] = (b << 3) | (b >> 2);
+}
+
+auto write16(uint8_t* out, uint16_t value) -> void {
+    out[0] = static_cast<uint8_t>(value & 0xFF);
+    out[1] = static_cast<uint8_t>(value >> 8);
+}
+
+auto read16(const uint8_t* in) -> uint16_t {
+    return static_cast<uint16_t>(in[0] | (in[1] << 8));
+}
+
+// endpoints along the principal axis of the block colors, always 4 color mode
+auto encodeColorBlock(const uint8_t* rgba, uint8_t* out) -> void {
+    float mean[3] = {};
+    for (uint32_t i = 0; i < BLOCK_TEXELS; ++i) {
+        for (int c = 0; c < 3; ++c) {
+            mean[c] += rgba[i * 4 + c];
+        }
+    }
+    for (float& value : mean) {
+        value /= BLOCK_TEXELS;
+    }
+
+    float covariance[6] = {};  // xx xy xz yy yz zz
+    float minColor[3] = {255.0f, 255.0f, 255.0f};
+    float maxColor[3] = {};
+    for (uint32_t i = 0; i < BLOCK_TEXELS; ++i) {
+        float d[3];
+        for (int c = 0; c < 3; ++c) {
+            float value = rgba[i * 4 + c];
+            d[c] = value - mean[c];
+            minColor[c] = std::min(minColor[c], value);
+            maxColor[c] = std::max(maxColor[c], value);
+        }
+        covariance[0] += d[0] * d[0];
+        covariance[1] += d[0] * d[1];
+        covariance[2] += d[0] * d[2];
+        covariance[3] += d[1] * d[1];
+        covariance[4] += d[1] * d[2];
+        covariance[5] += d[2] * d[2];
+    }
+
+    // a few power iterations are plenty for a 3x3 matrix
+    float axis[3] = {maxColor[0] - minColor[0], maxColor[1] - minColor[1], maxColor[2] - minColor[2]};
+    for (int iteration = 0; iteration < 4; ++iteration) {
+        float next[3] = {
+            covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2],
+            covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2],
+            covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2],
+        };
+        float length = std::sqrt(next[0] * next[0] + next[1] * next[1] + next[2] * next[2]);
+        if (length < 1e-6f) {
+            break;
+        }
+        for (int c = 0; c < 3; ++c) {
+            axis[c] = next[c] / length;
+        }
+    }
+
+    float minT = 0.0f;
+    float maxT = 0.0f;
+    for (uint32_t i = 0; i < BLOCK_TEXELS; ++i) {
+        float t = 0.0f;
+        for (int c = 0; c < 3; ++c) {
+            t += (rgba[i * 4 + c] - mean[c]) * axis[c];
+        }
+        minT = std::min(minT, t);
+        maxT = std::max(maxT, t);
+    }
+
+    float endpoint0[3];
+    float endpoint1[3];
+    for (int c = 0; c < 3; ++c) {
+        endpoint0[c] = std::clamp(mean[c] + axis[c] * maxT, 0.0f, 255.0f);
+        endpoint1[c] = std::clamp(mean[c] + axis[c] * minT, 0.0f, 255.0f);
+    }
+
+    uint16_t color0 = to565(endpoint0);
+    uint16_t color1 = to565(endpoint1);
+    if (color0 < color1) {
+        std::swap(color0, color1);
+    }
+    write16(out, color0);
+    write16(out + 2, color1);
+
+    uint32_t indices = 0;
+    if (color0 != color1) {
+        int palette[4][3];
+        from565(color0, palette[0]);
+        from565(color1, palette[1]);
+        for (int c = 0; c < 3; ++c) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+
+        for (uint32_t i = 0; i < BLOCK_TEXELS; ++i) {
+            uint32_t best = 0;
+            int bestDistance = 1 << 30;
+            for (uint32_t p = 0; p < 4; ++p) {
+                int distance = 0;
+                for (int c = 0; c < 3; ++c) {
+                    int d = rgba[i * 4 + c] - palette[p][c];
+                    distance += d * d;
+                }
+                if (distance < bestDistance) {
+                    bestDistance = distance;
+                    best = p;
+                }
+            }
+            indices |= best << (i * 2);
+        }
+    }
+    std::memcpy(out + 4, &indices, sizeof(indices));
+}
+
+auto decodeColorBlock(const uint8_t* block, uint8_t* rgba, bool allowThreeColor) -> void {
+    uint16_t color0 = read16(block);
+    uint16_t color1 = read16(block + 2);
+    int palette[4][4];
+    from565(color0, palette[0]);
+    from565(color1, palette[1]);
+    palette[0][3] = palette[1][3] = palette[2][3] = palette[3][3] = 255;
+
+    if (color0 > color1 || !allowThreeColor) {
+        for (int c = 0; c < 3; ++c) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+    } else {
+        for (int c = 0; c < 3; ++c) {
+            palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+            palette[3][c] = 0;
+        }
+        palette[3][3] = 0;
+    }
+
+    uint32_t indices = 0;
+    std::memcpy(&indices, block + 4, sizeof(indices));
+    for (uint32_t i = 0; i < BLOCK_TEXELS; ++i) {
+        uint32_t index = (indices >> (i * 2)) & 3;
+        for (int c = 0; c < 4; ++c) {
+            rgba[i * 4 + c] = static_cast<uint8_t>(palette[index][c]);
+        }
+    }
+}
+
+auto alphaPalette(uint8_t alpha0, uint8_t alpha1, int* palette) -> void {
+    palette[0] = alpha0;
+    palette[1] = alpha1;
+    if (alpha0 > alpha1) {
+        for (int i = 1; i < 7; ++i) {
+            palette[i + 1] = ((7 - i) * alpha0 + i * alpha1) / 7;
+        }
+    } else {
+        for (int i = 1; i < 5; ++i) {
+            palette[i + 1] = ((5 - i) * alpha0 + i * alpha1) / 5;
+        }
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+}
+
+// 8 value mode between the block min and max, 3 bit indices
+auto encodeAlphaBlock(const uint8_t* rgba, uint8_t* out) -> void {
+    uint8_t minAlpha = 255;
+    uint8_t maxAlpha = 0;
+    for (uint32_t i = 0; i < BLOCK_TEXELS; ++i) {
+        minAlpha = std::min(minAlpha, rgba[i * 4 + 3]);
+        maxAlpha = std::max(maxAlpha, rgba[i * 4 + 3]);
+    }
+    out[0] = maxAlpha;
+    out[1] = minAlpha;
+
+    uint64_t indices = 0;
+    if (maxAlpha != minAlpha) {
+        int palette[8];
+        alphaPalette(maxAlpha, minAlpha, palette);
+        for (uint32_t i = 0; i < BLOCK_TEXELS; ++i) {
+            uint64_t best = 0;
+            int bestDistance = 256;
+            for (uint64_t p = 0; p < 8; ++p) {
+                int distance = std::abs(rgba[i * 4 + 3] - palette[p]);
+                if (distance < bestDistance) {
+                    bestDistance = distance;
+                    best = p;
+                }
+            }
+            indices |= best << (i * 3);
+        }
+    }
+    for (int i = 0; i < 6; ++i) {
+        out[2 + i] = static_cast<uint8_t>((indices >> (i * 8)) & 0xFF);
+    }
+}
+
+auto decodeAlphaBlock(const uint8_t* block, uint8_t* rgba) -> void {
+    int palette[8];
+    alphaPalette(block[0], block[1], palette);
+    uint64_t indices = 0;
+    for (int i = 0; i < 6; ++i) {
+        indices |= static_cast<uint64_t>(block[2 + i]) << (i * 8);
+    }
+    for (uint32_t i = 0; i < BLOCK_TEXELS; ++i) {
+        rgba[i * 4 + 3] = static_cast<uint8_t>(palette[(indices >> (i * 3)) & 7]);
+    }
+}
+
+// 4x4 texels starting at x, y, edges are clamped for levels smaller than a block
+auto gatherBlock(const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t x, uint32_t y, uint8_t* out) -> void {
+    for (uint32_t by = 0; by < BLOCK_SIZE; ++by) {
+        uint32_t sy = std::min(y + by, height - 1);
+        for (uint32_t bx = 0; bx < BLOCK_SIZE; ++bx) {
+            uint32_t sx = std::min(x + bx, width - 1);
+            std::memcpy(out + (by * BLOCK_SIZE + bx) * 4, rgba + (static_cast<size_t>(sy) * width + sx) * 4, 4);
+        }
+    }
+}
+
+auto scatterBlock(const uint8_t* block, uint32_t width, uint32_t height, uint32_t x, uint32_t y, uint8_t* rgba)
+    -> void {
+    for (uint32_t by = 0; by < BLOCK_SIZE && y + by < height; ++by) {
+        for (uint32_t bx = 0; bx < BLOCK_SIZE && x + bx < width; ++bx) {
+            std::memcpy(rgba + (static_cast<size_t>(y + by) * width + x + bx) * 4, block + (by * BLOCK_SIZE + bx) * 4, 4);
+        }
+    }
+}
+
+// mips for the whole chain, bytes for the levels from data.firstLevel on
+auto layoutMips(TextureData& data) -> void {
+    data.mips.clear();
+    uint64_t offset = 0;
+    uint32_t width = data.width;
+    uint32_t height = data.height;
+    uint32_t count = getMipCount(width, height);
+    for (uint32_t level = 0; level < count; ++level) {
+        uint64_t size = getMipByteSize(data.format, width, height);
+        data.mips.push_back({width, height, offset, size});
+        offset += size;
+        width = std::max(1u, width / 2);
+        height = std::max(1u, height / 2);
+    }
+    data.bytes.resize(offset - data.mips[data.firstLevel].offset);
+}
+
+}  // namespace
+
+auto isBlockCompressed(TextureFormat format) -> bool {
+    return format == TextureFormat::BC1 || format == TextureFormat::BC3;
+}
+
+auto getMipByteSize(TextureFormat format, uint32_t width, uint32_t height) -> uint64_t {
+    if (!isBlockCompressed(format)) {
+        return static_cast<uint64_t>(width) * height * 4;
+    }
+    uint64_t blocksX = (width + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    uint64_t blocksY = (height + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    return blocksX * blocksY * getBlockBytes(format);
+}
+
+auto getMipCount(uint32_t width, uint32_t height) -> uint32_t {
+    uint32_t count = 1;
+    while (width > 1 || height > 1) {
+        width = std::max(1u, width / 2);
+        height = std::max(1u, height / 2);
+        ++count;
+    }
+    return count;
+}
+
+auto buildMipChain(const uint8_t* pixels, uint32_t width, uint32_t height, int channels) -> TextureData {
+    TextureData data;
+    data.format = TextureFormat::RGBA8;
+    data.width = width;
+    data.height = height;
+    layoutMips(data);
+    if (data.bytes.empty()) {
+        return data;
+    }
+
+    uint8_t* level0 = data.bytes.data();
+    for (size_t i = 0; i < static_cast<size_t>(width) * height; ++i) {
+        toRgba(pixels + i * channels, channels, level0 + i * 4);
+    }
+
+    // 2x2 box filter, odd edges reuse the last row/column
+    for (size_t level = 1; level < data.mips.size(); ++level) {
+        const TextureMip& src = data.mips[level - 1];
+        const TextureMip& dst = data.mips[level];
+        const uint8_t* srcTexels = data.bytes.data() + src.offset;
+        uint8_t* dstTexels = data.bytes.data() + dst.offset;
+
+        for (uint32_t y = 0; y < dst.height; ++y) {
+            uint32_t y0 = std::min(y * 2, src.height - 1);
+            uint32_t y1 = std::min(y * 2 + 1, src.height - 1);
+            for (uint32_t x = 0; x < dst.width; ++x) {
+                uint32_t x0 = std::min(x * 2, src.width - 1);
+                uint32_t x1 = std::min(x * 2 + 1, src.width - 1);
+                const uint8_t* a = srcTexels + (static_cast<size_t>(y0) * src.width + x0) * 4;
+                const uint8_t* b = srcTexels + (static_cast<size_t>(y0) * src.width + x1) * 4;
+                const uint8_t* c = srcTexels + (static_cast<size_t>(y1) * src.width + x0) * 4;
+                const uint8_t* d = srcTexels + (static_cast<size_t>(y1) * src.width + x1) * 4;
+                uint8_t* out = dstTexels + (static_cast<size_t>(y) * dst.width + x) * 4;
+                for (int channel = 0; channel < 4; ++channel) {
+                    out[channel] = static_cast<uint8_t>((a[channel] + b[channel] + c[channel] + d[channel] + 2) / 4);
+                }
+            }
+        }
+    }
+    return data;
+}
+
+auto compressTexture(const TextureData& rgba, TextureFormat format) -> TextureData {
+    if (!isBlockCompressed(format) || rgba.format != TextureFormat::RGBA8 || rgba.firstLevel != 0) {
+        return rgba;
+    }
+
+    TextureData data;
+    data.format = format;
+    data.width = rgba.width;
+    data.height = rgba.height;
+    layoutMips(data);
+
+    std::array<uint8_t, BLOCK_TEXELS * 4> block{};
+    uint32_t blockBytes = getBlockBytes(format);
+    for (size_t level = 0; level < data.mips.size(); ++level) {
+        const TextureMip& mip = data.mips[level];
+        const uint8_t* texels = rgba.getMipData(level);
+        uint8_t* out = data.getMipData(level);
+        for (uint32_t y = 0; y < mip.height; y += BLOCK_SIZE) {
+            for (uint32_t x = 0; x < mip.width; x += BLOCK_SIZE) {
+                gatherBlock(texels, mip.width, mip.height, x, y, block.data());
+                if (format == TextureFormat::BC1) {
+                    encodeBC1Block(block.data(), out);
+                } else {
+                    encodeBC3Block(block.data(), out);
+                }
+                out += blockBytes;
+            }
+        }
+    }
+    return data;
+}
+
+auto decompressTexture(const TextureData& data) -> TextureData {
+    if (!isBlockCompressed(data.format)) {
+        return data;
+    }
+
+    TextureData rgba;
+    rgba.format = TextureFormat::RGBA8;
+    rgba.width = data.width;
+    rgba.height = data.height;
+    rgba.firstLevel = data.firstLevel;
+    layoutMips(rgba);
+
+    std::array<uint8_t, BLOCK_TEXELS * 4> block{};
+    uint32_t blockBytes = getBlockBytes(data.format);
+    for (size_t level = data.firstLevel; level < rgba.mips.size(); ++level) {
+        const TextureMip& mip = rgba.mips[level];
+        const uint8_t* in = data.getMipData(level);
+        uint8_t* texels = rgba.getMipData(level);
+        for (uint32_t y = 0; y < mip.height; y += BLOCK_SIZE) {
+            for (uint32_t x = 0; x < mip.width; x += BLOCK_SIZE) {
+                if (data.format == TextureFormat::BC1) {
+                    decodeBC1Block(in, block.data());
+                } else {
+                    decodeBC3Block(in, block.data());
+                }
+                scatterBlock(block.data(), mip.width, mip.height, x, y, texels);
+                in += blockBytes;
+            }
+        }
+    }
+    return rgba;
+}
+
+auto getLevelForSize(const TextureData& data, uint32_t maxSize) -> uint32_t {
+    for (uint32_t level = 0; level < data.mips.size(); ++level) {
+        if (std::max(data.mips[level].width, data.mips[level].height) <= maxSize) {
+            return level;
+        }
+    }
+    return data.mips.empty() ? 0 : static_cast<uint32_t>(data.mips.size()) - 1;
+}
+
+auto dropLevels(TextureData& data, uint32_t firstLevel) -> void {
+    if (firstLevel <= data.firstLevel || firstLevel >= data.mips.size()) {
+        return;
+    }
+    auto dropped = data.mips[firstLevel].offset - data.mips[data.firstLevel].offset;
+    data.bytes.erase(data.bytes.begin(), data.bytes.begin() + static_cast<std::ptrdiff_t>(dropped));
+    data.bytes.shrink_to_fit();
+    data.firstLevel = firstLevel;
+}
+
+auto getLevelForScreenSize(uint32_t textureSize, float screenPixels, uint32_t levelCount, float bias) -> uint32_t {
+    if (levelCount == 0) {
+        return 0;
+    }
+    if (screenPixels <= 0.0f || textureSize == 0) {
+        return levelCount - 1;
+    }
+    // one texel per pixel, a texture twice the size of its footprint wants level 1 and so on
+    float ratio = std::max(static_cast<float>(textureSize) / screenPixels, 1.0f);
+    float level = std::floor(std::log2(ratio) + bias);
+    return static_cast<uint32_t>(std::clamp(level, 0.0f, static_cast<float>(levelCount - 1)));
+}
+
+auto fitStreamingBudget(std::vector<StreamingCandidate>& candidates, uint64_t budget) -> uint64_t {
+    uint64_t total = 0;
+    for (const auto& candidate : candidates) {
+        total += (*candidate.bytesFromLevel)[candidate.level];
+    }
+    if (total <= budget) {
+        return total;
+    }
+
+    // ordered so the top is the next one to lose a level
+    auto evictAfter = [&candidates](size_t a, size_t b) {
+        const auto& left = candidates[a];
+        const auto& right = candidates[b];
+        if (left.lastUsedFrame != right.lastUsedFrame) {
+            return left.lastUsedFrame > right.lastUsedFrame;
+        }
+        return (*left.bytesFromLevel)[left.level] < (*right.bytesFromLevel)[right.level];
+    };
+    std::priority_queue<size_t, std::vector<size_t>, decltype(evictAfter)> queue(evictAfter);
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        if (candidates[i].level < candidates[i].tailLevel) {
+            queue.push(i);
+        }
+    }
+
+    while (total > budget && !queue.empty()) {
+        auto index = queue.top();
+        queue.pop();
+        auto& candidate = candidates[index];
+        const auto& bytes = *candidate.bytesFromLevel;
+        total -= bytes[candidate.level] - bytes[candidate.level + 1];
+        candidate.level++;
+        if (candidate.level < candidate.tailLevel) {
+            queue.push(index);
+        }
+    }
+    return total;
+}
+
+auto chooseBlockFormat(const TextureData& rgba) -> TextureFormat {
+    if (rgba.mips.empty()) {
+        return TextureFormat::BC1;
+    }
+    const uint8_t* texels = rgba.getMipData(0);
+    for (uint64_t i = 3; i < rgba.mips[0].size; i += 4) {
+        if (texels[i] != 255) {
+            return TextureFormat::BC3;
+        }
+    }
+    return TextureFormat::BC1;
+}
+
+auto buildTexture(const uint8_t* pixels, uint32_t width, uint32_t height, int channels, TextureCompression compression)
+    -> TextureData {
+    auto rgba = buildMipChain(pixels, width, height, channels);
+    switch (compression) {
+        case TextureCompression::None:
+            return rgba;
+        case TextureCompression::Auto:
+            // no alpha channel in the source, the expanded alpha is all 255
+            return compressTexture(rgba, channels == 2 || channels == 4 ? chooseBlockFormat(rgba) : TextureFormat::BC1);
+        case TextureCompression::BC1:
+            return compressTexture(rgba, TextureFormat::BC1);
+        case TextureCompression::BC3:
+            return compressTexture(rgba, TextureFormat::BC3);
+    }
+    return rgba;
+}
+
+auto encodeBC1Block(const uint8_t* rgba, uint8_t* out) -> void {
+    encodeColorBlock(rgba, out);
+}
+
+auto encodeBC3Block(const uint8_t* rgba, uint8_t* out) -> void {
+    encodeAlphaBlock(rgba, out);
+    encodeColorBlock(rgba, out + 8);
+}
+
+auto decodeBC1Block(const uint8_t* block, uint8_t* rgba) -> void {
+    decodeColorBlock(block, rgba, true);
+}
+
+auto decodeBC3Block(const uint8_t* block, uint8_t* rgba) -> void {
+    decodeColorBlock(block + 8, rgba, false);
+    decodeAlphaBlock(block, rgba);
+}
+
+}  // namespace Vengine
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Vengine {
+
+// RGBA8 is 4 bytes per texel, the BC formats are 4x4 blocks of 8 (BC1) or 16 (BC3) bytes
+enum class TextureFormat : uint32_t {
+    RGBA8 = 0,
+    BC1 = 1,  // opaque rgb, 4 bpp
+    BC3 = 2,  // rgb + interpolated alpha, 8 bpp
+};
+
+// what a freshly imported texture is encoded to
+enum class TextureCompression : uint32_t {
+    None = 0,  // RGBA8 mips
+    Auto,      // BC1 for rgb and opaque textures, BC3 with alpha
+    BC1,
+    BC3,
+};
+
+struct TextureMip {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint64_t offset = 0;  // into TextureData::bytes
+    uint64_t size = 0;
+};
+
+// a mip chain, level 0 first, all levels in one allocation. no gl objects.
+// mips always describes the whole chain, bytes only holds levels from firstLevel on (streaming)
+struct TextureData {
+    TextureFormat format = TextureFormat::RGBA8;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t firstLevel = 0;
+    std::vector<TextureMip> mips;
+    std::vector<uint8_t> bytes;
+
+    [[nodiscard]] auto getMipData(size_t level) const -> const uint8_t* {
+        return bytes.data() + (mips[level].offset - mips[firstLevel].offset);
+    }
+    [[nodiscard]] auto getMipData(size_t level) -> uint8_t* {
+        return bytes.data() + (mips[level].offset - mips[firstLevel].offset);
+    }
+};
+
+[[nodiscard]] auto isBlockCompressed(TextureFormat format) -> bool;
+[[nodiscard]] auto getMipByteSize(TextureFormat format, uint32_t width, uint32_t height) -> uint64_t;
+[[nodiscard]] auto getMipCount(uint32_t width, uint32_t height) -> uint32_t;
+
+// box filtered chain down to 1x1, channels is 1-4 and the result is always RGBA8
+auto buildMipChain(const uint8_t* pixels, uint32_t width, uint32_t height, int channels) -> TextureData;
+
+// every level of a full RGBA8 chain encoded to format, RGBA8 returns a copy
+auto compressTexture(const TextureData& rgba, TextureFormat format) -> TextureData;
+// back to RGBA8, for drivers without s3tc and for checking the encoder
+auto decompressTexture(const TextureData& data) -> TextureData;
+
+// first level that is at most maxSize texels on its longer side, the last level if none is
+[[nodiscard]] auto getLevelForSize(const TextureData& data, uint32_t maxSize) -> uint32_t;
+// frees the bytes of every level below firstLevel
+auto dropLevels(TextureData& data, uint32_t firstLevel) -> void;
+
+// streaming policy, kept free of gl so it can be tested.
+// finest level worth having for a texture of textureSize texels (longer side) that covers
+// screenPixels on screen, bias > 0 goes blurrier. nothing on screen means the last level
+[[nodiscard]] auto getLevelForScreenSize(uint32_t textureSize, float screenPixels, uint32_t levelCount, float bias = 0.0f)
+    -> uint32_t;
+
+struct StreamingCandidate {
+    uint32_t level = 0;  // wanted level, fitStreamingBudget raises it
+    uint32_t tailLevel = 0;  // never goes coarser than this
+    uint64_t lastUsedFrame = 0;
+    const std::vector<uint64_t>* bytesFromLevel = nullptr;  // [l] = memory of levels [l, count)
+};
+
+// drops one level at a time from the least recently used textures, biggest first among those
+// used in the same frame, until everything fits in budget or sits at its tail. returns the total
+auto fitStreamingBudget(std::vector<StreamingCandidate>& candidates, uint64_t budget) -> uint64_t;
+
+// BC3 if any texel is not fully opaque, BC1 otherwise
+[[nodiscard]] auto chooseBlockFormat(const TextureData& rgba) -> TextureFormat;
+
+// decoded pixels to a finished mip chain, what the import tool and a cache miss both do
+auto buildTexture(const uint8_t* pixels, uint32_t width, uint32_t height, int channels, TextureCompression compression)
+    -> TextureData;
+
+// single 4x4 blocks, texels are row major rgba
+auto encodeBC1Block(const uint8_t* rgba, uint8_t* out) -> void;
+auto encodeBC3Block(const uint8_t* rgba, uint8_t* out) -> void;
+auto decodeBC1Block(const uint8_t* block, uint8_t* rgba) -> void;
+auto decodeBC3Block(const uint8_t* block, uint8_t* rgba) -> void;
+
+}  // namespace Vengine
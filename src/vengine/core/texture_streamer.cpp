@@ -0,0 +1,182 @@
+#include "texture_streamer.hpp"
+
+#include <algorithm>
+#include <spdlog/spdlog.h>
+
+namespace Vengine {
+
+TextureStreamer::TextureStreamer(std::shared_ptr<ThreadManager> threadManager, TextureStreamerConfig config)
+    : m_threadManager(std::move(threadManager)), m_config(config) {
+}
+
+auto TextureStreamer::add(const std::shared_ptr<Texture>& texture) -> void {
+    std::lock_guard<std::mutex> lock(m_incomingMutex);
+    m_incoming.push_back(texture);
+}
+
+auto TextureStreamer::requestScreenSize(const std::shared_ptr<Texture>& texture, float screenPixels) -> void {
+    auto it = m_entries.find(texture->getSerial());
+    if (it == m_entries.end() || it->second->bytesFromLevel.empty()) {
+        return;
+    }
+    auto& entry = *it->second;
+    auto level = getLevelForScreenSize(texture->getLevelSize(0), screenPixels, texture->getLevelCount(), m_config.lodBias);
+    if (entry.requestFrame != m_frame) {
+        entry.requestFrame = m_frame;
+        entry.requestedLevel = level;
+    } else {
+        entry.requestedLevel = std::min(entry.requestedLevel, level);
+    }
+}
+
+auto TextureStreamer::update() -> void {
+    {
+        std::lock_guard<std::mutex> lock(m_incomingMutex);
+        for (auto& weak : m_incoming) {
+            if (auto texture = weak.lock()) {
+                auto entry = std::make_shared<Entry>();
+                entry->texture = texture;
+                m_entries.emplace(texture->getSerial(), std::move(entry));
+            }
+        }
+        m_incoming.clear();
+    }
+
+    std::vector<StreamingCandidate> candidates;
+    std::vector<std::pair<std::shared_ptr<Entry>, std::shared_ptr<Texture>>> streamed;
+    candidates.reserve(m_entries.size());
+    streamed.reserve(m_entries.size());
+
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        auto texture = it->second->texture.lock();
+        if (!texture) {
+            it = m_entries.erase(it);
+            continue;
+        }
+        auto entryPtr = it->second;
+        auto& entry = *entryPtr;
+        ++it;
+
+        // still loading, or it fell back to a plain upload because the cache was off
+        if (!texture->isStreamable() || texture->getTextureID() == 0 || texture->getLevelCount() == 0) {
+            continue;
+        }
+        if (entry.bytesFromLevel.empty()) {
+            for (uint32_t level = 0; level < texture->getLevelCount(); ++level) {
+                entry.bytesFromLevel.push_back(texture->getResidentBytes(level));
+            }
+            entry.lastUsedFrame = m_frame;
+        }
+
+        auto tail = texture->getTailLevel();
+        uint32_t wanted = texture->getResidentLevel();
+        if (entry.requestFrame == m_frame) {
+            wanted = entry.requestedLevel;
+            entry.lastUsedFrame = m_frame;
+        } else if (m_frame - entry.lastUsedFrame > m_config.idleFrames) {
+            wanted = tail;
+        }
+        if (entry.failed) {
+            wanted = std::max(wanted, texture->getResidentLevel());
+        }
+
+        candidates.push_back({std::min(wanted, tail), tail, entry.lastUsedFrame, &entry.bytesFromLevel});
+        streamed.emplace_back(std::move(entryPtr), std::move(texture));
+    }
+
+    fitStreamingBudget(candidates, m_config.budgetBytes);
+
+    // evictions first so the memory is free before anything new comes in
+    m_residentBytes = 0;
+    for (size_t i = 0; i < streamed.size(); ++i) {
+        auto& [entry, texture] = streamed[i];
+        auto wanted = candidates[i].level;
+        if (wanted > texture->getResidentLevel()) {
+            texture->setResidentLevel(wanted, nullptr);
+        }
+        m_residentBytes += entry->bytesFromLevel[texture->getResidentLevel()];
+    }
+
+    // most useful loads first, the in flight limit keeps a camera cut from flooding the workers
+    std::vector<size_t> loads;
+    for (size_t i = 0; i < streamed.size(); ++i) {
+        const auto& [entry, texture] = streamed[i];
+        if (candidates[i].level < texture->getResidentLevel() && !entry->loading) {
+            loads.push_back(i);
+        }
+    }
+    std::sort(loads.begin(), loads.end(), [&candidates](size_t a, size_t b) {
+        return candidates[a].lastUsedFrame > candidates[b].lastUsedFrame;
+    });
+    for (auto i : loads) {
+        if (m_loadsInFlight >= m_config.maxLoadsInFlight) {
+            break;
+        }
+        startLoad(streamed[i].first, streamed[i].second, candidates[i].level);
+    }
+
+    ++m_frame;
+}
+
+auto TextureStreamer::startLoad(const std::shared_ptr<Entry>& entry,
+                                const std::shared_ptr<Texture>& texture,
+                                uint32_t level) -> void {
+    entry->loading = true;
+    ++m_loadsInFlight;
+
+    auto resident = texture->getResidentLevel();
+    m_threadManager->enqueueTask(
+        [this, entry, texture, level, resident]() {
+            auto data = std::make_shared<TextureData>();
+            bool loaded = texture->loadLevels(level, resident, *data);
+            auto costHint = static_cast<uint32_t>(data->bytes.size() / 1000);
+            m_threadManager->enqueueMainThreadTask(
+                [this, entry, texture, level, resident, data, loaded]() {
+                    entry->loading = false;
+                    --m_loadsInFlight;
+                    if (!loaded) {
+                        // cache entry gone or stale, don't retry every frame
+                        spdlog::warn("TextureStreamer: could not load levels {}-{} of {}",
+                                     level,
+                                     resident - 1,
+                                     texture->getName());
+                        entry->failed = true;
+                        return;
+                    }
+                    // evicted in the meantime, the new levels don't line up anymore
+                    if (texture->getResidentLevel() != resident) {
+                        return;
+                    }
+                    texture->setResidentLevel(level, data.get());
+                },
+                "Stream texture: " + texture->getName(),
+                TaskPriority::Low,
+                costHint);
+        },
+        "Stream texture: " + texture->getName(),
+        TaskPriority::Low);
+}
+
+auto TextureStreamer::getStats() const -> std::vector<TextureStreamingInfo> {
+    std::vector<TextureStreamingInfo> stats;
+    stats.reserve(m_entries.size());
+    for (const auto& [key, entry] : m_entries) {
+        auto texture = entry->texture.lock();
+        if (!texture || entry->bytesFromLevel.empty()) {
+            continue;
+        }
+        TextureStreamingInfo info;
+        info.name = texture->getName();
+        info.levelCount = texture->getLevelCount();
+        info.residentLevel = texture->getResidentLevel();
+        info.requestedLevel = entry->requestFrame + 1 >= m_frame ? entry->requestedLevel : texture->getTailLevel();
+        info.tailLevel = texture->getTailLevel();
+        info.residentBytes = entry->bytesFromLevel[info.residentLevel];
+        info.loading = entry->loading;
+        stats.push_back(std::move(info));
+    }
+    std::sort(stats.begin(), stats.end(), [](const auto& a, const auto& b) { return a.residentBytes > b.residentBytes; });
+    return stats;
+}
+
+}  // namespace Vengine
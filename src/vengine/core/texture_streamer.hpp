@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "vengine/core/resources.hpp"
+#include "vengine/core/thread_manager.hpp"
+
+namespace Vengine {
+
+struct TextureStreamerConfig {
+    bool enabled = true;
+    uint64_t budgetBytes = 256ull * 1024 * 1024;
+    uint32_t tailSize = 64;  // textures start out with the levels up to this many texels
+    uint32_t maxLoadsInFlight = 4;
+    uint32_t idleFrames = 300;  // not drawn for this long and a texture drops back to its tail
+    float lodBias = 0.0f;
+};
+
+// per texture, for tuning
+struct TextureStreamingInfo {
+    std::string name;
+    uint32_t levelCount = 0;
+    uint32_t residentLevel = 0;
+    uint32_t requestedLevel = 0;
+    uint32_t tailLevel = 0;
+    uint64_t residentBytes = 0;
+    bool loading = false;
+};
+
+// keeps streamed textures at the mip level their on-screen size needs. the renderer calls
+// requestScreenSize() for every texture it draws, update() once a frame then evicts levels to
+// stay inside the budget and loads missing levels from the texture cache on workers. the gpu side
+// runs on the main thread, the new levels show up a frame or two after they were asked for
+class TextureStreamer {
+   public:
+    explicit TextureStreamer(std::shared_ptr<ThreadManager> threadManager, TextureStreamerConfig config = {});
+
+    // any thread, the texture is picked up once it is on the gpu
+    auto add(const std::shared_ptr<Texture>& texture) -> void;
+
+    // main thread. screenPixels is the size of the texture's footprint on screen, requests
+    // within a frame keep the finest level
+    auto requestScreenSize(const std::shared_ptr<Texture>& texture, float screenPixels) -> void;
+    auto update() -> void;
+
+    [[nodiscard]] auto getStats() const -> std::vector<TextureStreamingInfo>;
+    [[nodiscard]] auto getResidentBytes() const -> uint64_t {
+        return m_residentBytes;
+    }
+    [[nodiscard]] auto getStreamedCount() const -> size_t {
+        return m_entries.size();
+    }
+    [[nodiscard]] auto getLoadsInFlight() const -> uint32_t {
+        return m_loadsInFlight;
+    }
+
+    auto setBudget(uint64_t bytes) -> void {
+        m_config.budgetBytes = bytes;
+    }
+    [[nodiscard]] auto getBudget() const -> uint64_t {
+        return m_config.budgetBytes;
+    }
+    [[nodiscard]] auto isEnabled() const -> bool {
+        return m_config.enabled;
+    }
+    [[nodiscard]] auto getConfig() const -> const TextureStreamerConfig& {
+        return m_config;
+    }
+
+   private:
+    struct Entry {
+        std::weak_ptr<Texture> texture;
+        std::vector<uint64_t> bytesFromLevel;
+        uint32_t requestedLevel = 0;
+        uint64_t requestFrame = 0;  // frames start at 1, 0 is never
+        uint64_t lastUsedFrame = 0;
+        bool loading = false;
+        bool failed = false;
+    };
+
+    auto startLoad(const std::shared_ptr<Entry>& entry, const std::shared_ptr<Texture>& texture, uint32_t level)
+        -> void;
+
+    std::shared_ptr<ThreadManager> m_threadManager;
+    TextureStreamerConfig m_config;
+
+    // main thread only, add() goes through m_incoming. keyed by Texture::getSerial(), a new
+    // texture at the address of a freed one must not pick up its entry
+    std::unordered_map<uint64_t, std::shared_ptr<Entry>> m_entries;
+    std::vector<std::weak_ptr<Texture>> m_incoming;
+    std::mutex m_incomingMutex;
+
+    uint64_t m_frame = 1;
+    uint64_t m_residentBytes = 0;
+    uint32_t m_loadsInFlight = 0;
+};
+
+}  // namespace Vengine
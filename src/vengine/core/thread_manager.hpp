@@ -1,15 +1,21 @@
 #pragma once
 
+#include <algorithm>
 #include <vector>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
 #include <functional>
-#include <queue>
 #include <atomic>
 #include <future>
 #include <memory>
+#include <cassert>
+#include <chrono>
 #include <spdlog/spdlog.h>
+#include "vengine/core/cpu_topology.hpp"
+#include "vengine/core/mpsc_queue.hpp"
+#include "vengine/core/task_profiler.hpp"
+#include "vengine/core/wait_group.hpp"
 
 namespace Vengine {
 
@@ -19,34 +25,105 @@ struct Task {
     std::function<void()> function;
     TaskPriority priority = TaskPriority::Normal;
     std::string name;
+    std::shared_ptr<WaitGroup> group;
+    uint64_t enqueueNs = 0;  // only set while the profiler is enabled
+    uint64_t sequence = 0;
+    uint32_t costHintUs = 0;  // estimated run time for main thread tasks, 0 = unknown
 
-    // order tasks by priority
+    // order tasks by priority, same priority in enqueue order
     bool operator<(const Task& other) const {
-        return priority < other.priority;
+        if (priority != other.priority) {
+            return priority < other.priority;
+        }
+        return sequence > other.sequence;
     }
 };
 
+// max heap of tasks. std::priority_queue only hands out a const top(), taking a task from it copies
+// the std::function and everything it captured, pop() here moves it out instead
+class TaskHeap {
+   public:
+    auto push(Task task) -> void {
+        m_tasks.push_back(std::move(task));
+        std::push_heap(m_tasks.begin(), m_tasks.end());
+    }
+    [[nodiscard]] auto top() const -> const Task& {
+        return m_tasks.front();
+    }
+    auto pop() -> Task {
+        std::pop_heap(m_tasks.begin(), m_tasks.end());
+        Task task = std::move(m_tasks.back());
+        m_tasks.pop_back();
+        return task;
+    }
+    [[nodiscard]] auto empty() const -> bool {
+        return m_tasks.empty();
+    }
+    [[nodiscard]] auto size() const -> size_t {
+        return m_tasks.size();
+    }
+
+   private:
+    std::vector<Task> m_tasks;
+};
+
+struct ThreadManagerConfig {
+    size_t threadCount = 0;          // 0 = derive it from the cpu topology
+    bool preferPhysicalCores = true;  // one worker per physical core, smt siblings stay free
+    size_t reservedCores = 1;        // physical cores left to the main/render thread
+    size_t externalThreads = 0;      // threads of other pools (jolt, audio) to leave room for
+    bool pinWorkers = false;         // pin each worker to its own core, needs reservedCores to be useful
+    bool nameThreads = true;         // os visible thread names, shows up in perf, htop and debuggers
+};
+
 class ThreadManager {
    public:
-    ThreadManager(size_t threadCount = 0) {
+    static constexpr size_t MAIN_THREAD_QUEUE_CAPACITY = 4096;
+
+    explicit ThreadManager(ThreadManagerConfig config = {})
+        : m_config(config), m_topology(CpuTopology::detect()) {
+        size_t reserved = std::min(m_config.reservedCores, m_topology.physicalCount() - 1);
+        for (size_t i = 0; i < m_topology.physicalCount(); ++i) {
+            const auto& cpus = m_topology.cores[i].logicalCpus;
+            if (i < reserved) {
+                m_reservedCpus.insert(m_reservedCpus.end(), cpus.begin(), cpus.end());
+            } else if (m_config.preferPhysicalCores) {
+                m_workerCpuSets.push_back(cpus);
+            } else {
+                for (auto cpu : cpus) {
+                    m_workerCpuSets.push_back({cpu});
+                }
+            }
+        }
+
+        size_t threadCount = m_config.threadCount;
         if (threadCount == 0) {
-            // -1 to leave one thread for the main thread
-            threadCount = std::max<size_t>(1, std::thread::hardware_concurrency() - 1);
+            size_t available = m_workerCpuSets.size();
+            threadCount = available > m_config.externalThreads ? available - m_config.externalThreads : 1;
         }
 
-        spdlog::debug("Constructor ThreadManager, {} worker threads", threadCount);
+        spdlog::debug("Constructor ThreadManager, {} worker threads ({} physical cores, {} logical, {} reserved)",
+                      threadCount,
+                      m_topology.physicalCount(),
+                      m_topology.logicalCount,
+                      reserved);
         startWorkers(threadCount);
     }
 
+    explicit ThreadManager(size_t threadCount) : ThreadManager(ThreadManagerConfig{.threadCount = threadCount}) {
+    }
+
     ~ThreadManager() {
         spdlog::debug("Destructor ThreadManager");
         shutdown();
     }
 
+    // group is optional, it gets add() now and done() once the task has run
     template <typename F>
     auto enqueueTask(F&& func,
                      const std::string& name = "",
-                     TaskPriority priority = TaskPriority::Normal) -> std::future<decltype(func())> {
+                     TaskPriority priority = TaskPriority::Normal,
+                     std::shared_ptr<WaitGroup> group = nullptr) -> std::future<decltype(func())> {
         using ReturnType = decltype(func());
 
         auto task = std::make_shared<std::packaged_task<ReturnType()>>(std::forward<F>(func));
@@ -56,80 +133,215 @@ class ThreadManager {
         wrappedTask.name = name;
         wrappedTask.priority = priority;
         wrappedTask.function = [task]() { (*task)(); };
+        wrappedTask.group = std::move(group);
+        wrappedTask.sequence = m_nextSequence.fetch_add(1, std::memory_order_relaxed);
+        if (m_profiler.isEnabled()) {
+            wrappedTask.enqueueNs = TaskProfiler::now();
+        }
+
+        // count before the task is visible, so a task that enqueues a child task
+        // keeps the counters above zero until the child is done too
+        m_allTasks.add();
+        if (wrappedTask.group) {
+            wrappedTask.group->add();
+        }
 
         {
             std::lock_guard<std::mutex> lock(m_queueMutex);
             m_tasks.push(std::move(wrappedTask));
         }
         m_condition.notify_one();
+        if (m_waiterCount.load(std::memory_order_acquire) > 0) {
+            m_completionCondition.notify_all();
+        }
 
         return result;
     }
 
+    // costHintUs is what the task is expected to take on the main thread, used against the frame budget
     template <typename F>
-    void enqueueMainThreadTask(F&& func, const std::string& name = "") {
+    void enqueueMainThreadTask(F&& func,
+                               const std::string& name = "",
+                               TaskPriority priority = TaskPriority::Normal,
+                               uint32_t costHintUs = 0) {
         Task task;
         task.function = std::forward<F>(func);
         task.name = name;
-        task.priority = TaskPriority::Normal;
+        task.priority = priority;
+        task.costHintUs = costHintUs;
+        task.sequence = m_nextSequence.fetch_add(1, std::memory_order_relaxed);
+        if (m_profiler.isEnabled()) {
+            task.enqueueNs = TaskProfiler::now();
+        }
 
-        std::lock_guard<std::mutex> lock(m_mainThreadMutex);
-        m_mainThreadTasks.push(std::move(task));
+        if (!m_mainThreadQueue.tryPush(std::move(task))) {
+            // queue full, rare. the main thread picks these up on its next frame as well
+            std::lock_guard<std::mutex> lock(m_mainThreadOverflowMutex);
+            m_mainThreadOverflow.push_back(std::move(task));
+            m_hasMainThreadOverflow.store(true, std::memory_order_release);
+        }
     }
 
+    // runs main thread tasks by priority until the frame budget is used up, the rest waits for
+    // the next frame. at least one task runs per call so nothing starves, critical tasks ignore the budget.
     void processMainThreadTasks() {
-        std::queue<Task> tasks;
-        {
-            std::lock_guard<std::mutex> lock(m_mainThreadMutex);
-            tasks.swap(m_mainThreadTasks);
+        Task incoming;
+        while (m_mainThreadQueue.tryPop(incoming)) {
+            m_pendingMainThreadTasks.push(std::move(incoming));
         }
+        if (m_hasMainThreadOverflow.load(std::memory_order_acquire)) {
+            std::lock_guard<std::mutex> lock(m_mainThreadOverflowMutex);
+            for (auto& task : m_mainThreadOverflow) {
+                m_pendingMainThreadTasks.push(std::move(task));
+            }
+            m_mainThreadOverflow.clear();
+            m_hasMainThreadOverflow.store(false, std::memory_order_release);
+        }
+
+        auto frameStart = std::chrono::steady_clock::now();
+        auto budget = m_mainThreadBudget;
+        size_t executed = 0;
 
-        while (!tasks.empty()) {
-            Task& task = tasks.front();
+        while (!m_pendingMainThreadTasks.empty()) {
+            const Task& next = m_pendingMainThreadTasks.top();
+
+            if (budget.count() > 0 && executed > 0 && next.priority != TaskPriority::Critical) {
+                auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - frameStart);
+                auto estimate = next.costHintUs > 0 ? next.costHintUs : static_cast<uint32_t>(m_averageMainThreadTaskUs);
+                if (elapsed + std::chrono::microseconds(estimate) > budget) {
+                    break;
+                }
+            }
+
+            Task task = m_pendingMainThreadTasks.pop();
+            auto taskStart = std::chrono::steady_clock::now();
 
             try {
                 spdlog::debug("Main thread executing task: {}", task.name);
-                task.function();
-                {
-                    std::lock_guard<std::mutex> lock(m_mainThreadMutex);
-                    ++m_completedMainThreadTasks;
+                if (m_profiler.isEnabled()) {
+                    if (!m_mainThreadNamed) {
+                        m_profiler.setThreadName("Main thread");
+                        m_mainThreadNamed = true;
+                    }
+                    auto startNs = TaskProfiler::now();
+                    task.function();
+                    m_profiler.record(task.name, task.enqueueNs, startNs, TaskProfiler::now());
+                } else {
+                    task.function();
                 }
+                m_completedMainThreadTasks.fetch_add(1, std::memory_order_relaxed);
             } catch (const std::exception& e) {
                 spdlog::error("Exception in main thread task '{}': {}", task.name, e.what());
             }
 
-            tasks.pop();
+            // running average for tasks without a cost hint
+            auto taskUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - taskStart).count();
+            m_averageMainThreadTaskUs = m_averageMainThreadTaskUs * 0.9 + taskUs * 0.1;
+            ++executed;
         }
+
+        m_lastMainThreadFrameUs = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - frameStart)
+                .count());
+        m_lastMainThreadTasksRun = executed;
+    }
+
+    // 0 disables the budget and drains the whole queue every frame
+    auto setMainThreadBudget(std::chrono::microseconds budget) -> void {
+        m_mainThreadBudget = budget;
+    }
+
+    [[nodiscard]] auto getMainThreadBudget() const -> std::chrono::microseconds {
+        return m_mainThreadBudget;
+    }
+
+    // time processMainThreadTasks spent running tasks in the last frame
+    [[nodiscard]] auto getLastMainThreadFrameTime() const -> uint64_t {
+        return m_lastMainThreadFrameUs;
+    }
+
+    [[nodiscard]] auto getLastMainThreadTasksRun() const -> size_t {
+        return m_lastMainThreadTasksRun;
     }
 
+    // tasks pushed to a later frame because the budget ran out
+    [[nodiscard]] auto getDeferredMainThreadTaskCount() const -> size_t {
+        return m_pendingMainThreadTasks.size();
+    }
+
+    // waits until every task enqueued so far (and every task those enqueue) has finished.
+    // not from a task, the calling task counts too and never finishes, wait on a WaitGroup there
     void waitForCompletion() {
-        bool tasksInQueue = false;
-        {
-            std::lock_guard<std::mutex> lock(m_queueMutex);
-            tasksInQueue = !m_tasks.empty();
-        }
-
-        if (!tasksInQueue) {
-            std::unique_lock<std::mutex> lock(m_busyMutex);
-            m_completionCondition.wait(lock, [this] { return m_busyCount == 0; });
-        } else {
-            while (true) {
-                {
-                    std::unique_lock<std::mutex> lock(m_busyMutex);
-                    if (m_busyCount == 0) {
-                        std::lock_guard<std::mutex> queueLock(m_queueMutex);
-                        if (m_tasks.empty()) {
-                            break;
-                        }
-                    } else {
-                        m_completionCondition.wait_for(lock, std::chrono::milliseconds(10));
-                    }
+        assert(!isWorkerThread() && "waitForCompletion from a worker waits for itself, use a WaitGroup");
+        if (isWorkerThread()) {
+            spdlog::error("ThreadManager: waitForCompletion called from a worker, not waiting");
+            return;
+        }
+        wait(m_allTasks);
+    }
+
+    // true on the workers of this manager
+    [[nodiscard]] auto isWorkerThread() const -> bool {
+        return t_workerOf == this;
+    }
+
+    // the calling thread runs queued tasks itself while the group is not done,
+    // and only sleeps when there is nothing left to help with
+    void wait(WaitGroup& group) {
+        m_waiterCount.fetch_add(1, std::memory_order_acq_rel);
+
+        while (!group.isDone()) {
+            Task task;
+            {
+                std::unique_lock<std::mutex> lock(m_queueMutex);
+                m_completionCondition.wait(lock, [this, &group] { return group.isDone() || !m_tasks.empty(); });
+
+                if (group.isDone()) {
+                    break;
                 }
 
-                // small sleep
-                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                task = m_tasks.pop();
             }
+
+            runTask(task);
         }
+
+        m_waiterCount.fetch_sub(1, std::memory_order_acq_rel);
+    }
+
+    auto wait(const std::shared_ptr<WaitGroup>& group) -> void {
+        assert(group != nullptr && "WaitGroup cannot be null");
+        wait(*group);
+    }
+
+    // wait() for the main thread, for groups that also count main thread tasks (finalizing a load).
+    // those would otherwise only run in the next frame, so they run here in between helping the workers
+    void waitOnMainThread(WaitGroup& group) {
+        m_waiterCount.fetch_add(1, std::memory_order_acq_rel);
+
+        while (!group.isDone()) {
+            processMainThreadTasks();
+
+            Task task;
+            {
+                std::unique_lock<std::mutex> lock(m_queueMutex);
+                // main thread tasks don't notify anyone, so only nap briefly
+                m_completionCondition.wait_for(lock, std::chrono::milliseconds(1), [this, &group] {
+                    return group.isDone() || !m_tasks.empty();
+                });
+
+                if (group.isDone() || m_tasks.empty()) {
+                    continue;
+                }
+
+                task = m_tasks.pop();
+            }
+
+            runTask(task);
+        }
+
+        m_waiterCount.fetch_sub(1, std::memory_order_acq_rel);
     }
 
     void shutdown() {
@@ -154,12 +366,43 @@ class ThreadManager {
         return m_workers.size();
     }
 
+    [[nodiscard]] auto getTopology() const -> const CpuTopology& {
+        return m_topology;
+    }
+
+    [[nodiscard]] auto getConfig() const -> const ThreadManagerConfig& {
+        return m_config;
+    }
+
+    // logical cpus of the cores workers stay away from
+    [[nodiscard]] auto getReservedCpus() const -> const std::vector<uint32_t>& {
+        return m_reservedCpus;
+    }
+
+    // call from the main or render thread to move it onto the reserved cores
+    auto pinCurrentThreadToReservedCores() const -> bool {
+        if (!setCurrentThreadAffinity(m_reservedCpus)) {
+            spdlog::warn("ThreadManager: could not pin thread to the reserved cores");
+            return false;
+        }
+        return true;
+    }
+
     [[nodiscard]] auto getActiveTaskCount() const -> size_t {
         return m_tasks.size();
     }
 
+    // queued plus currently running tasks
+    [[nodiscard]] auto getPendingTaskCount() const -> size_t {
+        return m_allTasks.getPending();
+    }
+
     [[nodiscard]] auto getMainThreadTaskCount() const -> size_t {
-        return m_mainThreadTasks.size();
+        return m_mainThreadQueue.size() + m_pendingMainThreadTasks.size();
+    }
+
+    [[nodiscard]] auto getMainThreadQueueStats() const -> MpscQueueStats {
+        return m_mainThreadQueue.getStats();
     }
 
     auto getCompletedTasks() -> size_t {
@@ -168,14 +411,32 @@ class ThreadManager {
     }
 
     auto getCompletedMainThreadTasks() -> size_t {
-        std::lock_guard<std::mutex> lock(m_mainThreadMutex);
-        return m_completedMainThreadTasks;
+        return m_completedMainThreadTasks.load(std::memory_order_relaxed);
+    }
+
+    // disabled by default, see TaskProfiler
+    [[nodiscard]] auto getProfiler() -> TaskProfiler& {
+        return m_profiler;
     }
 
    private:
     void startWorkers(size_t threadCount) {
         for (size_t i = 0; i < threadCount; ++i) {
-            m_workers.emplace_back([this] {
+            m_workers.emplace_back([this, i] {
+                t_workerOf = this;
+                auto threadName = "Worker " + std::to_string(i);
+                m_profiler.setThreadName(threadName);
+                if (m_config.nameThreads) {
+                    setCurrentThreadName(threadName);
+                }
+                if (m_config.pinWorkers && !m_workerCpuSets.empty()) {
+                    // more workers than cores only happens with an explicit threadCount, wrap around then
+                    const auto& cpus = m_workerCpuSets[i % m_workerCpuSets.size()];
+                    if (!setCurrentThreadAffinity(cpus)) {
+                        spdlog::warn("ThreadManager: could not pin worker {} to cpu {}", i, cpus.front());
+                    }
+                }
+
                 while (true) {
                     Task task;
 
@@ -188,37 +449,11 @@ class ThreadManager {
                         }
 
                         if (!m_tasks.empty()) {
-                            task = m_tasks.top();
-                            m_tasks.pop();
+                            task = m_tasks.pop();
                         }
                     }
 
-                    if (task.function) {
-                        {
-                            std::lock_guard<std::mutex> lock(m_busyMutex);
-                            ++m_busyCount;
-                        }
-
-                        try {
-                            // if (!task.name.empty()) {
-                                // spdlog::debug("ThreadManager executing task: {}", task.name);
-                            // }
-                            task.function();
-                        } catch (const std::exception& e) {
-                            spdlog::error("Exception in task '{}': {}", task.name, e.what());
-                        }
-
-                        {
-                            std::lock_guard<std::mutex> lock(m_busyMutex);
-                            --m_busyCount;
-                        }
-
-                        {
-                            std::lock_guard<std::mutex> lock(m_queueMutex);
-                            ++m_completedTasks;
-                        }
-                        m_completionCondition.notify_all();
-                    }
+                    runTask(task);
                 }
 
                 // spdlog::debug("Worker thread {} exiting", i);
@@ -226,21 +461,76 @@ class ThreadManager {
         }
     }
 
+    // used by the workers and by threads helping out in wait()
+    void runTask(Task& task) {
+        if (!task.function) {
+            return;
+        }
+
+        try {
+            // if (!task.name.empty()) {
+                // spdlog::debug("ThreadManager executing task: {}", task.name);
+            // }
+            if (m_profiler.isEnabled()) [[unlikely]] {
+                auto startNs = TaskProfiler::now();
+                task.function();
+                m_profiler.record(task.name, task.enqueueNs, startNs, TaskProfiler::now());
+            } else {
+                task.function();
+            }
+        } catch (const std::exception& e) {
+            spdlog::error("Exception in task '{}': {}", task.name, e.what());
+        }
+
+        if (task.group) {
+            task.group->done();
+        }
+        m_allTasks.done();
+
+        {
+            std::lock_guard<std::mutex> lock(m_queueMutex);
+            ++m_completedTasks;
+        }
+        m_completionCondition.notify_all();
+    }
+
+    static inline thread_local const ThreadManager* t_workerOf = nullptr;
+
+    ThreadManagerConfig m_config;
+    CpuTopology m_topology;
+    std::vector<uint32_t> m_reservedCpus;
+    std::vector<std::vector<uint32_t>> m_workerCpuSets;  // one entry per core a worker may be pinned to
+
     std::vector<std::thread> m_workers;
-    std::priority_queue<Task> m_tasks;
+    TaskHeap m_tasks;
     std::mutex m_queueMutex;
-    std::mutex m_busyMutex;
     std::condition_variable m_condition;
     std::condition_variable m_completionCondition;
     std::atomic<bool> m_shutdown{false};
-    std::atomic<size_t> m_busyCount{0};
 
-    std::queue<Task> m_mainThreadTasks;
-    std::mutex m_mainThreadMutex;
+    // every enqueued task, waitForCompletion waits on this
+    WaitGroup m_allTasks;
+    std::atomic<size_t> m_waiterCount{0};
+
+    // any thread pushes, main thread pops. overflow only used when the queue is full
+    MpscQueue<Task> m_mainThreadQueue{MAIN_THREAD_QUEUE_CAPACITY};
+    std::vector<Task> m_mainThreadOverflow;
+    std::mutex m_mainThreadOverflowMutex;
+    std::atomic<bool> m_hasMainThreadOverflow{false};
+    // only touched by the main thread
+    TaskHeap m_pendingMainThreadTasks;
+    std::chrono::microseconds m_mainThreadBudget{2000};
+    double m_averageMainThreadTaskUs = 0.0;
+    uint64_t m_lastMainThreadFrameUs = 0;
+    size_t m_lastMainThreadTasksRun = 0;
+    std::atomic<uint64_t> m_nextSequence{0};
+
+    TaskProfiler m_profiler;
+    bool m_mainThreadNamed = false;
 
     // statistics
     size_t m_completedTasks = 0;
-    size_t m_completedMainThreadTasks = 0;
+    std::atomic<size_t> m_completedMainThreadTasks{0};
 };
 
 }  // namespace Vengine
\ No newline at end of file
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+
+namespace Vengine {
+
+// counter of outstanding tasks. add() before enqueueing, done() when a task finished.
+// ThreadManager::wait(group) waits on it while helping with queued work, wait() here just blocks.
+// a group with a parent counts into it as well, so a load can track the loads it starts itself
+class WaitGroup {
+   public:
+    WaitGroup() = default;
+    explicit WaitGroup(std::shared_ptr<WaitGroup> parent) : m_parent(std::move(parent)) {
+    }
+    WaitGroup(const WaitGroup&) = delete;
+    auto operator=(const WaitGroup&) -> WaitGroup& = delete;
+
+    auto add(size_t count = 1) -> void {
+        m_total.fetch_add(count, std::memory_order_relaxed);
+        m_counter.fetch_add(count, std::memory_order_acq_rel);
+        if (m_parent) {
+            m_parent->add(count);
+        }
+    }
+
+    auto done() -> void {
+        if (m_counter.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            // lock so a waiter can't miss the notify between checking and sleeping
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_condition.notify_all();
+        }
+        if (m_parent) {
+            m_parent->done();
+        }
+    }
+
+    [[nodiscard]] auto isDone() const -> bool {
+        return m_counter.load(std::memory_order_acquire) == 0;
+    }
+
+    [[nodiscard]] auto getPending() const -> size_t {
+        return m_counter.load(std::memory_order_acquire);
+    }
+
+    // everything ever added, with getPending() this is the progress of the group
+    [[nodiscard]] auto getTotal() const -> size_t {
+        return m_total.load(std::memory_order_relaxed);
+    }
+
+    auto wait() -> void {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_condition.wait(lock, [this] { return isDone(); });
+    }
+
+   private:
+    std::atomic<size_t> m_counter{0};
+    std::atomic<size_t> m_total{0};
+    std::shared_ptr<WaitGroup> m_parent;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+};
+
+}  // namespace Vengine
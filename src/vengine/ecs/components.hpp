@@ -10,6 +10,7 @@
 #include "vengine/renderer/material.hpp"
 #include "vengine/core/model.hpp"
 #include "vengine/core/mesh.hpp"
+#include "vengine/core/resource_handle.hpp"
 
 namespace Vengine {
 
@@ -41,7 +42,11 @@ struct ScriptComponent : public BaseComponent {
     }
     ScriptComponent(std::shared_ptr<Script> script) : script(std::move(script)) {
     }
+    ScriptComponent(Handle<Script> handle) : handle(handle) {
+    }
+    // either a fixed script or a handle the ScriptSystem resolves every frame
     std::shared_ptr<Script> script;
+    Handle<Script> handle;
     bool isDirty = true;
 
     std::string path;
@@ -54,15 +59,23 @@ struct VelocityComponent : public BaseComponent {
 struct MeshComponent : public BaseComponent {
     MeshComponent(std::shared_ptr<Mesh> mesh) : mesh(std::move(mesh)) {
     }
+    MeshComponent(Handle<Mesh> handle) : handle(handle) {
+    }
 
+    // mesh wins if set, otherwise the renderer resolves the handle
     std::shared_ptr<Mesh> mesh;
+    Handle<Mesh> handle;
 };
 
 struct ModelComponent : public BaseComponent {
     ModelComponent(std::shared_ptr<Model> model) : model(std::move(model)) {
     }
+    ModelComponent(Handle<Model> handle) : handle(handle) {
+    }
 
+    // model wins if set, otherwise the renderer resolves the handle
     std::shared_ptr<Model> model;
+    Handle<Model> handle;
 };
 
 struct MaterialComponent : public BaseComponent {
@@ -49,14 +49,26 @@ void ScriptSystem::update(std::shared_ptr<Entities> entities, float deltaTime) {
         if (!scriptComp) {
             continue;
         }
+        auto* script = scriptComp->script.get();
+        if (!script && m_resourceManager) {
+            script = m_resourceManager->get(scriptComp->handle);
+        }
+        if (!script) {
+            // not loaded yet
+            continue;
+        }
+
+        // the source got hot reloaded since this entity's env was built
+        if (auto version = m_scriptVersions.find(entityId);
+            version != m_scriptVersions.end() && version->second != script->getVersion()) {
+            scriptComp->isDirty = true;
+        }
 
         // load only if dirty or not loaded yet
         if (scriptComp->isDirty || m_scriptEnvs.find(entityId) == m_scriptEnvs.end()) {
-            // remove old env if exists
-            if (m_scriptEnvs.count(entityId)) {
-                luaL_unref(m_luaState, LUA_REGISTRYINDEX, m_scriptEnvs[entityId]);
-                m_scriptEnvs.erase(entityId);
-            }
+            // a broken reload keeps the old env running, it is only replaced once the new one ran
+            m_scriptVersions[entityId] = script->getVersion();
+            scriptComp->isDirty = false;
 
             // new env table
             lua_newtable(m_luaState);  
@@ -71,7 +83,7 @@ void ScriptSystem::update(std::shared_ptr<Entities> entities, float deltaTime) {
             lua_setfield(m_luaState, -2, "__index");
             lua_setmetatable(m_luaState, envIdx);
 
-            if (luaL_loadstring(m_luaState, scriptComp->script->getSource().c_str()) != LUA_OK) {
+            if (luaL_loadstring(m_luaState, script->getSource().c_str()) != LUA_OK) {
                 spdlog::error("Error loading Lua script '{}': {}", scriptComp->path, lua_tostring(m_luaState, -1));
                 lua_pop(m_luaState, 2);  // pop error 
                 continue;
@@ -85,10 +97,12 @@ void ScriptSystem::update(std::shared_ptr<Entities> entities, float deltaTime) {
                 continue;
             }
 
-            // store env as ref
+            // store env as ref, drop the old one if exists
             int envRef = luaL_ref(m_luaState, LUA_REGISTRYINDEX);
+            if (auto old = m_scriptEnvs.find(entityId); old != m_scriptEnvs.end()) {
+                luaL_unref(m_luaState, LUA_REGISTRYINDEX, old->second);
+            }
             m_scriptEnvs[entityId] = envRef;
-            scriptComp->isDirty = false;
         }
 
         // get env for this entity
@@ -123,7 +137,7 @@ void ScriptSystem::update(std::shared_ptr<Entities> entities, float deltaTime) {
         // }
 
         // if (scriptComp->isDirty) {
-        //     if (luaL_loadstring(m_luaState, scriptComp->script->getSource().c_str()) != LUA_OK) {
+        //     if (luaL_loadstring(m_luaState, script->getSource().c_str()) != LUA_OK) {
         //         spdlog::error("Error loading Lua script '{}': {}", scriptComp->path, lua_tostring(m_luaState, -1));
         //         lua_pop(m_luaState, 1);
         //         continue;
@@ -184,6 +198,7 @@ void ScriptSystem::update(std::shared_ptr<Entities> entities, float deltaTime) {
 
 void ScriptSystem::registerBindings(Vengine* vengine) {
     sol::state_view lua(m_luaState);
+    m_resourceManager = vengine->resourceManager.get();
 
     // expose components to lua
     // GLFW key constants
@@ -8,6 +8,7 @@
 namespace Vengine {
 
 class Vengine;
+class ResourceManager;
 
 class ScriptSystem : public BaseSystem {
    public:
@@ -19,7 +20,9 @@ class ScriptSystem : public BaseSystem {
 
    private:
     lua_State* m_luaState = nullptr;
+    ResourceManager* m_resourceManager = nullptr;  // resolves script handles
     std::unordered_map<EntityId, int> m_scriptEnvs; // entityId -> Lua ref
+    std::unordered_map<EntityId, uint32_t> m_scriptVersions;  // Script::getVersion() the env was built from
 };
 
 }  // namespace Vengine
\ No newline at end of file
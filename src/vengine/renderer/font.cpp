@@ -6,6 +6,7 @@
 #include <GLFW/glfw3.h>
 #include <spdlog/spdlog.h>
 #include <freetype/freetype.h>
+#include "vengine/utils/vfs.hpp"
 
 namespace Vengine {
 
@@ -108,13 +109,15 @@ auto Font::load(const std::string& fileName, FT_Library& ftLibrary) -> bool {
 
     auto folder = std::filesystem::path("resources/fonts");
     auto fullPath = folder / fileName;
-    if (!std::filesystem::exists(fullPath)) {
+    // freetype reads from the file while the face is open, it is done with it at FT_Done_Face below
+    auto file = Vfs::open(fullPath);
+    if (!file.isOpen()) {
         spdlog::error("Font file not found: {}", fullPath.string());
         return false;
     }
 
     FT_Face face;
-    if (FT_New_Face(ftLibrary, fullPath.string().c_str(), 0, &face) != 0) {
+    if (FT_New_Memory_Face(ftLibrary, file.data(), static_cast<FT_Long>(file.size()), 0, &face) != 0) {
         spdlog::error("Failed to load font: {}", fullPath.string());
         return false;
     }
@@ -4,11 +4,11 @@
 
 namespace Vengine {
 
-IndexBuffer::IndexBuffer(const uint32_t* indices, uint32_t count) : m_count(count) {
+IndexBuffer::IndexBuffer(const void* indices, uint32_t count, GLenum type) : m_count(count), m_type(type) {
     // spdlog::debug("Constructor IndexBuffer, count: {}", count);
     glGenBuffers(1, &m_id);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_id);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(count * sizeof(uint32_t)), indices, GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(count * getIndexSize()), indices, GL_STATIC_DRAW);
 }
 
 IndexBuffer::~IndexBuffer() {
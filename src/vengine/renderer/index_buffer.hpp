@@ -6,7 +6,8 @@ namespace Vengine {
 
 class IndexBuffer {
 public:
-    IndexBuffer(const uint32_t* indices, uint32_t count);
+    // type is GL_UNSIGNED_INT or GL_UNSIGNED_SHORT
+    IndexBuffer(const void* indices, uint32_t count, GLenum type = GL_UNSIGNED_INT);
     ~IndexBuffer();
 
     auto bind() const -> void;
@@ -16,10 +17,17 @@ public:
     [[nodiscard]] auto getId() const -> GLuint {
         return m_id;
     }
+    [[nodiscard]] auto getType() const -> GLenum {
+        return m_type;
+    }
+    [[nodiscard]] auto getIndexSize() const -> uint32_t {
+        return m_type == GL_UNSIGNED_SHORT ? 2 : 4;
+    }
 
 private:
     GLuint m_id = 0;
     uint32_t m_count;
+    GLenum m_type;
 };
 
 }  // namespace Vengine
\ No newline at end of file
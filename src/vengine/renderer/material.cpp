@@ -61,7 +61,9 @@ auto Material::bind() const -> void {
 
     // texture
     int textureUnit = 0;
+    bool texturesReady = true;
     for (const auto& [name, texture] : m_textures) {
+        texturesReady = texturesReady && texture->getTextureID() != 0;
         glActiveTexture(GL_TEXTURE0 + textureUnit);
         glBindTexture(GL_TEXTURE_2D, texture->getTextureID());
         m_shader->setUniformInt(name, textureUnit);
@@ -96,6 +98,11 @@ auto Material::bind() const -> void {
     for (const auto& [name, value] : m_bools) {
         m_shader->setUniformBool(name, value);
     }
+
+    // async loaded textures are not on the gpu yet, show the plain color until they are
+    if (!texturesReady) {
+        m_shader->setUniformBool("uUseTexture", false);
+    }
 }
 
 } // namespace Vengine
\ No newline at end of file
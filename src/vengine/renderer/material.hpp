@@ -18,6 +18,9 @@ public:
     [[nodiscard]] auto getShader() const -> std::shared_ptr<Shader>;
 
     auto setTexture(const std::string& name, std::shared_ptr<Texture> texture) -> void;
+    [[nodiscard]] auto getTextures() const -> const std::unordered_map<std::string, std::shared_ptr<Texture>>& {
+        return m_textures;
+    }
     auto setFloat(const std::string& name, float value) -> void;
     auto setInt(const std::string& name, int value) -> void;
     auto setVec2(const std::string& name, const glm::vec2& value) -> void;
@@ -3,18 +3,24 @@
 #include <GLFW/glfw3.h>
 #include <spdlog/spdlog.h>
 #include <glad/glad.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <limits>
 #include <memory>
+#include <thread>
 #include <tl/expected.hpp>
 #include "vengine/core/error.hpp"
 #include <utility>
 #include "vengine/renderer/fonts.hpp"
 #include "vengine/renderer/font.hpp"
+#include "vengine/core/resource_manager.hpp"
 
 namespace Vengine {
 
 // test stuff
 struct MeshMaterialKey {
-    std::shared_ptr<Mesh> mesh;
+    Mesh* mesh;
     std::shared_ptr<Material> material;
     bool operator<(const MeshMaterialKey& other) const {
         return std::tie(mesh, material) < std::tie(other.mesh, other.material);
@@ -22,15 +28,169 @@ struct MeshMaterialKey {
 };
 
 struct MeshSubmeshMaterialKey {
-    std::shared_ptr<Mesh> mesh;
+    Mesh* mesh;
     size_t submeshIndex;
+    size_t lod;
     std::shared_ptr<Material> material;
     bool operator<(const MeshSubmeshMaterialKey& other) const {
-        return std::tie(mesh, submeshIndex, material) < std::tie(other.mesh, other.submeshIndex, other.material);
+        return std::tie(mesh, submeshIndex, lod, material) <
+               std::tie(other.mesh, other.submeshIndex, other.lod, other.material);
     }
 };
 
-static auto uploadInstanceTransforms(const std::shared_ptr<Mesh>& mesh, const std::vector<glm::mat4>& transforms) -> void {
+// a level is good enough while its error covers at most this many pixels
+constexpr float LOD_PIXEL_ERROR = 1.0f;
+// going coarser than last frame needs the error this much below the limit, so an instance
+// sitting right at a threshold doesn't flip between two levels every frame
+constexpr float LOD_HYSTERESIS = 0.25f;
+
+// meshlets per culling job, a few microseconds of work
+constexpr size_t CLUSTER_CULL_CHUNK = 2048;
+
+// what glMultiDrawElementsIndirect reads per draw
+struct DrawElementsIndirectCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+
+// a submesh batch drawn meshlet by meshlet, see ClusterCulling
+struct ClusterBatch {
+    const MeshSubmeshMaterialKey* key = nullptr;
+    const Mesh* mesh = nullptr;
+    const Submesh* submesh = nullptr;
+    std::vector<MeshletCullView> views;  // per instance
+    std::vector<uint8_t> visible;        // per instance and meshlet
+    size_t firstCommand = 0;
+    size_t commandCount = 0;
+    size_t drawnIndices = 0;
+    size_t culledIndices = 0;
+};
+
+// components either hold the resource directly or a handle, handles resolve to nullptr while loading.
+// either way the pointer is only good for this frame
+static auto resolveMesh(ResourceManager* resourceManager, const MeshComponent& component) -> Mesh* {
+    if (component.mesh || !resourceManager) {
+        return component.mesh.get();
+    }
+    return resourceManager->get(component.handle);
+}
+
+static auto resolveModel(ResourceManager* resourceManager, const ModelComponent& component) -> Model* {
+    if (component.model || !resourceManager) {
+        return component.model.get();
+    }
+    return resourceManager->get(component.handle);
+}
+
+// pixels the bounding sphere of a mesh covers on screen, the largest over all instances. submeshes
+// use the whole mesh, and a texture is assumed to span its mesh once, good enough to pick mips
+static auto getScreenSize(const Mesh* mesh,
+                          const std::vector<glm::mat4>& transforms,
+                          const glm::vec3& cameraPosition,
+                          float pixelsPerUnit) -> float {
+    auto [boundsMin, boundsMax] = mesh->getBounds();
+    glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+    float radius = glm::length(boundsMax - boundsMin) * 0.5f;
+
+    float screenSize = 0.0f;
+    for (const auto& transform : transforms) {
+        glm::vec3 worldCenter = glm::vec3(transform * glm::vec4(center, 1.0f));
+        float scale = std::max({glm::length(glm::vec3(transform[0])),
+                                glm::length(glm::vec3(transform[1])),
+                                glm::length(glm::vec3(transform[2]))});
+        float worldRadius = radius * scale;
+        float distance = glm::length(worldCenter - cameraPosition);
+        if (distance <= worldRadius) {
+            return std::numeric_limits<float>::max();
+        }
+        screenSize = std::max(screenSize, worldRadius / distance * pixelsPerUnit);
+    }
+    return screenSize;
+}
+
+static auto requestTextureLevels(ResourceManager* resourceManager, const Material& material, float screenSize) -> void {
+    if (!resourceManager || !resourceManager->getTextureStreamer().isEnabled()) {
+        return;
+    }
+    for (const auto& [name, texture] : material.getTextures()) {
+        // duplicates stream through the texture they share
+        const auto& target = texture && texture->getOriginal() ? texture->getOriginal() : texture;
+        if (target && target->isStreamable()) {
+            resourceManager->getTextureStreamer().requestScreenSize(target, screenSize);
+        }
+    }
+}
+
+// the frustum planes and the camera in the instance's model space, the meshlet bounds stay as they are
+static auto makeClusterView(const glm::mat4& viewProjection,
+                            const glm::mat4& transform,
+                            const glm::vec3& cameraPosition,
+                            bool cullBackfaces) -> MeshletCullView {
+    glm::mat4 modelViewProjection = viewProjection * transform;
+    std::array<float, 16> clip{};
+    std::memcpy(clip.data(), &modelViewProjection[0][0], sizeof(clip));
+    glm::vec3 localCamera = glm::vec3(glm::inverse(transform) * glm::vec4(cameraPosition, 1.0f));
+    // a mirroring transform flips the winding, the cones would point the wrong way
+    bool keepsWinding = glm::determinant(glm::mat3(transform)) > 0.0f;
+    return makeMeshletCullView(clip, {localCamera.x, localCamera.y, localCamera.z}, cullBackfaces && keepsWinding);
+}
+
+// every instance of every batch, in chunks of meshlets. jobs are claimed from a shared counter, the
+// render thread takes them too and then only waits for the ones a worker is in the middle of, never
+// for a worker that is still busy with a load
+static auto cullClusters(ThreadManager* threadManager, std::vector<ClusterBatch>& batches) -> void {
+    struct Job {
+        ClusterBatch* batch;
+        size_t instance;
+        size_t first;
+        size_t count;
+    };
+    // shared with the tasks, one that only runs after this returned finds nothing left to do
+    struct State {
+        std::vector<Job> jobs;
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> finished{0};
+    };
+    auto state = std::make_shared<State>();
+    for (auto& batch : batches) {
+        size_t meshletCount = batch.submesh->meshletCount;
+        batch.visible.resize(batch.views.size() * meshletCount);
+        for (size_t instance = 0; instance < batch.views.size(); instance++) {
+            for (size_t first = 0; first < meshletCount; first += CLUSTER_CULL_CHUNK) {
+                state->jobs.push_back({&batch, instance, first, std::min(CLUSTER_CULL_CHUNK, meshletCount - first)});
+            }
+        }
+    }
+
+    auto work = [state]() {
+        for (size_t j = state->next.fetch_add(1, std::memory_order_relaxed); j < state->jobs.size();
+             j = state->next.fetch_add(1, std::memory_order_relaxed)) {
+            const auto& job = state->jobs[j];
+            auto& batch = *job.batch;
+            cullMeshlets(batch.mesh->getMeshletBounds(),
+                         batch.submesh->firstMeshlet + job.first,
+                         job.count,
+                         batch.views[job.instance],
+                         batch.visible.data() + job.instance * batch.submesh->meshletCount + job.first);
+            state->finished.fetch_add(1, std::memory_order_release);
+        }
+    };
+    if (threadManager && state->jobs.size() > 1) {
+        size_t helpers = std::min(threadManager->getWorkerCount(), state->jobs.size() - 1);
+        for (size_t i = 0; i < helpers; i++) {
+            threadManager->enqueueTask(work, "Cull clusters", TaskPriority::Critical);
+        }
+    }
+    work();
+    while (state->finished.load(std::memory_order_acquire) < state->jobs.size()) {
+        std::this_thread::yield();
+    }
+}
+
+static auto uploadInstanceTransforms(const Mesh* mesh, const std::vector<glm::mat4>& transforms) -> void {
     // Early safety checks
     if (!mesh) {
         spdlog::error("Null mesh in uploadInstanceTransforms");
@@ -49,7 +209,7 @@ static auto uploadInstanceTransforms(const std::shared_ptr<Mesh>& mesh, const st
     }
 
     static std::unordered_map<size_t, GLuint> instanceVBOs;
-    size_t meshId = reinterpret_cast<size_t>(mesh.get());
+    size_t meshId = reinterpret_cast<size_t>(mesh);
     GLuint instanceVBO = 0;
 
     if (instanceVBOs.find(meshId) == instanceVBOs.end()) {
@@ -87,12 +247,32 @@ Renderer::Renderer() {
 
 Renderer::~Renderer() {
     spdlog::debug("Destructor Renderer");
+    if (m_indirectBuffer != 0) {
+        glDeleteBuffers(1, &m_indirectBuffer);
+    }
 }
 
 auto Renderer::render(const std::shared_ptr<Scene>& scene) -> void {
     m_drawCallCount = 0;
     m_vertexCount = 0;
     m_triangleCount = 0;
+    m_lodTriangleCounts.fill(0);
+    m_clusterCulledTriangleCount = 0;
+
+    // lods follow the camera in the shadow pass too, picked once per entity and frame
+    m_lodLevels.swap(m_frameLodLevels);
+    m_frameLodLevels.clear();
+    m_lodPixelsPerUnit = 0.0f;
+    if (auto camera = scene->getCameras()->getActive(); camera != 0) {
+        auto cameraTransform = scene->getEntities()->getEntityComponent<TransformComponent>(camera);
+        auto cameraComponent = scene->getEntities()->getEntityComponent<CameraComponent>(camera);
+        if (cameraTransform && cameraComponent) {
+            m_lodCameraPosition = cameraTransform->getPosition();
+            // ndc spans 2 units over the height, so a unit at distance 1 covers cot(fov / 2) * height / 2 pixels
+            m_lodPixelsPerUnit =
+                cameraComponent->getProjectionMatrix()[1][1] * static_cast<float>(m_window->getHeight()) * 0.5f;
+        }
+    }
 
     if (m_preRenderCallback) {
         m_preRenderCallback();
@@ -134,13 +314,17 @@ auto Renderer::render(const std::shared_ptr<Scene>& scene) -> void {
     glm::mat4 lightSpaceMatrix = lightProj * lightView;
     m_shadowShader->setUniformMat4("uLightSpaceMatrix", lightSpaceMatrix);
 
-    // 4. Batch shadow casters by mesh
-    std::map<std::shared_ptr<Mesh>, std::vector<glm::mat4>> shadowBatches;
+    // 4. Batch shadow casters by mesh and lod
+    std::map<std::pair<Mesh*, size_t>, std::vector<glm::mat4>> shadowBatches;
     auto shadowCasters = scene->getEntities()->getEntitiesWith<TransformComponent, MeshComponent>();
     for (auto entity : shadowCasters) {
         auto transformComp = scene->getEntities()->getEntityComponent<TransformComponent>(entity);
         auto meshComp = scene->getEntities()->getEntityComponent<MeshComponent>(entity);
-        if (!transformComp || !meshComp || !meshComp->mesh) {
+        if (!transformComp || !meshComp) {
+            continue;
+        }
+        auto mesh = resolveMesh(m_resourceManager, *meshComp);
+        if (!mesh || !mesh->getVertexArray()) {
             continue;
         }
 
@@ -149,7 +333,8 @@ auto Renderer::render(const std::shared_ptr<Scene>& scene) -> void {
             transformComp->dirty = false;
         }
 
-        shadowBatches[meshComp->mesh].push_back(transformComp->getTransform());
+        auto lod = selectLod(entity, *mesh, transformComp->getTransform());
+        shadowBatches[{mesh, lod}].push_back(transformComp->getTransform());
     }
 
     // Add ModelComponent entities to shadow casting
@@ -158,12 +343,15 @@ auto Renderer::render(const std::shared_ptr<Scene>& scene) -> void {
         auto transformComp = scene->getEntities()->getEntityComponent<TransformComponent>(entity);
         auto modelComp = scene->getEntities()->getEntityComponent<ModelComponent>(entity);
 
-        if (!transformComp || !modelComp || !modelComp->model) {
+        if (!transformComp || !modelComp) {
             continue;
         }
 
-        auto model = modelComp->model;
-        auto mesh = model->getMesh();
+        auto model = resolveModel(m_resourceManager, *modelComp);
+        if (!model) {
+            continue;
+        }
+        auto* mesh = model->getMesh().get();
 
         if (!mesh || !mesh->getVertexArray()) {
             continue;
@@ -174,23 +362,29 @@ auto Renderer::render(const std::shared_ptr<Scene>& scene) -> void {
             transformComp->dirty = false;
         }
 
-        shadowBatches[mesh].push_back(transformComp->getTransform());
+        auto lod = selectLod(entity, *mesh, transformComp->getTransform());
+        shadowBatches[{mesh, lod}].push_back(transformComp->getTransform());
     }
 
     // 5. Draw each batch with instancing
-    for (const auto& [mesh, transforms] : shadowBatches) {
+    for (const auto& [key, transforms] : shadowBatches) {
+        const auto& [mesh, lod] = key;
         uploadInstanceTransforms(mesh, transforms);
         mesh->getVertexArray()->bind();
         if (mesh->useIndices()) {
+            // the index buffer holds every lod, a level is one range of it
+            auto range = mesh->getLod(lod);
+            const auto& indexBuffer = mesh->getIndexBuffer();
             glDrawElementsInstanced(GL_TRIANGLES,
-                                    static_cast<GLsizei>(mesh->getIndexBuffer()->getCount()),
-                                    GL_UNSIGNED_INT,
-                                    nullptr,
+                                    static_cast<GLsizei>(range.indexCount),
+                                    indexBuffer->getType(),
+                                    reinterpret_cast<void*>(range.indexOffset * indexBuffer->getIndexSize()),
                                     static_cast<GLsizei>(transforms.size()));
 
             m_drawCallCount++;
-            m_vertexCount += mesh->getIndexBuffer()->getCount() * transforms.size();
-            m_triangleCount += mesh->getIndexBuffer()->getCount() / 3 * transforms.size();
+            m_vertexCount += range.indexCount * transforms.size();
+            m_triangleCount += range.indexCount / 3 * transforms.size();
+            m_lodTriangleCounts[lod] += range.indexCount / 3 * transforms.size();
         } else {
             glDrawArraysInstanced(GL_TRIANGLES,
                                   0,
@@ -229,6 +423,8 @@ auto Renderer::render(const std::shared_ptr<Scene>& scene) -> void {
     auto cameraComponent = scene->getEntities()->getEntityComponent<CameraComponent>(scene->getCameras()->getActive());
     glm::mat4 viewMatrix = cameraComponent->getViewMatrix(cameraTransform);
     glm::mat4 projectionMatrix = cameraComponent->getProjectionMatrix();
+    // radius / distance to pixels, projection[1][1] is cot(fov / 2)
+    float pixelsPerUnit = projectionMatrix[1][1] * static_cast<float>(m_window->getHeight());
 
     // batch rendering with submeshes
     std::map<MeshMaterialKey, std::vector<glm::mat4>> simpleBatches;
@@ -240,7 +436,11 @@ auto Renderer::render(const std::shared_ptr<Scene>& scene) -> void {
         auto meshComp = scene->getEntities()->getEntityComponent<MeshComponent>(entity);
         auto materialComp = scene->getEntities()->getEntityComponent<MaterialComponent>(entity);
 
-        if (!transformComp || !meshComp || !meshComp->mesh || !materialComp || !materialComp->material) {
+        if (!transformComp || !meshComp || !materialComp || !materialComp->material) {
+            continue;
+        }
+        auto mesh = resolveMesh(m_resourceManager, *meshComp);
+        if (!mesh || mesh->needsMainThreadInit()) {
             continue;
         }
 
@@ -249,9 +449,9 @@ auto Renderer::render(const std::shared_ptr<Scene>& scene) -> void {
             transformComp->dirty = false;
         }
 
-        auto mesh = meshComp->mesh;
         auto defaultMaterial = materialComp->material;
         const auto& submeshes = mesh->getSubmeshes();
+        auto lod = selectLod(entity, *mesh, transformComp->getTransform());
 
         if (submeshes.empty()) {
             // simple mesh, no submeshes, rendered simply
@@ -271,7 +471,7 @@ auto Renderer::render(const std::shared_ptr<Scene>& scene) -> void {
                     }
                 }
 
-                MeshSubmeshMaterialKey key{mesh, i, material};
+                MeshSubmeshMaterialKey key{mesh, i, lod, material};
                 submeshBatches[key].push_back(transformComp->getTransform());
             }
         }
@@ -284,13 +484,17 @@ auto Renderer::render(const std::shared_ptr<Scene>& scene) -> void {
         auto transformComp = scene->getEntities()->getEntityComponent<TransformComponent>(entity);
         auto modelComp = scene->getEntities()->getEntityComponent<ModelComponent>(entity);
 
-        if (!transformComp || !modelComp || !modelComp->model) {
+        if (!transformComp || !modelComp) {
             spdlog::warn("Model entity {} has invalid transform or model", entity);
             continue;
         }
 
-        auto model = modelComp->model;
-        auto mesh = model->getMesh();
+        // still loading
+        auto model = resolveModel(m_resourceManager, *modelComp);
+        if (!model || !model->getMesh() || model->getMesh()->needsMainThreadInit()) {
+            continue;
+        }
+        auto* mesh = model->getMesh().get();
         auto defaultMaterial = model->getDefaultMaterial();
 
         if (!mesh || !defaultMaterial) {
@@ -311,6 +515,7 @@ auto Renderer::render(const std::shared_ptr<Scene>& scene) -> void {
 
         // Rest of the code remains unchanged
         const auto& submeshes = mesh->getSubmeshes();
+        auto lod = selectLod(entity, *mesh, transformComp->getTransform());
         if (submeshes.empty()) {
             // Simple mesh, no submeshes
             MeshMaterialKey key{mesh, defaultMaterial};
@@ -326,7 +531,7 @@ auto Renderer::render(const std::shared_ptr<Scene>& scene) -> void {
                     material = model->getMaterialForSubmesh(submesh.materialName);
                 }
 
-                MeshSubmeshMaterialKey key{mesh, i, material};
+                MeshSubmeshMaterialKey key{mesh, i, lod, material};
                 submeshBatches[key].push_back(transformComp->getTransform());
             }
         }
@@ -337,6 +542,9 @@ auto Renderer::render(const std::shared_ptr<Scene>& scene) -> void {
         auto mesh = key.mesh;
         auto material = key.material;
 
+        auto screenSize = getScreenSize(mesh, transforms, cameraTransform->getPosition(), pixelsPerUnit);
+        requestTextureLevels(m_resourceManager, *material, screenSize);
+
         material->bind();
         auto shader = material->getShader();
         if (!shader) {
@@ -363,13 +571,14 @@ auto Renderer::render(const std::shared_ptr<Scene>& scene) -> void {
         if (mesh->useIndices()) {
             glDrawElementsInstanced(GL_TRIANGLES,
                                     static_cast<GLsizei>(mesh->getIndexBuffer()->getCount()),
-                                    GL_UNSIGNED_INT,
+                                    mesh->getIndexBuffer()->getType(),
                                     nullptr,
                                     static_cast<GLsizei>(transforms.size()));
 
             m_drawCallCount++;
             m_vertexCount += mesh->getIndexBuffer()->getCount() * transforms.size();
             m_triangleCount += mesh->getIndexBuffer()->getCount() / 3 * transforms.size();
+            m_lodTriangleCounts[0] += mesh->getIndexBuffer()->getCount() / 3 * transforms.size();
         } else {
             glDrawArraysInstanced(GL_TRIANGLES,
                                   0,
@@ -383,12 +592,83 @@ auto Renderer::render(const std::shared_ptr<Scene>& scene) -> void {
         mesh->getVertexArray()->unbind();
     }
 
+    // submeshes split into meshlets are culled cluster by cluster at full detail, every instance on
+    // its own. all batches go through the workers at once, the draws below only read the results
+    std::vector<ClusterBatch> clusterBatches;
+    if (m_clusterCulling != ClusterCulling::Off) {
+        glm::mat4 viewProjection = projectionMatrix * viewMatrix;
+        bool cullBackfaces = m_clusterCulling == ClusterCulling::FrustumAndBackfaces;
+        for (const auto& [key, transforms] : submeshBatches) {
+            const auto& submesh = key.mesh->getSubmeshes()[key.submeshIndex];
+            if (key.lod != 0 || submesh.meshletCount == 0 || !key.mesh->useIndices()) {
+                continue;
+            }
+            auto& batch = clusterBatches.emplace_back();
+            batch.key = &key;
+            batch.mesh = key.mesh;
+            batch.submesh = &submesh;
+            batch.views.reserve(transforms.size());
+            for (const auto& transform : transforms) {
+                batch.views.push_back(
+                    makeClusterView(viewProjection, transform, cameraTransform->getPosition(), cullBackfaces));
+            }
+        }
+        cullClusters(m_threadManager.get(), clusterBatches);
+    }
+
+    // meshlets follow each other in the index buffer, so a run of visible ones is one command.
+    // baseInstance picks the instance's transform, the commands of every batch go up in one buffer
+    std::vector<DrawElementsIndirectCommand> clusterCommands;
+    for (auto& batch : clusterBatches) {
+        batch.firstCommand = clusterCommands.size();
+        const auto& meshlets = batch.mesh->getMeshlets();
+        size_t meshletCount = batch.submesh->meshletCount;
+        for (size_t instance = 0; instance < batch.views.size(); instance++) {
+            const uint8_t* visible = batch.visible.data() + instance * meshletCount;
+            for (size_t i = 0; i < meshletCount; i++) {
+                const auto& meshlet = meshlets[batch.submesh->firstMeshlet + i];
+                if (!visible[i]) {
+                    batch.culledIndices += meshlet.indexCount;
+                } else if (i > 0 && visible[i - 1]) {
+                    clusterCommands.back().count += meshlet.indexCount;
+                    batch.drawnIndices += meshlet.indexCount;
+                } else {
+                    clusterCommands.push_back(
+                        {meshlet.indexCount, 1, meshlet.indexOffset, 0, static_cast<GLuint>(instance)});
+                    batch.drawnIndices += meshlet.indexCount;
+                }
+            }
+        }
+        batch.commandCount = clusterCommands.size() - batch.firstCommand;
+        m_clusterCulledTriangleCount += batch.culledIndices / 3;
+    }
+    if (!clusterCommands.empty()) {
+        if (m_indirectBuffer == 0) {
+            glCreateBuffers(1, &m_indirectBuffer);
+        }
+        glNamedBufferData(m_indirectBuffer,
+                          static_cast<GLsizeiptr>(clusterCommands.size() * sizeof(DrawElementsIndirectCommand)),
+                          clusterCommands.data(),
+                          GL_STREAM_DRAW);
+    }
+
     // submesh rendering
+    size_t nextClusterBatch = 0;
     for (const auto& [key, transforms] : submeshBatches) {
         auto mesh = key.mesh;
-        auto submeshIndex = key.submeshIndex;
         auto material = key.material;
-        const auto& submesh = mesh->getSubmeshes()[submeshIndex];
+        auto range = mesh->getSubmeshLod(key.submeshIndex, key.lod);
+        const ClusterBatch* clusterBatch = nullptr;
+        if (nextClusterBatch < clusterBatches.size() && clusterBatches[nextClusterBatch].key == &key) {
+            clusterBatch = &clusterBatches[nextClusterBatch++];
+        }
+        // every meshlet of every instance is out of sight
+        if (clusterBatch && clusterBatch->commandCount == 0) {
+            continue;
+        }
+
+        auto screenSize = getScreenSize(mesh, transforms, cameraTransform->getPosition(), pixelsPerUnit);
+        requestTextureLevels(m_resourceManager, *material, screenSize);
 
         material->bind();
         auto shader = material->getShader();
@@ -412,16 +692,33 @@ auto Renderer::render(const std::shared_ptr<Scene>& scene) -> void {
         uploadInstanceTransforms(mesh, transforms);
 
         mesh->getVertexArray()->bind();
-        if (mesh->useIndices()) {
+        if (clusterBatch) {
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirectBuffer);
+            glMultiDrawElementsIndirect(
+                GL_TRIANGLES,
+                mesh->getIndexBuffer()->getType(),
+                reinterpret_cast<void*>(clusterBatch->firstCommand * sizeof(DrawElementsIndirectCommand)),
+                static_cast<GLsizei>(clusterBatch->commandCount),
+                0);
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+            m_drawCallCount++;
+            m_vertexCount += clusterBatch->drawnIndices;
+            m_triangleCount += clusterBatch->drawnIndices / 3;
+            m_lodTriangleCounts[0] += clusterBatch->drawnIndices / 3;
+        } else if (mesh->useIndices()) {
+            // 16 or 32-bit, whatever the mesh packed its indices into
+            const auto& indexBuffer = mesh->getIndexBuffer();
             glDrawElementsInstanced(GL_TRIANGLES,
-                                    static_cast<GLsizei>(submesh.indexCount),
-                                    GL_UNSIGNED_INT,
-                                    reinterpret_cast<void*>(submesh.indexOffset * sizeof(uint32_t)),
+                                    static_cast<GLsizei>(range.indexCount),
+                                    indexBuffer->getType(),
+                                    reinterpret_cast<void*>(range.indexOffset * indexBuffer->getIndexSize()),
                                     static_cast<GLsizei>(transforms.size()));
 
             m_drawCallCount++;
-            m_vertexCount += submesh.indexCount * transforms.size();
-            m_triangleCount += submesh.indexCount / 3 * transforms.size();
+            m_vertexCount += range.indexCount * transforms.size();
+            m_triangleCount += range.indexCount / 3 * transforms.size();
+            m_lodTriangleCounts[key.lod] += range.indexCount / 3 * transforms.size();
         } else {
             // submeshes without indices? even a thing?
             // size_t vertexCount = mesh->getVertexCount();
@@ -436,6 +733,11 @@ auto Renderer::render(const std::shared_ptr<Scene>& scene) -> void {
         mesh->getVertexArray()->unbind();
     }
 
+    // streamed textures go up or down a level based on what was just drawn
+    if (m_resourceManager) {
+        m_resourceManager->getTextureStreamer().update();
+    }
+
     // TODO: handle the skybox some other way, in shader?
     if (m_skyboxEnabled) {
         skybox->render(viewMatrix, projectionMatrix);
@@ -555,6 +857,49 @@ auto Renderer::getTriangleCount() const -> size_t {
     return m_triangleCount;
 }
 
+auto Renderer::getLodTriangleCount(size_t level) const -> size_t {
+    return level < m_lodTriangleCounts.size() ? m_lodTriangleCounts[level] : 0;
+}
+
+auto Renderer::getClusterCulledTriangleCount() const -> size_t {
+    return m_clusterCulledTriangleCount;
+}
+
+auto Renderer::selectLod(EntityId entity, const Mesh& mesh, const glm::mat4& transform) -> size_t {
+    auto lodCount = std::min(mesh.getLodCount(), Mesh::MAX_LOD_LEVELS);
+    if (lodCount < 2 || m_lodPixelsPerUnit <= 0.0f) {
+        return 0;
+    }
+    // the shadow pass picked it already
+    if (auto it = m_frameLodLevels.find(entity); it != m_frameLodLevels.end()) {
+        return std::min<size_t>(it->second, lodCount - 1);
+    }
+    auto previousIt = m_lodLevels.find(entity);
+    size_t previous = previousIt != m_lodLevels.end() ? previousIt->second : 0;
+
+    auto [boundsMin, boundsMax] = mesh.getBounds();
+    glm::vec3 worldCenter = glm::vec3(transform * glm::vec4((boundsMin + boundsMax) * 0.5f, 1.0f));
+    float scale = std::max({glm::length(glm::vec3(transform[0])),
+                            glm::length(glm::vec3(transform[1])),
+                            glm::length(glm::vec3(transform[2]))});
+    float distance = glm::length(worldCenter - m_lodCameraPosition);
+
+    size_t level = 0;
+    if (distance > glm::length(boundsMax - boundsMin) * 0.5f * scale) {
+        // model units to pixels at the instance's distance, the coarsest level that still looks the same
+        float pixelsPerModelUnit = scale / distance * m_lodPixelsPerUnit;
+        for (size_t next = 1; next < lodCount; next++) {
+            float limit = next > previous ? LOD_PIXEL_ERROR * (1.0f - LOD_HYSTERESIS) : LOD_PIXEL_ERROR;
+            if (mesh.getLodError(next) * pixelsPerModelUnit > limit) {
+                break;
+            }
+            level = next;
+        }
+    }
+    m_frameLodLevels[entity] = static_cast<uint8_t>(level);
+    return level;
+}
+
 auto Renderer::setVSync(bool enabled) -> void {
     if (enabled) {
         glfwSwapInterval(1);
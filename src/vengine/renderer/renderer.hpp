@@ -1,7 +1,9 @@
 #pragma once
 
+#include <array>
 #include <cstddef>
 #include <memory>
+#include <unordered_map>
 #include <tl/expected.hpp>
 
 #include "vengine/core/error.hpp"
@@ -12,9 +14,21 @@
 #include "vengine/renderer/fonts.hpp"
 #include "vengine/renderer/skybox.hpp"
 #include "vengine/core/scene.hpp"
+#include "vengine/core/thread_manager.hpp"
 
 namespace Vengine {
 
+class ResourceManager;
+
+// how submeshes split into meshlets are culled in the main pass before they are drawn
+enum class ClusterCulling {
+    Off,
+    Frustum,
+    // also drops meshlets facing away. GL_CULL_FACE is never enabled, so only for scenes where no
+    // single sided geometry is seen from behind
+    FrustumAndBackfaces,
+};
+
 class Renderer {
    public:
     std::unique_ptr<Materials> materials;
@@ -27,6 +41,20 @@ class Renderer {
     [[nodiscard]] auto init(std::shared_ptr<Window> window) -> tl::expected<void, Error>;
     auto initFonts(std::shared_ptr<Shader> fontShader) -> tl::expected<void, Error>;
     auto setShadowShader(std::shared_ptr<Shader> shader) -> void;
+    // used to resolve resource handles in mesh and model components
+    auto setResourceManager(ResourceManager* resourceManager) -> void {
+        m_resourceManager = resourceManager;
+    }
+    // cluster culling spreads over the workers when set, the render thread does it alone otherwise
+    auto setThreadManager(std::shared_ptr<ThreadManager> threadManager) -> void {
+        m_threadManager = std::move(threadManager);
+    }
+    auto setClusterCulling(ClusterCulling mode) -> void {
+        m_clusterCulling = mode;
+    }
+    [[nodiscard]] auto getClusterCulling() const -> ClusterCulling {
+        return m_clusterCulling;
+    }
 
     auto render(const std::shared_ptr<Scene>& scene) -> void;
     auto setVSync(bool enabled) -> void;
@@ -46,10 +74,19 @@ class Renderer {
     [[nodiscard]] auto getDrawCallCount() const -> size_t; 
     [[nodiscard]] auto getVertexCount() const -> size_t;
     [[nodiscard]] auto getTriangleCount() const -> size_t;
+    // of getTriangleCount(), the ones drawn at this level of detail
+    [[nodiscard]] auto getLodTriangleCount(size_t level) const -> size_t;
+    // triangles cluster culling kept out of the draws, not part of getTriangleCount()
+    [[nodiscard]] auto getClusterCulledTriangleCount() const -> size_t;
 
 
    private:
+    // by the error of a level projected to the screen, kept per entity across frames for the hysteresis
+    auto selectLod(EntityId entity, const Mesh& mesh, const glm::mat4& transform) -> size_t;
+
     std::shared_ptr<Window> m_window;
+    ResourceManager* m_resourceManager = nullptr;
+    std::shared_ptr<ThreadManager> m_threadManager;
     bool m_skyboxEnabled = false;
     bool m_vsyncEnabled = false;
     bool m_msaaEnabled = false;
@@ -61,6 +98,16 @@ class Renderer {
     size_t m_drawCallCount = 0;
     size_t m_vertexCount = 0;
     size_t m_triangleCount = 0;
+    std::array<size_t, Mesh::MAX_LOD_LEVELS> m_lodTriangleCounts{};
+    size_t m_clusterCulledTriangleCount = 0;
+
+    std::unordered_map<EntityId, uint8_t> m_lodLevels;       // picked last frame
+    std::unordered_map<EntityId, uint8_t> m_frameLodLevels;  // picked this frame
+    glm::vec3 m_lodCameraPosition = glm::vec3(0.0f);
+    float m_lodPixelsPerUnit = 0.0f;  // 0 without a camera, everything at full detail
+
+    ClusterCulling m_clusterCulling = ClusterCulling::Frustum;
+    GLuint m_indirectBuffer = 0;  // draw commands of the culled batches, refilled every frame
 
     // shadow test
     GLuint m_shadowMap;
@@ -3,6 +3,7 @@
 #include <stb_image.h>
 #include <glm/gtc/matrix_transform.hpp>
 #include "vengine/renderer/vertex_layout.hpp"
+#include "vengine/utils/vfs.hpp"
 
 namespace Vengine {
 
@@ -51,42 +52,57 @@ auto Skybox::loadFromTextures(const std::vector<std::shared_ptr<Texture>>& textu
         return false;
     }
 
-    // cubemap texture for skybox
-    glGenTextures(1, &m_textureID);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, m_textureID);
-
+    // the faces are copied over on the gpu, so the textures don't have to keep their pixels around.
+    // glCopyImageSubData wants the same size and a matching format for all of them
+    GLint width = 0;
+    GLint height = 0;
+    GLint internalFormat = 0;
     for (unsigned int i = 0; i < textures.size(); ++i) {
         const auto& texture = textures[i];
-        if (!texture || !texture->isLoaded()) {
-             spdlog::error("Skybox face texture at index {} is not loaded or invalid.", i);
-             glDeleteTextures(1, &m_textureID); 
-             m_textureID = 0;
-             return false;
+        if (!texture || !texture->isLoaded() || texture->getTextureID() == 0) {
+            spdlog::error("Skybox face texture at index {} is not loaded or invalid.", i);
+            return false;
         }
 
-        auto rawData = texture->getRawData();
-
-        if (rawData && rawData->pixels) {
-            GLenum format = (rawData->channels == 4) ? GL_RGBA : GL_RGB;
-            GLint internalFormat = (rawData->channels == 4) ? GL_RGBA8 : GL_RGB8;
-            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, internalFormat, rawData->width, rawData->height, 0, format, GL_UNSIGNED_BYTE, rawData->pixels);
-            // spdlog::debug("Loaded skybox face {} from texture ({}x{}, {} channels)", i, rawData->width, rawData->height, rawData->channels);
-        } else {
-            spdlog::error("Failed to get raw image data for skybox texture at index {}", i);
-            //  glDeleteTextures(1, &m_textureID); 
-            //  m_textureID = 0;
-            // return false;
+        GLint faceWidth = 0;
+        GLint faceHeight = 0;
+        GLint faceFormat = 0;
+        glGetTextureLevelParameteriv(texture->getTextureID(), 0, GL_TEXTURE_WIDTH, &faceWidth);
+        glGetTextureLevelParameteriv(texture->getTextureID(), 0, GL_TEXTURE_HEIGHT, &faceHeight);
+        glGetTextureLevelParameteriv(texture->getTextureID(), 0, GL_TEXTURE_INTERNAL_FORMAT, &faceFormat);
+        if (i == 0) {
+            width = faceWidth;
+            height = faceHeight;
+            internalFormat = faceFormat;
+        } else if (faceWidth != width || faceHeight != height || faceFormat != internalFormat) {
+            spdlog::error("Skybox face {} is {}x{} (format 0x{:x}), face 0 is {}x{} (format 0x{:x})",
+                          i, faceWidth, faceHeight, faceFormat, width, height, internalFormat);
+            return false;
         }
     }
 
-    // set texture parameters
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    // textures uploaded with an unsized format report it like that, storage needs a sized one
+    if (internalFormat == GL_RGB) {
+        internalFormat = GL_RGB8;
+    } else if (internalFormat == GL_RGBA) {
+        internalFormat = GL_RGBA8;
+    }
 
-    glBindTexture(GL_TEXTURE_CUBE_MAP, 0); 
+    unload();
+    glCreateTextures(GL_TEXTURE_CUBE_MAP, 1, &m_textureID);
+    glTextureStorage2D(m_textureID, 1, static_cast<GLenum>(internalFormat), width, height);
+    for (unsigned int i = 0; i < textures.size(); ++i) {
+        glCopyImageSubData(textures[i]->getTextureID(), GL_TEXTURE_2D, 0, 0, 0, 0,
+                           m_textureID, GL_TEXTURE_CUBE_MAP, 0, 0, 0, static_cast<GLint>(i),
+                           width, height, 1);
+    }
+
+    // set texture parameters
+    glTextureParameteri(m_textureID, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTextureParameteri(m_textureID, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTextureParameteri(m_textureID, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTextureParameteri(m_textureID, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTextureParameteri(m_textureID, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
     return true;
 }
 
@@ -105,7 +121,10 @@ auto Skybox::load(const std::vector<std::string>& faceFiles) -> bool {
     int height;
     int nrChannels;
     for (unsigned int i = 0; i < faceFiles.size(); i++) {
-        unsigned char* data = stbi_load(faceFiles[i].c_str(), &width, &height, &nrChannels, 0);
+        unsigned char* data = nullptr;
+        if (auto file = Vfs::open(faceFiles[i]); file.isOpen()) {
+            data = stbi_load_from_memory(file.data(), static_cast<int>(file.size()), &width, &height, &nrChannels, 0);
+        }
         if (data != nullptr) {
             GLenum format = nrChannels == 4 ? GL_RGBA : GL_RGB;
             GLint internalFormat = nrChannels == 4 ? GL_RGBA8 : GL_RGB8;
@@ -18,7 +18,9 @@ class Skybox {
     Skybox();
     ~Skybox();
 
+    // six face images, decoded straight into the cubemap
     [[nodiscard]] auto load(const std::vector<std::string>& faceFiles) -> bool;
+    // six finalized textures of one size and format, copied on the gpu. they need no cpu copy
     [[nodiscard]] auto loadFromTextures(const std::vector<std::shared_ptr<Texture>>& textures) -> bool;
     auto unload() -> void;
 
@@ -0,0 +1,109 @@
+#include "upload_ring.hpp"
+
+#include <utility>
+#include <spdlog/spdlog.h>
+
+namespace Vengine {
+
+UploadBlock::~UploadBlock() {
+    reset();
+}
+
+UploadBlock::UploadBlock(UploadBlock&& other) noexcept {
+    *this = std::move(other);
+}
+
+auto UploadBlock::operator=(UploadBlock&& other) noexcept -> UploadBlock& {
+    if (this != &other) {
+        reset();
+        m_ring = std::move(other.m_ring);
+        m_data = std::exchange(other.m_data, nullptr);
+        m_range = std::exchange(other.m_range, RingRange{});
+    }
+    return *this;
+}
+
+auto UploadBlock::getBuffer() const -> GLuint {
+    return m_ring ? m_ring->getBuffer() : 0;
+}
+
+auto UploadBlock::reset() -> void {
+    if (m_ring) {
+        m_ring->m_allocator.release(m_range.id);
+    }
+    m_ring.reset();
+    m_data = nullptr;
+    m_range = {};
+}
+
+UploadRing::~UploadRing() {
+    for (const auto& fence : m_fences) {
+        glDeleteSync(fence.sync);
+    }
+    if (m_buffer != 0) {
+        glUnmapNamedBuffer(m_buffer);
+        glDeleteBuffers(1, &m_buffer);
+    }
+}
+
+auto UploadRing::init(size_t size) -> bool {
+    // coherent, the workers' memcpys are visible to the copies without a flush
+    constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glCreateBuffers(1, &m_buffer);
+    glNamedBufferStorage(m_buffer, static_cast<GLsizeiptr>(size), nullptr, flags);
+    m_mapped = static_cast<uint8_t*>(glMapNamedBufferRange(m_buffer, 0, static_cast<GLsizeiptr>(size), flags));
+    if (!m_mapped) {
+        spdlog::warn("UploadRing: could not map {} MB, uploads stay synchronous", size / (1024 * 1024));
+        glDeleteBuffers(1, &m_buffer);
+        m_buffer = 0;
+        return false;
+    }
+    m_allocator.reset(size);
+    spdlog::debug("UploadRing: {} MB staging buffer", size / (1024 * 1024));
+    return true;
+}
+
+auto UploadRing::allocate(size_t size) -> UploadBlock {
+    UploadBlock block;
+    if (!m_mapped) {
+        return block;
+    }
+    auto range = m_allocator.allocate(size, ALIGNMENT);
+    if (!range) {
+        return block;
+    }
+    block.m_ring = shared_from_this();
+    block.m_data = m_mapped + range->offset;
+    block.m_range = *range;
+    return block;
+}
+
+auto UploadRing::update() -> void {
+    if (!m_mapped) {
+        return;
+    }
+
+    // one fence behind all copies recorded since the last update
+    auto fenceId = m_nextFence;
+    if (m_allocator.fence(fenceId)) {
+        m_fences.push_back({glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), fenceId});
+        m_nextFence++;
+    }
+
+    // never waits, whatever hasn't passed yet is checked again next frame
+    uint64_t completed = 0;
+    while (!m_fences.empty()) {
+        auto status = glClientWaitSync(m_fences.front().sync, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+            break;
+        }
+        completed = m_fences.front().id;
+        glDeleteSync(m_fences.front().sync);
+        m_fences.pop_front();
+    }
+    if (completed != 0) {
+        m_allocator.retire(completed);
+    }
+}
+
+}  // namespace Vengine
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <glad/glad.h>
+
+#include "vengine/core/ring_allocator.hpp"
+
+namespace Vengine {
+
+class UploadRing;
+
+// one staged upload. workers memcpy into data(), the main thread copies from getOffset() in the
+// ring buffer into the real buffer or texture. dropping the block hands the space back once the
+// gpu is done with that copy, so drop it right after issuing the copy (or when giving up on it)
+class UploadBlock {
+   public:
+    UploadBlock() = default;
+    ~UploadBlock();
+    UploadBlock(const UploadBlock&) = delete;
+    auto operator=(const UploadBlock&) -> UploadBlock& = delete;
+    UploadBlock(UploadBlock&& other) noexcept;
+    auto operator=(UploadBlock&& other) noexcept -> UploadBlock&;
+
+    explicit operator bool() const {
+        return m_data != nullptr;
+    }
+    [[nodiscard]] auto data() const -> uint8_t* {
+        return m_data;
+    }
+    [[nodiscard]] auto getOffset() const -> size_t {
+        return m_range.offset;
+    }
+    [[nodiscard]] auto size() const -> size_t {
+        return m_range.size;
+    }
+    // the ring's buffer, for glCopyNamedBufferSubData or as GL_PIXEL_UNPACK_BUFFER
+    [[nodiscard]] auto getBuffer() const -> GLuint;
+
+    auto reset() -> void;
+
+   private:
+    friend class UploadRing;
+
+    std::shared_ptr<UploadRing> m_ring;
+    uint8_t* m_data = nullptr;
+    RingRange m_range;
+};
+
+// a persistently mapped buffer that uploads are staged through. workers allocate and fill blocks
+// while they load, the main thread only records the copies, no glBufferData or glTexImage2D with
+// client memory on the frame. update() fences the copies of each frame and recycles the space
+// behind fences that passed. a full ring is not an error, loaders upload directly then
+class UploadRing : public std::enable_shared_from_this<UploadRing> {
+   public:
+    static constexpr size_t DEFAULT_SIZE = 64 * 1024 * 1024;
+    // PBO offsets for compressed levels and buffer copies are happy with this, so is every cpu copy
+    static constexpr size_t ALIGNMENT = 256;
+
+    UploadRing() = default;
+    ~UploadRing();
+    UploadRing(const UploadRing&) = delete;
+    auto operator=(const UploadRing&) -> UploadRing& = delete;
+
+    // main thread, with the context current
+    auto init(size_t size = DEFAULT_SIZE) -> bool;
+    // any thread, an empty block if it doesn't fit right now
+    auto allocate(size_t size) -> UploadBlock;
+    // main thread, once a frame after the uploads
+    auto update() -> void;
+
+    [[nodiscard]] auto getBuffer() const -> GLuint {
+        return m_buffer;
+    }
+    [[nodiscard]] auto getSize() const -> size_t {
+        return m_allocator.getCapacity();
+    }
+    [[nodiscard]] auto getUsedBytes() const -> size_t {
+        return m_allocator.getUsedBytes();
+    }
+
+   private:
+    friend class UploadBlock;
+
+    struct Fence {
+        GLsync sync = nullptr;
+        uint64_t id = 0;
+    };
+
+    GLuint m_buffer = 0;
+    uint8_t* m_mapped = nullptr;
+    RingAllocator m_allocator;
+    std::deque<Fence> m_fences;  // oldest first, main thread only
+    uint64_t m_nextFence = 1;
+};
+
+}  // namespace Vengine
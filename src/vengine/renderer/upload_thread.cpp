@@ -0,0 +1,120 @@
+#include "upload_thread.hpp"
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <spdlog/spdlog.h>
+
+#include "vengine/core/cpu_topology.hpp"
+
+namespace Vengine {
+
+UploadThread::UploadThread(std::shared_ptr<ThreadManager> threadManager) : m_threadManager(std::move(threadManager)) {
+}
+
+UploadThread::~UploadThread() {
+    stop();
+}
+
+auto UploadThread::start() -> bool {
+    if (m_context) {
+        return true;
+    }
+    auto* shared = glfwGetCurrentContext();
+    if (!shared) {
+        spdlog::warn("UploadThread: no current context to share with");
+        return false;
+    }
+
+    // same context as the window's (Window::init sets these), just never shown
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    m_context = glfwCreateWindow(1, 1, "upload", nullptr, shared);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+    if (!m_context) {
+        spdlog::warn("UploadThread: could not create a shared context, finalizing stays on the main thread");
+        return false;
+    }
+
+    m_stop = false;
+    m_thread = std::thread([this]() { run(); });
+    spdlog::info("UploadThread: uploading on a shared context");
+    return true;
+}
+
+auto UploadThread::stop() -> void {
+    if (!m_context) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_condition.notify_one();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    glfwDestroyWindow(m_context);
+    m_context = nullptr;
+}
+
+auto UploadThread::submit(std::shared_ptr<IResource> resource, const std::string& name, std::function<void(bool)> done)
+    -> void {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.push_back({std::move(resource), name, std::move(done)});
+    }
+    m_condition.notify_one();
+}
+
+auto UploadThread::run() -> void {
+    glfwMakeContextCurrent(m_context);
+    setCurrentThreadName("Upload");
+
+    std::vector<Job> batch;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this]() { return m_stop || !m_queue.empty(); });
+            // stopping still drains what was submitted, loads are waiting for it
+            if (m_queue.empty()) {
+                break;
+            }
+            batch.swap(m_queue);
+        }
+
+        for (auto& job : batch) {
+            job.ok = job.resource->uploadShared();
+        }
+
+        // one fence behind the batch. the flush gets it to the gpu, the wait only blocks this thread
+        auto sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        constexpr GLuint64 TIMEOUT_NS = 100'000'000;
+        GLenum status = GL_TIMEOUT_EXPIRED;
+        while (status == GL_TIMEOUT_EXPIRED) {
+            status = glClientWaitSync(sync, GL_SYNC_FLUSH_COMMANDS_BIT, TIMEOUT_NS);
+        }
+        glDeleteSync(sync);
+        if (status == GL_WAIT_FAILED) {
+            spdlog::error("UploadThread: waiting for the upload fence failed");
+        }
+
+        // the objects are complete from here on, the main thread makes them visible
+        for (auto& job : batch) {
+            auto taskName = "Finish upload: " + job.name;
+            m_threadManager->enqueueMainThreadTask(
+                [job = std::move(job)]() {
+                    bool ok = job.ok && job.resource->finishUpload();
+                    job.done(ok);
+                },
+                taskName);
+        }
+        m_uploadedCount.fetch_add(batch.size(), std::memory_order_relaxed);
+        batch.clear();
+    }
+
+    glfwMakeContextCurrent(nullptr);
+}
+
+}  // namespace Vengine
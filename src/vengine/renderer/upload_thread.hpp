@@ -0,0 +1,71 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "vengine/core/i_resource.hpp"
+#include "vengine/core/thread_manager.hpp"
+
+struct GLFWwindow;
+
+namespace Vengine {
+
+// where loaded resources get their gpu objects. MainThread runs finalizeOnMainThread from the
+// main thread queue within the frame budget. SharedContext uploads on a thread with its own
+// context in the render context's share group, the main thread only finishes up what can't be
+// shared (vertex arrays) once the upload's fence passed
+enum class UploadMode { MainThread, SharedContext };
+
+// the thread behind UploadMode::SharedContext. it takes batches of resources, uploads them,
+// waits for one fence behind the whole batch and only then hands them to the main thread, so
+// the render thread never sees a half uploaded object
+class UploadThread {
+   public:
+    explicit UploadThread(std::shared_ptr<ThreadManager> threadManager);
+    ~UploadThread();
+    UploadThread(const UploadThread&) = delete;
+    auto operator=(const UploadThread&) -> UploadThread& = delete;
+
+    // main thread, with the render context current. false if the driver can't give us a
+    // shared context, resources keep finalizing on the main thread then
+    auto start() -> bool;
+    // main thread. finishes what was submitted already, its completions still go to the main thread
+    auto stop() -> void;
+
+    // any thread, resource->supportsSharedUpload() must be true. done runs on the main thread
+    // with the result, after finishUpload()
+    auto submit(std::shared_ptr<IResource> resource, const std::string& name, std::function<void(bool)> done) -> void;
+
+    [[nodiscard]] auto isRunning() const -> bool {
+        return m_context != nullptr;
+    }
+    [[nodiscard]] auto getUploadedCount() const -> size_t {
+        return m_uploadedCount.load(std::memory_order_relaxed);
+    }
+
+   private:
+    struct Job {
+        std::shared_ptr<IResource> resource;
+        std::string name;
+        std::function<void(bool)> done;
+        bool ok = false;
+    };
+
+    auto run() -> void;
+
+    std::shared_ptr<ThreadManager> m_threadManager;
+    GLFWwindow* m_context = nullptr;  // hidden window, glfw has no windowless contexts
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::vector<Job> m_queue;
+    bool m_stop = false;
+    std::atomic<size_t> m_uploadedCount{0};
+};
+
+}  // namespace Vengine
@@ -27,27 +27,24 @@ auto VertexArray::addVertexBuffer(const std::shared_ptr<VertexBuffer>& vertexBuf
 
     auto stride = layout.calculateStride();
 
-    uintptr_t currentOffset = 0;
-
-    // Position attribute (location 0)
-    if (layout.hasPosition) {
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<const void*>(currentOffset));
-        glEnableVertexAttribArray(0);
-        currentOffset += 3 * sizeof(float);
-    }
-
-    // Texture coordinate attribute (location 1)
-    if (layout.hasTexCoords) {
-        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<const void*>(currentOffset));
-        glEnableVertexAttribArray(1);
-        currentOffset += 2 * sizeof(float);
-    }
-
-    // Normal attribute (location 2)
-    if (layout.hasNormals) {
-        glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<const void*>(currentOffset));
-        glEnableVertexAttribArray(2);
-        currentOffset += 3 * sizeof(float);
+    // the attribute is the shader location: position 0, tex coords 1, normal 2
+    for (uint8_t i = 0; i < layout.elementCount; i++) {
+        const auto& element = layout.elements[i];
+        auto location = static_cast<GLuint>(element.attribute);
+        const auto* offset = reinterpret_cast<const void*>(static_cast<uintptr_t>(element.offset));
+        switch (element.format) {
+            case VertexFormat::Float:
+                glVertexAttribPointer(location, element.components, GL_FLOAT, GL_FALSE, stride, offset);
+                break;
+            case VertexFormat::Half:
+                glVertexAttribPointer(location, element.components, GL_HALF_FLOAT, GL_FALSE, stride, offset);
+                break;
+            case VertexFormat::Int2_10_10_10:
+                // packed formats always have 4 components, a vec3 input just ignores w
+                glVertexAttribPointer(location, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, offset);
+                break;
+        }
+        glEnableVertexAttribArray(location);
     }
 
     vertexBuffer->unbind();
@@ -4,7 +4,7 @@
 
 namespace Vengine {
 
-VertexBuffer::VertexBuffer(const float* vertices, uint32_t size)
+VertexBuffer::VertexBuffer(const void* vertices, uint32_t size)
     : m_size(size) {
     glGenBuffers(1, &m_id);
     glBindBuffer(GL_ARRAY_BUFFER, m_id);
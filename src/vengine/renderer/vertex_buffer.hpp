@@ -6,7 +6,7 @@ namespace Vengine {
 
 class VertexBuffer {
    public:
-    VertexBuffer(const float* vertices, uint32_t size);
+    VertexBuffer(const void* vertices, uint32_t size);
     ~VertexBuffer();
 
     auto bind() const -> void;
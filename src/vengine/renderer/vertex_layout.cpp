@@ -0,0 +1,200 @@
+#include "vertex_layout.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace Vengine {
+
+auto VertexElement::getSize() const -> uint32_t {
+    switch (format) {
+        case VertexFormat::Float:
+            return components * 4u;
+        case VertexFormat::Half:
+            return components * 2u;
+        case VertexFormat::Int2_10_10_10:
+            return 4;
+    }
+    return 0;
+}
+
+auto VertexLayout::add(VertexAttribute attribute, VertexFormat format, uint8_t components) -> VertexLayout& {
+    if (elementCount == MAX_ELEMENTS) {
+        return *this;
+    }
+    VertexElement element{attribute, format, components, stride};
+    stride = static_cast<uint8_t>((stride + element.getSize() + 3u) & ~3u);
+    elements[elementCount++] = element;
+    return *this;
+}
+
+auto VertexLayout::find(VertexAttribute attribute) const -> const VertexElement* {
+    for (uint8_t i = 0; i < elementCount; i++) {
+        if (elements[i].attribute == attribute) {
+            return &elements[i];
+        }
+    }
+    return nullptr;
+}
+
+auto VertexLayout::isFloats() const -> bool {
+    return std::all_of(elements.begin(), elements.begin() + elementCount,
+                       [](const VertexElement& element) { return element.format == VertexFormat::Float; });
+}
+
+auto VertexLayout::floats(bool position, bool texCoords, bool normals) -> VertexLayout {
+    VertexLayout layout;
+    if (position) {
+        layout.add(VertexAttribute::Position, VertexFormat::Float, 3);
+    }
+    if (texCoords) {
+        layout.add(VertexAttribute::TexCoords, VertexFormat::Float, 2);
+    }
+    if (normals) {
+        layout.add(VertexAttribute::Normal, VertexFormat::Float, 3);
+    }
+    return layout;
+}
+
+auto chooseCompactLayout(const float* vertices, size_t vertexCount, const VertexLayout& source) -> VertexLayout {
+    const size_t floatsPerVertex = source.stride / sizeof(float);
+    VertexLayout layout;
+    for (uint8_t i = 0; i < source.elementCount; i++) {
+        const auto& element = source.elements[i];
+        const float* first = vertices + element.offset / sizeof(float);
+        auto format = VertexFormat::Float;
+
+        if (element.attribute == VertexAttribute::Normal && element.components == 3) {
+            format = VertexFormat::Int2_10_10_10;
+        } else if (element.attribute == VertexAttribute::Position && vertexCount > 0) {
+            std::array<float, 3> boundsMin{first[0], first[1], first[2]};
+            std::array<float, 3> boundsMax = boundsMin;
+            float maxAbs = 0.0f;
+            for (size_t v = 0; v < vertexCount; v++) {
+                const float* position = first + v * floatsPerVertex;
+                for (size_t axis = 0; axis < element.components; axis++) {
+                    boundsMin[axis] = std::min(boundsMin[axis], position[axis]);
+                    boundsMax[axis] = std::max(boundsMax[axis], position[axis]);
+                    maxAbs = std::max(maxAbs, std::abs(position[axis]));
+                }
+            }
+            float diagonal = std::hypot(boundsMax[0] - boundsMin[0], boundsMax[1] - boundsMin[1],
+                                        boundsMax[2] - boundsMin[2]);
+            // half the spacing of halves around the largest coordinate, 10 stored mantissa bits
+            float error = maxAbs > 0.0f ? std::ldexp(1.0f, std::ilogb(maxAbs) - 11) : 0.0f;
+            if (maxAbs <= 65504.0f && diagonal > 0.0f && error <= diagonal * HALF_POSITION_TOLERANCE) {
+                format = VertexFormat::Half;
+            }
+        } else if (element.attribute == VertexAttribute::TexCoords) {
+            bool fits = true;
+            for (size_t v = 0; v < vertexCount && fits; v++) {
+                const float* texCoords = first + v * floatsPerVertex;
+                for (size_t k = 0; k < element.components; k++) {
+                    fits = fits && std::abs(texCoords[k]) <= HALF_TEX_COORD_RANGE;
+                }
+            }
+            if (fits) {
+                format = VertexFormat::Half;
+            }
+        }
+        layout.add(element.attribute, format, element.components);
+    }
+    return layout;
+}
+
+auto packVertices(const float* vertices, size_t vertexCount, const VertexLayout& source, const VertexLayout& target,
+                  uint8_t* out) -> void {
+    const size_t floatsPerVertex = source.stride / sizeof(float);
+    std::memset(out, 0, vertexCount * target.stride);
+    for (uint8_t i = 0; i < target.elementCount; i++) {
+        const auto& element = target.elements[i];
+        const auto* from = source.find(element.attribute);
+        if (!from) {
+            continue;
+        }
+        const float* src = vertices + from->offset / sizeof(float);
+        uint8_t* dst = out + element.offset;
+        for (size_t v = 0; v < vertexCount; v++, src += floatsPerVertex, dst += target.stride) {
+            switch (element.format) {
+                case VertexFormat::Float:
+                    std::memcpy(dst, src, element.components * sizeof(float));
+                    break;
+                case VertexFormat::Half:
+                    for (size_t k = 0; k < element.components; k++) {
+                        auto half = floatToHalf(src[k]);
+                        std::memcpy(dst + k * sizeof(uint16_t), &half, sizeof(half));
+                    }
+                    break;
+                case VertexFormat::Int2_10_10_10: {
+                    auto packed = packSnorm10(src[0], src[1], src[2]);
+                    std::memcpy(dst, &packed, sizeof(packed));
+                    break;
+                }
+            }
+        }
+    }
+}
+
+auto floatToHalf(float value) -> uint16_t {
+    uint32_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    auto sign = static_cast<uint16_t>((bits >> 16) & 0x8000u);
+    uint32_t magnitude = bits & 0x7fffffffu;
+
+    if (magnitude >= 0x7f800000u) {
+        // inf stays inf, nan stays a (quiet) nan
+        return sign | 0x7c00u | (magnitude > 0x7f800000u ? 0x200u : 0u);
+    }
+    if (magnitude >= 0x477ff000u) {
+        // 65520 and up round past the largest half
+        return sign | 0x7c00u;
+    }
+    if (magnitude < 0x38800000u) {
+        // below the smallest normal half, 2^-14. subnormals count in steps of 2^-24
+        float absolute = 0.0f;
+        std::memcpy(&absolute, &magnitude, sizeof(absolute));
+        return sign | static_cast<uint16_t>(std::nearbyint(absolute * 16777216.0f));
+    }
+    // rebias the exponent from 127 to 15, then round the 13 dropped mantissa bits to nearest even
+    uint32_t half = magnitude - 0x38000000u;
+    half += 0x0fffu + ((half >> 13) & 1u);
+    return sign | static_cast<uint16_t>(half >> 13);
+}
+
+auto halfToFloat(uint16_t value) -> float {
+    uint32_t sign = static_cast<uint32_t>(value & 0x8000u) << 16;
+    uint32_t exponent = (value >> 10) & 0x1fu;
+    uint32_t mantissa = value & 0x3ffu;
+    if (exponent == 0) {
+        float result = std::ldexp(static_cast<float>(mantissa), -24);
+        return sign ? -result : result;
+    }
+    uint32_t bits = exponent == 31 ? sign | 0x7f800000u | (mantissa << 13)
+                                   : sign | ((exponent + 112) << 23) | (mantissa << 13);
+    float result = 0.0f;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+auto packSnorm10(float x, float y, float z) -> uint32_t {
+    auto pack = [](float value) {
+        auto quantized = static_cast<int32_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * 511.0f));
+        return static_cast<uint32_t>(quantized) & 0x3ffu;
+    };
+    return pack(x) | (pack(y) << 10) | (pack(z) << 20);
+}
+
+auto unpackSnorm10(uint32_t packed) -> std::array<float, 3> {
+    std::array<float, 3> result{};
+    for (size_t k = 0; k < 3; k++) {
+        // sign extend the 10 bits, -512 and -511 both mean -1 like in gl
+        auto value = static_cast<int32_t>((packed >> (k * 10)) & 0x3ffu);
+        if (value >= 512) {
+            value -= 1024;
+        }
+        result[k] = std::max(static_cast<float>(value) / 511.0f, -1.0f);
+    }
+    return result;
+}
+
+}  // namespace Vengine
@@ -1,25 +1,79 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
 namespace Vengine {
 
+// doubles as the shader input location
+enum class VertexAttribute : uint8_t { Position = 0, TexCoords = 1, Normal = 2 };
+
+enum class VertexFormat : uint8_t {
+    Float,
+    Half,
+    Int2_10_10_10,  // xyz as signed normalized 10 bits each + 2 spare bits, GL_INT_2_10_10_10_REV
+};
+
+struct VertexElement {
+    VertexAttribute attribute = VertexAttribute::Position;
+    VertexFormat format = VertexFormat::Float;
+    uint8_t components = 0;
+    uint8_t offset = 0;  // bytes from the start of the vertex
+
+    [[nodiscard]] auto getSize() const -> uint32_t;
+    auto operator==(const VertexElement&) const -> bool = default;
+};
+
+// interleaved vertex, described element by element
 struct VertexLayout {
-    bool hasPosition = true;
-    bool hasTexCoords = false;
-    bool hasNormals = false;
+    static constexpr size_t MAX_ELEMENTS = 3;
+
+    std::array<VertexElement, MAX_ELEMENTS> elements{};
+    uint8_t elementCount = 0;
+    uint8_t stride = 0;
+
+    // appended at the end, every element starts 4 byte aligned like gl wants it
+    auto add(VertexAttribute attribute, VertexFormat format, uint8_t components) -> VertexLayout&;
 
+    [[nodiscard]] auto find(VertexAttribute attribute) const -> const VertexElement*;
+    [[nodiscard]] auto has(VertexAttribute attribute) const -> bool {
+        return find(attribute) != nullptr;
+    }
     [[nodiscard]] auto calculateStride() const -> int {
-        int stride = 0;
-        if (hasPosition) {
-            stride += 3 * sizeof(float);
-        }
-        if (hasTexCoords) {
-            stride += 2 * sizeof(float);
-        }
-        if (hasNormals) {
-            stride += 3 * sizeof(float);
-        }
         return stride;
     }
+    // only 32-bit floats, what meshes are built and cached in
+    [[nodiscard]] auto isFloats() const -> bool;
+
+    // position 3, tex coords 2 and normal 3 floats, in that order
+    [[nodiscard]] static auto floats(bool position, bool texCoords, bool normals) -> VertexLayout;
+
+    auto operator==(const VertexLayout&) const -> bool = default;
 };
 
-}  // namespace Vengine
\ No newline at end of file
+// half positions as long as their rounding stays below this fraction of the bounds' diagonal,
+// meshes far from their origin keep floats
+constexpr float HALF_POSITION_TOLERANCE = 1.0f / 2048.0f;
+// half tex coords up to this magnitude, that keeps them within half a texel of a 1024 texture
+constexpr float HALF_TEX_COORD_RANGE = 2.0f;
+
+// the smallest gpu layout for vertices in a floats() layout that keeps them close enough.
+// normals always fit 2_10_10_10, positions and tex coords go half if the data allows it
+[[nodiscard]] auto chooseCompactLayout(const float* vertices, size_t vertexCount, const VertexLayout& source)
+    -> VertexLayout;
+
+// converts from a floats() layout, out is vertexCount * target.stride bytes. target has to have
+// the same attributes
+auto packVertices(const float* vertices, size_t vertexCount, const VertexLayout& source, const VertexLayout& target,
+                  uint8_t* out) -> void;
+
+// ieee 754 binary16, round to nearest even, out of range goes to infinity
+[[nodiscard]] auto floatToHalf(float value) -> uint16_t;
+[[nodiscard]] auto halfToFloat(uint16_t value) -> float;
+
+// x in the lowest bits, like GL_INT_2_10_10_10_REV. values are clamped to [-1, 1]
+[[nodiscard]] auto packSnorm10(float x, float y, float z) -> uint32_t;
+[[nodiscard]] auto unpackSnorm10(uint32_t packed) -> std::array<float, 3>;
+
+}  // namespace Vengine
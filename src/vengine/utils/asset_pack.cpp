@@ -0,0 +1,272 @@
+#include "asset_pack.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <lz4.h>
+#include <spdlog/spdlog.h>
+
+#include "vengine/utils/hash.hpp"
+
+namespace Vengine {
+
+namespace {
+
+constexpr char MAGIC[4] = {'V', 'P', 'A', 'K'};
+
+struct AssetPackHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t reserved;
+    uint64_t tocOffset;
+    uint64_t pathsSize;  // right after the toc
+};
+static_assert(sizeof(AssetPackHeader) == 32, "AssetPackHeader layout changed, bump AssetPack::VERSION");
+
+auto alignUp(uint64_t value) -> uint64_t {
+    return (value + AssetPack::ALIGNMENT - 1) / AssetPack::ALIGNMENT * AssetPack::ALIGNMENT;
+}
+
+}  // namespace
+
+auto AssetPack::normalizePath(const std::filesystem::path& path) -> std::string {
+    auto normal = path.lexically_normal().generic_string();
+    if (normal.starts_with("./")) {
+        normal.erase(0, 2);
+    }
+    return normal;
+}
+
+auto AssetPack::open(const std::filesystem::path& path) -> bool {
+    m_entries = {};
+    m_paths = nullptr;
+    m_pathsSize = 0;
+    if (!m_file.open(path.string()) || m_file.size() < sizeof(AssetPackHeader)) {
+        spdlog::error("AssetPack: could not open {}", path.string());
+        return false;
+    }
+
+    AssetPackHeader header;
+    std::memcpy(&header, m_file.data(), sizeof(header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION) {
+        spdlog::error("AssetPack: {} is not a version {} pack", path.string(), VERSION);
+        m_file.close();
+        return false;
+    }
+
+    uint64_t tocBytes = static_cast<uint64_t>(header.entryCount) * sizeof(AssetPackEntry);
+    if (header.tocOffset % alignof(AssetPackEntry) != 0 || header.tocOffset > m_file.size() ||
+        tocBytes + header.pathsSize > m_file.size() - header.tocOffset) {
+        spdlog::error("AssetPack: {} has a corrupt table of contents", path.string());
+        m_file.close();
+        return false;
+    }
+
+    // the mapping is page aligned and the toc offset is checked above, the toc is used in place
+    const auto* entries = reinterpret_cast<const AssetPackEntry*>(m_file.data() + header.tocOffset);
+    m_entries = std::span<const AssetPackEntry>(entries, header.entryCount);
+    m_paths = reinterpret_cast<const char*>(m_file.data() + header.tocOffset + tocBytes);
+    m_pathsSize = header.pathsSize;
+
+    for (const auto& entry : m_entries) {
+        if (entry.offset > header.tocOffset || entry.storedSize > header.tocOffset - entry.offset ||
+            static_cast<uint64_t>(entry.pathOffset) + entry.pathLength > m_pathsSize ||
+            entry.compression > static_cast<uint32_t>(AssetCompression::LZ4) ||
+            // stored as is, read() and Vfs hand out size bytes from the mapping
+            (entry.compression == static_cast<uint32_t>(AssetCompression::None) && entry.size != entry.storedSize) ||
+            // LZ4_decompress_safe takes both sizes as int
+            (entry.compression == static_cast<uint32_t>(AssetCompression::LZ4) &&
+             (entry.size > static_cast<uint64_t>(std::numeric_limits<int>::max()) ||
+              entry.storedSize > static_cast<uint64_t>(std::numeric_limits<int>::max())))) {
+            spdlog::error("AssetPack: {} has a corrupt entry", path.string());
+            m_entries = {};
+            m_file.close();
+            return false;
+        }
+    }
+
+    // find() binary searches by pathHash and walks the collisions, that needs sorted, unique paths
+    for (size_t i = 1; i < m_entries.size(); ++i) {
+        bool sorted = m_entries[i - 1].pathHash <= m_entries[i].pathHash;
+        for (size_t k = i; sorted && k > 0 && m_entries[k - 1].pathHash == m_entries[i].pathHash; --k) {
+            sorted = getPath(m_entries[k - 1]) != getPath(m_entries[i]);
+        }
+        if (!sorted) {
+            spdlog::error("AssetPack: {} has an unsorted table of contents or a path twice", path.string());
+            m_entries = {};
+            m_file.close();
+            return false;
+        }
+    }
+
+    m_path = path;
+    spdlog::debug("AssetPack: opened {} with {} entries", path.string(), m_entries.size());
+    return true;
+}
+
+auto AssetPack::find(const std::filesystem::path& path) const -> const AssetPackEntry* {
+    auto normal = normalizePath(path);
+    auto pathHash = hash64(normal);
+    auto it = std::lower_bound(m_entries.begin(), m_entries.end(), pathHash, [](const auto& entry, uint64_t hash) {
+        return entry.pathHash < hash;
+    });
+    // collisions are next to each other, the string decides
+    for (; it != m_entries.end() && it->pathHash == pathHash; ++it) {
+        if (getPath(*it) == normal) {
+            return &*it;
+        }
+    }
+    return nullptr;
+}
+
+auto AssetPack::getPath(const AssetPackEntry& entry) const -> std::string_view {
+    return {m_paths + entry.pathOffset, entry.pathLength};
+}
+
+auto AssetPack::read(const AssetPackEntry& entry, std::vector<uint8_t>& out) const -> bool {
+    const auto* stored = getStoredData(entry);
+    if (entry.compression == static_cast<uint32_t>(AssetCompression::None)) {
+        out.assign(stored, stored + entry.size);
+        return true;
+    }
+
+    out.resize(entry.size);
+    int decoded = LZ4_decompress_safe(reinterpret_cast<const char*>(stored),
+                                      reinterpret_cast<char*>(out.data()),
+                                      static_cast<int>(entry.storedSize),
+                                      static_cast<int>(entry.size));
+    if (decoded < 0 || static_cast<uint64_t>(decoded) != entry.size) {
+        spdlog::error("AssetPack: could not decompress {} from {}", getPath(entry), m_path.string());
+        out.clear();
+        return false;
+    }
+    return true;
+}
+
+AssetPackWriter::~AssetPackWriter() {
+    // never finished, don't leave the temp file behind
+    if (m_file.is_open()) {
+        m_file.close();
+        std::error_code error;
+        std::filesystem::remove(m_tempPath, error);
+    }
+}
+
+auto AssetPackWriter::open(const std::filesystem::path& path) -> bool {
+    m_path = path;
+    m_tempPath = path;
+    m_tempPath += ".tmp";
+    m_file.open(m_tempPath, std::ios::binary | std::ios::trunc);
+    if (!m_file.is_open()) {
+        spdlog::error("AssetPackWriter: could not write {}", m_tempPath.string());
+        return false;
+    }
+
+    // the real header goes in at finish(), once the toc offset is known
+    AssetPackHeader header{};
+    m_offset = 0;
+    return write(&header, sizeof(header));
+}
+
+auto AssetPackWriter::write(const void* data, size_t size) -> bool {
+    m_file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+    m_offset += size;
+    return m_file.good();
+}
+
+auto AssetPackWriter::add(const std::filesystem::path& path,
+                          const uint8_t* data,
+                          size_t size,
+                          AssetCompression compression) -> bool {
+    auto normal = AssetPack::normalizePath(path);
+
+    AssetPackEntry entry{};
+    entry.pathHash = hash64(normal);
+    entry.contentHash = hash64(data, size);
+    entry.size = size;
+    entry.pathOffset = static_cast<uint32_t>(m_paths.size());
+    entry.pathLength = static_cast<uint32_t>(normal.size());
+
+    const uint8_t* stored = data;
+    size_t storedSize = size;
+    std::vector<uint8_t> compressed;
+    if (compression == AssetCompression::LZ4 && size > 0 && size <= LZ4_MAX_INPUT_SIZE) {
+        compressed.resize(static_cast<size_t>(LZ4_compressBound(static_cast<int>(size))));
+        int written = LZ4_compress_default(reinterpret_cast<const char*>(data),
+                                           reinterpret_cast<char*>(compressed.data()),
+                                           static_cast<int>(size),
+                                           static_cast<int>(compressed.size()));
+        // png, jpg and the like barely shrink, those are cheaper to read as they are
+        if (written > 0 && static_cast<size_t>(written) < size - size / 16) {
+            stored = compressed.data();
+            storedSize = static_cast<size_t>(written);
+            entry.compression = static_cast<uint32_t>(AssetCompression::LZ4);
+        }
+    }
+
+    static constexpr uint8_t PADDING[AssetPack::ALIGNMENT] = {};
+    if (!write(PADDING, alignUp(m_offset) - m_offset)) {
+        return false;
+    }
+    entry.offset = m_offset;
+    entry.storedSize = storedSize;
+    if (!write(stored, storedSize)) {
+        spdlog::error("AssetPackWriter: could not write {}", normal);
+        return false;
+    }
+
+    m_paths += normal;
+    m_entries.push_back(entry);
+    m_storedBytes += storedSize;
+    m_rawBytes += size;
+    return true;
+}
+
+auto AssetPackWriter::finish() -> bool {
+    std::sort(m_entries.begin(), m_entries.end(), [](const auto& a, const auto& b) { return a.pathHash < b.pathHash; });
+    for (size_t i = 1; i < m_entries.size(); ++i) {
+        if (m_entries[i].pathHash == m_entries[i - 1].pathHash &&
+            std::string_view(m_paths).substr(m_entries[i].pathOffset, m_entries[i].pathLength) ==
+                std::string_view(m_paths).substr(m_entries[i - 1].pathOffset, m_entries[i - 1].pathLength)) {
+            spdlog::error("AssetPackWriter: {} was added twice",
+                          std::string_view(m_paths).substr(m_entries[i].pathOffset, m_entries[i].pathLength));
+            return false;
+        }
+    }
+
+    static constexpr uint8_t PADDING[AssetPack::ALIGNMENT] = {};
+    AssetPackHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = AssetPack::VERSION;
+    header.entryCount = static_cast<uint32_t>(m_entries.size());
+    header.pathsSize = m_paths.size();
+
+    if (!write(PADDING, alignUp(m_offset) - m_offset)) {
+        return false;
+    }
+    header.tocOffset = m_offset;
+    if (!write(m_entries.data(), m_entries.size() * sizeof(AssetPackEntry)) || !write(m_paths.data(), m_paths.size())) {
+        spdlog::error("AssetPackWriter: could not write the table of contents");
+        return false;
+    }
+
+    m_file.seekp(0);
+    m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    m_file.close();
+    if (m_file.fail()) {
+        spdlog::error("AssetPackWriter: could not finish {}", m_tempPath.string());
+        return false;
+    }
+
+    std::error_code error;
+    std::filesystem::rename(m_tempPath, m_path, error);
+    if (error) {
+        spdlog::error("AssetPackWriter: could not move {} into place: {}", m_path.string(), error.message());
+        std::filesystem::remove(m_tempPath, error);
+        return false;
+    }
+    return true;
+}
+
+}  // namespace Vengine
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "vengine/utils/mapped_file.hpp"
+
+namespace Vengine {
+
+enum class AssetCompression : uint32_t { None = 0, LZ4 = 1 };
+
+// one file in a pack. the toc is sorted by pathHash so a lookup is a binary search on the mapping
+struct AssetPackEntry {
+    uint64_t pathHash;
+    uint64_t contentHash;  // hash64 of the uncompressed bytes, the same as FileStamp::hash
+    uint64_t offset;       // from the start of the pack, a multiple of AssetPack::ALIGNMENT
+    uint64_t storedSize;
+    uint64_t size;
+    uint32_t pathOffset;  // into the path strings after the toc
+    uint32_t pathLength;
+    uint32_t compression;
+    uint32_t reserved;
+};
+static_assert(sizeof(AssetPackEntry) == 56, "AssetPackEntry layout changed, bump AssetPack::VERSION");
+
+// a .vpak: header, the entries one after another, then the toc and the path strings.
+// native endian like .vmesh/.vtex, packs are built for the platform they ship on
+class AssetPack {
+   public:
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint64_t ALIGNMENT = 64;
+
+    auto open(const std::filesystem::path& path) -> bool;
+
+    // path as the loaders use it, "resources/textures/foo.png". nullptr when it isn't packed
+    [[nodiscard]] auto find(const std::filesystem::path& path) const -> const AssetPackEntry*;
+    [[nodiscard]] auto getPath(const AssetPackEntry& entry) const -> std::string_view;
+    // the bytes as stored, still compressed for LZ4 entries
+    [[nodiscard]] auto getStoredData(const AssetPackEntry& entry) const -> const uint8_t* {
+        return m_file.data() + entry.offset;
+    }
+    // decompresses when needed
+    auto read(const AssetPackEntry& entry, std::vector<uint8_t>& out) const -> bool;
+
+    [[nodiscard]] auto getEntries() const -> std::span<const AssetPackEntry> {
+        return m_entries;
+    }
+    [[nodiscard]] auto getFilePath() const -> const std::filesystem::path& {
+        return m_path;
+    }
+
+    // the form paths are stored and looked up in, forward slashes and no "./" or ".."
+    static auto normalizePath(const std::filesystem::path& path) -> std::string;
+
+   private:
+    MappedFile m_file;
+    std::filesystem::path m_path;
+    std::span<const AssetPackEntry> m_entries;
+    const char* m_paths = nullptr;
+    size_t m_pathsSize = 0;
+};
+
+// what the asset_pack tool writes packs with. entries go straight to a temp file, only the toc
+// stays in memory until finish() moves the pack into place
+class AssetPackWriter {
+   public:
+    AssetPackWriter() = default;
+    ~AssetPackWriter();
+    AssetPackWriter(const AssetPackWriter&) = delete;
+    auto operator=(const AssetPackWriter&) -> AssetPackWriter& = delete;
+
+    auto open(const std::filesystem::path& path) -> bool;
+    // LZ4 is only kept when it actually saves space, the entry is stored as is otherwise
+    auto add(const std::filesystem::path& path, const uint8_t* data, size_t size, AssetCompression compression) -> bool;
+    auto finish() -> bool;
+
+    [[nodiscard]] auto getEntryCount() const -> size_t {
+        return m_entries.size();
+    }
+    [[nodiscard]] auto getStoredBytes() const -> uint64_t {
+        return m_storedBytes;
+    }
+    [[nodiscard]] auto getRawBytes() const -> uint64_t {
+        return m_rawBytes;
+    }
+
+   private:
+    auto write(const void* data, size_t size) -> bool;
+
+    std::ofstream m_file;
+    std::filesystem::path m_path;
+    std::filesystem::path m_tempPath;
+    uint64_t m_offset = 0;
+    std::vector<AssetPackEntry> m_entries;
+    std::string m_paths;
+    uint64_t m_storedBytes = 0;
+    uint64_t m_rawBytes = 0;
+};
+
+}  // namespace Vengine
@@ -0,0 +1,63 @@
+#include "file_stamp.hpp"
+
+#include "vengine/utils/hash.hpp"
+#include "vengine/utils/mapped_file.hpp"
+#include "vengine/utils/vfs.hpp"
+
+namespace Vengine {
+
+namespace {
+
+auto readSizeAndTime(const std::filesystem::path& path, FileStamp& out) -> bool {
+    std::error_code error;
+    auto size = std::filesystem::file_size(path, error);
+    if (error) {
+        return false;
+    }
+    auto mtime = std::filesystem::last_write_time(path, error);
+    if (error) {
+        return false;
+    }
+    out.size = static_cast<uint64_t>(size);
+    out.mtime = static_cast<int64_t>(mtime.time_since_epoch().count());
+    return true;
+}
+
+auto hashFile(const std::filesystem::path& path, uint64_t& out) -> bool {
+    MappedFile file;
+    if (!file.open(path.string())) {
+        return false;
+    }
+    out = hash64(file.data(), file.size());
+    return true;
+}
+
+}  // namespace
+
+auto readFileStamp(const std::filesystem::path& path, FileStamp& out) -> bool {
+    // a packed file has its hash in the toc already
+    if (Vfs::statPacked(path, out)) {
+        return true;
+    }
+    return readSizeAndTime(path, out) && hashFile(path, out.hash);
+}
+
+auto matchesFileStamp(const std::filesystem::path& path, const FileStamp& stamp, FileStamp* current) -> bool {
+    FileStamp now;
+    if (!current) {
+        current = &now;
+    }
+    if (Vfs::statPacked(path, *current)) {
+        return current->size == stamp.size && current->hash == stamp.hash;
+    }
+    if (!readSizeAndTime(path, *current) || current->size != stamp.size) {
+        return false;
+    }
+    if (current->mtime == stamp.mtime) {
+        current->hash = stamp.hash;
+        return true;
+    }
+    return hashFile(path, current->hash) && current->hash == stamp.hash;
+}
+
+}  // namespace Vengine
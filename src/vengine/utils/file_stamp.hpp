@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+
+namespace Vengine {
+
+// identifies the version of a source file a cache entry was built from
+struct FileStamp {
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    uint64_t hash = 0;  // hash64 of the content
+};
+
+auto readFileStamp(const std::filesystem::path& path, FileStamp& out) -> bool;
+
+// size + mtime first, the content hash only runs when the mtime alone differs
+// (touched, checked out again, copied). files in a mounted pack compare size and the toc hash.
+// current, if given, gets the mtime the file has now, a caller can refresh a stale stamp with it
+auto matchesFileStamp(const std::filesystem::path& path, const FileStamp& stamp, FileStamp* current = nullptr)
+    -> bool;
+
+}  // namespace Vengine
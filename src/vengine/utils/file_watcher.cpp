@@ -0,0 +1,138 @@
+#include "file_watcher.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include "vengine/utils/asset_pack.hpp"
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace Vengine {
+
+auto FileWatcher::normalize(const std::filesystem::path& path) -> std::string {
+    // hot reload and pack lookups have to agree on the key of a file
+    return AssetPack::normalizePath(path);
+}
+
+#ifdef __linux__
+
+FileWatcher::~FileWatcher() {
+    if (m_fd >= 0) {
+        close(m_fd);
+    }
+}
+
+auto FileWatcher::isNative() const -> bool {
+    return true;
+}
+
+auto FileWatcher::watch(const std::filesystem::path& path) -> bool {
+    auto key = normalize(path);
+    if (m_files.contains(key)) {
+        return true;
+    }
+
+    if (m_fd < 0) {
+        m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (m_fd < 0) {
+            spdlog::error("FileWatcher: inotify_init1 failed: {}", std::strerror(errno));
+            return false;
+        }
+    }
+
+    // the directory, the file itself would lose its watch when an editor replaces it
+    auto directory = std::filesystem::path(key).parent_path();
+    if (!m_watchedDirectories.contains(directory.string())) {
+        auto target = directory.empty() ? std::string(".") : directory.string();
+        int wd = inotify_add_watch(m_fd, target.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+        if (wd < 0) {
+            spdlog::warn("FileWatcher: can't watch {}: {}", target, std::strerror(errno));
+            return false;
+        }
+        m_directories[wd] = directory;
+        m_watchedDirectories.insert(directory.string());
+    }
+
+    m_files.emplace(std::move(key), std::filesystem::file_time_type{});
+    return true;
+}
+
+auto FileWatcher::poll(std::vector<std::filesystem::path>& changed) -> void {
+    if (m_fd < 0) {
+        return;
+    }
+
+    std::unordered_set<std::string> seen;
+    alignas(inotify_event) char buffer[4096];
+    while (true) {
+        auto length = read(m_fd, buffer, sizeof(buffer));
+        if (length <= 0) {
+            // EAGAIN, nothing left
+            break;
+        }
+        for (ssize_t offset = 0; offset < length;) {
+            const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+            offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+            auto directory = m_directories.find(event->wd);
+            if (directory == m_directories.end() || event->len == 0) {
+                continue;
+            }
+            auto key = normalize(directory->second / event->name);
+            if (m_files.contains(key) && seen.insert(key).second) {
+                changed.emplace_back(std::move(key));
+            }
+        }
+    }
+}
+
+#else
+
+namespace {
+
+auto lastWriteTime(const std::string& path) -> std::filesystem::file_time_type {
+    std::error_code error;
+    auto time = std::filesystem::last_write_time(path, error);
+    return error ? std::filesystem::file_time_type{} : time;
+}
+
+}  // namespace
+
+FileWatcher::~FileWatcher() = default;
+
+auto FileWatcher::isNative() const -> bool {
+    return false;
+}
+
+auto FileWatcher::watch(const std::filesystem::path& path) -> bool {
+    auto key = normalize(path);
+    if (!m_files.contains(key)) {
+        auto time = lastWriteTime(key);
+        m_files.emplace(std::move(key), time);
+    }
+    return true;
+}
+
+auto FileWatcher::poll(std::vector<std::filesystem::path>& changed) -> void {
+    auto now = std::chrono::steady_clock::now();
+    if (now - m_lastPoll < POLL_INTERVAL) {
+        return;
+    }
+    m_lastPoll = now;
+
+    for (auto& [path, time] : m_files) {
+        auto current = lastWriteTime(path);
+        if (current != time) {
+            time = current;
+            changed.emplace_back(path);
+        }
+    }
+}
+
+#endif
+
+}  // namespace Vengine
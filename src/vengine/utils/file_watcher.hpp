@@ -0,0 +1,49 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace Vengine {
+
+// tells which of a set of files were written since the last poll. on linux that is inotify on the
+// parent directories (editors that save through a temp file and rename are caught too), elsewhere
+// the mtimes get compared every POLL_INTERVAL. not thread safe, the owner locks
+class FileWatcher {
+   public:
+    static constexpr auto POLL_INTERVAL = std::chrono::milliseconds(250);
+
+    FileWatcher() = default;
+    ~FileWatcher();
+    FileWatcher(const FileWatcher&) = delete;
+    auto operator=(const FileWatcher&) -> FileWatcher& = delete;
+
+    // false if the directory can't be watched, watching a file twice is fine
+    auto watch(const std::filesystem::path& path) -> bool;
+    // never blocks. every changed file shows up once, however often it was written in between
+    auto poll(std::vector<std::filesystem::path>& changed) -> void;
+
+    [[nodiscard]] auto getWatchedCount() const -> size_t {
+        return m_files.size();
+    }
+    // inotify, false for the mtime fallback
+    [[nodiscard]] auto isNative() const -> bool;
+
+    // the key files are watched under, "./a/../b.txt" and "b.txt" are the same file
+    static auto normalize(const std::filesystem::path& path) -> std::string;
+
+   private:
+    std::unordered_map<std::string, std::filesystem::file_time_type> m_files;
+#ifdef __linux__
+    int m_fd = -1;
+    std::unordered_map<int, std::filesystem::path> m_directories;  // inotify watch -> directory
+    std::unordered_set<std::string> m_watchedDirectories;
+#else
+    std::chrono::steady_clock::time_point m_lastPoll;
+#endif
+};
+
+}  // namespace Vengine
@@ -0,0 +1,113 @@
+#include "hash.hpp"
+
+#include <bit>
+#include <cstring>
+
+namespace Vengine {
+
+namespace {
+
+constexpr uint64_t PRIME1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr uint64_t PRIME3 = 0x165667B19E3779F9ULL;
+constexpr uint64_t PRIME4 = 0x85EBCA77C2B2AE63ULL;
+constexpr uint64_t PRIME5 = 0x27D4EB2F165667C5ULL;
+
+// little endian reads, memcpy so unaligned input is fine
+auto read64(const uint8_t* p) -> uint64_t {
+    uint64_t value = 0;
+    std::memcpy(&value, p, sizeof(value));
+    if constexpr (std::endian::native == std::endian::big) {
+        value = __builtin_bswap64(value);
+    }
+    return value;
+}
+
+auto read32(const uint8_t* p) -> uint32_t {
+    uint32_t value = 0;
+    std::memcpy(&value, p, sizeof(value));
+    if constexpr (std::endian::native == std::endian::big) {
+        value = __builtin_bswap32(value);
+    }
+    return value;
+}
+
+auto round(uint64_t acc, uint64_t input) -> uint64_t {
+    acc += input * PRIME2;
+    acc = std::rotl(acc, 31);
+    return acc * PRIME1;
+}
+
+auto mergeRound(uint64_t acc, uint64_t value) -> uint64_t {
+    acc ^= round(0, value);
+    return acc * PRIME1 + PRIME4;
+}
+
+}  // namespace
+
+auto hash64(const void* data, size_t size, uint64_t seed) -> uint64_t {
+    const auto* p = static_cast<const uint8_t*>(data);
+    const uint8_t* end = p + size;
+    uint64_t hash = 0;
+
+    if (size >= 32) {
+        uint64_t v1 = seed + PRIME1 + PRIME2;
+        uint64_t v2 = seed + PRIME2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - PRIME1;
+
+        const uint8_t* limit = end - 32;
+        do {
+            v1 = round(v1, read64(p));
+            v2 = round(v2, read64(p + 8));
+            v3 = round(v3, read64(p + 16));
+            v4 = round(v4, read64(p + 24));
+            p += 32;
+        } while (p <= limit);
+
+        hash = std::rotl(v1, 1) + std::rotl(v2, 7) + std::rotl(v3, 12) + std::rotl(v4, 18);
+        hash = mergeRound(hash, v1);
+        hash = mergeRound(hash, v2);
+        hash = mergeRound(hash, v3);
+        hash = mergeRound(hash, v4);
+    } else {
+        hash = seed + PRIME5;
+    }
+
+    hash += static_cast<uint64_t>(size);
+
+    while (p + 8 <= end) {
+        hash ^= round(0, read64(p));
+        hash = std::rotl(hash, 27) * PRIME1 + PRIME4;
+        p += 8;
+    }
+    if (p + 4 <= end) {
+        hash ^= static_cast<uint64_t>(read32(p)) * PRIME1;
+        hash = std::rotl(hash, 23) * PRIME2 + PRIME3;
+        p += 4;
+    }
+    while (p < end) {
+        hash ^= static_cast<uint64_t>(*p) * PRIME5;
+        hash = std::rotl(hash, 11) * PRIME1;
+        ++p;
+    }
+
+    hash ^= hash >> 33;
+    hash *= PRIME2;
+    hash ^= hash >> 29;
+    hash *= PRIME3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+auto hashToString(uint64_t hash) -> std::string {
+    static constexpr char DIGITS[] = "0123456789abcdef";
+    std::string result(16, '0');
+    for (int i = 15; i >= 0; --i) {
+        result[static_cast<size_t>(i)] = DIGITS[hash & 0xF];
+        hash >>= 4;
+    }
+    return result;
+}
+
+}  // namespace Vengine
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Vengine {
+
+// xxh64, fast non-cryptographic hash. same input and seed give the same value on every platform,
+// so results can be written to disk (cache keys, content hashes)
+auto hash64(const void* data, size_t size, uint64_t seed = 0) -> uint64_t;
+
+inline auto hash64(const std::string& text, uint64_t seed = 0) -> uint64_t {
+    return hash64(text.data(), text.size(), seed);
+}
+
+// 16 lowercase hex digits
+auto hashToString(uint64_t hash) -> std::string;
+
+}  // namespace Vengine
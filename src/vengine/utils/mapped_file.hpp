@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Vengine {
+
+// read only memory mapping of a whole file, unmapped on destruction
+class MappedFile {
+   public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    auto operator=(const MappedFile&) -> MappedFile& = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    auto operator=(MappedFile&& other) noexcept -> MappedFile&;
+
+    auto open(const std::string& path) -> bool;
+    auto close() -> void;
+
+    [[nodiscard]] auto isOpen() const -> bool {
+        return m_data != nullptr || m_isEmptyFile;
+    }
+    [[nodiscard]] auto data() const -> const uint8_t* {
+        return m_data;
+    }
+    [[nodiscard]] auto size() const -> size_t {
+        return m_size;
+    }
+
+   private:
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+    bool m_isEmptyFile = false;  // mmap refuses zero length, still counts as open
+#ifdef _WIN32
+    void* m_file = nullptr;
+    void* m_mapping = nullptr;
+#endif
+};
+
+}  // namespace Vengine
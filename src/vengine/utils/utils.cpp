@@ -1,5 +1,5 @@
 #include "utils.hpp"
-#include <fstream>
+#include "vengine/utils/vfs.hpp"
 
 namespace Vengine {
 
@@ -27,12 +27,7 @@ auto Utils::getRandomInt(int min, int max) -> int {
 }
 
 auto Utils::readFile(const std::string& filePath) -> std::string {
-    std::ifstream file(filePath);
-    if (!file.is_open()) {
-        return {};
-    }
-    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-    return content;
+    return Vfs::readText(filePath);
 }
 
 }  // namespace Vengine
\ No newline at end of file
@@ -0,0 +1,133 @@
+#include "vfs.hpp"
+
+#include <mutex>
+#include <shared_mutex>
+#include <utility>
+#include <spdlog/spdlog.h>
+
+#include "vengine/utils/asset_pack.hpp"
+#include "vengine/utils/file_stamp.hpp"
+#include "vengine/utils/mapped_file.hpp"
+
+namespace Vengine {
+
+namespace {
+
+// mounts happen at start-up, lookups from every loader thread
+std::shared_mutex mountMutex;
+std::vector<std::shared_ptr<AssetPack>> mountedPacks;
+
+struct PackedEntry {
+    std::shared_ptr<AssetPack> pack;
+    const AssetPackEntry* entry = nullptr;
+};
+
+auto findPacked(const std::filesystem::path& path) -> PackedEntry {
+    std::shared_lock<std::shared_mutex> lock(mountMutex);
+    for (auto it = mountedPacks.rbegin(); it != mountedPacks.rend(); ++it) {
+        if (const auto* entry = (*it)->find(path)) {
+            return {*it, entry};
+        }
+    }
+    return {};
+}
+
+}  // namespace
+
+auto Vfs::mount(const std::filesystem::path& packPath) -> bool {
+    auto pack = std::make_shared<AssetPack>();
+    if (!pack->open(packPath)) {
+        return false;
+    }
+    spdlog::info("Vfs: mounted {} ({} files)", packPath.string(), pack->getEntries().size());
+
+    std::unique_lock<std::shared_mutex> lock(mountMutex);
+    mountedPacks.push_back(std::move(pack));
+    return true;
+}
+
+auto Vfs::unmountAll() -> void {
+    // files still open keep their pack mapped
+    std::unique_lock<std::shared_mutex> lock(mountMutex);
+    mountedPacks.clear();
+}
+
+auto Vfs::getMountCount() -> size_t {
+    std::shared_lock<std::shared_mutex> lock(mountMutex);
+    return mountedPacks.size();
+}
+
+auto Vfs::exists(const std::filesystem::path& path) -> bool {
+    if (findPacked(path).entry) {
+        return true;
+    }
+    std::error_code error;
+    return std::filesystem::is_regular_file(path, error);
+}
+
+VfsFile::VfsFile(VfsFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+auto VfsFile::operator=(VfsFile&& other) noexcept -> VfsFile& {
+    if (this != &other) {
+        bool ownsData = other.m_data != nullptr && other.m_data == other.m_buffer.data();
+        m_buffer = std::move(other.m_buffer);
+        m_data = ownsData ? m_buffer.data() : other.m_data;
+        m_size = std::exchange(other.m_size, 0);
+        m_isOpen = std::exchange(other.m_isOpen, false);
+        m_isPacked = std::exchange(other.m_isPacked, false);
+        m_owner = std::move(other.m_owner);
+        other.m_data = nullptr;
+        other.m_buffer.clear();
+    }
+    return *this;
+}
+
+auto Vfs::open(const std::filesystem::path& path) -> VfsFile {
+    VfsFile file;
+    if (auto packed = findPacked(path); packed.entry) {
+        const auto& entry = *packed.entry;
+        if (entry.compression == static_cast<uint32_t>(AssetCompression::None)) {
+            file.m_data = packed.pack->getStoredData(entry);
+        } else {
+            if (!packed.pack->read(entry, file.m_buffer)) {
+                return {};
+            }
+            file.m_data = file.m_buffer.data();
+        }
+        file.m_size = entry.size;
+        file.m_isOpen = true;
+        file.m_isPacked = true;
+        file.m_owner = std::move(packed.pack);
+        return file;
+    }
+
+    auto mapped = std::make_shared<MappedFile>();
+    if (!mapped->open(path.string())) {
+        return {};
+    }
+    file.m_data = mapped->data();
+    file.m_size = mapped->size();
+    file.m_isOpen = true;
+    file.m_owner = std::move(mapped);
+    return file;
+}
+
+auto Vfs::readText(const std::filesystem::path& path) -> std::string {
+    auto file = open(path);
+    return file.isOpen() ? std::string(file.view()) : std::string();
+}
+
+auto Vfs::statPacked(const std::filesystem::path& path, FileStamp& out) -> bool {
+    auto packed = findPacked(path);
+    if (!packed.entry) {
+        return false;
+    }
+    out.size = packed.entry->size;
+    out.mtime = 0;
+    out.hash = packed.entry->contentHash;
+    return true;
+}
+
+}  // namespace Vengine
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Vengine {
+
+struct FileStamp;
+
+// one file opened through the Vfs. uncompressed pack entries and loose files are views into a
+// mapping that lives as long as this, compressed entries own their decompressed bytes
+class VfsFile {
+   public:
+    VfsFile() = default;
+    // a copy of a compressed entry would point into the other file's buffer
+    VfsFile(const VfsFile&) = delete;
+    auto operator=(const VfsFile&) -> VfsFile& = delete;
+    VfsFile(VfsFile&& other) noexcept;
+    auto operator=(VfsFile&& other) noexcept -> VfsFile&;
+
+    [[nodiscard]] auto isOpen() const -> bool {
+        return m_isOpen;
+    }
+    [[nodiscard]] auto data() const -> const uint8_t* {
+        return m_data;
+    }
+    [[nodiscard]] auto size() const -> size_t {
+        return m_size;
+    }
+    [[nodiscard]] auto view() const -> std::string_view {
+        return {reinterpret_cast<const char*>(m_data), m_size};
+    }
+    // true when it came out of a mounted pack
+    [[nodiscard]] auto isPacked() const -> bool {
+        return m_isPacked;
+    }
+
+   private:
+    friend class Vfs;
+
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+    bool m_isOpen = false;
+    bool m_isPacked = false;
+    std::vector<uint8_t> m_buffer;
+    std::shared_ptr<const void> m_owner;  // the pack or the mapped loose file
+};
+
+// the virtual file layer every resource loader reads through. mounted packs come first, the most
+// recently mounted one wins, paths nothing packs fall back to the loose file on disk. paths are
+// the ones the loaders already use ("resources/textures/foo.png"), relative to the working directory
+class Vfs {
+   public:
+    static auto mount(const std::filesystem::path& packPath) -> bool;
+    static auto unmountAll() -> void;
+    [[nodiscard]] static auto getMountCount() -> size_t;
+
+    [[nodiscard]] static auto exists(const std::filesystem::path& path) -> bool;
+    [[nodiscard]] static auto open(const std::filesystem::path& path) -> VfsFile;
+    // empty when the file can't be read
+    [[nodiscard]] static auto readText(const std::filesystem::path& path) -> std::string;
+
+    // size and content hash straight from the toc of the pack holding path, false for loose files.
+    // packed files have no mtime of their own, it is always 0
+    static auto statPacked(const std::filesystem::path& path, FileStamp& out) -> bool;
+};
+
+}  // namespace Vengine
@@ -17,7 +17,17 @@
 
 namespace Vengine {
 
-Vengine::Vengine() {
+// components keep handles, which the resource manager can't see on its own
+template <typename T>
+static auto markComponentHandles(Entities& entities, ResourceManager& resources) -> void {
+    for (auto entity : entities.getEntitiesWith<T>()) {
+        if (auto component = entities.getEntityComponent<T>(entity)) {
+            resources.markReferenced(component->handle);
+        }
+    }
+}
+
+Vengine::Vengine(VengineConfig config) : m_config(std::move(config)) {
     auto result = init();
     if (!result) {
         spdlog::error("{}", result.error().toString());
@@ -68,7 +78,12 @@ Vengine::~Vengine() {
     // glfw callbacks
     registerGlfwCallbacks();
 
-    threadManager = std::make_shared<ThreadManager>();
+    // one worker per physical core, minus the core reserved for this thread.
+    // jolt runs its own pool, raise externalThreads once physics is enabled by default
+    threadManager = std::make_shared<ThreadManager>(m_config.threads);
+    if (m_config.threads.pinWorkers) {
+        threadManager->pinCurrentThreadToReservedCores();
+    }
 
     // resources
     resourceManager = std::make_unique<ResourceManager>();
@@ -89,7 +104,11 @@ Vengine::~Vengine() {
     if (auto result = renderer->init(window); !result) {
         return tl::unexpected(result.error());
     }
+    renderer->setResourceManager(resourceManager.get());
+    renderer->setThreadManager(threadManager);
     spdlog::info("Vengine: renderer initialized");
+    // needs the gl context, failing just leaves uploads synchronous
+    resourceManager->initUploadRing();
     addDefaults();
     renderer->initFonts(resourceManager->get<Shader>("default.text"));
     // if (auto result = renderer->initFonts(resourceManager->get<Shader>("default.text")); !result) {
@@ -110,6 +129,16 @@ Vengine::~Vengine() {
     ecs->registerComponent<CameraComponent>("Camera");
     ecs->registerComponent<PhysicsComponent>("Physics");
     ecs->registerComponent<LightComponent>("Light");
+    // whatever the live entities point at is never evicted, rendered this frame or not
+    resourceManager->addReferenceSource([this](ResourceManager& resources) {
+        auto entities = ecs->getActiveEntities();
+        if (!entities) {
+            return;
+        }
+        markComponentHandles<MeshComponent>(*entities, resources);
+        markComponentHandles<ModelComponent>(*entities, resources);
+        markComponentHandles<ScriptComponent>(*entities, resources);
+    });
     // register built-in systems
     auto transformSystem = std::make_shared<TransformSystem>();
     transformSystem->setEnabled(false);  // calling manually to make sure it runs before collision and physics
@@ -144,6 +173,7 @@ auto Vengine::run() -> void {
         }
 
         threadManager->processMainThreadTasks();
+        resourceManager->update();
         timers->update();
         inputSystem->update();
 
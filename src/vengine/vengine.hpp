@@ -20,6 +20,11 @@ namespace Vengine {
 
 class InputManager;
 
+// what has to be known before the engine starts
+struct VengineConfig {
+    ThreadManagerConfig threads;  // pinWorkers also pins the main thread to the reserved cores
+};
+
 class Vengine {
    public:
     bool isRunning = false;
@@ -35,7 +40,7 @@ class Vengine {
     EventManager* events = nullptr;
     std::unique_ptr<Scenes> scenes;
 
-    Vengine();
+    explicit Vengine(VengineConfig config = {});
     ~Vengine();
     [[nodiscard]] auto init() -> tl::expected<void, Error>;
 
@@ -58,6 +63,7 @@ class Vengine {
     auto run() -> void;
 
    private:
+    VengineConfig m_config;
     std::vector<std::shared_ptr<Module>> m_modules;
 
     void addDefaults() const;
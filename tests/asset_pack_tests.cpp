@@ -0,0 +1,200 @@
+#include <doctest.h>
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <utility>
+
+#include "vengine/utils/asset_pack.hpp"
+#include "vengine/utils/file_stamp.hpp"
+#include "vengine/utils/hash.hpp"
+#include "vengine/utils/vfs.hpp"
+#include "test_helpers.hpp"
+
+namespace {
+
+using Tests::writeFile;
+
+auto bytes(const std::string& text) -> const uint8_t* {
+    return reinterpret_cast<const uint8_t*>(text.data());
+}
+
+}  // namespace
+
+TEST_CASE("AssetPackRoundTripsStoredAndLz4Entries") {
+    auto root = std::filesystem::temp_directory_path() / "vengine_asset_pack_test";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root);
+    auto packPath = root / "test.vpak";
+
+    std::string script = "print('hello')";
+    std::string repetitive(4096, 'a');
+    std::string incompressible;
+    for (int i = 0; i < 512; ++i) {
+        incompressible.push_back(static_cast<char>((i * 7919) ^ (i >> 3)));
+    }
+
+    Vengine::AssetPackWriter writer;
+    REQUIRE(writer.open(packPath));
+    CHECK(writer.add("resources/scripts/hello.lua", bytes(script), script.size(), Vengine::AssetCompression::None));
+    CHECK(writer.add("./resources/data/../data/big.txt", bytes(repetitive), repetitive.size(), Vengine::AssetCompression::LZ4));
+    CHECK(writer.add("resources/noise.bin", bytes(incompressible), incompressible.size(), Vengine::AssetCompression::LZ4));
+    CHECK(writer.add("resources/empty.txt", nullptr, 0, Vengine::AssetCompression::LZ4));
+    REQUIRE(writer.finish());
+    CHECK(writer.getStoredBytes() < writer.getRawBytes());
+
+    Vengine::AssetPack pack;
+    REQUIRE(pack.open(packPath));
+    CHECK(pack.getEntries().size() == 4);
+
+    const auto* big = pack.find("resources/data/big.txt");
+    REQUIRE(big != nullptr);
+    CHECK(pack.getPath(*big) == "resources/data/big.txt");
+    CHECK(big->compression == static_cast<uint32_t>(Vengine::AssetCompression::LZ4));
+    CHECK(big->storedSize < big->size);
+    CHECK(big->offset % Vengine::AssetPack::ALIGNMENT == 0);
+    std::vector<uint8_t> out;
+    REQUIRE(pack.read(*big, out));
+    CHECK(std::string(out.begin(), out.end()) == repetitive);
+    CHECK(big->contentHash == Vengine::hash64(repetitive));
+
+    // not worth compressing, stays as it is
+    const auto* noise = pack.find("resources/noise.bin");
+    REQUIRE(noise != nullptr);
+    CHECK(noise->compression == static_cast<uint32_t>(Vengine::AssetCompression::None));
+
+    CHECK(pack.find("resources/scripts/missing.lua") == nullptr);
+
+    // a duplicate path is refused
+    Vengine::AssetPackWriter duplicate;
+    REQUIRE(duplicate.open(root / "duplicate.vpak"));
+    CHECK(duplicate.add("a.txt", bytes(script), script.size(), Vengine::AssetCompression::None));
+    CHECK(duplicate.add("./a.txt", bytes(script), script.size(), Vengine::AssetCompression::None));
+    CHECK_FALSE(duplicate.finish());
+
+    // not a pack
+    writeFile(root / "junk.vpak", "definitely not a pack, but long enough for a header");
+    Vengine::AssetPack junk;
+    CHECK_FALSE(junk.open(root / "junk.vpak"));
+
+    // a stored entry claiming more bytes than it has would be read past the mapping
+    Vengine::AssetPackWriter single;
+    REQUIRE(single.open(root / "truncated.vpak"));
+    CHECK(single.add("a.txt", bytes(script), script.size(), Vengine::AssetCompression::None));
+    REQUIRE(single.finish());
+    {
+        std::fstream file(root / "truncated.vpak", std::ios::binary | std::ios::in | std::ios::out);
+        uint64_t tocOffset = 0;
+        file.seekg(16);  // magic, version, entry count, reserved
+        file.read(reinterpret_cast<char*>(&tocOffset), sizeof(tocOffset));
+        Vengine::AssetPackEntry entry{};
+        file.seekg(static_cast<std::streamoff>(tocOffset));
+        file.read(reinterpret_cast<char*>(&entry), sizeof(entry));
+        REQUIRE(entry.size == script.size());
+        entry.size = entry.storedSize + 65536;
+        file.seekp(static_cast<std::streamoff>(tocOffset));
+        file.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+    }
+    Vengine::AssetPack truncated;
+    CHECK_FALSE(truncated.open(root / "truncated.vpak"));
+
+    // find() relies on a sorted toc with every path once, and LZ4 sizes have to fit an int
+    auto editToc = [&root, &script](const std::function<void(std::array<Vengine::AssetPackEntry, 2>&)>& edit) {
+        Vengine::AssetPackWriter pair;
+        REQUIRE(pair.open(root / "edited.vpak"));
+        CHECK(pair.add("a.txt", bytes(script), script.size(), Vengine::AssetCompression::None));
+        CHECK(pair.add("b.txt", bytes(script), script.size(), Vengine::AssetCompression::None));
+        REQUIRE(pair.finish());
+
+        std::fstream file(root / "edited.vpak", std::ios::binary | std::ios::in | std::ios::out);
+        uint64_t tocOffset = 0;
+        file.seekg(16);
+        file.read(reinterpret_cast<char*>(&tocOffset), sizeof(tocOffset));
+        std::array<Vengine::AssetPackEntry, 2> entries{};
+        file.seekg(static_cast<std::streamoff>(tocOffset));
+        file.read(reinterpret_cast<char*>(entries.data()), sizeof(entries));
+        edit(entries);
+        file.seekp(static_cast<std::streamoff>(tocOffset));
+        file.write(reinterpret_cast<const char*>(entries.data()), sizeof(entries));
+    };
+    Vengine::AssetPack edited;
+    editToc([](auto&) {});
+    CHECK(edited.open(root / "edited.vpak"));
+    editToc([](auto& entries) { std::swap(entries[0], entries[1]); });
+    CHECK_FALSE(edited.open(root / "edited.vpak"));
+    editToc([](auto& entries) { entries[1] = entries[0]; });
+    CHECK_FALSE(edited.open(root / "edited.vpak"));
+    editToc([](auto& entries) {
+        entries[0].compression = static_cast<uint32_t>(Vengine::AssetCompression::LZ4);
+        entries[0].size = uint64_t{1} << 31;
+    });
+    CHECK_FALSE(edited.open(root / "edited.vpak"));
+
+    std::filesystem::remove_all(root);
+}
+
+TEST_CASE("VfsPrefersMountedPacksOverLooseFiles") {
+    auto root = std::filesystem::temp_directory_path() / "vengine_vfs_test";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root);
+    auto loose = root / "loose.txt";
+    writeFile(loose, "loose");
+    auto shadowed = root / "shadowed.txt";
+    writeFile(shadowed, "on disk");
+
+    std::string packed(2048, 'p');
+    std::string shadowing = "from the pack";
+    Vengine::AssetPackWriter writer;
+    REQUIRE(writer.open(root / "test.vpak"));
+    CHECK(writer.add(root / "packed.txt", bytes(packed), packed.size(), Vengine::AssetCompression::LZ4));
+    CHECK(writer.add(shadowed, bytes(shadowing), shadowing.size(), Vengine::AssetCompression::None));
+    REQUIRE(writer.finish());
+
+    Vengine::Vfs::unmountAll();
+    REQUIRE(Vengine::Vfs::mount(root / "test.vpak"));
+    CHECK(Vengine::Vfs::getMountCount() == 1);
+
+    CHECK(Vengine::Vfs::exists(root / "packed.txt"));
+    CHECK(Vengine::Vfs::exists(loose));
+    CHECK_FALSE(Vengine::Vfs::exists(root / "missing.txt"));
+
+    auto file = Vengine::Vfs::open(root / "packed.txt");
+    REQUIRE(file.isOpen());
+    CHECK(file.isPacked());
+    CHECK(file.view() == packed);
+    CHECK(Vengine::Vfs::readText(shadowed) == shadowing);
+    CHECK(Vengine::Vfs::readText(loose) == "loose");
+    CHECK_FALSE(Vengine::Vfs::open(root / "missing.txt").isOpen());
+
+    // caches keyed on packed sources use the toc hash, no file on disk needed
+    Vengine::FileStamp stamp;
+    REQUIRE(Vengine::readFileStamp(root / "packed.txt", stamp));
+    CHECK(stamp.size == packed.size());
+    CHECK(stamp.hash == Vengine::hash64(packed));
+    CHECK(Vengine::matchesFileStamp(root / "packed.txt", stamp));
+    stamp.hash ^= 1;
+    CHECK_FALSE(Vengine::matchesFileStamp(root / "packed.txt", stamp));
+
+    // moving a decompressed entry takes its bytes along
+    {
+        Vengine::VfsFile moved(std::move(file));
+        CHECK_FALSE(file.isOpen());
+        CHECK(moved.view() == packed);
+        Vengine::VfsFile assigned = Vengine::Vfs::open(loose);
+        assigned = std::move(moved);
+        CHECK(assigned.view() == packed);
+        file = std::move(assigned);
+    }
+    CHECK(file.view() == packed);
+
+    // open files keep the pack mapped after it is unmounted
+    Vengine::Vfs::unmountAll();
+    CHECK(file.view() == packed);
+    CHECK(Vengine::Vfs::readText(shadowed) == "on disk");
+    CHECK_FALSE(Vengine::Vfs::exists(root / "packed.txt"));
+
+    std::filesystem::remove_all(root);
+}
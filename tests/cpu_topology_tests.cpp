@@ -0,0 +1,89 @@
+#include <doctest.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "vengine/core/cpu_topology.hpp"
+#include "vengine/core/thread_manager.hpp"
+#include "test_helpers.hpp"
+
+namespace {
+
+using Tests::writeFile;
+
+}  // namespace
+
+TEST_CASE("ParseCpuListHandlesRangesAndSingleCpus") {
+    CHECK(Vengine::parseCpuList("0") == std::vector<uint32_t>{0});
+    CHECK(Vengine::parseCpuList("0-3") == std::vector<uint32_t>{0, 1, 2, 3});
+    CHECK(Vengine::parseCpuList("0-1,4,6-7\n") == std::vector<uint32_t>{0, 1, 4, 6, 7});
+    CHECK(Vengine::parseCpuList("").empty());
+}
+
+TEST_CASE("CpuTopologyGroupsSmtSiblings") {
+    auto root = std::filesystem::temp_directory_path() / "vengine_cpu_topology_test";
+    std::filesystem::remove_all(root);
+
+    // 2 cores with 2 threads each, siblings numbered like linux does it on most intel parts
+    writeFile(root / "online", "0-3");
+    const uint32_t coreIds[] = {0, 1, 0, 1};
+    for (uint32_t cpu = 0; cpu < 4; ++cpu) {
+        auto topologyDir = root / ("cpu" + std::to_string(cpu)) / "topology";
+        writeFile(topologyDir / "core_id", std::to_string(coreIds[cpu]));
+        writeFile(topologyDir / "physical_package_id", "0");
+    }
+
+    auto topology = Vengine::CpuTopology::fromSysfs(root.string());
+    CHECK(topology.logicalCount == 4);
+    REQUIRE(topology.physicalCount() == 2);
+    CHECK(topology.cores[0].logicalCpus == std::vector<uint32_t>{0, 2});
+    CHECK(topology.cores[1].logicalCpus == std::vector<uint32_t>{1, 3});
+
+    std::filesystem::remove_all(root);
+}
+
+TEST_CASE("CpuTopologyKeepsOnlyAllowedCpus") {
+    auto topology = Vengine::CpuTopology::fallback(2);
+    topology.cores[0].logicalCpus = {0, 2};
+    topology.cores[1].logicalCpus = {1, 3};
+    topology.logicalCount = 4;
+
+    auto restricted = topology.restrictedTo({0, 1, 2});
+    CHECK(restricted.logicalCount == 3);
+    REQUIRE(restricted.physicalCount() == 2);
+    CHECK(restricted.cores[0].logicalCpus == std::vector<uint32_t>{0, 2});
+    CHECK(restricted.cores[1].logicalCpus == std::vector<uint32_t>{1});
+
+    // a core with no allowed sibling is gone
+    restricted = topology.restrictedTo({1, 3});
+    CHECK(restricted.logicalCount == 2);
+    REQUIRE(restricted.physicalCount() == 1);
+    CHECK(restricted.cores[0].coreId == 1);
+
+    // detect() never hands out a cpu outside the affinity mask
+    std::vector<uint32_t> allowed;
+    if (Vengine::getCurrentThreadAffinity(allowed)) {
+        for (const auto& core : Vengine::CpuTopology::detect().cores) {
+            for (auto cpu : core.logicalCpus) {
+                CHECK(std::binary_search(allowed.begin(), allowed.end(), cpu));
+            }
+        }
+    }
+}
+
+TEST_CASE("ThreadManagerLeavesReservedCoresOut") {
+    auto topology = Vengine::CpuTopology::detect();
+    CHECK(topology.physicalCount() >= 1);
+
+    Vengine::ThreadManagerConfig config;
+    config.reservedCores = 1;
+    Vengine::ThreadManager threadManager(config);
+
+    size_t expected = topology.physicalCount() > 1 ? topology.physicalCount() - 1 : 1;
+    CHECK(threadManager.getWorkerCount() == expected);
+    if (topology.physicalCount() > 1) {
+        CHECK(threadManager.getReservedCpus() == topology.cores[0].logicalCpus);
+    }
+}
@@ -0,0 +1,67 @@
+#include <doctest.h>
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "vengine/utils/file_watcher.hpp"
+#include "test_helpers.hpp"
+
+namespace {
+
+using Tests::writeFile;
+
+// polls until something shows up, the mtime fallback only looks every POLL_INTERVAL
+auto waitForChanges(Vengine::FileWatcher& watcher) -> std::vector<std::filesystem::path> {
+    std::vector<std::filesystem::path> changed;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (changed.empty() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        watcher.poll(changed);
+    }
+    return changed;
+}
+
+}  // namespace
+
+TEST_CASE("FileWatcherReportsWrittenAndReplacedFiles") {
+    auto root = std::filesystem::temp_directory_path() / "vengine_file_watcher_test";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root);
+    auto shader = root / "shader.frag";
+    auto script = root / "script.lua";
+    writeFile(shader, "void main() {}");
+    writeFile(script, "print('a')");
+    writeFile(root / "other.txt", "not watched");
+
+    Vengine::FileWatcher watcher;
+    REQUIRE(watcher.watch(shader));
+    REQUIRE(watcher.watch(root / "." / "script.lua"));
+    CHECK(watcher.watch(shader));
+    CHECK(watcher.getWatchedCount() == 2);
+
+    std::vector<std::filesystem::path> changed;
+    watcher.poll(changed);
+    CHECK(changed.empty());
+
+    // a couple of writes in a row come out as one change, unwatched files not at all
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    writeFile(shader, "void main() { }");
+    writeFile(shader, "void main() {  }");
+    writeFile(root / "other.txt", "still not watched");
+    changed = waitForChanges(watcher);
+    REQUIRE(changed.size() == 1);
+    CHECK(changed[0] == Vengine::FileWatcher::normalize(shader));
+
+    // saved through a temp file and a rename, like most editors do
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    writeFile(root / "script.lua.tmp", "print('b')");
+    std::filesystem::rename(root / "script.lua.tmp", script);
+    changed = waitForChanges(watcher);
+    REQUIRE(changed.size() == 1);
+    CHECK(changed[0] == Vengine::FileWatcher::normalize(script));
+
+    std::filesystem::remove_all(root);
+}
@@ -0,0 +1,152 @@
+#include <doctest.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "vengine/core/mesh_cache.hpp"
+#include "vengine/utils/hash.hpp"
+#include "test_helpers.hpp"
+
+namespace {
+
+using Tests::writeFile;
+
+auto makeTriangle() -> Vengine::MeshCacheData {
+    Vengine::MeshCacheData data;
+    data.layout = Vengine::VertexLayout::floats(true, true, true);
+    data.vertices = {
+        0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f,
+        1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f,
+        0.0f, 2.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f,
+    };
+    // one lod level that happens to be the same triangle, and level 0 as a single meshlet
+    data.indices = {0, 1, 2, 0, 1, 2};
+    data.submeshes.push_back({0, 3, "red", {{3, 3}}, 0, 1});
+    data.lodErrors = {0.5f};
+    data.meshlets.push_back({0, 3, {0.5f, 1.0f, 0.0f}, 1.2f, {0.0f, 0.0f, 1.0f}, 1.0f});
+
+    Vengine::MeshCacheMaterial material;
+    material.name = "red";
+    material.diffuse = {1.0f, 0.0f, 0.0f};
+    material.hasDiffuse = true;
+    material.diffuseTexture = "textures/red.png";
+    material.embeddedTexture = 0;
+    data.materials.push_back(material);
+
+    Vengine::MeshCacheTexture texture;
+    texture.width = 4;
+    texture.formatHint = "png";
+    texture.data = {1, 2, 3, 4};
+    data.embeddedTextures.push_back(texture);
+    data.boundsMin = {0.0f, 0.0f, 0.0f};
+    data.boundsMax = {1.0f, 2.0f, 0.0f};
+    return data;
+}
+
+}  // namespace
+
+TEST_CASE("Hash64MatchesXxh64Reference") {
+    CHECK(Vengine::hash64("", 0) == 0xEF46DB3751D8E999ULL);
+    CHECK(Vengine::hash64("a", 1) == 0xD24EC4F1A98C6E5BULL);
+    CHECK(Vengine::hashToString(0xEF46DB3751D8E999ULL) == "ef46db3751d8e999");
+}
+
+TEST_CASE("MeshCacheRoundTripAndInvalidation") {
+    auto root = std::filesystem::temp_directory_path() / "vengine_mesh_cache_test";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root);
+
+    auto source = root / "triangle.obj";
+    writeFile(source, "v 0 0 0\nv 1 0 0\nv 0 2 0\nf 1 2 3\n");
+
+    Vengine::MeshCache cache(root / "cache");
+    Vengine::MeshCacheData loaded;
+    CHECK_FALSE(cache.load(source, 1, loaded));
+
+    auto data = makeTriangle();
+    REQUIRE(cache.store(source, 1, data));
+
+    SUBCASE("hit returns the stored data") {
+        REQUIRE(cache.load(source, 1, loaded));
+        CHECK(loaded.vertices == data.vertices);
+        CHECK(loaded.indices == data.indices);
+        REQUIRE(loaded.submeshes.size() == 1);
+        CHECK(loaded.submeshes[0].indexCount == 3);
+        CHECK(loaded.submeshes[0].materialName == "red");
+        REQUIRE(loaded.submeshes[0].lods.size() == 1);
+        CHECK(loaded.submeshes[0].lods[0].indexOffset == 3);
+        CHECK(loaded.submeshes[0].lods[0].indexCount == 3);
+        CHECK(loaded.lodErrors == data.lodErrors);
+        CHECK(loaded.submeshes[0].meshletCount == 1);
+        REQUIRE(loaded.meshlets.size() == 1);
+        CHECK(loaded.meshlets[0].indexCount == 3);
+        CHECK(loaded.meshlets[0].radius == 1.2f);
+        CHECK(loaded.meshlets[0].coneAxis[2] == 1.0f);
+        CHECK(loaded.layout == data.layout);
+        REQUIRE(loaded.materials.size() == 1);
+        CHECK(loaded.materials[0].name == "red");
+        CHECK(loaded.materials[0].hasDiffuse);
+        CHECK_FALSE(loaded.materials[0].hasSpecular);
+        CHECK(loaded.materials[0].diffuse[0] == 1.0f);
+        CHECK(loaded.materials[0].diffuseTexture == "textures/red.png");
+        CHECK(loaded.materials[0].embeddedTexture == 0);
+        REQUIRE(loaded.embeddedTextures.size() == 1);
+        CHECK(loaded.embeddedTextures[0].formatHint == "png");
+        CHECK(loaded.embeddedTextures[0].data == data.embeddedTextures[0].data);
+        CHECK(loaded.boundsMax[1] == 2.0f);
+        CHECK(cache.getHits() == 1);
+    }
+
+    SUBCASE("different import flags miss") {
+        CHECK_FALSE(cache.load(source, 2, loaded));
+    }
+
+    SUBCASE("changed source misses") {
+        writeFile(source, "v 0 0 0\nv 1 0 0\nv 0 3 0\nf 1 2 3\n");
+        CHECK_FALSE(cache.load(source, 1, loaded));
+    }
+
+    SUBCASE("touched but unchanged source still hits") {
+        std::filesystem::last_write_time(source,
+                                         std::filesystem::last_write_time(source) + std::chrono::hours(1));
+        CHECK(cache.load(source, 1, loaded));
+
+        // and the entry takes the new mtime, the next load needs no hash. it sits after magic,
+        // version, import flags, layout and size in the header
+        int64_t stored = 0;
+        std::ifstream entry(cache.getCachePath(source), std::ios::binary);
+        entry.seekg(24);
+        entry.read(reinterpret_cast<char*>(&stored), sizeof(stored));
+        CHECK(stored == std::filesystem::last_write_time(source).time_since_epoch().count());
+        entry.close();
+        CHECK(cache.load(source, 1, loaded));
+    }
+
+    SUBCASE("truncated cache file misses") {
+        auto cachePath = cache.getCachePath(source);
+        std::filesystem::resize_file(cachePath, std::filesystem::file_size(cachePath) - 4);
+        CHECK_FALSE(cache.load(source, 1, loaded));
+    }
+
+    SUBCASE("ranges outside the stored data miss") {
+        auto broken = data;
+        SUBCASE("index past the vertices") {
+            broken.indices[4] = 3;
+        }
+        SUBCASE("submesh past the indices") {
+            broken.submeshes[0].indexCount = 7;
+        }
+        SUBCASE("lod past the indices") {
+            broken.submeshes[0].lods[0].indexOffset = 4;
+        }
+        SUBCASE("meshlet past the indices") {
+            broken.meshlets[0].indexOffset = 5;
+        }
+        REQUIRE(cache.store(source, 1, broken));
+        CHECK_FALSE(cache.load(source, 1, loaded));
+    }
+
+    std::filesystem::remove_all(root);
+}
@@ -0,0 +1,65 @@
+#include <doctest.h>
+
+#include <memory>
+#include <vector>
+
+#include "vengine/core/content_registry.hpp"
+#include "vengine/core/mesh.hpp"
+#include "vengine/core/model.hpp"
+#include "vengine/renderer/vertex_array.hpp"
+#include "test_helpers.hpp"
+
+namespace {
+
+auto makeQuad() -> std::shared_ptr<Vengine::Mesh> {
+    std::vector<float> vertices = {
+        -1.0F, -1.0F, 0.0F, 0.0F, 0.0F, 0.0F, 0.0F, 1.0F,
+        1.0F,  -1.0F, 0.0F, 1.0F, 0.0F, 0.0F, 0.0F, 1.0F,
+        1.0F,  1.0F,  0.0F, 1.0F, 1.0F, 0.0F, 0.0F, 1.0F,
+        -1.0F, 1.0F,  0.0F, 0.0F, 1.0F, 0.0F, 0.0F, 1.0F,
+    };
+    std::vector<uint32_t> indices = {0, 1, 2, 2, 3, 0};
+    return std::make_shared<Vengine::Mesh>(std::move(vertices), std::move(indices),
+                                           Vengine::VertexLayout::floats(true, true, true));
+}
+
+}  // namespace
+
+TEST_CASE("DeduplicatedMeshOutlivesOriginalModel") {
+    Tests::GlContext context;
+    if (!context) {
+        MESSAGE("no OpenGL context, skipped");
+        return;
+    }
+
+    Vengine::ContentRegistry<Vengine::Mesh> registry;
+    auto original = makeQuad();
+    auto copy = makeQuad();
+    CHECK_FALSE(original->deduplicate(registry));
+    REQUIRE(copy->deduplicate(registry));
+    CHECK(copy->getDuplicateOf() == original.get());
+
+    REQUIRE(original->load(""));
+    REQUIRE(original->finalizeOnMainThread());
+    REQUIRE(copy->load(""));
+    REQUIRE(copy->finalizeOnMainThread());
+
+    auto originalModel = std::make_unique<Vengine::Model>();
+    originalModel->setMesh(original);
+    auto copyModel = std::make_unique<Vengine::Model>();
+    copyModel->setMesh(copy);
+    original.reset();
+    copy.reset();
+
+    originalModel->unload();
+    originalModel.reset();
+
+    auto mesh = copyModel->getMesh();
+    REQUIRE(mesh);
+    REQUIRE(mesh->getVertexArray());
+    CHECK(mesh->getVertexArray()->getID() != 0);
+    REQUIRE(mesh->getVertexBuffer());
+    CHECK(mesh->getVertexBuffer()->getId() != 0);
+    REQUIRE(mesh->getIndexBuffer());
+    CHECK(mesh->getIndexBuffer()->getId() != 0);
+}
@@ -0,0 +1,145 @@
+#include <doctest.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "vengine/core/mesh_optimizer.hpp"
+#include "test_helpers.hpp"
+
+namespace {
+
+using Tests::getTriangles;
+using Tests::makeGrid;
+constexpr size_t STRIDE = Tests::GRID_STRIDE;
+
+}  // namespace
+
+TEST_CASE("AnalyzeVertexCacheCountsFifoMisses") {
+    // two triangles sharing an edge, 4 vertices transformed once each
+    std::vector<uint32_t> quad = {0, 1, 2, 2, 1, 3};
+    auto stats = Vengine::analyzeVertexCache(quad.data(), quad.size(), 4);
+    CHECK(stats.triangles == 2);
+    CHECK(stats.misses == 4);
+    CHECK(stats.vertices == 4);
+    CHECK(stats.getAcmr() == doctest::Approx(2.0f));
+    CHECK(stats.getAtvr() == doctest::Approx(1.0f));
+
+    // a cache of 3 loses vertex 0 before it comes back
+    std::vector<uint32_t> strip = {0, 1, 2, 3, 4, 5, 0, 1, 2};
+    CHECK(Vengine::analyzeVertexCache(strip.data(), strip.size(), 6, 3).misses == 9);
+    CHECK(Vengine::analyzeVertexCache(strip.data(), strip.size(), 6, 6).misses == 6);
+}
+
+TEST_CASE("OptimizeVertexCacheImprovesLocality") {
+    auto grid = makeGrid(64, true);
+    auto triangles = getTriangles(grid.positions, grid.indices);
+    auto before = Vengine::analyzeVertexCache(grid.indices.data(), grid.indices.size(), grid.vertexCount);
+
+    std::vector<size_t> clusterStarts;
+    Vengine::optimizeVertexCache(grid.indices.data(), grid.indices.size(), grid.vertexCount, &clusterStarts);
+    auto after = Vengine::analyzeVertexCache(grid.indices.data(), grid.indices.size(), grid.vertexCount);
+
+    CHECK(getTriangles(grid.positions, grid.indices) == triangles);
+    CHECK(before.getAcmr() > 2.0f);
+    CHECK(after.getAcmr() < 1.0f);
+    CHECK(after.getAtvr() < before.getAtvr());
+    REQUIRE_FALSE(clusterStarts.empty());
+    CHECK(clusterStarts.front() == 0);
+    CHECK(std::is_sorted(clusterStarts.begin(), clusterStarts.end()));
+}
+
+TEST_CASE("OptimizeOverdrawKeepsCacheOrder") {
+    auto grid = makeGrid(64, true);
+    std::vector<size_t> clusterStarts;
+    Vengine::optimizeVertexCache(grid.indices.data(), grid.indices.size(), grid.vertexCount, &clusterStarts);
+    auto triangles = getTriangles(grid.positions, grid.indices);
+    auto before = Vengine::analyzeVertexCache(grid.indices.data(), grid.indices.size(), grid.vertexCount);
+
+    Vengine::optimizeOverdraw(grid.indices.data(), grid.indices.size(), grid.positions.data(), STRIDE,
+                              grid.vertexCount, clusterStarts, 1.05f, 64);
+    auto after = Vengine::analyzeVertexCache(grid.indices.data(), grid.indices.size(), grid.vertexCount);
+
+    CHECK(getTriangles(grid.positions, grid.indices) == triangles);
+    CHECK(after.getAcmr() <= before.getAcmr() * 1.05f + 1e-6f);
+}
+
+TEST_CASE("OptimizeVertexFetchOrdersByFirstUse") {
+    auto grid = makeGrid(16, true);
+    Vengine::optimizeVertexCache(grid.indices.data(), grid.indices.size(), grid.vertexCount);
+    auto triangles = getTriangles(grid.positions, grid.indices);
+
+    Vengine::optimizeVertexFetch(grid.positions.data(), STRIDE, grid.vertexCount, grid.indices.data(),
+                                 grid.indices.size());
+
+    CHECK(getTriangles(grid.positions, grid.indices) == triangles);
+    uint32_t next = 0;
+    for (auto index : grid.indices) {
+        CHECK(index <= next);
+        if (index == next) {
+            next++;
+        }
+    }
+    CHECK(next == grid.vertexCount);
+}
+
+TEST_CASE("SimplifyMeshKeepsFlatGridBorder") {
+    auto grid = makeGrid(32, true);
+    auto triangleArea = [&grid](const uint32_t* triangle) {
+        const float* a = grid.positions.data() + triangle[0] * STRIDE;
+        const float* b = grid.positions.data() + triangle[1] * STRIDE;
+        const float* c = grid.positions.data() + triangle[2] * STRIDE;
+        // z is 0 everywhere, signed area in the xy plane
+        return ((b[0] - a[0]) * (c[1] - a[1]) - (b[1] - a[1]) * (c[0] - a[0])) * 0.5f;
+    };
+
+    auto target = grid.indices.size() / 4;
+    auto result = Vengine::simplifyMesh(grid.indices.data(), grid.indices.size(), grid.positions.data(), STRIDE,
+                                        grid.vertexCount, target, 0.01f);
+    REQUIRE(result.indexCount <= target);
+    CHECK(result.indexCount % 3 == 0);
+    CHECK(result.error < 1e-4f);
+
+    // same surface: total area, every triangle still facing the same way, border vertices all there
+    float area = 0.0f;
+    std::vector<uint8_t> used(grid.vertexCount, 0);
+    for (size_t i = 0; i < result.indexCount; i += 3) {
+        auto triangle = triangleArea(grid.indices.data() + i);
+        CHECK(triangle > 0.0f);
+        area += triangle;
+        for (size_t k = 0; k < 3; ++k) {
+            used[grid.indices[i + k]] = 1;
+        }
+    }
+    CHECK(area == doctest::Approx(32.0f * 32.0f));
+    for (uint32_t x = 0; x <= 32; ++x) {
+        CHECK(used[x]);
+        CHECK(used[32 * 33 + x]);
+        CHECK(used[x * 33]);
+        CHECK(used[x * 33 + 32]);
+    }
+}
+
+TEST_CASE("SimplifyMeshStopsAtErrorLimit") {
+    // a bumpy height field, every collapse moves the surface a bit
+    auto grid = makeGrid(32, true);
+    for (size_t v = 0; v < grid.vertexCount; ++v) {
+        float* p = grid.positions.data() + v * STRIDE;
+        p[2] = std::sin(p[0] * 0.4f) * std::cos(p[1] * 0.3f) * 2.0f;
+    }
+    auto indices = grid.indices;
+
+    auto strict = Vengine::simplifyMesh(indices.data(), indices.size(), grid.positions.data(), STRIDE,
+                                        grid.vertexCount, 0, 0.001f);
+    CHECK(strict.error <= 0.001f);
+    CHECK(strict.indexCount > grid.indices.size() / 2);
+
+    indices = grid.indices;
+    auto loose = Vengine::simplifyMesh(indices.data(), indices.size(), grid.positions.data(), STRIDE,
+                                       grid.vertexCount, grid.indices.size() / 8, 1.0f);
+    CHECK(loose.indexCount <= grid.indices.size() / 8);
+    CHECK(loose.error > strict.error);
+    CHECK(loose.error <= 1.0f);
+}
@@ -0,0 +1,134 @@
+#include <doctest.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "vengine/core/meshlets.hpp"
+#include "test_helpers.hpp"
+
+namespace {
+
+using Tests::getTriangles;
+using Tests::makeGrid;
+constexpr size_t STRIDE = Tests::GRID_STRIDE;
+
+// column major identity, the visible volume is the cube from -1 to 1
+auto identity() -> std::array<float, 16> {
+    return {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+}
+
+}  // namespace
+
+TEST_CASE("BuildMeshletsRespectsLimits") {
+    auto grid = makeGrid(48, true);
+    auto triangles = getTriangles(grid.positions, grid.indices);
+
+    auto meshlets = Vengine::buildMeshlets(grid.indices.data(), grid.indices.size(), grid.positions.data(), STRIDE,
+                                           grid.vertexCount);
+
+    CHECK(getTriangles(grid.positions, grid.indices) == triangles);
+    REQUIRE_FALSE(meshlets.empty());
+    // 64 vertices of a grid hold about 100 triangles, most meshlets get close to that
+    CHECK(meshlets.size() <= triangles.size() / 70);
+
+    uint32_t next = 0;
+    float radiusSum = 0.0f;
+    for (const auto& meshlet : meshlets) {
+        CHECK(meshlet.indexOffset == next);
+        CHECK(meshlet.indexCount % 3 == 0);
+        CHECK(meshlet.indexCount / 3 <= Vengine::MESHLET_MAX_TRIANGLES);
+        next += meshlet.indexCount;
+
+        std::vector<uint32_t> vertices(grid.indices.begin() + meshlet.indexOffset,
+                                       grid.indices.begin() + meshlet.indexOffset + meshlet.indexCount);
+        std::sort(vertices.begin(), vertices.end());
+        vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+        CHECK(vertices.size() <= Vengine::MESHLET_MAX_VERTICES);
+
+        for (auto vertex : vertices) {
+            const float* p = grid.positions.data() + vertex * STRIDE;
+            float distance = std::hypot(p[0] - meshlet.center[0], p[1] - meshlet.center[1], p[2] - meshlet.center[2]);
+            CHECK(distance <= meshlet.radius * 1.0001f);
+        }
+        // flat, counter clockwise from +z: a closed cone straight up
+        CHECK(meshlet.coneAxis[2] == doctest::Approx(1.0f));
+        CHECK(meshlet.coneCutoff == doctest::Approx(1.0f));
+        radiusSum += meshlet.radius;
+    }
+    CHECK(next == grid.indices.size());
+    // grown round, not as strips through the whole grid. a full 7 x 7 quad patch is 4.95
+    CHECK(radiusSum / static_cast<float>(meshlets.size()) < 6.0f);
+}
+
+TEST_CASE("BuildMeshletsOpensConeForFoldedGeometry") {
+    // two quads at a right angle, and a quad with its back side too
+    std::vector<float> positions = {0, 0, 0, 1, 0, 0, 0, 1, 0, 1, 1, 0, 0, 0, 1, 1, 0, 1};
+    std::vector<uint32_t> folded = {0, 1, 2, 1, 3, 2, 0, 4, 1, 1, 4, 5};
+    auto meshlets = Vengine::buildMeshlets(folded.data(), folded.size(), positions.data(), STRIDE, 6);
+    REQUIRE(meshlets.size() == 1);
+    CHECK(meshlets[0].coneCutoff == doctest::Approx(std::sqrt(0.5f)).epsilon(0.001));
+
+    std::vector<uint32_t> twoSided = {0, 1, 2, 1, 3, 2, 0, 2, 1, 1, 2, 3};
+    meshlets = Vengine::buildMeshlets(twoSided.data(), twoSided.size(), positions.data(), STRIDE, 6);
+    REQUIRE(meshlets.size() == 1);
+    CHECK(meshlets[0].coneCutoff == 0.0f);
+}
+
+TEST_CASE("CullMeshletsDropsOutsideFrustum") {
+    // 32 x 32 grid scaled down to 0..2, the identity frustum sees the quarter from 0 to 1
+    auto grid = makeGrid(32, false);
+    for (auto& coordinate : grid.positions) {
+        coordinate /= 16.0f;
+    }
+    auto meshlets = Vengine::buildMeshlets(grid.indices.data(), grid.indices.size(), grid.positions.data(), STRIDE,
+                                           grid.vertexCount);
+    Vengine::MeshletBounds bounds;
+    bounds.assign(meshlets);
+    REQUIRE(bounds.size() == meshlets.size());
+
+    auto view = Vengine::makeMeshletCullView(identity(), {0.5f, 0.5f, 5.0f}, false);
+    std::vector<uint8_t> visible(meshlets.size());
+    auto visibleCount = Vengine::cullMeshlets(bounds, 0, meshlets.size(), view, visible.data());
+
+    CHECK(visibleCount > 0);
+    CHECK(visibleCount < meshlets.size() / 2);
+    for (size_t i = 0; i < meshlets.size(); i++) {
+        const auto& meshlet = meshlets[i];
+        bool touches = meshlet.center[0] - meshlet.radius <= 1.0f && meshlet.center[1] - meshlet.radius <= 1.0f;
+        CHECK(static_cast<bool>(visible[i]) == touches);
+    }
+
+    // scaled up 4 times by the "model" matrix, everything but the corner at the origin is gone
+    auto scaled = identity();
+    scaled[0] = scaled[5] = scaled[10] = 4.0f;
+    view = Vengine::makeMeshletCullView(scaled, {0.0f, 0.0f, 5.0f}, false);
+    CHECK(Vengine::cullMeshlets(bounds, 0, meshlets.size(), view, visible.data()) < visibleCount);
+    CHECK(visible[0] == 1);
+}
+
+TEST_CASE("CullMeshletsBackfacesOnlyWhenAsked") {
+    auto grid = makeGrid(16, false);
+    for (auto& coordinate : grid.positions) {
+        coordinate /= 16.0f;
+    }
+    auto meshlets = Vengine::buildMeshlets(grid.indices.data(), grid.indices.size(), grid.positions.data(), STRIDE,
+                                           grid.vertexCount);
+    Vengine::MeshletBounds bounds;
+    bounds.assign(meshlets);
+    std::vector<uint8_t> visible(meshlets.size());
+
+    // the grid faces +z
+    auto front = Vengine::makeMeshletCullView(identity(), {0.5f, 0.5f, 3.0f}, true);
+    CHECK(Vengine::cullMeshlets(bounds, 0, meshlets.size(), front, visible.data()) == meshlets.size());
+    auto behind = Vengine::makeMeshletCullView(identity(), {0.5f, 0.5f, -3.0f}, true);
+    CHECK(Vengine::cullMeshlets(bounds, 0, meshlets.size(), behind, visible.data()) == 0);
+    auto twoSided = Vengine::makeMeshletCullView(identity(), {0.5f, 0.5f, -3.0f}, false);
+    CHECK(Vengine::cullMeshlets(bounds, 0, meshlets.size(), twoSided, visible.data()) == meshlets.size());
+
+    // from the side, level with the grid, every triangle is seen edge on and nothing is culled
+    auto edgeOn = Vengine::makeMeshletCullView(identity(), {0.5f, -3.0f, 0.0f}, true);
+    CHECK(Vengine::cullMeshlets(bounds, 0, meshlets.size(), edgeOn, visible.data()) == meshlets.size());
+}
@@ -0,0 +1,119 @@
+#include <doctest.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "vengine/core/mpsc_queue.hpp"
+
+TEST_CASE("MpscQueuePushAndPopInOrder") {
+    Vengine::MpscQueue<int> queue(8);
+    CHECK(queue.capacity() == 8);
+    CHECK(queue.empty());
+
+    for (int i = 0; i < 5; ++i) {
+        CHECK(queue.tryPush(i));
+    }
+    CHECK(queue.size() == 5);
+
+    int value = -1;
+    for (int i = 0; i < 5; ++i) {
+        CHECK(queue.tryPop(value));
+        CHECK(value == i);
+    }
+    CHECK_FALSE(queue.tryPop(value));
+}
+
+TEST_CASE("MpscQueueRejectsPushesWhenFull") {
+    Vengine::MpscQueue<std::string> queue(4);
+
+    for (int i = 0; i < 4; ++i) {
+        CHECK(queue.tryPush(std::to_string(i)));
+    }
+    std::string overflow = "overflow";
+    CHECK_FALSE(queue.tryPush(std::move(overflow)));
+    CHECK(overflow == "overflow");  // not moved from on failure
+
+    std::string value;
+    CHECK(queue.tryPop(value));
+    CHECK(value == "0");
+    CHECK(queue.tryPush(std::string("4")));
+
+    auto stats = queue.getStats();
+    CHECK(stats.pushed == 5);
+    CHECK(stats.popped == 1);
+    CHECK(stats.failedPushes == 1);
+    CHECK(stats.highWaterMark == 4);
+}
+
+TEST_CASE("MpscQueueDestroysUnpoppedValues") {
+    auto tracked = std::make_shared<int>(0);
+    {
+        Vengine::MpscQueue<std::shared_ptr<int>> queue(4);
+        queue.tryPush(tracked);
+        queue.tryPush(tracked);
+        CHECK(tracked.use_count() == 3);
+    }
+    CHECK(tracked.use_count() == 1);
+}
+
+TEST_CASE("MpscQueueManyProducers") {
+    constexpr int PRODUCERS = 8;
+    constexpr int ITEMS_PER_PRODUCER = 20000;
+
+    struct Message {
+        int producer = 0;
+        int index = 0;
+    };
+
+    Vengine::MpscQueue<Message> queue(256);
+    std::atomic<bool> start{false};
+    std::vector<std::thread> producers;
+
+    for (int p = 0; p < PRODUCERS; ++p) {
+        producers.emplace_back([&queue, &start, p]() {
+            while (!start.load()) {
+                std::this_thread::yield();
+            }
+            for (int i = 0; i < ITEMS_PER_PRODUCER; ++i) {
+                while (!queue.tryPush(Message{p, i})) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    start.store(true);
+
+    // every producer's messages have to arrive complete and in order
+    std::vector<int> nextIndex(PRODUCERS, 0);
+    int received = 0;
+    bool ordered = true;
+    Message message;
+    while (received < PRODUCERS * ITEMS_PER_PRODUCER) {
+        if (queue.tryPop(message)) {
+            ordered = ordered && message.index == nextIndex[message.producer];
+            nextIndex[message.producer] = message.index + 1;
+            ++received;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    for (auto& producer : producers) {
+        producer.join();
+    }
+
+    CHECK(ordered);
+    CHECK_FALSE(queue.tryPop(message));
+    for (int p = 0; p < PRODUCERS; ++p) {
+        CHECK(nextIndex[p] == ITEMS_PER_PRODUCER);
+    }
+
+    auto stats = queue.getStats();
+    CHECK(stats.pushed == static_cast<size_t>(PRODUCERS * ITEMS_PER_PRODUCER));
+    CHECK(stats.popped == stats.pushed);
+    CHECK(stats.highWaterMark <= queue.capacity());
+}
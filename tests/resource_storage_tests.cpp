@@ -0,0 +1,272 @@
+#include <doctest.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "vengine/core/content_registry.hpp"
+#include "vengine/core/resource_storage.hpp"
+
+namespace {
+
+class DummyResource : public Vengine::IResource {
+   public:
+    explicit DummyResource(int value = 0) : value(value) {
+    }
+    auto load(const std::string& /*fileName*/) -> bool override {
+        m_isLoaded = true;
+        return true;
+    }
+    auto unload() -> bool override {
+        m_isLoaded = false;
+        return true;
+    }
+    int value = 0;
+};
+
+}  // namespace
+
+TEST_CASE("ResourceStorageResolvesAfterPublish") {
+    Vengine::ResourceStorage<DummyResource> storage;
+
+    auto handle = storage.acquire("a");
+    CHECK(handle.isValid());
+    CHECK(storage.get(handle) == nullptr);  // reserved but not loaded yet
+    CHECK(storage.getLoadedCount() == 0);
+
+    storage.publish(handle, std::make_shared<DummyResource>(7));
+    REQUIRE(storage.get(handle) != nullptr);
+    CHECK(storage.get(handle)->value == 7);
+    CHECK(storage.find("a") == handle);
+    CHECK(storage.acquire("a") == handle);
+    CHECK(storage.contains("a"));
+    CHECK(storage.getLoadedCount() == 1);
+
+    CHECK_FALSE(storage.find("missing").isValid());
+    CHECK(storage.get(Vengine::Handle<DummyResource>{}) == nullptr);
+}
+
+TEST_CASE("ResourceStorageStaleHandles") {
+    Vengine::ResourceStorage<DummyResource> storage;
+
+    auto first = storage.acquire("a");
+    storage.publish(first, std::make_shared<DummyResource>(1));
+    auto released = storage.release("a");
+    CHECK(released != nullptr);
+    CHECK(storage.get(first) == nullptr);
+    CHECK(storage.getLoadedCount() == 0);
+
+    // the slot is reused with a new generation
+    auto second = storage.acquire("b");
+    storage.publish(second, std::make_shared<DummyResource>(2));
+    CHECK(second.index == first.index);
+    CHECK(second.generation != first.generation);
+    CHECK(storage.get(first) == nullptr);
+    CHECK(storage.get(second)->value == 2);
+}
+
+TEST_CASE("ResourceStorageGrowsWhileReadersResolve") {
+    constexpr int COUNT = Vengine::ResourceStorage<DummyResource>::CHUNK_SIZE * 4;
+    Vengine::ResourceStorage<DummyResource> storage;
+
+    auto firstHandle = storage.acquire("resource0");
+    storage.publish(firstHandle, std::make_shared<DummyResource>(0));
+
+    std::atomic<bool> done{false};
+    std::atomic<bool> failed{false};
+    std::thread reader([&]() {
+        while (!done.load()) {
+            auto resource = storage.get(firstHandle);
+            if (!resource || resource->value != 0) {
+                failed.store(true);
+            }
+        }
+    });
+
+    std::vector<Vengine::Handle<DummyResource>> handles;
+    for (int i = 1; i < COUNT; ++i) {
+        auto handle = storage.acquire("resource" + std::to_string(i));
+        storage.publish(handle, std::make_shared<DummyResource>(i));
+        handles.push_back(handle);
+    }
+    done.store(true);
+    reader.join();
+
+    CHECK_FALSE(failed.load());
+    CHECK(storage.getLoadedCount() == COUNT);
+    for (int i = 1; i < COUNT; ++i) {
+        CHECK(storage.get(handles[i - 1])->value == i);
+    }
+}
+
+TEST_CASE("ResourceStoragePublishIfEmpty") {
+    Vengine::ResourceStorage<DummyResource> storage;
+
+    auto handle = storage.acquire("a");
+    auto first = std::make_shared<DummyResource>(1);
+    CHECK(storage.publishIfEmpty(handle, first) == first);
+    CHECK(storage.publishIfEmpty(handle, std::make_shared<DummyResource>(2)) == first);
+    CHECK(storage.get(handle)->value == 1);
+    CHECK(storage.getLoadedCount() == 1);
+}
+
+TEST_CASE("ResourceStorageTracksUseAndReferences") {
+    Vengine::ResourceStorage<DummyResource> storage("Dummy");
+    CHECK(storage.getTypeName() == "Dummy");
+
+    storage.setFrame(3);
+    auto handle = storage.acquire("a");
+    storage.publish(handle, std::make_shared<DummyResource>());
+    storage.publish(storage.acquire("b"), std::make_shared<DummyResource>());
+
+    storage.setFrame(10);
+    CHECK(storage.get(handle) != nullptr);
+    auto held = storage.lock(handle);
+    CHECK(storage.contains("b"));  // lookups by name don't count as use
+
+    auto entries = storage.getEntries();
+    REQUIRE(entries.size() == 2);
+    for (const auto& entry : entries) {
+        if (entry.name == "a") {
+            CHECK(entry.lastUsedFrame == 10);
+            CHECK(entry.referenced);
+        } else {
+            CHECK(entry.lastUsedFrame == 3);
+            CHECK_FALSE(entry.referenced);
+        }
+    }
+
+    held.reset();
+    entries.clear();
+    entries = storage.getEntries();
+    for (const auto& entry : entries) {
+        CHECK_FALSE(entry.referenced);
+    }
+
+    // a handle held somewhere counts once it is marked, for that frame only
+    storage.markReferenced(storage.find("b"));
+    entries.clear();
+    entries = storage.getEntries();
+    for (const auto& entry : entries) {
+        CHECK(entry.referenced == (entry.name == "b"));
+    }
+    storage.setFrame(11);
+    entries.clear();
+    for (const auto& entry : storage.getEntries()) {
+        CHECK_FALSE(entry.referenced);
+    }
+
+    CHECK(storage.releaseResource("b") != nullptr);
+    CHECK(storage.getLoadedCount() == 1);
+}
+
+TEST_CASE("ResourceStorageRetiresReleasedResources") {
+    Vengine::ResourceStorage<DummyResource> storage;
+    storage.setFrame(5);
+
+    auto handle = storage.acquire("a");
+    auto resource = std::make_shared<DummyResource>(1);
+    std::weak_ptr<DummyResource> weak = resource;
+    storage.publish(handle, std::move(resource));
+    DummyResource* read = storage.get(handle);
+    REQUIRE(read != nullptr);
+    CHECK(storage.lock(handle).get() == read);
+
+    // a pointer resolved this frame outlives the release and the frame after it
+    storage.release("a");
+    CHECK(storage.get(handle) == nullptr);
+    CHECK(storage.lock(handle) == nullptr);
+    storage.setFrame(6);
+    CHECK_FALSE(weak.expired());
+    CHECK(read->value == 1);
+    storage.setFrame(5 + Vengine::ResourceStorage<DummyResource>::RETIRE_FRAMES);
+    CHECK(weak.expired());
+
+    // so does one that got replaced
+    auto second = storage.acquire("b");
+    auto first = std::make_shared<DummyResource>(2);
+    std::weak_ptr<DummyResource> firstWeak = first;
+    storage.publish(second, std::move(first));
+    storage.publish(second, std::make_shared<DummyResource>(3));
+    CHECK(storage.get(second)->value == 3);
+    CHECK_FALSE(firstWeak.expired());
+    storage.setFrame(100);
+    CHECK(firstWeak.expired());
+    CHECK(storage.getLoadedCount() == 1);
+}
+
+TEST_CASE("ResourceStorageReleaseIfEmpty") {
+    Vengine::ResourceStorage<DummyResource> storage;
+
+    auto failed = storage.acquire("a");
+    CHECK(storage.releaseIfEmpty(failed));
+    CHECK_FALSE(storage.find("a").isValid());
+    CHECK_FALSE(storage.releaseIfEmpty(failed));
+
+    // a load that fails after an earlier one worked keeps the old resource
+    auto loaded = storage.acquire("b");
+    storage.publish(loaded, std::make_shared<DummyResource>(1));
+    CHECK_FALSE(storage.releaseIfEmpty(storage.acquire("b")));
+    CHECK(storage.get(loaded)->value == 1);
+
+    // and the name can be loaded again
+    auto retry = storage.acquire("a");
+    CHECK(retry.isValid());
+    CHECK(retry != failed);
+}
+
+TEST_CASE("ResourceStorageReleaseIfHolds") {
+    Vengine::ResourceStorage<DummyResource> storage;
+
+    auto handle = storage.acquire("a");
+    auto placeholder = std::make_shared<DummyResource>(1);
+    storage.publishIfEmpty(handle, placeholder);
+
+    // replaced in the meantime, the new resource stays
+    auto replacement = std::make_shared<DummyResource>(2);
+    storage.publish(handle, replacement);
+    CHECK_FALSE(storage.releaseIfHolds(handle, placeholder.get()));
+    CHECK(storage.get(handle)->value == 2);
+
+    CHECK(storage.releaseIfHolds(handle, replacement.get()));
+    CHECK_FALSE(storage.find("a").isValid());
+    CHECK(storage.getLoadedCount() == 0);
+    CHECK(replacement->value == 2);  // holders keep their object
+}
+
+TEST_CASE("ContentRegistrySharesFirstLiveResource") {
+    Vengine::ContentRegistry<DummyResource> registry;
+    auto first = std::make_shared<DummyResource>(1);
+    auto second = std::make_shared<DummyResource>(2);
+
+    CHECK(registry.findOrAdd(42, first) == nullptr);
+    CHECK(registry.findOrAdd(42, first) == nullptr);  // registering again is not a duplicate
+    CHECK(registry.findOrAdd(42, second) == first);
+    CHECK(registry.findOrAdd(7, second) == nullptr);
+    CHECK(registry.size() == 2);
+
+    // a dead entry is taken over by the next candidate
+    first.reset();
+    auto third = std::make_shared<DummyResource>(3);
+    CHECK(registry.findOrAdd(42, third) == nullptr);
+    CHECK(registry.findOrAdd(42, second) == third);
+
+    second.reset();
+    registry.prune();
+    CHECK(registry.size() == 1);
+}
+
+TEST_CASE("ContentRegistryFindDoesNotRegister") {
+    Vengine::ContentRegistry<DummyResource> registry;
+    CHECK(registry.find(42) == nullptr);
+    CHECK(registry.size() == 0);
+
+    auto first = std::make_shared<DummyResource>(1);
+    registry.findOrAdd(42, first);
+    CHECK(registry.find(42) == first);
+
+    first.reset();
+    CHECK(registry.find(42) == nullptr);
+}
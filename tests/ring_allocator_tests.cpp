@@ -0,0 +1,103 @@
+#include <doctest.h>
+
+#include "vengine/core/ring_allocator.hpp"
+
+using Vengine::RingAllocator;
+
+TEST_CASE("RingAllocatorAlignedRangesInOrder") {
+    RingAllocator ring(1024);
+
+    auto a = ring.allocate(100);
+    auto b = ring.allocate(10);
+    REQUIRE(a);
+    REQUIRE(b);
+    CHECK(a->offset == 0);
+    CHECK(b->offset == 256);
+    CHECK(a->id != b->id);
+    CHECK(ring.getLiveCount() == 2);
+    CHECK(ring.getUsedBytes() == 266);
+
+    auto c = ring.allocate(10, 1);
+    REQUIRE(c);
+    CHECK(c->offset == 266);
+
+    CHECK_FALSE(ring.allocate(0));
+    CHECK_FALSE(ring.allocate(2048));
+}
+
+TEST_CASE("RingAllocatorFreesBehindPassedFence") {
+    RingAllocator ring(1024);
+
+    auto a = ring.allocate(512);
+    auto b = ring.allocate(512);
+    REQUIRE(a);
+    REQUIRE(b);
+    CHECK_FALSE(ring.allocate(1));
+
+    // released but not fenced yet, the gpu may still read from it
+    ring.release(a->id);
+    ring.retire(100);
+    CHECK_FALSE(ring.allocate(1));
+
+    CHECK(ring.fence(1));
+    CHECK_FALSE(ring.fence(2));
+    ring.retire(1);
+    CHECK(ring.getLiveCount() == 1);
+
+    // wraps around to the start, in front of b
+    auto c = ring.allocate(256);
+    REQUIRE(c);
+    CHECK(c->offset == 0);
+    CHECK(ring.getUsedBytes() == 512 + 256);
+
+    auto d = ring.allocate(256);
+    REQUIRE(d);
+    CHECK(d->offset == 256);
+    CHECK_FALSE(ring.allocate(1));
+}
+
+TEST_CASE("RingAllocatorHeldUpByOldestRange") {
+    RingAllocator ring(1024);
+
+    auto a = ring.allocate(256);
+    auto b = ring.allocate(256);
+    auto c = ring.allocate(512);
+    REQUIRE(a);
+    REQUIRE(b);
+    REQUIRE(c);
+
+    // out of order, nothing comes back while a is still being filled
+    ring.release(c->id);
+    ring.release(b->id);
+    CHECK(ring.fence(1));
+    ring.retire(1);
+    CHECK(ring.getLiveCount() == 3);
+    CHECK_FALSE(ring.allocate(1));
+
+    ring.release(a->id);
+    CHECK(ring.fence(2));
+    ring.retire(1);
+    CHECK(ring.getLiveCount() == 3);
+    ring.retire(2);
+    CHECK(ring.getLiveCount() == 0);
+    CHECK(ring.getUsedBytes() == 0);
+
+    auto d = ring.allocate(1024);
+    REQUIRE(d);
+    CHECK(d->offset == 0);
+}
+
+TEST_CASE("RingAllocatorReset") {
+    RingAllocator ring;
+    CHECK_FALSE(ring.allocate(1));
+
+    ring.reset(512);
+    CHECK(ring.getCapacity() == 512);
+    auto a = ring.allocate(512);
+    REQUIRE(a);
+    CHECK_FALSE(ring.allocate(1));
+
+    ring.reset(512);
+    CHECK(ring.getLiveCount() == 0);
+    CHECK(ring.allocate(512));
+}
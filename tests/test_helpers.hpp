@@ -0,0 +1,125 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+namespace Tests {
+
+// creates the directories on the way, replaces what was there
+inline auto writeFile(const std::filesystem::path& path, const std::string& content) -> void {
+    if (path.has_parent_path()) {
+        std::filesystem::create_directories(path.parent_path());
+    }
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << content;
+}
+
+// floats per grid vertex, just the position
+constexpr size_t GRID_STRIDE = 3;
+
+struct Grid {
+    std::vector<float> positions;
+    std::vector<uint32_t> indices;
+    size_t vertexCount = 0;
+};
+
+// a size x size quad grid in the xy plane from 0 to size, counter clockwise seen from +z.
+// shuffled puts the triangles in random order, like a badly exported mesh
+inline auto makeGrid(uint32_t size, bool shuffled) -> Grid {
+    Grid grid;
+    for (uint32_t y = 0; y <= size; ++y) {
+        for (uint32_t x = 0; x <= size; ++x) {
+            grid.positions.insert(grid.positions.end(), {static_cast<float>(x), static_cast<float>(y), 0.0f});
+        }
+    }
+    grid.vertexCount = grid.positions.size() / GRID_STRIDE;
+
+    std::vector<std::array<uint32_t, 3>> triangles;
+    for (uint32_t y = 0; y < size; ++y) {
+        for (uint32_t x = 0; x < size; ++x) {
+            uint32_t bottomLeft = y * (size + 1) + x;
+            uint32_t topLeft = bottomLeft + size + 1;
+            triangles.push_back({bottomLeft, bottomLeft + 1, topLeft});
+            triangles.push_back({bottomLeft + 1, topLeft + 1, topLeft});
+        }
+    }
+    if (shuffled) {
+        std::mt19937 random(42);
+        std::shuffle(triangles.begin(), triangles.end(), random);
+    }
+    for (const auto& triangle : triangles) {
+        grid.indices.insert(grid.indices.end(), triangle.begin(), triangle.end());
+    }
+    return grid;
+}
+
+// every triangle as its three positions, rotated so the smallest corner comes first (winding kept),
+// sorted. compares the same across index and vertex reordering
+inline auto getTriangles(const std::vector<float>& positions, const std::vector<uint32_t>& indices)
+    -> std::vector<std::array<float, 9>> {
+    std::vector<std::array<float, 9>> triangles;
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        std::array<std::array<float, 3>, 3> corners{};
+        for (size_t k = 0; k < 3; ++k) {
+            const float* p = positions.data() + indices[i + k] * GRID_STRIDE;
+            corners[k] = {p[0], p[1], p[2]};
+        }
+        auto first = std::min_element(corners.begin(), corners.end()) - corners.begin();
+        std::array<float, 9> triangle{};
+        for (size_t k = 0; k < 3; ++k) {
+            const auto& corner = corners[(static_cast<size_t>(first) + k) % 3];
+            std::copy(corner.begin(), corner.end(), triangle.begin() + static_cast<std::ptrdiff_t>(k * 3));
+        }
+        triangles.push_back(triangle);
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+// hidden window for its context, false where there is no display or driver (ci)
+class GlContext {
+   public:
+    GlContext() {
+        if (glfwInit() == 0) {
+            return;
+        }
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        m_window = glfwCreateWindow(16, 16, "vengine_tests", nullptr, nullptr);
+        if (m_window == nullptr) {
+            return;
+        }
+        glfwMakeContextCurrent(m_window);
+        m_loaded = gladLoadGLLoader(reinterpret_cast<GLADloadproc>(glfwGetProcAddress)) != 0;
+    }
+    ~GlContext() {
+        if (m_window != nullptr) {
+            glfwDestroyWindow(m_window);
+        }
+        glfwTerminate();
+    }
+    GlContext(const GlContext&) = delete;
+    auto operator=(const GlContext&) -> GlContext& = delete;
+
+    explicit operator bool() const {
+        return m_loaded;
+    }
+
+   private:
+    GLFWwindow* m_window = nullptr;
+    bool m_loaded = false;
+};
+
+}  // namespace Tests
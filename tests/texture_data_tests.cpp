@@ -0,0 +1,219 @@
+#include <doctest.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include "vengine/core/texture_cache.hpp"
+#include "vengine/core/texture_data.hpp"
+
+namespace {
+
+// mostly one dimensional in color like real textures, a block is close to a line in rgb
+auto makeGradient(uint32_t width, uint32_t height, bool withAlpha) -> std::vector<uint8_t> {
+    std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 4);
+    for (uint32_t y = 0; y < height; ++y) {
+        for (uint32_t x = 0; x < width; ++x) {
+            uint8_t* texel = &pixels[(static_cast<size_t>(y) * width + x) * 4];
+            auto red = x * 255 / std::max(1u, width - 1);
+            texel[0] = static_cast<uint8_t>(red);
+            texel[1] = static_cast<uint8_t>(red / 2 + y * 2);
+            texel[2] = static_cast<uint8_t>(255 - red);
+            texel[3] = withAlpha ? static_cast<uint8_t>((x + y) * 255 / std::max(1u, width + height - 2)) : 255;
+        }
+    }
+    return pixels;
+}
+
+auto maxError(const Vengine::TextureData& a, const Vengine::TextureData& b) -> int {
+    int error = 0;
+    for (size_t i = 0; i < a.bytes.size(); ++i) {
+        error = std::max(error, std::abs(static_cast<int>(a.bytes[i]) - static_cast<int>(b.bytes[i])));
+    }
+    return error;
+}
+
+}  // namespace
+
+TEST_CASE("BuildMipChainGoesDownToOne") {
+    std::vector<uint8_t> rgb(5 * 3 * 3, 200);
+    auto data = Vengine::buildMipChain(rgb.data(), 5, 3, 3);
+
+    REQUIRE(data.mips.size() == 3);
+    CHECK(data.mips[1].width == 2);
+    CHECK(data.mips[1].height == 1);
+    CHECK(data.mips[2].width == 1);
+    CHECK(data.mips[2].height == 1);
+    CHECK(data.bytes.size() == (5 * 3 + 2 * 1 + 1) * 4);
+    // rgb gets an opaque alpha, a flat color stays flat down the chain
+    CHECK(data.getMipData(2)[0] == 200);
+    CHECK(data.getMipData(2)[3] == 255);
+}
+
+TEST_CASE("Bc1AndBc3StayCloseToSource") {
+    auto opaque = makeGradient(16, 16, false);
+    auto rgba = Vengine::buildMipChain(opaque.data(), 16, 16, 4);
+    CHECK(Vengine::chooseBlockFormat(rgba) == Vengine::TextureFormat::BC1);
+
+    auto bc1 = Vengine::compressTexture(rgba, Vengine::TextureFormat::BC1);
+    CHECK(bc1.bytes.size() == (16 + 4 + 1 + 1 + 1) * 8);  // 4x4 blocks, levels below 4x4 still take one
+    CHECK(maxError(rgba, Vengine::decompressTexture(bc1)) <= 16);
+
+    auto translucent = makeGradient(16, 16, true);
+    auto rgbaAlpha = Vengine::buildMipChain(translucent.data(), 16, 16, 4);
+    CHECK(Vengine::chooseBlockFormat(rgbaAlpha) == Vengine::TextureFormat::BC3);
+
+    auto bc3 = Vengine::compressTexture(rgbaAlpha, Vengine::TextureFormat::BC3);
+    CHECK(bc3.bytes.size() == bc1.bytes.size() * 2);
+    CHECK(maxError(rgbaAlpha, Vengine::decompressTexture(bc3)) <= 16);
+}
+
+TEST_CASE("RuntimeImportFormatFromChannels") {
+    CHECK(Vengine::TextureCache().getImportCompression() == Vengine::TextureCompression::Auto);
+
+    std::vector<uint8_t> rgb(8 * 8 * 3, 200);
+    auto opaque = Vengine::buildTexture(rgb.data(), 8, 8, 3, Vengine::TextureCompression::Auto);
+    CHECK(opaque.format == Vengine::TextureFormat::BC1);
+    CHECK(opaque.bytes.size() < static_cast<size_t>(8) * 8 * 3);
+
+    auto translucent = makeGradient(8, 8, true);
+    auto withAlpha = Vengine::buildTexture(translucent.data(), 8, 8, 4, Vengine::TextureCompression::Auto);
+    CHECK(withAlpha.format == Vengine::TextureFormat::BC3);
+}
+
+TEST_CASE("Bc1EncodesSolidBlockExactly") {
+    uint8_t texels[64];
+    for (int i = 0; i < 16; ++i) {
+        texels[i * 4 + 0] = 255;
+        texels[i * 4 + 1] = 0;
+        texels[i * 4 + 2] = 0;
+        texels[i * 4 + 3] = 255;
+    }
+    uint8_t block[8];
+    uint8_t decoded[64];
+    Vengine::encodeBC1Block(texels, block);
+    Vengine::decodeBC1Block(block, decoded);
+    for (int i = 0; i < 64; ++i) {
+        CHECK(decoded[i] == texels[i]);
+    }
+}
+
+TEST_CASE("TextureCacheRoundTripAndInvalidation") {
+    auto root = std::filesystem::temp_directory_path() / "vengine_texture_cache_test";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root);
+
+    auto source = root / "gradient.png";
+    {
+        std::ofstream file(source, std::ios::binary);
+        file << "not really a png";
+    }
+
+    auto pixels = makeGradient(8, 8, false);
+    auto data = Vengine::buildTexture(pixels.data(), 8, 8, 4, Vengine::TextureCompression::Auto);
+    CHECK(data.format == Vengine::TextureFormat::BC1);
+
+    Vengine::TextureCache cache(root / "cache");
+    Vengine::TextureData loaded;
+    CHECK_FALSE(cache.load(source, loaded));
+    REQUIRE(cache.store(source, data));
+
+    REQUIRE(cache.load(source, loaded));
+    CHECK(loaded.format == Vengine::TextureFormat::BC1);
+    CHECK(loaded.width == 8);
+    REQUIRE(loaded.mips.size() == data.mips.size());
+    CHECK(loaded.mips[1].offset == data.mips[1].offset);
+    CHECK(loaded.bytes == data.bytes);
+
+    // what a streamed texture starts with and what the streamer reads later
+    Vengine::TextureData tail;
+    REQUIRE(cache.load(source, tail, 2));
+    CHECK(tail.firstLevel == 2);
+    CHECK(tail.mips.size() == data.mips.size());
+    CHECK(std::equal(tail.bytes.begin(), tail.bytes.end(), data.getMipData(2)));
+
+    Vengine::TextureData levels;
+    REQUIRE(cache.loadLevels(source, 0, 2, levels));
+    CHECK(levels.firstLevel == 0);
+    CHECK(levels.bytes.size() == data.mips[0].size + data.mips[1].size);
+    CHECK(std::equal(levels.bytes.begin(), levels.bytes.end(), data.bytes.begin()));
+
+    // a table that isn't the chain back to back is rejected, not copied out of order
+    auto overlapping = data;
+    overlapping.mips[2].offset = overlapping.mips[1].offset;
+    REQUIRE(cache.store(source, overlapping));
+    CHECK_FALSE(cache.load(source, loaded));
+
+    auto wrongSize = data;
+    std::swap(wrongSize.mips[1].width, wrongSize.mips[2].width);
+    REQUIRE(cache.store(source, wrongSize));
+    CHECK_FALSE(cache.load(source, loaded));
+
+    REQUIRE(cache.store(source, data));
+    {
+        std::ofstream file(source, std::ios::binary | std::ios::app);
+        file << "changed";
+    }
+    CHECK_FALSE(cache.load(source, loaded));
+
+    std::filesystem::remove_all(root);
+}
+
+TEST_CASE("DropLevelsKeepsTail") {
+    std::vector<uint8_t> rgba(16 * 16 * 4, 10);
+    auto data = Vengine::buildMipChain(rgba.data(), 16, 16, 4);
+    auto level = Vengine::getLevelForSize(data, 4);
+    CHECK(level == 2);
+
+    Vengine::dropLevels(data, level);
+    CHECK(data.firstLevel == 2);
+    CHECK(data.bytes.size() == (4 * 4 + 2 * 2 + 1) * 4);
+    CHECK(data.getMipData(4) == data.bytes.data() + (4 * 4 + 2 * 2) * 4);
+}
+
+TEST_CASE("GetLevelForScreenSize") {
+    CHECK(Vengine::getLevelForScreenSize(1024, 1024.0f, 11) == 0);
+    CHECK(Vengine::getLevelForScreenSize(1024, 2048.0f, 11) == 0);
+    CHECK(Vengine::getLevelForScreenSize(1024, 512.0f, 11) == 1);
+    CHECK(Vengine::getLevelForScreenSize(1024, 100.0f, 11) == 3);
+    CHECK(Vengine::getLevelForScreenSize(1024, 100.0f, 11, 1.0f) == 4);
+    CHECK(Vengine::getLevelForScreenSize(1024, 0.0f, 11) == 10);
+    CHECK(Vengine::getLevelForScreenSize(1024, 0.01f, 11) == 10);
+}
+
+TEST_CASE("FitStreamingBudgetDropsLeastRecentlyUsed") {
+    // 4 levels at 1000, 250, 60, 15 bytes
+    std::vector<uint64_t> bytes = {1325, 325, 75, 15};
+    std::vector<Vengine::StreamingCandidate> candidates = {
+        {0, 3, 10, &bytes},
+        {0, 3, 5, &bytes},
+        {0, 2, 10, &bytes},
+    };
+
+    SUBCASE("fits already") {
+        CHECK(Vengine::fitStreamingBudget(candidates, 5000) == 3 * 1325);
+        CHECK(candidates[1].level == 0);
+    }
+
+    SUBCASE("the stale texture goes first") {
+        CHECK(Vengine::fitStreamingBudget(candidates, 2700) == 1325 * 2 + 15);
+        CHECK(candidates[0].level == 0);
+        CHECK(candidates[1].level == 3);
+        CHECK(candidates[2].level == 0);
+    }
+
+    SUBCASE("textures of the same frame share the cut and stop at their tail") {
+        CHECK(Vengine::fitStreamingBudget(candidates, 0) == 15 + 15 + 75);
+        CHECK(candidates[0].level == 3);
+        CHECK(candidates[1].level == 3);
+        CHECK(candidates[2].level == 2);
+    }
+
+    SUBCASE("a tighter budget costs the recent ones one level each") {
+        CHECK(Vengine::fitStreamingBudget(candidates, 700) == 325 + 15 + 325);
+        CHECK(candidates[0].level == 1);
+        CHECK(candidates[2].level == 1);
+    }
+}
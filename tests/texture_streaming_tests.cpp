@@ -0,0 +1,90 @@
+#define STB_IMAGE_IMPLEMENTATION
+
+#include <doctest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <vector>
+
+#include "vengine/core/resources.hpp"
+#include "vengine/core/texture_cache.hpp"
+#include "vengine/core/texture_data.hpp"
+#include "test_helpers.hpp"
+
+namespace {
+
+// uncompressed 32 bit tga, stb reads it without an encoder on our side
+auto writeTga(const std::filesystem::path& path, uint32_t size) -> void {
+    std::vector<uint8_t> file(18 + static_cast<size_t>(size) * size * 4, 255);
+    std::fill(file.begin(), file.begin() + 18, 0);
+    file[2] = 2;
+    file[12] = static_cast<uint8_t>(size);
+    file[14] = static_cast<uint8_t>(size);
+    file[16] = 32;
+    file[17] = 0x28;
+    for (size_t i = 18; i < file.size(); i += 4) {
+        file[i] = static_cast<uint8_t>(i / 4);
+        file[i + 1] = static_cast<uint8_t>(i / 64);
+    }
+    std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(file.data()),
+                                                static_cast<std::streamsize>(file.size()));
+}
+
+}  // namespace
+
+TEST_CASE("EvictStreamedTexture") {
+    Tests::GlContext context;
+    if (!context) {
+        MESSAGE("no OpenGL context, skipped");
+        return;
+    }
+
+    auto root = std::filesystem::temp_directory_path() / "vengine_texture_streaming_test";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root);
+    auto source = root / "streamed.tga";
+    writeTga(source, 64);
+
+    {
+        Vengine::TextureCache cache(root / "cache");
+        auto texture = std::make_shared<Vengine::Texture>();
+        texture->setCache(&cache);
+        texture->setStreaming(8);
+        REQUIRE(texture->load(source.string()));
+        REQUIRE(texture->isStreamable());
+        REQUIRE(texture->finalizeOnMainThread());
+
+        auto tail = texture->getTailLevel();
+        REQUIRE(tail > 0);
+        CHECK(texture->getResidentLevel() == tail);
+        CHECK(texture->getMemoryUsage().gpuBytes == texture->getResidentBytes(tail));
+
+        // streamed in the way TextureStreamer::startLoad does it
+        Vengine::TextureData levels;
+        REQUIRE(texture->loadLevels(0, tail, levels));
+        REQUIRE(texture->setResidentLevel(0, &levels));
+        CHECK(texture->getResidentLevel() == 0);
+        CHECK(texture->getMemoryUsage().gpuBytes == texture->getResidentBytes(0));
+
+        // and evicted the way TextureStreamer::update does it, no data
+        CHECK(texture->setResidentLevel(tail, nullptr));
+        CHECK(texture->getResidentLevel() == tail);
+        CHECK(texture->getTextureID() != 0);
+        CHECK(texture->getMemoryUsage().gpuBytes == texture->getResidentBytes(tail));
+        CHECK(glGetError() == GL_NO_ERROR);
+
+        texture->unload();
+    }
+    std::filesystem::remove_all(root);
+}
+
+TEST_CASE("StreamerKeepsTexturesApartAtReusedAddress") {
+    auto first = std::make_shared<Vengine::Texture>();
+    auto serial = first->getSerial();
+    first.reset();
+
+    // the allocator likely hands out the same block again, the serial is new regardless
+    auto second = std::make_shared<Vengine::Texture>();
+    CHECK(second->getSerial() != serial);
+}
@@ -0,0 +1,306 @@
+#include <doctest.h>
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "vengine/core/thread_manager.hpp"
+
+TEST_CASE("WaitForCompletionWaitsForAllTasks") {
+    Vengine::ThreadManager threadManager(2);
+    std::atomic<int> counter{0};
+
+    for (int i = 0; i < 100; ++i) {
+        threadManager.enqueueTask([&counter]() { counter.fetch_add(1); });
+    }
+
+    threadManager.waitForCompletion();
+    CHECK(counter.load() == 100);
+    CHECK(threadManager.getPendingTaskCount() == 0);
+}
+
+TEST_CASE("WaitForCompletionIncludesSpawnedTasks") {
+    Vengine::ThreadManager threadManager(2);
+    std::atomic<int> counter{0};
+
+    for (int i = 0; i < 10; ++i) {
+        threadManager.enqueueTask([&threadManager, &counter]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            for (int j = 0; j < 10; ++j) {
+                threadManager.enqueueTask([&counter]() { counter.fetch_add(1); });
+            }
+        });
+    }
+
+    threadManager.waitForCompletion();
+    CHECK(counter.load() == 100);
+}
+
+TEST_CASE("WaitGroupWaitsForOwnTasks") {
+    Vengine::ThreadManager threadManager(2);
+    auto group = std::make_shared<Vengine::WaitGroup>();
+    std::atomic<bool> blockerStarted{false};
+    std::atomic<bool> release{false};
+    std::atomic<int> counter{0};
+
+    // not part of the group, keeps running on a worker while we wait on the group
+    threadManager.enqueueTask([&blockerStarted, &release]() {
+        blockerStarted.store(true);
+        while (!release.load()) {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    });
+    while (!blockerStarted.load()) {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+
+    for (int i = 0; i < 20; ++i) {
+        threadManager.enqueueTask([&counter]() { counter.fetch_add(1); }, "group task", Vengine::TaskPriority::Normal, group);
+    }
+
+    threadManager.wait(group);
+    CHECK(group->isDone());
+    CHECK(counter.load() == 20);
+
+    release.store(true);
+    threadManager.waitForCompletion();
+}
+
+TEST_CASE("WaitingThreadHelpsWithTasks") {
+    Vengine::ThreadManager threadManager(1);
+    auto group = std::make_shared<Vengine::WaitGroup>();
+    std::atomic<bool> blockerStarted{false};
+    std::atomic<bool> release{false};
+    std::atomic<int> counter{0};
+
+    // occupy the only worker
+    threadManager.enqueueTask([&blockerStarted, &release]() {
+        blockerStarted.store(true);
+        while (!release.load()) {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    });
+    while (!blockerStarted.load()) {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+
+    auto waitingThread = std::this_thread::get_id();
+    std::atomic<int> ranOnWaitingThread{0};
+    for (int i = 0; i < 10; ++i) {
+        threadManager.enqueueTask(
+            [&counter, &ranOnWaitingThread, waitingThread]() {
+                counter.fetch_add(1);
+                if (std::this_thread::get_id() == waitingThread) {
+                    ranOnWaitingThread.fetch_add(1);
+                }
+            },
+            "helped task",
+            Vengine::TaskPriority::Normal,
+            group);
+    }
+
+    // the worker is blocked, so only the waiting thread can finish the group
+    threadManager.wait(group);
+    CHECK(counter.load() == 10);
+    CHECK(ranOnWaitingThread.load() == 10);
+
+    release.store(true);
+    threadManager.waitForCompletion();
+}
+
+TEST_CASE("WaitGroupCountsIntoParent") {
+    auto parent = std::make_shared<Vengine::WaitGroup>();
+    auto child = std::make_shared<Vengine::WaitGroup>(parent);
+
+    parent->add();
+    child->add(2);
+    CHECK(parent->getPending() == 3);
+    CHECK(parent->getTotal() == 3);
+
+    child->done();
+    child->done();
+    CHECK(child->isDone());
+    CHECK(parent->getPending() == 1);
+    CHECK(child->getTotal() == 2);
+
+    parent->done();
+    CHECK(parent->isDone());
+}
+
+TEST_CASE("WaitOnMainThreadRunsGroupTasks") {
+    Vengine::ThreadManager threadManager(1);
+    auto group = std::make_shared<Vengine::WaitGroup>();
+    std::atomic<bool> finalized{false};
+
+    // a load: worker task first, then a finalize on the main thread counted into the same group
+    threadManager.enqueueTask(
+        [&threadManager, &finalized, group]() {
+            group->add();
+            threadManager.enqueueMainThreadTask([&finalized, group]() {
+                finalized.store(true);
+                group->done();
+            });
+        },
+        "load",
+        Vengine::TaskPriority::Normal,
+        group);
+
+    threadManager.waitOnMainThread(*group);
+    CHECK(group->isDone());
+    CHECK(finalized.load());
+    CHECK(threadManager.getMainThreadTaskCount() == 0);
+}
+
+TEST_CASE("TaskProfilerRecordsWhenEnabled") {
+    Vengine::ThreadManager threadManager(2);
+
+    threadManager.enqueueTask([]() {}, "not recorded");
+    threadManager.waitForCompletion();
+    CHECK(threadManager.getProfiler().collect().empty());
+
+    threadManager.getProfiler().setEnabled(true);
+    for (int i = 0; i < 50; ++i) {
+        threadManager.enqueueTask([]() { std::this_thread::sleep_for(std::chrono::microseconds(50)); }, "profiled");
+    }
+    threadManager.waitForCompletion();
+
+    auto events = threadManager.getProfiler().collect();
+    CHECK(events.size() == 50);
+    for (const auto& event : events) {
+        CHECK(std::string(event.name) == "profiled");
+        CHECK(event.startNs >= event.enqueueNs);
+        CHECK(event.endNs >= event.startNs);
+    }
+
+    auto summary = threadManager.getProfiler().getSummary();
+    CHECK(summary.duration.count == 50);
+    CHECK(summary.queueLatency.count == 50);
+    CHECK(summary.droppedEvents == 0);
+
+    threadManager.getProfiler().clear();
+    CHECK(threadManager.getProfiler().collect().empty());
+}
+
+TEST_CASE("TaskProfilerTraceTimestamps") {
+    Vengine::TaskProfiler profiler;
+    profiler.record("first", 1000, 1000, 2000);
+    // queued at the origin, starts 1.234567891 s later and runs 0.5 us
+    profiler.record("late", 1000, 1'234'568'891, 1'234'569'391);
+
+    auto path = (std::filesystem::temp_directory_path() / "vengine_task_profiler_trace.json").string();
+    REQUIRE(profiler.exportChromeTrace(path));
+    std::stringstream trace;
+    trace << std::ifstream(path).rdbuf();
+    std::filesystem::remove(path);
+
+    CHECK(trace.str().find(R"("ts":1234567.891,"dur":0.500,"args":{"queue_us":1234567.891})") != std::string::npos);
+    CHECK(trace.str().find("e+") == std::string::npos);
+}
+
+TEST_CASE("TaskProfilerOneBufferPerThread") {
+    Vengine::TaskProfiler first;
+    Vengine::TaskProfiler second;
+    for (uint64_t i = 0; i < 10; ++i) {
+        first.record("first", i, i, i + 1);
+        second.record("second", i, i, i + 1);
+    }
+
+    for (const auto* profiler : {&first, &second}) {
+        auto events = profiler->collect();
+        CHECK(events.size() == 10);
+        for (const auto& event : events) {
+            CHECK(event.threadId == 0);
+        }
+    }
+}
+
+TEST_CASE("MainThreadTasksRespectFrameBudget") {
+    Vengine::ThreadManager threadManager(1);
+    threadManager.setMainThreadBudget(std::chrono::microseconds(2500));
+    int executed = 0;
+
+    for (int i = 0; i < 10; ++i) {
+        threadManager.enqueueMainThreadTask(
+            [&executed]() {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                ++executed;
+            },
+            "upload",
+            Vengine::TaskPriority::Normal,
+            1000);
+    }
+
+    threadManager.processMainThreadTasks();
+    CHECK(executed >= 1);
+    CHECK(executed <= 3);
+    CHECK(threadManager.getDeferredMainThreadTaskCount() == static_cast<size_t>(10 - executed));
+
+    int frames = 1;
+    while (threadManager.getMainThreadTaskCount() > 0 && frames < 20) {
+        threadManager.processMainThreadTasks();
+        ++frames;
+    }
+    CHECK(executed == 10);
+    CHECK(frames > 3);
+}
+
+TEST_CASE("MainThreadTasksRunInPriorityOrder") {
+    Vengine::ThreadManager threadManager(1);
+    std::vector<int> order;
+
+    threadManager.enqueueMainThreadTask([&order]() { order.push_back(1); }, "low", Vengine::TaskPriority::Low);
+    threadManager.enqueueMainThreadTask([&order]() { order.push_back(2); }, "normal a");
+    threadManager.enqueueMainThreadTask([&order]() { order.push_back(3); }, "high", Vengine::TaskPriority::High);
+    threadManager.enqueueMainThreadTask([&order]() { order.push_back(4); }, "normal b");
+
+    threadManager.setMainThreadBudget(std::chrono::microseconds(0));
+    threadManager.processMainThreadTasks();
+    CHECK(order == std::vector<int>{3, 2, 4, 1});
+}
+
+namespace {
+
+// counts how often the queues copy a task instead of moving it
+struct CopyCounter {
+    std::shared_ptr<std::atomic<int>> copies = std::make_shared<std::atomic<int>>(0);
+    CopyCounter() = default;
+    CopyCounter(const CopyCounter& other) : copies(other.copies) {
+        ++*copies;
+    }
+    CopyCounter(CopyCounter&&) = default;
+    auto operator=(const CopyCounter&) -> CopyCounter& = delete;
+    auto operator=(CopyCounter&&) -> CopyCounter& = delete;
+    ~CopyCounter() = default;
+    void operator()() const {
+    }
+};
+
+}  // namespace
+
+TEST_CASE("MainThreadTasksAreMoved") {
+    Vengine::ThreadManager threadManager(1);
+    CopyCounter counter;
+    auto copies = counter.copies;
+
+    threadManager.enqueueMainThreadTask(std::move(counter), "counted");
+    threadManager.enqueueMainThreadTask([]() {}, "other", Vengine::TaskPriority::High);
+    threadManager.setMainThreadBudget(std::chrono::microseconds(0));
+    threadManager.processMainThreadTasks();
+
+    CHECK(threadManager.getCompletedMainThreadTasks() == 2);
+    CHECK(copies->load() == 0);
+}
+
+TEST_CASE("WorkersKnowTheyAreWorkers") {
+    Vengine::ThreadManager threadManager(2);
+    CHECK_FALSE(threadManager.isWorkerThread());
+    CHECK(threadManager.enqueueTask([&threadManager]() { return threadManager.isWorkerThread(); }).get());
+
+    Vengine::ThreadManager other(1);
+    CHECK_FALSE(threadManager.enqueueTask([&other]() { return other.isWorkerThread(); }).get());
+}
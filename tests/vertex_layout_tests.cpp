@@ -0,0 +1,142 @@
+#include <doctest.h>
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include "vengine/renderer/vertex_layout.hpp"
+
+using Vengine::VertexAttribute;
+using Vengine::VertexFormat;
+using Vengine::VertexLayout;
+
+namespace {
+
+// pos + tex + normal floats for a unit sized shape around the origin
+auto makeVertices(float offset, float texScale) -> std::vector<float> {
+    std::vector<float> vertices;
+    for (int i = 0; i < 64; i++) {
+        float angle = static_cast<float>(i) * 0.1f;
+        float x = std::cos(angle);
+        float y = std::sin(angle);
+        float z = static_cast<float>(i) / 64.0f;
+        float length = std::sqrt(x * x + y * y + z * z);
+        vertices.insert(vertices.end(), {x + offset, y, z, (x + 1.0f) * 0.5f * texScale, z * texScale, x / length,
+                                         y / length, z / length});
+    }
+    return vertices;
+}
+
+template <typename T>
+auto readAt(const std::vector<uint8_t>& bytes, size_t offset) -> T {
+    T value{};
+    std::memcpy(&value, bytes.data() + offset, sizeof(T));
+    return value;
+}
+
+}  // namespace
+
+TEST_CASE("VertexLayoutAlignsElements") {
+    auto floats = VertexLayout::floats(true, true, true);
+    CHECK(floats.stride == 32);
+    CHECK(floats.isFloats());
+    REQUIRE(floats.find(VertexAttribute::Normal) != nullptr);
+    CHECK(floats.find(VertexAttribute::Normal)->offset == 20);
+
+    CHECK(VertexLayout::floats(true, true, false).stride == 20);
+    CHECK_FALSE(VertexLayout::floats(true, false, false).has(VertexAttribute::TexCoords));
+
+    VertexLayout compact;
+    compact.add(VertexAttribute::Position, VertexFormat::Half, 3)
+        .add(VertexAttribute::TexCoords, VertexFormat::Half, 2)
+        .add(VertexAttribute::Normal, VertexFormat::Int2_10_10_10, 3);
+    // 6 bytes of position padded to 8
+    CHECK(compact.find(VertexAttribute::TexCoords)->offset == 8);
+    CHECK(compact.find(VertexAttribute::Normal)->offset == 12);
+    CHECK(compact.stride == 16);
+    CHECK_FALSE(compact.isFloats());
+    CHECK(compact != floats);
+}
+
+TEST_CASE("HalfConversionRoundsToNearestEven") {
+    for (float value : {0.0f, 1.0f, -2.5f, 0.099975586f, 65504.0f, 6.1035156e-05f, 5.9604645e-08f}) {
+        CHECK(Vengine::halfToFloat(Vengine::floatToHalf(value)) == value);
+    }
+    CHECK(Vengine::floatToHalf(1.0f) == 0x3c00);
+    CHECK(Vengine::floatToHalf(-2.0f) == 0xc000);
+    // 1 + 2^-11 is halfway between 1 and the next half, goes to the even one
+    CHECK(Vengine::floatToHalf(1.0f + std::ldexp(1.0f, -11)) == 0x3c00);
+    CHECK(Vengine::floatToHalf(1.0f + 3.0f * std::ldexp(1.0f, -11)) == 0x3c02);
+    CHECK(Vengine::floatToHalf(70000.0f) == 0x7c00);
+    CHECK(Vengine::floatToHalf(-std::numeric_limits<float>::infinity()) == 0xfc00);
+    CHECK(std::isnan(Vengine::halfToFloat(Vengine::floatToHalf(std::numeric_limits<float>::quiet_NaN()))));
+
+    for (float value = -8.0f; value < 8.0f; value += 0.0137f) {
+        CHECK(Vengine::halfToFloat(Vengine::floatToHalf(value)) == doctest::Approx(value).epsilon(1.0 / 2048.0));
+    }
+}
+
+TEST_CASE("Snorm2101010KeepsUnitNormals") {
+    auto packed = Vengine::packSnorm10(1.0f, -1.0f, 0.0f);
+    auto unpacked = Vengine::unpackSnorm10(packed);
+    CHECK(unpacked[0] == 1.0f);
+    CHECK(unpacked[1] == -1.0f);
+    CHECK(unpacked[2] == 0.0f);
+    CHECK(Vengine::unpackSnorm10(Vengine::packSnorm10(3.0f, -3.0f, 0.5f))[0] == 1.0f);
+
+    auto back = Vengine::unpackSnorm10(Vengine::packSnorm10(0.267f, 0.535f, 0.802f));
+    CHECK(back[0] == doctest::Approx(0.267f).epsilon(0.002));
+    CHECK(back[1] == doctest::Approx(0.535f).epsilon(0.002));
+    CHECK(back[2] == doctest::Approx(0.802f).epsilon(0.002));
+}
+
+TEST_CASE("ChooseCompactLayoutHalfOnlyWhereAllowed") {
+    auto source = VertexLayout::floats(true, true, true);
+
+    SUBCASE("centered mesh with unit tex coords") {
+        auto vertices = makeVertices(0.0f, 1.0f);
+        auto layout = Vengine::chooseCompactLayout(vertices.data(), vertices.size() / 8, source);
+        CHECK(layout.find(VertexAttribute::Position)->format == VertexFormat::Half);
+        CHECK(layout.find(VertexAttribute::TexCoords)->format == VertexFormat::Half);
+        CHECK(layout.find(VertexAttribute::Normal)->format == VertexFormat::Int2_10_10_10);
+        CHECK(layout.stride == 16);
+    }
+
+    SUBCASE("mesh far from its origin with tiled tex coords") {
+        auto vertices = makeVertices(5000.0f, 16.0f);
+        auto layout = Vengine::chooseCompactLayout(vertices.data(), vertices.size() / 8, source);
+        CHECK(layout.find(VertexAttribute::Position)->format == VertexFormat::Float);
+        CHECK(layout.find(VertexAttribute::TexCoords)->format == VertexFormat::Float);
+        CHECK(layout.find(VertexAttribute::Normal)->format == VertexFormat::Int2_10_10_10);
+        CHECK(layout.stride == 24);
+    }
+}
+
+TEST_CASE("PackVerticesWritesEveryElement") {
+    auto source = VertexLayout::floats(true, true, true);
+    auto vertices = makeVertices(0.0f, 1.0f);
+    size_t vertexCount = vertices.size() / 8;
+    auto layout = Vengine::chooseCompactLayout(vertices.data(), vertexCount, source);
+    REQUIRE(layout.stride == 16);
+
+    std::vector<uint8_t> packed(vertexCount * layout.stride);
+    Vengine::packVertices(vertices.data(), vertexCount, source, layout, packed.data());
+
+    for (size_t v = 0; v < vertexCount; v++) {
+        const float* expected = vertices.data() + v * 8;
+        size_t base = v * layout.stride;
+        for (size_t k = 0; k < 3; k++) {
+            auto position = Vengine::halfToFloat(readAt<uint16_t>(packed, base + k * 2));
+            CHECK(position == doctest::Approx(expected[k]).epsilon(1.0 / 1024.0));
+        }
+        for (size_t k = 0; k < 2; k++) {
+            auto texCoord = Vengine::halfToFloat(readAt<uint16_t>(packed, base + 8 + k * 2));
+            CHECK(texCoord == doctest::Approx(expected[3 + k]).epsilon(1.0 / 1024.0));
+        }
+        auto normal = Vengine::unpackSnorm10(readAt<uint32_t>(packed, base + 12));
+        for (size_t k = 0; k < 3; k++) {
+            CHECK(std::abs(normal[k] - expected[5 + k]) < 0.002f);
+        }
+    }
+}
@@ -0,0 +1,89 @@
+// packs loose resources into one .vpak the engine mounts at start-up (see Vfs).
+// run it from the directory the engine runs in, entries are stored under the path as given:
+//   asset_pack [--lz4] [--out resources.vpak] resources
+// a cache/ directory can go in as well, .vtex and .vmesh entries then come out of the pack too
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <spdlog/spdlog.h>
+
+#include "vengine/utils/asset_pack.hpp"
+#include "vengine/utils/mapped_file.hpp"
+
+namespace {
+
+auto collectFiles(const std::filesystem::path& input, std::vector<std::filesystem::path>& out) -> void {
+    std::error_code error;
+    if (std::filesystem::is_directory(input, error)) {
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(input, error)) {
+            if (entry.is_regular_file()) {
+                out.push_back(entry.path().lexically_normal());
+            }
+        }
+    } else if (std::filesystem::is_regular_file(input, error)) {
+        out.push_back(input.lexically_normal());
+    } else {
+        spdlog::warn("Skipping {}, not a file or directory", input.string());
+    }
+}
+
+}  // namespace
+
+auto main(int argc, char** argv) -> int {
+    auto compression = Vengine::AssetCompression::None;
+    std::filesystem::path output = "resources.vpak";
+    std::vector<std::filesystem::path> files;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--lz4") {
+            compression = Vengine::AssetCompression::LZ4;
+        } else if (arg == "--out" && i + 1 < argc) {
+            output = argv[++i];
+        } else {
+            collectFiles(arg, files);
+        }
+    }
+
+    if (files.empty()) {
+        spdlog::error("usage: asset_pack [--lz4] [--out file.vpak] <files or directories>");
+        return 1;
+    }
+
+    // directory order, files of one folder end up next to each other in the pack
+    std::sort(files.begin(), files.end());
+    files.erase(std::unique(files.begin(), files.end()), files.end());
+    std::erase(files, output.lexically_normal());
+
+    Vengine::AssetPackWriter writer;
+    if (!writer.open(output)) {
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& path : files) {
+        Vengine::MappedFile file;
+        if (!file.open(path.string())) {
+            spdlog::error("Failed to read {}", path.string());
+            return 1;
+        }
+        if (!writer.add(path, file.data(), file.size(), compression)) {
+            return 1;
+        }
+    }
+    if (!writer.finish()) {
+        return 1;
+    }
+
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    spdlog::info("Packed {} files into {} in {:.2f}s, {} MB stored as {} MB",
+                 writer.getEntryCount(),
+                 output.string(),
+                 elapsed,
+                 writer.getRawBytes() / (1024 * 1024),
+                 writer.getStoredBytes() / (1024 * 1024));
+    return 0;
+}
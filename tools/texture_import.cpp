@@ -0,0 +1,136 @@
+// precomputes .vtex files (mip chain, optionally BC1/BC3) for the runtime texture cache.
+// run it from the directory the engine runs in, cache entries are keyed by the path as given:
+//   texture_import [--compression none|auto|bc1|bc3] [--cache cache/textures] resources/textures resources/models
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+#include <spdlog/spdlog.h>
+
+#include "vengine/core/texture_cache.hpp"
+
+namespace {
+
+auto isImage(const std::filesystem::path& path) -> bool {
+    auto extension = path.extension().string();
+    for (auto& c : extension) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".tga" ||
+           extension == ".bmp";
+}
+
+auto parseCompression(const std::string& value, Vengine::TextureCompression& out) -> bool {
+    if (value == "none") {
+        out = Vengine::TextureCompression::None;
+    } else if (value == "auto") {
+        out = Vengine::TextureCompression::Auto;
+    } else if (value == "bc1") {
+        out = Vengine::TextureCompression::BC1;
+    } else if (value == "bc3") {
+        out = Vengine::TextureCompression::BC3;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+auto collectImages(const std::filesystem::path& input, std::vector<std::filesystem::path>& out) -> void {
+    std::error_code error;
+    if (std::filesystem::is_directory(input, error)) {
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(input, error)) {
+            if (entry.is_regular_file() && isImage(entry.path())) {
+                out.push_back(entry.path().lexically_normal());
+            }
+        }
+    } else if (std::filesystem::is_regular_file(input, error)) {
+        out.push_back(input.lexically_normal());
+    } else {
+        spdlog::warn("Skipping {}, not a file or directory", input.string());
+    }
+}
+
+}  // namespace
+
+auto main(int argc, char** argv) -> int {
+    auto compression = Vengine::TextureCompression::Auto;
+    std::filesystem::path cacheDirectory = "cache/textures";
+    std::vector<std::filesystem::path> images;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--compression" && i + 1 < argc) {
+            if (!parseCompression(argv[++i], compression)) {
+                spdlog::error("Unknown compression {}, expected none, auto, bc1 or bc3", argv[i]);
+                return 1;
+            }
+        } else if (arg == "--cache" && i + 1 < argc) {
+            cacheDirectory = argv[++i];
+        } else {
+            collectImages(arg, images);
+        }
+    }
+
+    if (images.empty()) {
+        spdlog::error("usage: texture_import [--compression none|auto|bc1|bc3] [--cache dir] <files or directories>");
+        return 1;
+    }
+
+    Vengine::TextureCache cache(cacheDirectory);
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> failed{0};
+    std::atomic<uint64_t> sourceBytes{0};
+    std::atomic<uint64_t> storedBytes{0};
+
+    auto start = std::chrono::steady_clock::now();
+    auto worker = [&]() {
+        for (size_t index = next.fetch_add(1); index < images.size(); index = next.fetch_add(1)) {
+            const auto& path = images[index];
+            int width = 0;
+            int height = 0;
+            int channels = 0;
+            unsigned char* pixels = stbi_load(path.string().c_str(), &width, &height, &channels, 0);
+            if (!pixels) {
+                spdlog::error("Failed to decode {}: {}", path.string(), stbi_failure_reason());
+                failed.fetch_add(1);
+                continue;
+            }
+
+            auto data = Vengine::buildTexture(pixels, static_cast<uint32_t>(width), static_cast<uint32_t>(height),
+                                              channels, compression);
+            stbi_image_free(pixels);
+
+            if (!cache.store(path, data)) {
+                failed.fetch_add(1);
+                continue;
+            }
+            sourceBytes.fetch_add(static_cast<uint64_t>(width) * height * channels);
+            storedBytes.fetch_add(data.bytes.size());
+            spdlog::info("{}: {}x{}, {} mips, {} bytes", path.string(), width, height, data.mips.size(),
+                         data.bytes.size());
+        }
+    };
+
+    std::vector<std::thread> threads;
+    unsigned int threadCount = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned int i = 0; i < threadCount; ++i) {
+        threads.emplace_back(worker);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    spdlog::info("Imported {} of {} textures in {:.2f}s, {} MB of pixels stored as {} MB (mips included)",
+                 images.size() - failed.load(), images.size(), elapsed, sourceBytes.load() / (1024 * 1024),
+                 storedBytes.load() / (1024 * 1024));
+    return failed.load() == 0 ? 0 : 1;
+}